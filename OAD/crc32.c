@@ -60,6 +60,13 @@
 /* Warning! this must be a power of 2 less than 1024 */
 #define CRC32_BUF_SZ          256
 
+/*
+ * The CRC is computed a byte at a time from a 1 KB table in flash. Defining
+ * CRC32_SLICE8 computes it 8 bytes at a time instead, from 7 more tables
+ * built in RAM (7 KB) on first use. It reads the image a word at a time and
+ * expects a little endian device.
+ */
+
 /*******************************************************************************
  *                                       Local Variables
  */
@@ -72,26 +79,94 @@ uint8_t crcBuf[CRC32_BUF_SZ];
 uint8_t crcBuf[CRC32_BUF_SZ] __attribute__ ((section (".noinit")));
 #endif
 
+/* CRC32_value() of each byte value */
+static const uint32_t crcTable[256] =
+{
+    0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F,
+    0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4, 0xE0D5E91E, 0x97D2D988,
+    0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2,
+    0xF3B97148, 0x84BE41DE, 0x1ADAD47D, 0x6DDDE4EB, 0xF4D4B551, 0x83D385C7,
+    0x136C9856, 0x646BA8C0, 0xFD62F97A, 0x8A65C9EC, 0x14015C4F, 0x63066CD9,
+    0xFA0F3D63, 0x8D080DF5, 0x3B6E20C8, 0x4C69105E, 0xD56041E4, 0xA2677172,
+    0x3C03E4D1, 0x4B04D447, 0xD20D85FD, 0xA50AB56B, 0x35B5A8FA, 0x42B2986C,
+    0xDBBBC9D6, 0xACBCF940, 0x32D86CE3, 0x45DF5C75, 0xDCD60DCF, 0xABD13D59,
+    0x26D930AC, 0x51DE003A, 0xC8D75180, 0xBFD06116, 0x21B4F4B5, 0x56B3C423,
+    0xCFBA9599, 0xB8BDA50F, 0x2802B89E, 0x5F058808, 0xC60CD9B2, 0xB10BE924,
+    0x2F6F7C87, 0x58684C11, 0xC1611DAB, 0xB6662D3D, 0x76DC4190, 0x01DB7106,
+    0x98D220BC, 0xEFD5102A, 0x71B18589, 0x06B6B51F, 0x9FBFE4A5, 0xE8B8D433,
+    0x7807C9A2, 0x0F00F934, 0x9609A88E, 0xE10E9818, 0x7F6A0DBB, 0x086D3D2D,
+    0x91646C97, 0xE6635C01, 0x6B6B51F4, 0x1C6C6162, 0x856530D8, 0xF262004E,
+    0x6C0695ED, 0x1B01A57B, 0x8208F4C1, 0xF50FC457, 0x65B0D9C6, 0x12B7E950,
+    0x8BBEB8EA, 0xFCB9887C, 0x62DD1DDF, 0x15DA2D49, 0x8CD37CF3, 0xFBD44C65,
+    0x4DB26158, 0x3AB551CE, 0xA3BC0074, 0xD4BB30E2, 0x4ADFA541, 0x3DD895D7,
+    0xA4D1C46D, 0xD3D6F4FB, 0x4369E96A, 0x346ED9FC, 0xAD678846, 0xDA60B8D0,
+    0x44042D73, 0x33031DE5, 0xAA0A4C5F, 0xDD0D7CC9, 0x5005713C, 0x270241AA,
+    0xBE0B1010, 0xC90C2086, 0x5768B525, 0x206F85B3, 0xB966D409, 0xCE61E49F,
+    0x5EDEF90E, 0x29D9C998, 0xB0D09822, 0xC7D7A8B4, 0x59B33D17, 0x2EB40D81,
+    0xB7BD5C3B, 0xC0BA6CAD, 0xEDB88320, 0x9ABFB3B6, 0x03B6E20C, 0x74B1D29A,
+    0xEAD54739, 0x9DD277AF, 0x04DB2615, 0x73DC1683, 0xE3630B12, 0x94643B84,
+    0x0D6D6A3E, 0x7A6A5AA8, 0xE40ECF0B, 0x9309FF9D, 0x0A00AE27, 0x7D079EB1,
+    0xF00F9344, 0x8708A3D2, 0x1E01F268, 0x6906C2FE, 0xF762575D, 0x806567CB,
+    0x196C3671, 0x6E6B06E7, 0xFED41B76, 0x89D32BE0, 0x10DA7A5A, 0x67DD4ACC,
+    0xF9B9DF6F, 0x8EBEEFF9, 0x17B7BE43, 0x60B08ED5, 0xD6D6A3E8, 0xA1D1937E,
+    0x38D8C2C4, 0x4FDFF252, 0xD1BB67F1, 0xA6BC5767, 0x3FB506DD, 0x48B2364B,
+    0xD80D2BDA, 0xAF0A1B4C, 0x36034AF6, 0x41047A60, 0xDF60EFC3, 0xA867DF55,
+    0x316E8EEF, 0x4669BE79, 0xCB61B38C, 0xBC66831A, 0x256FD2A0, 0x5268E236,
+    0xCC0C7795, 0xBB0B4703, 0x220216B9, 0x5505262F, 0xC5BA3BBE, 0xB2BD0B28,
+    0x2BB45A92, 0x5CB36A04, 0xC2D7FFA7, 0xB5D0CF31, 0x2CD99E8B, 0x5BDEAE1D,
+    0x9B64C2B0, 0xEC63F226, 0x756AA39C, 0x026D930A, 0x9C0906A9, 0xEB0E363F,
+    0x72076785, 0x05005713, 0x95BF4A82, 0xE2B87A14, 0x7BB12BAE, 0x0CB61B38,
+    0x92D28E9B, 0xE5D5BE0D, 0x7CDCEFB7, 0x0BDBDF21, 0x86D3D2D4, 0xF1D4E242,
+    0x68DDB3F8, 0x1FDA836E, 0x81BE16CD, 0xF6B9265B, 0x6FB077E1, 0x18B74777,
+    0x88085AE6, 0xFF0F6A70, 0x66063BCA, 0x11010B5C, 0x8F659EFF, 0xF862AE69,
+    0x616BFFD3, 0x166CCF45, 0xA00AE278, 0xD70DD2EE, 0x4E048354, 0x3903B3C2,
+    0xA7672661, 0xD06016F7, 0x4969474D, 0x3E6E77DB, 0xAED16A4A, 0xD9D65ADC,
+    0x40DF0B66, 0x37D83BF0, 0xA9BCAE53, 0xDEBB9EC5, 0x47B2CF7F, 0x30B5FFE9,
+    0xBDBDF21C, 0xCABAC28A, 0x53B39330, 0x24B4A3A6, 0xBAD03605, 0xCDD70693,
+    0x54DE5729, 0x23D967BF, 0xB3667A2E, 0xC4614AB8, 0x5D681B02, 0x2A6F2B94,
+    0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
+};
+
+#ifdef CRC32_SLICE8
+/* crcSlice[k][n] is the CRC of byte n followed by k + 1 zero bytes */
+static uint32_t crcSlice[7][256];
+static bool crcSliceReady = false;
+#endif
+
 /*******************************************************************************
  * @fn          CRC32_memCpy
  *
- * @brief       Copies source buffer to destination buffer.
+ * @brief       Copies source buffer to destination buffer, a word at a time
+ *              when both are word aligned.
  *
  * @param       dest  - Destination buffer.
- * @param       src   - Destination buffer.
- * @param       len   - Destination buffer.
+ * @param       src   - Source buffer.
+ * @param       len   - Number of bytes to copy.
  *
  * @return      pointer to destination buffer.
  */
 void *CRC32_memCpy(void *dest, const void *src, uint16_t len)
 {
+    uint8_t *pDst = (uint8_t *)dest;
+    const uint8_t *pSrc = (const uint8_t *)src;
+
     if(dest == NULL)
     {
         return(NULL);
     }
+    if((((uintptr_t)pDst | (uintptr_t)pSrc) & 3) == 0)
+    {
+        while(len >= 4)
+        {
+            *(uint32_t *)pDst = *(const uint32_t *)pSrc;
+            pDst += 4;
+            pSrc += 4;
+            len -= 4;
+        }
+    }
     while(len--)
     {
-        ((uint8_t *)dest)[len] = ((uint8_t *)src)[len];
+        *pDst++ = *pSrc++;
     }
     return(dest);
 }
@@ -107,24 +182,89 @@ void *CRC32_memCpy(void *dest, const void *src, uint16_t len)
  */
 uint32_t CRC32_value(uint32_t inCRC)
 {
-    uint8_t  j;
-    uint32_t ulCRC = inCRC;
+    /* the 8 shifts of the low byte, and what is left of the word */
+    return((inCRC >> 8) ^ crcTable[inCRC & 0xFF]);
+}
 
-    /* for this byte (inCRC).. */
-    for (j = 8; j; j--)
+#ifdef CRC32_SLICE8
+/*******************************************************************************
+ * @fn          CRC32_initSlices
+ *
+ * @brief       Builds the tables of 8 bytes at a time from the byte table.
+ *
+ * @return      none
+ */
+static void CRC32_initSlices(void)
+{
+    uint16_t n;
+    uint8_t k;
+    uint32_t crc;
+
+    for(n = 0; n < 256; n++)
     {
-        /* lsb on? yes -- shift right and XOR with poly. else just shift */
-        if (ulCRC & 1)
-        {
-            ulCRC = (ulCRC >> 1) ^ CRC32_POLYNOMIAL;
-        }
-        else
+        crc = crcTable[n];
+        for(k = 0; k < 7; k++)
         {
-            ulCRC >>= 1;
+            crc = (crc >> 8) ^ crcTable[crc & 0xFF];
+            crcSlice[k][n] = crc;
         }
     }
+    crcSliceReady = true;
+}
+#endif
 
-    return(ulCRC);
+/*******************************************************************************
+ * @fn          CRC32_update
+ *
+ * @brief       Runs the CRC over a buffer. A CRC starts at 0xFFFFFFFF, the
+ *              value CRC32_calc() returns is the last one XORed with
+ *              0xFFFFFFFF.
+ *
+ * @param       crc  - CRC so far.
+ * @param       pBuf - bytes to add.
+ * @param       len  - number of bytes.
+ *
+ * @return      the updated CRC.
+ */
+uint32_t CRC32_update(uint32_t crc, const uint8_t *pBuf, uint32_t len)
+{
+#ifdef CRC32_SLICE8
+    uint32_t one;
+    uint32_t two;
+
+    if(!crcSliceReady)
+    {
+        CRC32_initSlices();
+    }
+
+    /* Bytes up to a word boundary, then 8 at a time */
+    while(len && ((uintptr_t)pBuf & 3))
+    {
+        crc = (crc >> 8) ^ crcTable[(crc ^ *pBuf++) & 0xFF];
+        len--;
+    }
+    while(len >= 8)
+    {
+        one = *(const uint32_t *)pBuf ^ crc;
+        two = *(const uint32_t *)(pBuf + 4);
+        crc = crcSlice[6][one & 0xFF] ^
+              crcSlice[5][(one >> 8) & 0xFF] ^
+              crcSlice[4][(one >> 16) & 0xFF] ^
+              crcSlice[3][one >> 24] ^
+              crcSlice[2][two & 0xFF] ^
+              crcSlice[1][(two >> 8) & 0xFF] ^
+              crcSlice[0][(two >> 16) & 0xFF] ^
+              crcTable[two >> 24];
+        pBuf += 8;
+        len -= 8;
+    }
+#endif
+    while(len--)
+    {
+        crc = (crc >> 8) ^ crcTable[(crc ^ *pBuf++) & 0xFF];
+    }
+
+    return(crc);
 }
 
 /*******************************************************************************
@@ -142,13 +282,15 @@ uint32_t CRC32_value(uint32_t inCRC)
  */
 uint32_t CRC32_calc(uint8_t page, uint32_t pageSize, uint16_t offset, uint32_t len, bool useExtFl)
 {
-    uint8_t pageIdx;
-    uint8_t pageBeg = page;
-    uint8_t pageEnd;
-    uint16_t numBytesInLastPg;
-    uint32_t temp1 = pageSize, temp2, crc = 0;
-    uint16_t oset = 0;
-    uint8_t bufNum;
+    uint16_t pageIdx;
+    uint16_t pageBeg = page;
+    uint16_t pageEnd;
+    uint32_t numBytesInCurPg;
+    uint32_t bufOfs;
+    uint16_t bufLen;
+    uint16_t oset;
+    const uint8_t *pBuf;
+    uint32_t crc = 0;
 
     /* Check for invalid length */
     if((len == 0) || (len == 0xFFFFFFFF) ||
@@ -157,102 +299,52 @@ uint32_t CRC32_calc(uint8_t page, uint32_t pageSize, uint16_t offset, uint32_t l
     {
         return crc;
     }
-    /* Read first page of the image into the buffer. */
-    if(!useExtFl)
-    {
-        CRC32_memCpy(crcBuf, (uint8_t *)(page * pageSize), CRC32_BUF_SZ);
-    }
-    else
-    {
-        readFlashPg(page, 0, crcBuf, CRC32_BUF_SZ);
-    }
 
     pageEnd = ((len - 1) / (pageSize) + pageBeg);
 
-    /* Determine the number of bytes in the last page */
-    numBytesInLastPg = ((len - 1) % pageSize) + 1;
-
     crc = 0xFFFFFFFF;
 
     /* Read over image pages. */
     for (pageIdx = pageBeg; pageIdx <= pageEnd; pageIdx++)
     {
-        uint8_t numBufInCurPg;
-
-        /* Find the number of buffers within this page */
+        /* Determine the number of bytes in this page */
         if(pageIdx == pageEnd)
         {
-            /* Number of bytes divided by buf_sz is the number of buffers */
-            numBufInCurPg = numBytesInLastPg / CRC32_BUF_SZ;
-
-            /* Round up a buffer if a partial buffer must be used */
-            if(numBytesInLastPg % CRC32_BUF_SZ != 0)
-            {
-                numBufInCurPg++;
-            }
+            numBytesInCurPg = ((len - 1) % pageSize) + 1;
         }
         else
         {
-            /* Note this requires that pageSize is an integer multiple of
-              CRC32_BUF_SZ */
-            numBufInCurPg = pageSize / CRC32_BUF_SZ;
+            numBytesInCurPg = pageSize;
         }
+
         /* Read over buffers within each page */
-        for(bufNum = 0; bufNum < numBufInCurPg; bufNum++)
+        for(bufOfs = 0; bufOfs < numBytesInCurPg; bufOfs += CRC32_BUF_SZ)
         {
-            /* Find ending offset in bytes last buffer. */
-            uint16_t osetEnd;
-            /* Calculate the ending offset for this buffer */
-            if(bufNum == (numBufInCurPg - 1) && pageIdx == pageEnd)
+            bufLen = CRC32_BUF_SZ;
+            if(numBytesInCurPg - bufOfs < CRC32_BUF_SZ)
             {
-                if(numBytesInLastPg % CRC32_BUF_SZ != 0)
-                {
-                    osetEnd = (numBytesInLastPg % CRC32_BUF_SZ );
-                }
-                else
-                {
-                    osetEnd = CRC32_BUF_SZ;
-                }
-            }
-            else
-            {
-                osetEnd = CRC32_BUF_SZ;
-            }
-
-            /* Read over all flash words in a buffer, excluding the CRC section
-             * of the first page and all bytes after the remainder bytes in the
-             * last buffer
-             */
-            for (oset = ((pageIdx == pageBeg && bufNum == 0) ? offset + IMG_DATA_OFFSET : 0);
-                     oset < osetEnd;
-                     oset++)
-            {
-                temp1 = (crc >> 8) & 0x00FFFFFFL;
-                temp2 = CRC32_value(((uint32_t)crc ^ crcBuf[oset]) & 0xFF);
-                crc = temp1 ^ temp2;
+                bufLen = numBytesInCurPg - bufOfs;
             }
 
-            /* Read data into the next buffer */
+            /* Internal flash is read in place, external flash is copied */
             if(!useExtFl)
             {
-                CRC32_memCpy(crcBuf, (uint8_t *)((pageIdx*pageSize) + ((bufNum + 1)*CRC32_BUF_SZ)),
-                        CRC32_BUF_SZ);
+                pBuf = (const uint8_t *)(uintptr_t)((pageIdx * pageSize) + bufOfs);
             }
             else
             {
-                /* Check to see    if the next buffer is on the next page */
-                if(bufNum    == (numBufInCurPg - 1))
-                {
-                    readFlashPg((pageIdx + 1), 0, crcBuf, CRC32_BUF_SZ);
-                }
-                else
-                {
-                    readFlashPg(pageIdx, ((bufNum + 1)*CRC32_BUF_SZ), crcBuf,
-                                      CRC32_BUF_SZ);
-                }
+                readFlashPg(pageIdx, bufOfs, crcBuf, bufLen);
+                pBuf = crcBuf;
+            }
+
+            /* Skip the CRC section of the first page */
+            oset = ((pageIdx == pageBeg && bufOfs == 0) ? offset + IMG_DATA_OFFSET : 0);
+            if(oset < bufLen)
+            {
+                crc = CRC32_update(crc, pBuf + oset, bufLen - oset);
             }
-        } /* for(uint8_t bufNum = 0; bufNum < numBufInCurPg; bufNum++) */
-    } /* for (uint8_t pageIdx = pageBeg; pageIdx <= pageEnd; pageIdx++) */
+        } /* for(bufOfs = 0; bufOfs < numBytesInCurPg; bufOfs += CRC32_BUF_SZ) */
+    } /* for (pageIdx = pageBeg; pageIdx <= pageEnd; pageIdx++) */
 
     /* XOR CRC with all bits on */
     crc = crc ^ 0xFFFFFFFF;
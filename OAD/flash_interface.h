@@ -75,7 +75,9 @@
  *        (external flash) using NVS driver
  *
  *  To select the interface, the user should include one of the above .c
- *  files within their project
+ *  files within their project. Each of them defines all the functions of
+ *  this header, flash_flush() included: an interface without a write buffer
+ *  defines it as returning @ref FLASH_SUCCESS.
  *
  *  ## Initialzation
  *    Initialze the module as shown below
@@ -286,6 +288,17 @@ extern uint8_t writeFlash(uint_least32_t addr, uint8_t *pBuf, size_t len);
 extern uint8_t writeFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf,
                             uint16_t len);
 
+/*!
+ * Program the bytes of writes kept in a write buffer, if the interface has
+ * one. Reads see the bytes kept, but they are only in flash once flushed,
+ * and a write may report the failure to program bytes kept from the ones
+ * before it. An interface without a buffer returns @ref FLASH_SUCCESS.
+ *
+ * @return  status - @ref FLASH_SUCCESS if programmed successfully or
+ *                   @ref FLASH_FAILURE if programming failed
+ */
+extern uint8_t flash_flush(void);
+
 /*!
  * Erase selected flash page.
  *
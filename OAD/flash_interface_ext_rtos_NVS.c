@@ -48,6 +48,8 @@
  * INCLUDES
  */
 
+#include <string.h>
+
 #include <common/cc26xx/flash_interface/flash_interface.h>
 #include <ti_drivers_config.h>
 #include <ti/drivers/NVS.h>
@@ -56,6 +58,15 @@
  * Constants and macros
  */
 
+/*
+ * Consecutive writes are combined in a buffer of this size, a program page
+ * of the flash, and programmed together. It must be a power of 2 that
+ * divides EFL_PAGE_SIZE.
+ */
+#ifndef FLASH_WRITE_BUF_SZ
+#define FLASH_WRITE_BUF_SZ  256
+#endif
+
 /*******************************************************************************
  * PRIVATE VARIABLES
  */
@@ -64,9 +75,20 @@ static NVS_Handle nvsHandle;
 static NVS_Attrs regionAttrs;
 static NVS_Params nvsParams;
 
+// Bytes written but not programmed yet, from writeBufAddr on, all in one
+// program page
+static uint8_t writeBuf[FLASH_WRITE_BUF_SZ];
+static uint32_t writeBufAddr = 0;
+static uint16_t writeBufLen = 0;
+// NVS_write() flags of the bytes in the buffer
+static uint_fast16_t writeBufFlags = 0;
+
 /*******************************************************************************
  * PRIVATE FUNCTIONS
  */
+static bool flashBufOverlaps(uint32_t addr, size_t len);
+static uint8_t flashWrite(uint32_t addr, uint8_t *pBuf, size_t len,
+                          uint_fast16_t flags);
 
 /*******************************************************************************
  * FUNCTIONS
@@ -126,6 +148,7 @@ void flash_close(void)
 {
   if (isOpen)
   {
+    flash_flush();
     NVS_close(nvsHandle);
     isOpen = false;
   }
@@ -163,6 +186,13 @@ uint8_t readFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len)
 
   if(isOpen)
   {
+    // Bytes still in the write buffer are programmed first
+    if(flashBufOverlaps(EXT_FLASH_ADDRESS(page, offset), len) &&
+       (flash_flush() != FLASH_SUCCESS))
+    {
+        return (flashStat);
+    }
+
     if(NVS_read(nvsHandle, EXT_FLASH_ADDRESS(page,offset), pBuf, len)
                 == NVS_STATUS_SUCCESS)
     {
@@ -189,6 +219,12 @@ uint8_t readFlash(uint_least32_t addr, uint8_t *pBuf, size_t len)
 
   if(isOpen)
   {
+    // Bytes still in the write buffer are programmed first
+    if(flashBufOverlaps(addr, len) && (flash_flush() != FLASH_SUCCESS))
+    {
+        return (flashStat);
+    }
+
     if(NVS_read(nvsHandle, addr, pBuf, len) == NVS_STATUS_SUCCESS)
     {
         flashStat = FLASH_SUCCESS;
@@ -200,7 +236,8 @@ uint8_t readFlash(uint_least32_t addr, uint8_t *pBuf, size_t len)
 /*********************************************************************
  * @fn      writeFlashPg
  *
- * @brief   Write data to flash.
+ * @brief   Write data to flash. The end of it may be kept in the write
+ *          buffer, see flash_flush().
  *
  * @param   page   - page to write to in flash
  * @param   offset - offset into flash page to begin writing
@@ -215,11 +252,8 @@ uint8_t writeFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len)
   uint8_t flashStat = FLASH_FAILURE;
   if(isOpen)
   {
-    if(NVS_write(nvsHandle, (uint32_t)EXT_FLASH_ADDRESS(page, offset),
-                          pBuf, len, NVS_WRITE_POST_VERIFY) == NVS_STATUS_SUCCESS)
-    {
-        flashStat = FLASH_SUCCESS;
-    }
+    flashStat = flashWrite((uint32_t)EXT_FLASH_ADDRESS(page, offset), pBuf, len,
+                           NVS_WRITE_POST_VERIFY);
   }
   return (flashStat);
 }
@@ -227,7 +261,8 @@ uint8_t writeFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf, uint16_t len)
 /*********************************************************************
  * @fn      writeFlash
  *
- * @brief   Write data to flash.
+ * @brief   Write data to flash. The end of it may be kept in the write
+ *          buffer, see flash_flush().
  *
  * @param   addr   - address to write to in flash
  * @param   pBuf   - pointer to buffer of data to write
@@ -241,15 +276,41 @@ uint8_t writeFlash(uint_least32_t addr, uint8_t *pBuf, size_t len)
     uint8_t flashStat = FLASH_FAILURE;
     if(isOpen)
     {
-        if(NVS_write(nvsHandle, addr,  pBuf, len, NVS_WRITE_PRE_VERIFY | NVS_WRITE_POST_VERIFY)
-                 == NVS_STATUS_SUCCESS)
-       {
-           flashStat = FLASH_SUCCESS;
-       }
+        flashStat = flashWrite(addr, pBuf, len,
+                               NVS_WRITE_PRE_VERIFY | NVS_WRITE_POST_VERIFY);
     }
     return (flashStat);
 }
 
+/*********************************************************************
+ * @fn      flash_flush
+ *
+ * @brief   Program the bytes kept in the write buffer.
+ *
+ * @param   None.
+ *
+ * @return  status - FLASH_SUCCESS if programmed successfully or
+ *                   FLASH_FAILURE if programming failed
+ */
+uint8_t flash_flush(void)
+{
+    uint8_t flashStat = FLASH_SUCCESS;
+
+    if(writeBufLen != 0)
+    {
+        if(!isOpen ||
+           (NVS_write(nvsHandle, writeBufAddr, writeBuf, writeBufLen,
+                      writeBufFlags) != NVS_STATUS_SUCCESS))
+        {
+            flashStat = FLASH_FAILURE;
+        }
+        writeBufLen = 0;
+        writeBufFlags = 0;
+    }
+
+    return (flashStat);
+}
+
 /*********************************************************************
  * @fn      eraseFlashPg
  *
@@ -265,6 +326,13 @@ uint8_t eraseFlashPg(uint8_t page)
   uint8_t flashStat = FLASH_FAILURE;
   if(isOpen)
   {
+      // Bytes still to be written to the page would be erased anyway
+      if(flashBufOverlaps(EXT_FLASH_ADDRESS(page, 0), EFL_PAGE_SIZE))
+      {
+          writeBufLen = 0;
+          writeBufFlags = 0;
+      }
+
       if(NVS_erase(nvsHandle, EXT_FLASH_ADDRESS(page,0), EFL_PAGE_SIZE)
          == NVS_STATUS_SUCCESS)
       {
@@ -275,4 +343,95 @@ uint8_t eraseFlashPg(uint8_t page)
   return flashStat;
 }
 
+/*********************************************************************
+ * @fn      flashBufOverlaps
+ *
+ * @brief   Check if flash bytes are in the write buffer.
+ *
+ * @param   addr   - address of the bytes
+ * @param   len    - number of bytes
+ *
+ * @return  TRUE if any of them are
+ */
+static bool flashBufOverlaps(uint32_t addr, size_t len)
+{
+    return ((writeBufLen != 0) && (addr < (writeBufAddr + writeBufLen)) &&
+            ((addr + len) > writeBufAddr));
+}
+
+/*********************************************************************
+ * @fn      flashWrite
+ *
+ * @brief   Write data to flash through the write buffer. Whole program
+ *          pages are programmed as they are, the bytes of a page in part
+ *          are kept in the buffer until the page is full or another
+ *          write does not follow them.
+ *
+ * @param   addr   - address to write to in flash
+ * @param   pBuf   - pointer to buffer of data to write
+ * @param   len    - length of data to write in bytes
+ * @param   flags  - NVS_write() flags
+ *
+ * @return  status - FLASH_SUCCESS if programmed successfully or
+ *                   FLASH_FAILURE if programming failed, of this write or
+ *                   of bytes kept from the writes before it
+ */
+static uint8_t flashWrite(uint32_t addr, uint8_t *pBuf, size_t len,
+                          uint_fast16_t flags)
+{
+    uint32_t pageEnd;
+    size_t n;
+
+    while(len > 0)
+    {
+        pageEnd = (addr & ~(uint32_t)(FLASH_WRITE_BUF_SZ - 1)) +
+                  FLASH_WRITE_BUF_SZ;
+
+        // Only bytes that follow the ones kept go in the buffer, a full
+        // buffer was programmed already
+        if((writeBufLen != 0) && (addr != (writeBufAddr + writeBufLen)))
+        {
+            if(flash_flush() != FLASH_SUCCESS)
+            {
+                return (FLASH_FAILURE);
+            }
+        }
+
+        if((writeBufLen == 0) &&
+           (len >= FLASH_WRITE_BUF_SZ) &&
+           (addr == (pageEnd - FLASH_WRITE_BUF_SZ)))
+        {
+            // Whole program pages
+            n = len & ~(size_t)(FLASH_WRITE_BUF_SZ - 1);
+            if(NVS_write(nvsHandle, addr, pBuf, n, flags) != NVS_STATUS_SUCCESS)
+            {
+                return (FLASH_FAILURE);
+            }
+        }
+        else
+        {
+            n = ((pageEnd - addr) < len) ? (pageEnd - addr) : len;
+            if(writeBufLen == 0)
+            {
+                writeBufAddr = addr;
+            }
+            memcpy(&writeBuf[writeBufLen], pBuf, n);
+            writeBufLen += n;
+            writeBufFlags |= flags;
+
+            if((addr + n) == pageEnd)
+            {
+                if(flash_flush() != FLASH_SUCCESS)
+                {
+                    return (FLASH_FAILURE);
+                }
+            }
+        }
+
+        addr += n;
+        pBuf += n;
+        len -= n;
+    }
 
+    return (FLASH_SUCCESS);
+}
@@ -47,6 +47,7 @@
 /*********************************************************************
  * INCLUDES
  */
+#include <stddef.h>
 #include <string.h>
 #include <driverlib/chipinfo.h>
 #include <driverlib/flash.h>
@@ -62,6 +63,7 @@
 #include <common/cc26xx/oad/ext_flash_layout.h>
 #include "oad_defines.h"
 #include "oad.h"
+#include "oad_lz.h"
 
 /*********************************************************************
  * CONSTANTS
@@ -71,6 +73,21 @@
 
 #define OAD_EFL_IMG_REGION      OAD_EFL_MAX_META*EFL_PAGE_SIZE
 
+// Resume record of a download in external flash, in its meta page past the
+// ExtImageInfo_t that is written there once the download completes
+#define OAD_RESUME_OFS          0x100
+#define OAD_RESUME_MAGIC        {'O', 'A', 'D', ' ', 'R', 'S', 'M', '1'}
+
+// Bitmap of the blocks in flash after the record, a cleared bit per block
+#define OAD_RESUME_MAP_OFS      (OAD_RESUME_OFS + sizeof(oadResumeRec_t))
+#define OAD_RESUME_MAX_BLKS     ((EFL_PAGE_SIZE - OAD_RESUME_MAP_OFS) * 8)
+
+// Image pages erased past the last one written, while the blocks requested
+// are on their way
+#ifndef OAD_ERASE_AHEAD
+#define OAD_ERASE_AHEAD         1
+#endif
+
 /*********************************************************************
  * MACROS
  */
@@ -86,8 +103,18 @@ typedef struct
     uint32_t counter;
     uint32_t startAddress;
     uint32_t length;
+    imageInfo_t info;           // Copy and CRC status, type and number
+    uint16_t techType;
 }ImageSizeInfo_t;
 
+typedef struct
+{
+    imgIdentifyPld_t idPld;     // Image identify the download was started with
+    uint32_t imgAddr;           // Address of the image in external flash
+    uint16_t blkSize;           // Block size, the bitmap has a bit per block
+    uint8_t  magic[8];          // Written last, the record is valid with it
+}oadResumeRec_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -273,6 +300,50 @@ static uint16_t oadImgBytesPerBlock = OAD_DEFAULT_BLOCK_SIZE - OAD_BLK_NUM_HDR_S
 static uint8_t  blkReqActive = true;
 static uint8_t numBlksInImgHdr = 0;
 
+// Running CRC of the image blocks received so far, see CRC32_update()
+static uint32_t oadImgCrc = 0xFFFFFFFF;
+
+// Block window set by the peer, 1 for one block request at a time
+static uint8_t  oadBlkWin = 1;
+// Window in use, it shrinks on a loss and grows back as blocks come in order
+static uint8_t  oadBlkWinCur = 1;
+// Blocks received in order since the window last grew
+static uint8_t  oadBlkWinRun = 0;
+// Blocks after oadBlkNum received ahead of it, bit 0 is oadBlkNum + 1
+static uint32_t oadBlkWinMap = 0;
+// First block not requested yet
+static uint32_t oadBlkReqNext = 0;
+// Blocks missing below this one were already requested again
+static uint32_t oadBlkLossMark = 0;
+
+// The download has a resume record in its meta page
+static bool     oadResumeRec = false;
+// Bytes of the resume bitmap cleared, the blocks before them are in flash
+static uint32_t oadResumeMapLen = 0;
+// Block a resumed download starts at, 0 for a new one
+static uint32_t oadResumeBlk = 0;
+// Image identify of the download, kept in its resume record
+static imgIdentifyPld_t oadResumeId;
+
+// Decoder of a compressed image, NULL if the image is sent as is
+static OADLz_t *oadLz = NULL;
+// Bytes of a compressed image decoded into flash after its header
+static uint32_t oadLzOfs = 0;
+
+// Metadata of the images in external flash, by meta page, read once and
+// kept up to date as OAD writes and erases it
+static ImageSizeInfo_t oadImgDir[OAD_EFL_MAX_META];
+// Meta pages of the images, by start address
+static uint8_t oadImgDirOrder[OAD_EFL_MAX_META];
+static uint8_t oadImgDirCnt = 0;
+static bool    oadImgDirValid = false;
+
+// Image pages from oadEraseNext to before oadEraseEnd are not erased yet
+static uint16_t oadEraseNext = 0;
+static uint16_t oadEraseEnd = 0;
+// Last image page written
+static uint16_t oadWritePage = 0;
+
 /* Information about image that is currently being downloaded */
 static uint32_t imageAddress = 0;
 static uint16_t imagePage = 0;
@@ -331,6 +402,34 @@ static uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t le
 static void oadGetNextBlockReq(uint16_t connHandle, uint32_t blkNum,
                                 uint8_t status);
 
+static void oadRequestBlocks(uint16_t connHandle, uint8_t status);
+
+static uint8_t oadImgBlockAhead(uint32_t blkNum, uint8_t *pValue, uint8_t len);
+
+static void oadGetBlockAddr(uint32_t blkNum, uint8_t *pPage, uint32_t *pOffset);
+
+static void oadGetImgAddr(uint32_t imgOfs, uint8_t *pPage, uint32_t *pOffset);
+
+static void oadCrcAddBlock(uint32_t blkNum);
+
+static bool oadResumeFind(imgIdentifyPld_t *idPld);
+
+static void oadResumeStart(void);
+
+static void oadResumeMark(void);
+
+static void oadResumeDrop(uint8_t page);
+
+static uint8_t oadLzDecode(uint8_t *pBuf, uint16_t len);
+
+static bool oadLzOut(const uint8_t *pBuf, uint16_t len);
+
+static void oadLzFree(void);
+
+static uint8_t oadEraseTo(uint16_t lastPage);
+
+static uint8_t oadEraseForWrite(uint8_t page, uint32_t offset, uint32_t len);
+
 static uint8_t oadEnqueueMsg(oadEvent_e event, uint16_t connHandle,
                              uint8_t *pData, uint16_t len);
 
@@ -351,11 +450,12 @@ static void oadInactivityTimeout(UArg param);
 static uint8_t oadCheckImageID(imgIdentifyPld_t *idPld);
 
 static uint32_t oadFindFactImgAddr();
-static uint8_t oadFindExtFlMetaPage(uint16_t *metaPg, ImageSizeInfo_t *imgInfo);
-static uint32_t oadFindExtFlImgAddr(ImageSizeInfo_t *extImgInfo,
-                                    uint32_t  candiateLen);
-static void oadSortImgInfo(ImageSizeInfo_t *extImgInfo, uint8_t numImgs);
+static uint8_t oadFindExtFlMetaPage(uint16_t *metaPg);
+static uint32_t oadFindExtFlImgAddr(uint32_t  candiateLen);
 static uint16_t oadFindleastRecentlyUsedIdx(ImageSizeInfo_t *extImgInfo, uint8_t numImgs);
+static void oadImgDirLoad(void);
+static void oadImgDirSet(uint8_t page, ExtImageInfo_t *pMeta);
+static void oadImgDirRemove(uint8_t page);
 
 static uint8_t oadEraseExtFlashPages(uint8_t startAddr, uint32_t imgLen,
                                      uint32_t pageSize);
@@ -681,12 +781,15 @@ uint8_t OAD_processQueue(void)
                                                 oadWriteEvt->pData,
                                                 oadWriteEvt->len);
 
-                    // Request the next block
-                    oadGetNextBlockReq(oadWriteEvt->connHandle, oadBlkNum,
-                                        status);
+                    // Request the next block, or the next ones in the window
+                    oadRequestBlocks(oadWriteEvt->connHandle, status);
 
                     if(status == OAD_SUCCESS)
                     {
+                        // Erase ahead while the blocks are on their way, a
+                        // failure shows up when a block is written there
+                        oadEraseTo(oadWritePage + OAD_ERASE_AHEAD);
+
                         // If the block write was successful but the process
                         // is not complete then stay in download state
                         nextState = OAD_DOWNLOAD;
@@ -945,6 +1048,14 @@ uint8_t oadImgIdentifyWrite(uint16_t connHandle, uint8_t *pValue, uint16_t len,
     // If image ID is accepted, set variables and pre-erase flash pages
     if(idStatus == OAD_SUCCESS && verifStatus == OAD_SUCCESS)
     {
+        // Calculate total number of OAD blocks, round up if needed
+        oadBlkTot = candidateImageLength / (oadImgBytesPerBlock);
+
+        // If there is a remainder after division, round up
+        if( 0 != (candidateImageLength % (oadImgBytesPerBlock)))
+        {
+            oadBlkTot += 1;
+        }
 
         if(!useExternalFlash)
         {
@@ -952,28 +1063,23 @@ uint8_t oadImgIdentifyWrite(uint16_t connHandle, uint8_t *pValue, uint16_t len,
             imagePage = 0;
             metaPage = 0;
         }
+        else if(oadResumeFind(idPld))
+        {
+            // The image was partly downloaded before, carry on from there
+        }
         else
         {
-            ImageSizeInfo_t extFlInfo[OAD_EFL_MAX_META] = {0};
+            memcpy(&oadResumeId, idPld, sizeof(imgIdentifyPld_t));
 
-            // Warning: oadFindExtFlMetaPage needs to be called first
-            // to populate the imageInfo structure.
-            oadFindExtFlMetaPage(&metaPage, extFlInfo);
+            // Warning: oadFindExtFlMetaPage needs to be called first,
+            // it frees the meta page of the image in the image directory
+            oadFindExtFlMetaPage(&metaPage);
             // oadFindExtFlImgAddr will find a suitable region
-            // based on ext meta
-            imageAddress = oadFindExtFlImgAddr(extFlInfo , idPld->len);
+            // based on the image directory
+            imageAddress = oadFindExtFlImgAddr(idPld->len);
             imagePage = EXT_FLASH_PAGE(imageAddress);
         }
 
-        // Calculate total number of OAD blocks, round up if needed
-        oadBlkTot = candidateImageLength / (oadImgBytesPerBlock);
-
-        // If there is a remainder after division, round up
-        if( 0 != (candidateImageLength % (oadImgBytesPerBlock)))
-        {
-            oadBlkTot += 1;
-        }
-
         // Image has been accepted, start the inactivity timer
         Util_startClock(&oadActivityClk);
     }
@@ -1016,10 +1122,23 @@ uint8_t oadImgIdentifyWrite(uint16_t connHandle, uint8_t *pValue, uint16_t len,
     {
         oadBlkSize = OAD_DEFAULT_BLOCK_SIZE;
         oadImgBytesPerBlock = oadBlkSize - OAD_BLK_NUM_HDR_SZ;
+        oadBlkWin = 1;
     }
 
+    // Blocks written so far go to flash, a resumed download takes them up
+    flash_flush();
+
     // Reset the variables used by the OAD state machine's event handlers
     oadBlkNum = 0;
+    oadBlkWinMap = 0;
+    oadBlkReqNext = 0;
+    oadResumeRec = false;
+    oadResumeMapLen = 0;
+    oadResumeBlk = 0;
+    oadLzFree();
+    oadEraseNext = 0;
+    oadEraseEnd = 0;
+    oadWritePage = 0;
     oadBlkTot = 0xFFFFFFFF;
     numBlksInImgHdr = 0;
     imageAddress = 0;
@@ -1098,6 +1217,25 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
         expectedBlkSz = oadBlkSize;
     }
 
+    // A compressed image is shorter than its length, any block can be the last
+    if((oadLz != NULL) && (len > OAD_BLK_NUM_HDR_SZ) && (len < expectedBlkSz))
+    {
+        expectedBlkSz = len;
+    }
+
+    // With a window, blocks after the expected one can come first
+    if ((blkNum > oadBlkNum) && (blkNum < oadBlkReqNext) &&
+        (oadBlkNum >= numBlksInImgHdr) && (len == expectedBlkSz))
+    {
+        return (oadImgBlockAhead(blkNum, pValue, len));
+    }
+
+    // and a block requested again can come twice
+    if ((blkNum < oadBlkNum) && (oadBlkWin > 1))
+    {
+        return (OAD_SUCCESS);
+    }
+
     // Check that this is the expected block number, and the block size is right
     if ((oadBlkNum == blkNum) && (len == expectedBlkSz))
     {
@@ -1151,12 +1289,28 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
             }
 
             status = oadValidateCandidateHdr((imgHdr_t * )&candidateImageHeader);
+
+            // A delta is against the running image, which on-chip OAD erases
+            if((status == OAD_SUCCESS) && !useExternalFlash &&
+               !(candidateImageHeader.fixedHdr.rfu & IMG_FLAG_DELTA))
+            {
+                status = OAD_INCOMPATIBLE_IMAGE;
+            }
+
             if(status == OAD_SUCCESS)
             {
-                // Calculate number of flash pages to pre-erase
+                // Image pages are erased as the download reaches them,
+                // the first one now for the header
                 uint32_t pageSize = (useExternalFlash)?EFL_PAGE_SIZE:HAL_FLASH_PAGE_SIZE;
 
-                oadEraseExtFlashPages(imagePage, candidateImageHeader.fixedHdr.len, pageSize);
+                oadEraseNext = imagePage;
+                oadEraseEnd = imagePage +
+                    ((candidateImageHeader.fixedHdr.len + pageSize - 1) / pageSize);
+                oadWritePage = imagePage;
+                if(OAD_SUCCESS != oadEraseTo(imagePage))
+                {
+                    return (OAD_FLASH_ERR);
+                }
 
                 // at this point we have erased the user app
                 if(!useExternalFlash)
@@ -1175,12 +1329,70 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
                     return (OAD_FLASH_ERR);
                 }
 
+                // The image CRC starts after the CRC field of the header
+                oadImgCrc = CRC32_update(0xFFFFFFFF,
+                                         (uint8_t *)&candidateImageHeader + IMG_DATA_OFFSET,
+                                         sizeof(imgHdr_t) - IMG_DATA_OFFSET);
+
+                // A compressed or delta image is decoded into flash after
+                // its header
+                uint16_t imgFlags = candidateImageHeader.fixedHdr.rfu;
+                if(!(imgFlags & IMG_FLAG_COMPRESSED) ||
+                   !(imgFlags & IMG_FLAG_DELTA))
+                {
+                    if(candidateImageHeader.fixedHdr.len <= sizeof(imgHdr_t))
+                    {
+                        return (OAD_INVALID_FILE);
+                    }
+
+                    oadLz = (OADLz_t *)ICall_malloc(sizeof(OADLz_t));
+                    if(oadLz == NULL)
+                    {
+                        return (OAD_NO_RESOURCES);
+                    }
+                    if(!(imgFlags & IMG_FLAG_DELTA))
+                    {
+                        OADLz_initDelta(oadLz,
+                                        candidateImageHeader.fixedHdr.len - sizeof(imgHdr_t),
+                                        oadLzOut,
+                                        (const uint8_t *)_imgHdr.imgPayload.startAddr,
+                                        _imgHdr.fixedHdr.len,
+                                        _imgHdr.fixedHdr.crc32);
+                    }
+                    else
+                    {
+                        OADLz_init(oadLz,
+                                   candidateImageHeader.fixedHdr.len - sizeof(imgHdr_t),
+                                   oadLzOut);
+                    }
+                    oadLzOfs = 0;
+                }
+                else
+                {
+                    // Keep track of the blocks in flash from here on
+                    oadResumeStart();
+                }
 
+                if(nonHeaderBytes && (oadLz != NULL))
+                {
+                    status = oadLzDecode(pValue+OAD_BLK_NUM_HDR_SZ+remainder,
+                                         nonHeaderBytes);
+                    if(status != OAD_SUCCESS)
+                    {
+                        return (status);
+                    }
+                }
                 // If there are non header (image data) bytes in this packet
                 // write them to flash as well
-                if(nonHeaderBytes)
+                else if(nonHeaderBytes)
                 {
                     // Write a OAD_BLOCK to Flash.
+                    status = oadEraseForWrite(imagePage, sizeof(imgHdr_t),
+                                              nonHeaderBytes);
+                    if(OAD_SUCCESS != status)
+                    {
+                        return (status);
+                    }
                     status = writeFlashPg(imagePage,
                                             sizeof(imgHdr_t),
                                             (pValue+OAD_BLK_NUM_HDR_SZ+remainder),
@@ -1191,6 +1403,10 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
                     {
                         return (OAD_FLASH_ERR);
                     }
+
+                    oadImgCrc = CRC32_update(oadImgCrc,
+                                             pValue+OAD_BLK_NUM_HDR_SZ+remainder,
+                                             nonHeaderBytes);
                 }
             }
             else
@@ -1199,22 +1415,27 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
                 return (status);
             }
         }
+        else if(oadLz != NULL)
+        {
+            // Decode the block into flash, the CRC follows what is written
+            status = oadLzDecode(pValue+OAD_BLK_NUM_HDR_SZ,
+                                 (len - OAD_BLK_NUM_HDR_SZ));
+            if(status != OAD_SUCCESS)
+            {
+                return (status);
+            }
+        }
         else
         {
-            // Calculate address to write as (start of OAD range) + (offset into range)
-            uint32_t blkStartAddr = (oadImgBytesPerBlock)*blkNum + imageAddress;
             uint8_t page = 0xFF;
             uint32_t offset = 0;
 
-            if(useExternalFlash)
-            {
-                page = EXT_FLASH_PAGE(blkStartAddr); //(blkStartAddr >> 12);
-                offset = blkStartAddr & (~EXTFLASH_PAGE_MASK); //0x00000FFF);
-            }
-            else
+            oadGetBlockAddr(blkNum, &page, &offset);
+
+            status = oadEraseForWrite(page, offset, (len - OAD_BLK_NUM_HDR_SZ));
+            if(OAD_SUCCESS != status)
             {
-                page = FLASH_PAGE(blkStartAddr); //(blkStartAddr >> 13);
-                offset = blkStartAddr & (~INTFLASH_PAGE_MASK); //0x00001FFF);
+                return (status);
             }
 
             // Write a OAD_BLOCK to Flash.
@@ -1226,10 +1447,32 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
             {
                 return (OAD_FLASH_ERR);
             }
+
+            // Blocks come in order, so the CRC can follow them
+            oadImgCrc = CRC32_update(oadImgCrc, pValue+OAD_BLK_NUM_HDR_SZ,
+                                     (len - OAD_BLK_NUM_HDR_SZ));
         }
 
         // Increment received block count.
         oadBlkNum++;
+
+        // Take in the blocks after it that came first, they are in flash
+        while(oadBlkWinMap & 1)
+        {
+            oadCrcAddBlock(oadBlkNum);
+            oadBlkNum++;
+            oadBlkWinMap >>= 1;
+        }
+        oadBlkWinMap >>= 1;
+
+        oadResumeMark();
+
+        // Grow the window back by a block for each window in order
+        if((oadBlkWinCur < oadBlkWin) && (++oadBlkWinRun >= oadBlkWinCur))
+        {
+            oadBlkWinCur++;
+            oadBlkWinRun = 0;
+        }
     }
     else
     {
@@ -1239,13 +1482,26 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
         return (OAD_BUFFER_OFL);
     }
 
-    // Check if the OAD Image is complete.
-    if (oadBlkNum == oadBlkTot)
+    // A compressed image must decode to its length in fewer blocks
+    if ((oadLz != NULL) && (oadLz->outLeft != 0) && (oadBlkNum >= oadBlkTot))
+    {
+        return (OAD_INVALID_FILE);
+    }
+
+    // Check if the OAD Image is complete, a compressed one once all of it
+    // is decoded
+    if ((oadLz != NULL) ? (oadLz->outLeft == 0) : (oadBlkNum == oadBlkTot))
     {
+        oadLzFree();
+
         // Run CRC check on new image.
         if (OAD_SUCCESS != oadCheckDL())
         {
-            // CRC error
+            // CRC error, the image in flash cannot be resumed either
+            if(oadResumeRec)
+            {
+                oadResumeDrop(metaPage);
+            }
             return (OAD_CRC_ERR);
 
         }
@@ -1299,7 +1555,14 @@ uint8_t oadImgBlockWrite(uint16_t connHandle, uint8_t *pValue, uint8_t len)
             {
                 return (OAD_FLASH_ERR);
             }
+            oadImgDirSet(metaPage, &extFlMetaHdr);
+
+        }
 
+        // The image is in flash once the write buffer is programmed
+        if(FLASH_SUCCESS != flash_flush())
+        {
+            return (OAD_FLASH_ERR);
         }
 
         // Indicate a successful download and CRC
@@ -1388,11 +1651,17 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
         {
             if(state == OAD_CONFIG)
             {
-                // Reset OAD variables
-                oadBlkNum = 0;
+                // Reset OAD variables, a resumed image starts past the
+                // blocks already in flash
+                oadBlkNum = oadResumeBlk;
+                oadBlkWinMap = 0;
+                oadBlkWinCur = oadBlkWin;
+                oadBlkWinRun = 0;
+                oadBlkLossMark = 0;
 
                 // Send the first block request to kick off the OAD
                 oadGetNextBlockReq(connHandle, oadBlkNum, OAD_SUCCESS);
+                oadBlkReqNext = oadBlkNum + 1;
 
                 // This is an exception case where a RSP is not sent
                 return (OAD_SUCCESS);
@@ -1488,6 +1757,7 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
                                             (uint8_t *)&extFlMetaHdr,
                                              sizeof(ExtImageInfo_t)) == FLASH_SUCCESS)
                             {
+                                oadImgDirSet(metaPage, &extFlMetaHdr);
                                 rsp->status = FLASH_SUCCESS;
                             }
                             else
@@ -1536,17 +1806,20 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
                          * meta page that matches the requested params
                          */
                         ExtImageInfo_t extFlMetaHdr;
+                        oadImgDirLoad();
                         for(uint8_t curPg = 0; curPg < OAD_EFL_MAX_META; ++curPg)
                         {
-                            // Read in the meta header
-                            readFlashPg(curPg, 0, (uint8_t *)&extFlMetaHdr,
-                                            sizeof(ExtImageInfo_t));
+                            ImageSizeInfo_t *pImg = &oadImgDir[curPg];
 
                             // Check to see if image matches the requested params
-                            if(extFlMetaHdr.fixedHdr.imgType == enablePld->imgType &&
-                                extFlMetaHdr.fixedHdr.imgNo == enablePld->imgNo    &&
-                                extFlMetaHdr.fixedHdr.techType == enablePld->techType)
+                            if(pImg->isUsed &&
+                                pImg->info.imgType == enablePld->imgType &&
+                                pImg->info.imgNo == enablePld->imgNo    &&
+                                pImg->techType == enablePld->techType)
                             {
+                                // Read in the meta header
+                                readFlashPg(curPg, 0, (uint8_t *)&extFlMetaHdr,
+                                                sizeof(ExtImageInfo_t));
 
                                 // Copy the candidate img header into the buffer
                                 readFlashPg(EXT_FLASH_PAGE(extFlMetaHdr.extFlAddr), 0,
@@ -1567,6 +1840,7 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
                                                     (uint8_t *)&extFlMetaHdr,
                                                      sizeof(ExtImageInfo_t)) == FLASH_SUCCESS)
                                     {
+                                        oadImgDirSet(curPg, &extFlMetaHdr);
                                         rsp->status = FLASH_SUCCESS;
                                     }
                                     else
@@ -1606,6 +1880,52 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
 
             break;
         }
+        case OAD_EXT_CTRL_SET_BLK_WINDOW:
+        {
+            pRspPldlen = sizeof(blockWindowRspPld_t);
+
+            // Allocate memory for the ext ctrl rsp message
+            pCmdRsp = ICall_malloc(pRspPldlen);
+
+            if(pCmdRsp == NULL)
+            {
+                // Ensure the allocation succeeded
+                return (OAD_NO_RESOURCES);
+            }
+
+            blockWindowRspPld_t *rsp = (blockWindowRspPld_t *)pCmdRsp;
+
+            // Pack up the payload
+            rsp->cmdID = OAD_EXT_CTRL_SET_BLK_WINDOW;
+
+            if(len != sizeof(blockWindowReq_t))
+            {
+                rsp->status = OAD_EXT_NOT_SUPPORTED;
+            }
+            else if(state == OAD_DOWNLOAD)
+            {
+                // The window cannot change under blocks in flight
+                rsp->status = OAD_ALREADY_STARTED;
+            }
+            else
+            {
+                blockWindowReq_t *req = (blockWindowReq_t *)pData;
+
+                oadBlkWin = req->window;
+                if(oadBlkWin > OAD_MAX_BLK_WINDOW)
+                {
+                    oadBlkWin = OAD_MAX_BLK_WINDOW;
+                }
+                else if(oadBlkWin == 0)
+                {
+                    oadBlkWin = 1;
+                }
+                rsp->status = OAD_SUCCESS;
+            }
+            rsp->window = oadBlkWin;
+
+            break;
+        }
         case OAD_EXT_CTRL_CANCEL_OAD:
         {
 
@@ -1805,8 +2125,6 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
             }
             else
             {
-                ExtImageInfo_t extFlMetaHdr;
-
                 uint8_t numImages = 0;
                 // Create a buffer for all the possible image info
                 imageInfo_t extFlInfo[OAD_EFL_MAX_META] = {0};
@@ -1814,19 +2132,15 @@ uint8_t oadProcessExtControlCmd(uint16_t connHandle, uint8_t  *pData,
                 //Open the flash if not opened already
                 flash_open();
 
+                // The images are in the image directory, read from flash once
+                oadImgDirLoad();
+
                 for(uint8_t curPg = 0; curPg < OAD_EFL_MAX_META; ++curPg)
                 {
-                    uint8_t imgIdExpected[OAD_IMG_ID_LEN] = OAD_EXTFL_ID_VAL;
-
-                    // Read in the meta header
-                    readFlashPg(curPg, 0, (uint8_t *)&extFlMetaHdr,
-                                    sizeof(ExtImageInfo_t));
-
-
-                    if(memcmp(&extFlMetaHdr.fixedHdr.imgID, &imgIdExpected, OAD_IMG_ID_LEN) == 0)
+                    if(oadImgDir[curPg].isUsed)
                     {
                         // copy the image info into the array
-                        memcpy(&extFlInfo[numImages], ((uint8_t *)&extFlMetaHdr + IMG_INFO_OFFSET), sizeof(imageInfo_t));
+                        memcpy(&extFlInfo[numImages], &oadImgDir[curPg].info, sizeof(imageInfo_t));
 
                         // We found an image, add it to the meta array
                         numImages++;
@@ -2324,6 +2638,543 @@ static void oadGetNextBlockReq(uint16_t connHandle, uint32_t blkNum,
     }
 }
 
+/*********************************************************************
+ * @fn      oadRequestBlocks
+ *
+ * @brief   Request blocks after a block write. Without a window this is
+ *          the next block. With one, blocks that went missing are requested
+ *          again, and new blocks until the window is full. A block that
+ *          comes after a later requested one is taken as lost and halves
+ *          the window, which grows back as blocks come in order.
+ *
+ * @param   connHandle - connection message was received on
+ * @param   status - status of the block write
+ *
+ * @return  None
+ */
+static void oadRequestBlocks(uint16_t connHandle, uint8_t status)
+{
+    uint32_t blkNum;
+    uint32_t top;
+    uint32_t map;
+    bool lost = false;
+
+    // The header and a compressed image come a block at a time
+    if((oadBlkWin <= 1) || (status != OAD_SUCCESS) ||
+       (oadBlkNum < numBlksInImgHdr) || (oadLz != NULL))
+    {
+        oadGetNextBlockReq(connHandle, oadBlkNum, status);
+        if(oadBlkReqNext <= oadBlkNum)
+        {
+            oadBlkReqNext = oadBlkNum + 1;
+        }
+        return;
+    }
+
+    // Ask again for the blocks missing below the last one received
+    if(oadBlkWinMap != 0)
+    {
+        // Last block received
+        top = oadBlkNum;
+        for(map = oadBlkWinMap; map != 0; map >>= 1)
+        {
+            top++;
+        }
+        blkNum = (oadBlkLossMark > oadBlkNum) ? oadBlkLossMark : oadBlkNum;
+        for(; blkNum < top; blkNum++)
+        {
+            if((blkNum == oadBlkNum) ||
+               !(oadBlkWinMap & (1UL << (blkNum - oadBlkNum - 1))))
+            {
+                oadGetNextBlockReq(connHandle, blkNum, status);
+                lost = true;
+            }
+        }
+        if(top > oadBlkLossMark)
+        {
+            oadBlkLossMark = top;
+        }
+    }
+    if(lost)
+    {
+        oadBlkWinCur = (oadBlkWinCur > 1) ? (oadBlkWinCur / 2) : 1;
+        oadBlkWinRun = 0;
+    }
+
+    // Fill the window
+    while((oadBlkReqNext < oadBlkTot) &&
+          (oadBlkReqNext < (oadBlkNum + oadBlkWinCur)))
+    {
+        oadGetNextBlockReq(connHandle, oadBlkReqNext, status);
+        oadBlkReqNext++;
+    }
+}
+
+/*********************************************************************
+ * @fn      oadImgBlockAhead
+ *
+ * @brief   Write a block that came before the one expected, it is added
+ *          to the CRC when the blocks before it are in.
+ *
+ * @param   blkNum - number of the block
+ * @param   pValue - pointer to the block, with its number
+ * @param   len - length of the block, with its number
+ *
+ * @return  OAD_SUCCESS, OAD_BUFFER_OFL or OAD_FLASH_ERR
+ */
+static uint8_t oadImgBlockAhead(uint32_t blkNum, uint8_t *pValue, uint8_t len)
+{
+    uint32_t bit;
+    uint8_t page = 0xFF;
+    uint32_t offset = 0;
+
+    if((blkNum - oadBlkNum) > 31)
+    {
+        // Beyond the largest window
+        return (OAD_BUFFER_OFL);
+    }
+
+    bit = 1UL << (blkNum - oadBlkNum - 1);
+    if(oadBlkWinMap & bit)
+    {
+        // Already written
+        return (OAD_SUCCESS);
+    }
+
+    oadGetBlockAddr(blkNum, &page, &offset);
+
+    if(OAD_SUCCESS != oadEraseForWrite(page, offset,
+                                       (len - OAD_BLK_NUM_HDR_SZ)))
+    {
+        return (OAD_FLASH_ERR);
+    }
+
+    // Write a OAD_BLOCK to Flash.
+    if(FLASH_SUCCESS != writeFlashPg(page, offset, pValue+OAD_BLK_NUM_HDR_SZ,
+                                     (len - OAD_BLK_NUM_HDR_SZ)))
+    {
+        return (OAD_FLASH_ERR);
+    }
+
+    oadBlkWinMap |= bit;
+
+    return (OAD_SUCCESS);
+}
+
+/*********************************************************************
+ * @fn      oadGetBlockAddr
+ *
+ * @brief   Find where an image block goes in flash.
+ *
+ * @param   blkNum - number of the block
+ * @param   pPage - the flash page is put here
+ * @param   pOffset - the offset in the page is put here
+ *
+ * @return  None
+ */
+static void oadGetBlockAddr(uint32_t blkNum, uint8_t *pPage, uint32_t *pOffset)
+{
+    oadGetImgAddr((oadImgBytesPerBlock)*blkNum, pPage, pOffset);
+}
+
+/*********************************************************************
+ * @fn      oadGetImgAddr
+ *
+ * @brief   Find where a byte of the image goes in flash.
+ *
+ * @param   imgOfs - offset of the byte in the image
+ * @param   pPage - the flash page is put here
+ * @param   pOffset - the offset in the page is put here
+ *
+ * @return  None
+ */
+static void oadGetImgAddr(uint32_t imgOfs, uint8_t *pPage, uint32_t *pOffset)
+{
+    // Calculate address to write as (start of OAD range) + (offset into range)
+    uint32_t blkStartAddr = imgOfs + imageAddress;
+
+    if(useExternalFlash)
+    {
+        *pPage = EXT_FLASH_PAGE(blkStartAddr); //(blkStartAddr >> 12);
+        *pOffset = blkStartAddr & (~EXTFLASH_PAGE_MASK); //0x00000FFF);
+    }
+    else
+    {
+        *pPage = FLASH_PAGE(blkStartAddr); //(blkStartAddr >> 13);
+        *pOffset = blkStartAddr & (~INTFLASH_PAGE_MASK); //0x00001FFF);
+    }
+}
+
+/*********************************************************************
+ * @fn      oadCrcAddBlock
+ *
+ * @brief   Add a block already in flash to the image CRC.
+ *
+ * @param   blkNum - number of the block
+ *
+ * @return  None
+ */
+static void oadCrcAddBlock(uint32_t blkNum)
+{
+    uint8_t buf[32];
+    uint8_t page = 0xFF;
+    uint32_t offset = 0;
+    uint16_t blkLen = oadImgBytesPerBlock;
+    uint16_t n;
+
+    // The last block may be a partial
+    if((blkNum == (oadBlkTot - 1)) &&
+       (candidateImageHeader.fixedHdr.len % (oadImgBytesPerBlock) != 0))
+    {
+        blkLen = candidateImageHeader.fixedHdr.len % (oadImgBytesPerBlock);
+    }
+
+    oadGetBlockAddr(blkNum, &page, &offset);
+    while(blkLen > 0)
+    {
+        n = (blkLen < sizeof(buf)) ? blkLen : sizeof(buf);
+        readFlashPg(page, offset, buf, n);
+        oadImgCrc = CRC32_update(oadImgCrc, buf, n);
+        offset += n;
+        blkLen -= n;
+    }
+}
+
+/*********************************************************************
+ * @fn      oadResumeFind
+ *
+ * @brief   Look for a download of the image that was cut off, and take
+ *          it up where it stopped. Resume records of other images are
+ *          dropped, as the new download may overwrite their blocks.
+ *
+ * @param   idPld - image identify of the download
+ *
+ * @return  TRUE if the download resumes, FALSE for a new download
+ */
+static bool oadResumeFind(imgIdentifyPld_t *idPld)
+{
+    oadResumeRec_t rec;
+    uint8_t hdrID[] = OAD_EFL_MAGIC;
+    uint8_t resumeID[] = OAD_RESUME_MAGIC;
+    uint8_t buf[32];
+    uint16_t resumePg = EFL_META_PG_INVALID;
+    uint8_t page = 0xFF;
+    uint32_t offset = 0;
+    uint32_t mapLen = 0;
+    uint32_t mapTot = (oadBlkTot + 7) / 8;
+    uint32_t blk;
+    uint16_t n;
+    uint16_t i;
+
+    for(uint8_t curPg = EFL_FACT_IMG_META_PG; curPg < OAD_EFL_MAX_META; ++curPg)
+    {
+        // The page of a complete image has no download in progress
+        readFlashPg(curPg, 0, buf, OAD_IMG_ID_LEN);
+        if(0 == memcmp(buf, hdrID, OAD_IMG_ID_LEN))
+        {
+            continue;
+        }
+
+        readFlashPg(curPg, OAD_RESUME_OFS, (uint8_t *)&rec, sizeof(rec));
+        if(0 != memcmp(rec.magic, resumeID, sizeof(rec.magic)))
+        {
+            continue;
+        }
+
+        if((resumePg == EFL_META_PG_INVALID) &&
+           (0 == memcmp(&rec.idPld, idPld, sizeof(imgIdentifyPld_t))) &&
+           (rec.blkSize == oadBlkSize))
+        {
+            resumePg = curPg;
+            imageAddress = rec.imgAddr;
+        }
+        else
+        {
+            oadResumeDrop(curPg);
+        }
+    }
+
+    if(resumePg == EFL_META_PG_INVALID)
+    {
+        return (false);
+    }
+
+    // Blocks are marked in order a byte at a time, count the cleared bytes
+    while(mapLen < mapTot)
+    {
+        n = ((mapTot - mapLen) < sizeof(buf)) ? (mapTot - mapLen) : sizeof(buf);
+        readFlashPg(resumePg, OAD_RESUME_MAP_OFS + mapLen, buf, n);
+        i = 0;
+        while((i < n) && (buf[i] == 0x00))
+        {
+            i++;
+        }
+        mapLen += i;
+        if(i < n)
+        {
+            break;
+        }
+    }
+
+    // The last block is always requested, the download completes on it
+    blk = mapLen * 8;
+    if(blk >= oadBlkTot)
+    {
+        blk = oadBlkTot - 1;
+    }
+
+    // The header in flash must be the one of the image identified
+    imagePage = EXT_FLASH_PAGE(imageAddress);
+    readFlashPg(imagePage, 0, (uint8_t *)&candidateImageHeader,
+                sizeof(imgHdr_t));
+    if((blk < numBlksInImgHdr) ||
+       (0 != memcmp(candidateImageHeader.fixedHdr.imgID, idPld->imgID,
+                    sizeof(idPld->imgID))) ||
+       (candidateImageHeader.fixedHdr.len != idPld->len) ||
+       (0 != memcmp(candidateImageHeader.fixedHdr.softVer, idPld->softVer,
+                    sizeof(idPld->softVer))) ||
+       (OAD_SUCCESS != oadValidateCandidateHdr(&candidateImageHeader)))
+    {
+        oadResumeDrop(resumePg);
+        return (false);
+    }
+
+    // The CRC of the blocks in flash, the rest is added as they come
+    oadImgCrc = CRC32_calc(imagePage, EFL_PAGE_SIZE, 0,
+                           blk * oadImgBytesPerBlock, true) ^ 0xFFFFFFFF;
+
+    // Pages past the one of the last block in flash are erased again
+    oadGetImgAddr(blk * oadImgBytesPerBlock - 1, &page, &offset);
+    oadEraseNext = page + 1;
+    oadEraseEnd = imagePage +
+        ((candidateImageHeader.fixedHdr.len + EFL_PAGE_SIZE - 1) / EFL_PAGE_SIZE);
+    oadWritePage = page;
+
+    memcpy(&oadResumeId, idPld, sizeof(imgIdentifyPld_t));
+    metaPage = resumePg;
+    oadResumeBlk = blk;
+    oadResumeMapLen = blk / 8;
+    oadResumeRec = true;
+
+    return (true);
+}
+
+/*********************************************************************
+ * @fn      oadResumeStart
+ *
+ * @brief   Write the resume record of a download in external flash,
+ *          once its header is in flash. The meta page was erased when
+ *          the image was identified.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void oadResumeStart(void)
+{
+    oadResumeRec_t rec;
+    uint8_t resumeID[] = OAD_RESUME_MAGIC;
+
+    oadResumeRec = false;
+    oadResumeMapLen = 0;
+
+    // The bitmap of a large image with small blocks does not fit the page
+    if(!useExternalFlash || (oadBlkTot > OAD_RESUME_MAX_BLKS))
+    {
+        return;
+    }
+
+    memcpy(&rec.idPld, &oadResumeId, sizeof(imgIdentifyPld_t));
+    rec.imgAddr = imageAddress;
+    rec.blkSize = oadBlkSize;
+    memcpy(rec.magic, resumeID, sizeof(rec.magic));
+
+    // The magic goes last, a record cut short is not taken up
+    if((FLASH_SUCCESS == writeFlashPg(metaPage, OAD_RESUME_OFS,
+                                      (uint8_t *)&rec,
+                                      offsetof(oadResumeRec_t, magic))) &&
+       (FLASH_SUCCESS == writeFlashPg(metaPage,
+                                      OAD_RESUME_OFS +
+                                      offsetof(oadResumeRec_t, magic),
+                                      rec.magic, sizeof(rec.magic))))
+    {
+        oadResumeRec = true;
+    }
+}
+
+/*********************************************************************
+ * @fn      oadResumeMark
+ *
+ * @brief   Mark the blocks before oadBlkNum in the resume bitmap. The
+ *          bits are cleared a byte, 8 blocks, at a time so a block costs
+ *          an eighth of a one byte write and no erase.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void oadResumeMark(void)
+{
+    uint8_t done = 0x00;
+
+    while(oadResumeRec && (((oadResumeMapLen + 1) * 8) <= oadBlkNum))
+    {
+        if(FLASH_SUCCESS != writeFlashPg(metaPage,
+                                         OAD_RESUME_MAP_OFS + oadResumeMapLen,
+                                         &done, sizeof(done)))
+        {
+            // Stop marking, a resume requests the later blocks again
+            oadResumeRec = false;
+        }
+        oadResumeMapLen++;
+    }
+}
+
+/*********************************************************************
+ * @fn      oadResumeDrop
+ *
+ * @brief   Clear the magic of a resume record so it is not taken up.
+ *
+ * @param   page - meta page of the record
+ *
+ * @return  None
+ */
+static void oadResumeDrop(uint8_t page)
+{
+    uint8_t magic[8] = {0};
+
+    writeFlashPg(page, OAD_RESUME_OFS + offsetof(oadResumeRec_t, magic),
+                 magic, sizeof(magic));
+}
+
+/*********************************************************************
+ * @fn      oadLzDecode
+ *
+ * @brief   Decode the next bytes of a compressed or delta image into
+ *          flash.
+ *
+ * @param   pBuf - the bytes
+ * @param   len - number of bytes
+ *
+ * @return  OAD_SUCCESS, OAD_INVALID_FILE, OAD_FLASH_ERR or
+ *          OAD_INCOMPATIBLE_IMAGE
+ */
+static uint8_t oadLzDecode(uint8_t *pBuf, uint16_t len)
+{
+    switch(OADLz_decode(oadLz, pBuf, len))
+    {
+        case OAD_LZ_MORE:
+        case OAD_LZ_DONE:
+            return (OAD_SUCCESS);
+        case OAD_LZ_OUT_ERR:
+            return (OAD_FLASH_ERR);
+        case OAD_LZ_BASE_ERR:
+            return (OAD_INCOMPATIBLE_IMAGE);
+        default:
+            return (OAD_INVALID_FILE);
+    }
+}
+
+/*********************************************************************
+ * @fn      oadLzOut
+ *
+ * @brief   Write decoded bytes of a compressed image to flash, after the
+ *          ones before them, and add them to the image CRC.
+ *
+ * @param   pBuf - the bytes
+ * @param   len - number of bytes
+ *
+ * @return  TRUE if they were written
+ */
+static bool oadLzOut(const uint8_t *pBuf, uint16_t len)
+{
+    uint8_t page = 0xFF;
+    uint32_t offset = 0;
+
+    oadGetImgAddr(sizeof(imgHdr_t) + oadLzOfs, &page, &offset);
+    if((OAD_SUCCESS != oadEraseForWrite(page, offset, len)) ||
+       (FLASH_SUCCESS != writeFlashPg(page, offset, (uint8_t *)pBuf, len)))
+    {
+        return (false);
+    }
+
+    oadImgCrc = CRC32_update(oadImgCrc, pBuf, len);
+    oadLzOfs += len;
+
+    return (true);
+}
+
+/*********************************************************************
+ * @fn      oadLzFree
+ *
+ * @brief   Free the decoder of a compressed image, if there is one.
+ *
+ * @param   None
+ *
+ * @return  None
+ */
+static void oadLzFree(void)
+{
+    if(oadLz != NULL)
+    {
+        ICall_free(oadLz);
+        oadLz = NULL;
+    }
+}
+
+/*********************************************************************
+ * @fn      oadEraseTo
+ *
+ * @brief   Erase the image pages not erased yet, in order, up to a page.
+ *
+ * @param   lastPage - last page to erase, past the image is left as is
+ *
+ * @return  OAD_SUCCESS or OAD_FLASH_ERR
+ */
+static uint8_t oadEraseTo(uint16_t lastPage)
+{
+    while((oadEraseNext <= lastPage) && (oadEraseNext < oadEraseEnd))
+    {
+        if(FLASH_FAILURE == eraseFlashPg((uint8_t)oadEraseNext))
+        {
+            return (OAD_FLASH_ERR);
+        }
+        oadEraseNext++;
+    }
+
+    return (OAD_SUCCESS);
+}
+
+/*********************************************************************
+ * @fn      oadEraseForWrite
+ *
+ * @brief   Erase the image pages a write goes to, if they are not yet.
+ *
+ * @param   page - flash page of the write
+ * @param   offset - offset of the write in the page
+ * @param   len - length of the write
+ *
+ * @return  OAD_SUCCESS or OAD_FLASH_ERR
+ */
+static uint8_t oadEraseForWrite(uint8_t page, uint32_t offset, uint32_t len)
+{
+    uint32_t pageSize = (useExternalFlash)?EFL_PAGE_SIZE:HAL_FLASH_PAGE_SIZE;
+    uint16_t lastPage;
+
+    if(len == 0)
+    {
+        return (OAD_SUCCESS);
+    }
+
+    lastPage = page + ((offset + len - 1) / pageSize);
+    if(lastPage > oadWritePage)
+    {
+        oadWritePage = lastPage;
+    }
+
+    return (oadEraseTo(lastPage));
+}
+
 /*********************************************************************
  * @fn      oadSendNotification
  *
@@ -2408,19 +3259,16 @@ static uint8_t oadSendNotification(uint16_t connHandle, gattCharCfg_t *charCfg,
  *          OAD_FLASH_ERR       - Flash erase failed
  *          OAD_NO_RESOURCES    - Invalid parameters
  */
- static uint8_t oadFindExtFlMetaPage(uint16_t *metaPg, ImageSizeInfo_t *imgInfo)
+ static uint8_t oadFindExtFlMetaPage(uint16_t *metaPg)
  {
     // Store lowest counter variable
     uint32_t lowestCounter = 0xFFFFFFFF;
     // Store the necessary info about the leastRecentlyUsed image
     uint16_t leastRecentlyUsedMetaPg = EFL_META_PG_INVALID;
-    // Structures to hold the current metaHDR
-    ExtImageInfo_t extFlMetaHdr;
     uint8_t status = OAD_SUCCESS;
-    uint8_t hdrID[] = OAD_EFL_MAGIC;
 
     // Check the input parameters
-    if((metaPg == NULL) || (imgInfo == NULL))
+    if(metaPg == NULL)
     {
         return(OAD_NO_RESOURCES);
     }
@@ -2428,6 +3276,8 @@ static uint8_t oadSendNotification(uint16_t connHandle, gattCharCfg_t *charCfg,
     // Reset the metaPage to known value
     *metaPg = EFL_META_PG_INVALID;
 
+    oadImgDirLoad();
+
     /*
      * Iterate through all meta pages to get info
      * Note, if there are multiple free metadata pages this will take the
@@ -2435,37 +3285,21 @@ static uint8_t oadSendNotification(uint16_t connHandle, gattCharCfg_t *charCfg,
      */
     for(uint8_t curPg = EFL_FACT_IMG_META_PG; curPg < OAD_EFL_MAX_META; ++curPg)
     {
-        // Read in the metadata from ExtFl
-        readFlashPg(curPg, 0, (uint8_t *)&extFlMetaHdr, sizeof(ExtImageInfo_t));
-
-        if(0 != memcmp((uint8_t *)&extFlMetaHdr.fixedHdr.imgID, hdrID, OAD_IMG_ID_LEN))
+        if(!oadImgDir[curPg].isUsed)
         {
             // We have found an empty pg
             // Note: this doesn't cover the case where the factory image
             // sector is empty, this is expected to be handled at opening time
             *metaPg = curPg;
-
-            // Mark the page as unused
-            imgInfo[curPg].isUsed = false;
         }
-        else
+        // If this counter is the least recently used
+        // Note: We cannot erase the factory image as part of leastRecentlyUsed
+        else if((oadImgDir[curPg].counter < lowestCounter) &&
+                (curPg != EFL_FACT_IMG_META_PG))
         {
-            // Store the info from the page
-            imgInfo[curPg].isUsed = true;
-            imgInfo[curPg].startAddress = extFlMetaHdr.extFlAddr;
-            imgInfo[curPg].length = extFlMetaHdr.fixedHdr.len;
-            imgInfo[curPg].metaPage = curPg;
-            imgInfo[curPg].counter = extFlMetaHdr.counter;   // Copy timestamp from OAD image header(external flash sector) as the LRU val
-
-            // If this counter is the least recently used
-            // Note: We cannot erase the factory image as part of leastRecentlyUsed
-            if((extFlMetaHdr.counter < lowestCounter) &&
-               (curPg != EFL_FACT_IMG_META_PG) )
-            {
-                // Setup leastRecentlyUsed values
-                lowestCounter = extFlMetaHdr.counter;
-                leastRecentlyUsedMetaPg = curPg;
-            }
+            // Setup leastRecentlyUsed values
+            lowestCounter = oadImgDir[curPg].counter;
+            leastRecentlyUsedMetaPg = curPg;
         }
     }
 
@@ -2477,23 +3311,23 @@ static uint8_t oadSendNotification(uint16_t connHandle, gattCharCfg_t *charCfg,
 
     // Erase the page
     status = eraseFlashPg(*metaPg);
+    oadImgDirRemove(*metaPg);
     return (status);
  }
 
 /*********************************************************************
  * @fn      oadFindExtFlImgAddr
  *
- * @brief   Find a location in external flash for the candidate image
+ * @brief   Find a location in external flash for the candidate image,
+ *          between the images of the image directory
  *
- * @param   extImgInfo  - array of info about current images on ext fl
  * @param   candiateLen - Lenght of candidate image
  *
  * @return  OAD_SUCCESS         - Operation successful
  *          OAD_FLASH_ERR       - Flash erase failed
  *          OAD_NO_RESOURCES    - Invalid parameters
  */
-static uint32_t oadFindExtFlImgAddr(ImageSizeInfo_t *extImgInfo,
-                                    uint32_t  candiateLen)
+static uint32_t oadFindExtFlImgAddr(uint32_t  candiateLen)
 {
     bool foundFreeRegion = false;
     uint32_t curExtFlAddr = OAD_EFL_IMG_REGION;
@@ -2504,24 +3338,19 @@ static uint32_t oadFindExtFlImgAddr(ImageSizeInfo_t *extImgInfo,
         candidateNumPages += 1;
     }
 
-    // Sort the image info array from smallest to largest based on start addr
-    oadSortImgInfo(extImgInfo, OAD_EFL_MAX_META);
-
     while(!foundFreeRegion)
     {
         curExtFlAddr = OAD_EFL_IMG_REGION;
-        for(uint8_t idx = 0; idx < OAD_EFL_MAX_META; idx++)
+
+        // The images are in order of their start address
+        for(uint8_t idx = 0; idx < oadImgDirCnt; idx++)
         {
-            if(!extImgInfo[idx].isUsed)
-            {
-                // If the current meta page is not used, skip it
-                continue;
-            }
+            ImageSizeInfo_t *pImg = &oadImgDir[oadImgDirOrder[idx]];
 
-            uint32_t spaceAvail = extImgInfo[idx].startAddress - curExtFlAddr;
+            uint32_t spaceAvail = pImg->startAddress - curExtFlAddr;
             uint16_t pagesAvail = EXT_FLASH_PAGE(spaceAvail);
-            uint16_t currentImgNumPages = extImgInfo[idx].length / EFL_PAGE_SIZE;
-            if(0 != (extImgInfo[idx].length % EFL_PAGE_SIZE))
+            uint16_t currentImgNumPages = pImg->length / EFL_PAGE_SIZE;
+            if(0 != (pImg->length % EFL_PAGE_SIZE))
             {
                 currentImgNumPages += 1;
             }
@@ -2532,25 +3361,25 @@ static uint32_t oadFindExtFlImgAddr(ImageSizeInfo_t *extImgInfo,
                 break;
             }
 
-            curExtFlAddr = extImgInfo[idx].startAddress +                      \
+            curExtFlAddr = pImg->startAddress +                                \
                             (currentImgNumPages * EFL_PAGE_SIZE);
         }
 
         if(!foundFreeRegion)
         {
             // Erase leastRecentlyUsed page and its meta
-            uint8_t leastRecentlyUsedIdx = oadFindleastRecentlyUsedIdx(extImgInfo,
+            uint8_t leastRecentlyUsedIdx = oadFindleastRecentlyUsedIdx(oadImgDir,
                                                             OAD_EFL_MAX_META);
             if (leastRecentlyUsedIdx < OAD_EFL_MAX_META)
             {
-                uint16_t eraseStartPage = EXT_FLASH_PAGE(extImgInfo[leastRecentlyUsedIdx].startAddress);
+                uint16_t eraseStartPage = EXT_FLASH_PAGE(oadImgDir[leastRecentlyUsedIdx].startAddress);
 
                 oadEraseExtFlashPages(eraseStartPage,
-                                        extImgInfo[leastRecentlyUsedIdx].length,
+                                        oadImgDir[leastRecentlyUsedIdx].length,
                                         EFL_PAGE_SIZE);
 
-                eraseFlashPg(extImgInfo[leastRecentlyUsedIdx].metaPage);
-                extImgInfo[leastRecentlyUsedIdx].isUsed = false;
+                eraseFlashPg(oadImgDir[leastRecentlyUsedIdx].metaPage);
+                oadImgDirRemove(leastRecentlyUsedIdx);
             }
         }
     }
@@ -2558,34 +3387,6 @@ static uint32_t oadFindExtFlImgAddr(ImageSizeInfo_t *extImgInfo,
     return (curExtFlAddr);
 }
 
-/*********************************************************************
- * @fn      oadSortImgInfo
- *
- * @brief   Use insertion sort to arrange the image info from extfl
- *
- * @param   extImgInfo  - array of info about current images on ext fl
- * @param   numImgs     - Number of images to sort
- *
- * @return  None.
- */
-static void oadSortImgInfo(ImageSizeInfo_t *extImgInfo, uint8_t numImgs)
-{
-   for (uint8_t i = 1; i < numImgs; i++)
-   {
-        ImageSizeInfo_t tmp;
-        memcpy(&tmp, &extImgInfo[i], sizeof(ImageSizeInfo_t));
-
-        uint8_t j = i;
-        while (j > 0 && extImgInfo[j-1].startAddress > tmp.startAddress)
-        {
-            memcpy((void *)&extImgInfo[j], (void *)&extImgInfo[j-1], sizeof(ImageSizeInfo_t));
-            j--;
-        }
-        extImgInfo[j] = tmp;
-        memcpy(&extImgInfo[j], &tmp, sizeof(ImageSizeInfo_t));
-  }
-}
-
 /*********************************************************************
  * @fn      oadFindleastRecentlyUsedIdx
  *
@@ -2620,6 +3421,123 @@ static uint16_t oadFindleastRecentlyUsedIdx(ImageSizeInfo_t *extImgInfo,
     return (leastRecentlyUsedMetaPg);
 }
 
+/*********************************************************************
+ * @fn      oadImgDirLoad
+ *
+ * @brief   Read the metadata of the images in external flash into the
+ *          image directory, if it is not yet. OAD keeps it up to date
+ *          as it writes and erases metadata from then on.
+ *
+ * @param   None.
+ *
+ * @return  None.
+ */
+static void oadImgDirLoad(void)
+{
+    ExtImageInfo_t extFlMetaHdr;
+    bool readOk = true;
+
+    if(oadImgDirValid)
+    {
+        return;
+    }
+
+    oadImgDirValid = true;
+    oadImgDirCnt = 0;
+    for(uint8_t curPg = 0; curPg < OAD_EFL_MAX_META; ++curPg)
+    {
+        oadImgDir[curPg].isUsed = false;
+        if(FLASH_SUCCESS == readFlashPg(curPg, 0, (uint8_t *)&extFlMetaHdr,
+                                        sizeof(ExtImageInfo_t)))
+        {
+            oadImgDirSet(curPg, &extFlMetaHdr);
+        }
+        else
+        {
+            readOk = false;
+        }
+    }
+
+    // Read again next time if the flash could not be read
+    oadImgDirValid = readOk;
+}
+
+/*********************************************************************
+ * @fn      oadImgDirSet
+ *
+ * @brief   Put the metadata written to a meta page in the image
+ *          directory. An image is kept in order of its start address.
+ *
+ * @param   page - the meta page
+ * @param   pMeta - the metadata
+ *
+ * @return  None.
+ */
+static void oadImgDirSet(uint8_t page, ExtImageInfo_t *pMeta)
+{
+    uint8_t hdrID[] = OAD_EFL_MAGIC;
+    ImageSizeInfo_t *pImg = &oadImgDir[page];
+    uint8_t idx;
+
+    oadImgDirRemove(page);
+    if(!oadImgDirValid ||
+       (0 != memcmp((uint8_t *)&pMeta->fixedHdr.imgID, hdrID, OAD_IMG_ID_LEN)))
+    {
+        return;
+    }
+
+    pImg->isUsed = true;
+    pImg->metaPage = page;
+    pImg->counter = pMeta->counter;
+    pImg->startAddress = pMeta->extFlAddr;
+    pImg->length = pMeta->fixedHdr.len;
+    memcpy(&pImg->info, ((uint8_t *)pMeta + IMG_INFO_OFFSET), sizeof(imageInfo_t));
+    pImg->techType = pMeta->fixedHdr.techType;
+
+    // Insert it after the images that start before it
+    idx = oadImgDirCnt;
+    while((idx > 0) &&
+          (oadImgDir[oadImgDirOrder[idx - 1]].startAddress > pImg->startAddress))
+    {
+        oadImgDirOrder[idx] = oadImgDirOrder[idx - 1];
+        idx--;
+    }
+    oadImgDirOrder[idx] = page;
+    oadImgDirCnt++;
+}
+
+/*********************************************************************
+ * @fn      oadImgDirRemove
+ *
+ * @brief   Take the image of an erased meta page out of the image
+ *          directory.
+ *
+ * @param   page - the meta page
+ *
+ * @return  None.
+ */
+static void oadImgDirRemove(uint8_t page)
+{
+    uint8_t idx = 0;
+
+    if((page >= OAD_EFL_MAX_META) || !oadImgDir[page].isUsed)
+    {
+        return;
+    }
+
+    oadImgDir[page].isUsed = false;
+    while(oadImgDirOrder[idx] != page)
+    {
+        idx++;
+    }
+    oadImgDirCnt--;
+    while(idx < oadImgDirCnt)
+    {
+        oadImgDirOrder[idx] = oadImgDirOrder[idx + 1];
+        idx++;
+    }
+}
+
 /*********************************************************************
  * @fn      oadFindleastRecentlyUsedIdx
  *
@@ -2661,6 +3579,12 @@ static uint8_t oadCheckDL(void)
     uint8_t status = OAD_SUCCESS;
     imgHdr_t imgHdr;
 
+    // All of the image must be programmed and verified first
+    if(FLASH_SUCCESS != flash_flush())
+    {
+        return (OAD_FLASH_ERR);
+    }
+
     readFlashPg(imagePage, 0, (uint8_t *)(&imgHdr),
                         sizeof(imgHdr));
 
@@ -2681,16 +3605,9 @@ static uint8_t oadCheckDL(void)
         return (OAD_CRC_ERR);
     }
 
-    //uint8_t page, uint32_t pageSize, uint16_t offset, bool useExtFl
-    // Calculate CRC of downloaded image.
-    if(useExternalFlash)
-    {
-        crcCalculated = CRC32_calc(imagePage, EFL_PAGE_SIZE, 0, imgHdr.fixedHdr.len, useExternalFlash);
-    }
-    else
-    {
-        crcCalculated = CRC32_calc(imagePage, HAL_FLASH_PAGE_SIZE, 0, imgHdr.fixedHdr.len, useExternalFlash);
-    }
+    // The CRC of the downloaded image was computed as its blocks were
+    // written, the writes are verified so it is the CRC of the flash too
+    crcCalculated = oadImgCrc ^ 0xFFFFFFFF;
 
     if (crcCalculated == crcFromHdr)
     {
@@ -3015,6 +3932,9 @@ uint8_t oadCreateFactoryImageBackup(void)
             return OAD_FLASH_ERR;
         }
 
+        // The image directory is read again with the factory image
+        oadImgDirValid = false;
+
         /* Erase - external portion to be written*/
         status = oadEraseExtFlashPages(EXT_FLASH_PAGE(dstAddr),
                 (_imgHdr.fixedHdr.imgEndAddr - _imgHdr.imgPayload.startAddr -1),
@@ -3072,6 +3992,12 @@ uint8_t oadCreateFactoryImageBackup(void)
            rtn = OAD_FLASH_ERR;
        } //  end of if(extFlashErase(dstAddr, imgLen))
 
+        /* Program what is left in the write buffer */
+        if((rtn == OAD_SUCCESS) && (flash_flush() != FLASH_SUCCESS))
+        {
+            rtn = OAD_FLASH_ERR;
+        }
+
         /* close driver */
         flash_close();
 
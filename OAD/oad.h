@@ -308,6 +308,14 @@ extern "C"
  */
 #define OAD_IMAGE_ID_RSP_LEN                0x01
 
+/*!
+ * Largest block window a peer can set with @ref OAD_EXT_CTRL_SET_BLK_WINDOW,
+ * at most 32. A window of 1 requests one block at a time
+ */
+#ifndef OAD_MAX_BLK_WINDOW
+#define OAD_MAX_BLK_WINDOW                  8
+#endif
+
 /*!
  * @defgroup OAD_EXT_CTRL_OPCODES OAD Extended Control Command op codes
  * @{
@@ -396,6 +404,14 @@ extern "C"
  */
 #define OAD_EXT_CTRL_ERASE_BONDS            0x13
 
+/*!
+ * Set block window external control command op-code
+ * This command is used by a peer to let the target request up to the given
+ * number of blocks ahead instead of one block at a time. It must be sent
+ * before @ref OAD_EXT_CTRL_START_OAD
+ */
+#define OAD_EXT_CTRL_SET_BLK_WINDOW         0x14
+
 /** @} End OAD_EXT_CTRL_OPCODES */
 
 
@@ -665,6 +681,25 @@ PACKED_TYPEDEF_STRUCT
     uint16_t    techType;       //!< Wireless technology type
 }extImgEnableReq_t;
 
+/*!
+ * The payload of an @ref OAD_EXT_CTRL_SET_BLK_WINDOW command
+ */
+PACKED_TYPEDEF_STRUCT
+{
+    uint8_t   cmdID;            //!< Ext Ctrl Op-code
+    uint8_t   window;           //!< Most block requests the peer can queue
+} blockWindowReq_t;
+
+/*!
+ * Response to a @ref OAD_EXT_CTRL_SET_BLK_WINDOW command
+ */
+PACKED_TYPEDEF_STRUCT
+{
+    uint8_t   cmdID;            //!< Ext Ctrl Op-code
+    uint8_t   status;           //!< Status of command
+    uint8_t   window;           //!< Block window the target will use
+} blockWindowRspPld_t;
+
 #ifdef DMM_OAD
 typedef struct
 {
@@ -566,6 +566,24 @@ extern uint32_t _sign_fnPtr;     //!< Variable for Pointer to BIM Function
 */
 #define VERIFY_FAIL                  0xFC
 
+/*!
+ * Offset of the image flags, kept in the rfu field of the core header. A
+ * flag is set when its bit is clear, so an image with rfu 0xFFFF has none
+ */
+#define IMG_FLAGS_OFFSET             offsetof(imgHdr_t, fixedHdr.rfu)
+
+/*!
+ * Image flag indicating the image after its header is sent compressed,
+ * see oad_lz.h. The length and CRC are those of the image decompressed
+ */
+#define IMG_FLAG_COMPRESSED          0x0001
+
+/*!
+ * Image flag indicating the image after its header is sent as a delta
+ * against the running image, see oad_lz.h
+ */
+#define IMG_FLAG_DELTA               0x0002
+
 /*!
  * Length of image external flash image header
  */
@@ -0,0 +1,400 @@
+/******************************************************************************
+
+ @file  oad_lz.c
+
+ @brief Decoder of compressed OAD images
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*******************************************************************************
+ *                                          Includes
+ */
+
+#include <stddef.h>
+
+#include "oad_lz.h"
+
+/*******************************************************************************
+ *                                          Constants
+ */
+
+#define OAD_LZ_WINDOW_MASK    (OAD_LZ_WINDOW - 1)
+
+#if (OAD_LZ_WINDOW & OAD_LZ_WINDOW_MASK) != 0
+#error "OAD_LZ_WINDOW must be a power of 2"
+#endif
+
+/* Parts of a delta image */
+#define OAD_LZ_STEP_CRC       0   /* CRC of the base */
+#define OAD_LZ_STEP_LEN       1   /* Length of the base */
+#define OAD_LZ_STEP_ITEM      2   /* Flags, literal or the first copy number */
+#define OAD_LZ_STEP_FROM      3   /* Second copy number */
+
+/*******************************************************************************
+ *                                     Local Functions
+ */
+
+/*******************************************************************************
+ * @fn          OADLz_flush
+ *
+ * @brief       Pass the bytes of the window not yet out to the output.
+ *
+ * @param       pLz - the decoder
+ * @param       end - end of the bytes in the window
+ *
+ * @return      true if the output took them
+ */
+static bool OADLz_flush(OADLz_t *pLz, uint16_t end)
+{
+    bool ok = true;
+
+    if(end > pLz->outPos)
+    {
+        ok = pLz->outFxn(&pLz->window[pLz->outPos], end - pLz->outPos);
+    }
+    pLz->outPos = end & OAD_LZ_WINDOW_MASK;
+
+    return(ok);
+}
+
+/*******************************************************************************
+ * @fn          OADLz_put
+ *
+ * @brief       Put a byte out, the window goes out each time it wraps.
+ *
+ * @param       pLz - the decoder
+ * @param       b - the byte
+ *
+ * @return      true if the output took it
+ */
+static bool OADLz_put(OADLz_t *pLz, uint8_t b)
+{
+    pLz->window[pLz->pos] = b;
+    pLz->pos = (pLz->pos + 1) & OAD_LZ_WINDOW_MASK;
+    pLz->outDone++;
+    pLz->outLeft--;
+
+    return((pLz->pos != 0) || OADLz_flush(pLz, OAD_LZ_WINDOW));
+}
+
+/*******************************************************************************
+ * @fn          OADLz_copy
+ *
+ * @brief       Copy earlier bytes of the image, or bytes of the base, out.
+ *
+ * @param       pLz - the decoder
+ * @param       pSrc - the base bytes, NULL to copy from the window
+ * @param       dist - distance back of the window bytes
+ * @param       n - number of bytes
+ *
+ * @return      OAD_LZ_MORE, OAD_LZ_ERR or OAD_LZ_OUT_ERR
+ */
+static uint8_t OADLz_copy(OADLz_t *pLz, const uint8_t *pSrc, uint32_t dist,
+                          uint32_t n)
+{
+    uint16_t src;
+
+    // A copy from before the image or past its end is a bad image
+    if(((pSrc == NULL) && ((dist == 0) || (dist > pLz->outDone) ||
+                           (dist > OAD_LZ_WINDOW))) ||
+       (n > pLz->outLeft))
+    {
+        return(OAD_LZ_ERR);
+    }
+
+    src = (pLz->pos - dist) & OAD_LZ_WINDOW_MASK;
+    while(n--)
+    {
+        if(!OADLz_put(pLz, (pSrc != NULL) ? *pSrc++ : pLz->window[src]))
+        {
+            return(OAD_LZ_OUT_ERR);
+        }
+        src = (src + 1) & OAD_LZ_WINDOW_MASK;
+    }
+
+    return(OAD_LZ_MORE);
+}
+
+/*******************************************************************************
+ * @fn          OADLz_decodeDelta
+ *
+ * @brief       Decode the next bytes of a delta image.
+ *
+ * @param       pLz - the decoder
+ * @param       pIn - the bytes
+ * @param       len - number of bytes
+ *
+ * @return      OAD_LZ_MORE, OAD_LZ_ERR, OAD_LZ_OUT_ERR or OAD_LZ_BASE_ERR
+ */
+static uint8_t OADLz_decodeDelta(OADLz_t *pLz, const uint8_t *pIn,
+                                 uint16_t len)
+{
+    uint32_t ofs;
+    uint8_t status;
+    uint8_t b;
+
+    while((len > 0) && (pLz->outLeft > 0))
+    {
+        b = *pIn++;
+        len--;
+
+        if(pLz->step <= OAD_LZ_STEP_LEN)
+        {
+            // CRC and length of the base, 4 bytes each
+            pLz->num |= (uint32_t)b << pLz->shift;
+            pLz->shift += 8;
+            if(pLz->shift == 32)
+            {
+                if(pLz->num != ((pLz->step == OAD_LZ_STEP_CRC) ?
+                                pLz->baseCrc : pLz->baseLen))
+                {
+                    return(OAD_LZ_BASE_ERR);
+                }
+                pLz->num = 0;
+                pLz->shift = 0;
+                pLz->step++;
+            }
+            continue;
+        }
+
+        if((pLz->step == OAD_LZ_STEP_ITEM) && (pLz->shift == 0))
+        {
+            if(pLz->flags == 1)
+            {
+                // Flags of the next 8 items, above a stop bit
+                pLz->flags = 0x100 | b;
+                continue;
+            }
+
+            if(pLz->flags & 1)
+            {
+                if(!OADLz_put(pLz, b))
+                {
+                    return(OAD_LZ_OUT_ERR);
+                }
+                pLz->flags >>= 1;
+                continue;
+            }
+        }
+
+        // A number of a copy
+        if(pLz->shift > 28)
+        {
+            return(OAD_LZ_ERR);
+        }
+        pLz->num |= (uint32_t)(b & 0x7F) << pLz->shift;
+        pLz->shift += 7;
+        if(b & 0x80)
+        {
+            continue;
+        }
+
+        if(pLz->step == OAD_LZ_STEP_ITEM)
+        {
+            pLz->copyLen = pLz->num;
+            pLz->step = OAD_LZ_STEP_FROM;
+        }
+        else if(pLz->copyLen & 1)
+        {
+            // From the base, near the end of the last copy from it
+            ofs = pLz->baseEnd + ((pLz->num & 1) ? (0 - (pLz->num >> 1)) :
+                                                   (pLz->num >> 1));
+            pLz->copyLen = (pLz->copyLen >> 1) + OAD_LZ_MIN_MATCH;
+            if((ofs >= pLz->baseLen) ||
+               (pLz->copyLen > (pLz->baseLen - ofs)))
+            {
+                return(OAD_LZ_ERR);
+            }
+            status = OADLz_copy(pLz, &pLz->pBase[ofs], 0, pLz->copyLen);
+            if(status != OAD_LZ_MORE)
+            {
+                return(status);
+            }
+            pLz->baseEnd = ofs + pLz->copyLen;
+            pLz->step = OAD_LZ_STEP_ITEM;
+            pLz->flags >>= 1;
+        }
+        else
+        {
+            status = OADLz_copy(pLz, NULL, pLz->num + 1,
+                                (pLz->copyLen >> 1) + OAD_LZ_MIN_MATCH);
+            if(status != OAD_LZ_MORE)
+            {
+                return(status);
+            }
+            pLz->step = OAD_LZ_STEP_ITEM;
+            pLz->flags >>= 1;
+        }
+        pLz->num = 0;
+        pLz->shift = 0;
+    }
+
+    return(OAD_LZ_MORE);
+}
+
+/*******************************************************************************
+ *                                    Public Functions
+ */
+
+/*******************************************************************************
+ * @fn          OADLz_init
+ *
+ * @brief       Start decoding a compressed image.
+ *
+ * @param       pLz - the decoder
+ * @param       outLen - length of the image after its header
+ * @param       outFxn - where the image goes, in order
+ *
+ * @return      None
+ */
+void OADLz_init(OADLz_t *pLz, uint32_t outLen, OADLz_outFxn_t outFxn)
+{
+    pLz->pos = 0;
+    pLz->outPos = 0;
+    pLz->flags = 1;
+    pLz->matchLo = -1;
+    pLz->outDone = 0;
+    pLz->outLeft = outLen;
+    pLz->outFxn = outFxn;
+    pLz->pBase = NULL;
+}
+
+/*******************************************************************************
+ * @fn          OADLz_initDelta
+ *
+ * @brief       Start decoding a delta image.
+ *
+ * @param       pLz - the decoder
+ * @param       outLen - length of the image after its header
+ * @param       outFxn - where the image goes, in order
+ * @param       pBase - the base image, it must stay as is while decoding
+ * @param       baseLen - length of the base
+ * @param       baseCrc - CRC of the base, from its header
+ *
+ * @return      None
+ */
+void OADLz_initDelta(OADLz_t *pLz, uint32_t outLen, OADLz_outFxn_t outFxn,
+                     const uint8_t *pBase, uint32_t baseLen, uint32_t baseCrc)
+{
+    OADLz_init(pLz, outLen, outFxn);
+    pLz->pBase = pBase;
+    pLz->baseLen = baseLen;
+    pLz->baseCrc = baseCrc;
+    pLz->baseEnd = 0;
+    pLz->num = 0;
+    pLz->copyLen = 0;
+    pLz->shift = 0;
+    pLz->step = OAD_LZ_STEP_CRC;
+}
+
+/*******************************************************************************
+ * @fn          OADLz_decode
+ *
+ * @brief       Decode the next bytes of a compressed image. An item can be
+ *              split over two calls. Bytes after the end of the image are
+ *              padding and ignored.
+ *
+ * @param       pLz - the decoder
+ * @param       pIn - the bytes
+ * @param       len - number of bytes
+ *
+ * @return      OAD_LZ_MORE, OAD_LZ_DONE or an error, OAD_LZ_ERR,
+ *              OAD_LZ_OUT_ERR or OAD_LZ_BASE_ERR
+ */
+uint8_t OADLz_decode(OADLz_t *pLz, const uint8_t *pIn, uint16_t len)
+{
+    uint8_t status = OAD_LZ_MORE;
+    uint8_t b;
+
+    if(pLz->pBase != NULL)
+    {
+        status = OADLz_decodeDelta(pLz, pIn, len);
+        len = 0;
+    }
+
+    while((len > 0) && (pLz->outLeft > 0) && (status == OAD_LZ_MORE))
+    {
+        b = *pIn++;
+        len--;
+
+        if(pLz->flags == 1)
+        {
+            // Flags of the next 8 items, above a stop bit
+            pLz->flags = 0x100 | b;
+            continue;
+        }
+
+        if(pLz->flags & 1)
+        {
+            if(!OADLz_put(pLz, b))
+            {
+                return(OAD_LZ_OUT_ERR);
+            }
+        }
+        else if(pLz->matchLo < 0)
+        {
+            pLz->matchLo = b;
+            continue;
+        }
+        else
+        {
+            status = OADLz_copy(pLz, NULL,
+                                (((uint32_t)(b >> 6) << 8) |
+                                 (uint32_t)pLz->matchLo) + 1,
+                                (b & 0x3F) + OAD_LZ_MIN_MATCH);
+            pLz->matchLo = -1;
+        }
+        pLz->flags >>= 1;
+    }
+
+    if(status != OAD_LZ_MORE)
+    {
+        return(status);
+    }
+
+    // The output has the bytes up to here, so writes are a block at a time
+    if(!OADLz_flush(pLz, pLz->pos))
+    {
+        return(OAD_LZ_OUT_ERR);
+    }
+
+    return((pLz->outLeft == 0) ? OAD_LZ_DONE : OAD_LZ_MORE);
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+
+ @file  oad_lz.h
+
+ @brief Decoder of compressed OAD images
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef OAD_LZ_H
+#define OAD_LZ_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ *                                          Includes
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+ *                                          Constants
+ */
+
+/*
+ * A compressed image is the image header as is, with IMG_FLAG_COMPRESSED
+ * set, and then the rest of the image in LZSS items. A flag byte comes
+ * before each 8 items, its bit 0 for the first one. An item with its flag
+ * set is a literal byte. One with its flag clear is a copy of earlier
+ * bytes in 2 bytes: the low 8 bits of the distance back less 1, then the
+ * high 2 bits of it above the length less OAD_LZ_MIN_MATCH.
+ *
+ * A delta image has IMG_FLAG_DELTA set instead, and is made against a base
+ * image, the one running. After the header come the CRC and length of the
+ * base, 4 bytes each, then items with flag bytes as above. A copy is a
+ * number, its bit 0 set for a copy from the base and the rest the length
+ * less OAD_LZ_MIN_MATCH, then a second number: the distance back less 1
+ * for a copy of earlier bytes, or the start in the base less the end of
+ * the last copy from it, 0 before the first, bit 0 the sign. Numbers are 7
+ * bits a byte, low bits first, with bit 7 set in all but the last byte.
+ */
+
+/* Bytes kept to copy from, the largest distance back */
+#define OAD_LZ_WINDOW           1024
+
+/* Shortest and longest copy */
+#define OAD_LZ_MIN_MATCH        3
+#define OAD_LZ_MAX_MATCH        (OAD_LZ_MIN_MATCH + 0x3F)
+
+/* OADLz_decode() status */
+#define OAD_LZ_MORE             0   /* Needs more of the image */
+#define OAD_LZ_DONE             1   /* The whole image is out */
+#define OAD_LZ_ERR              2   /* Bad image */
+#define OAD_LZ_OUT_ERR          3   /* The output did not take the bytes */
+#define OAD_LZ_BASE_ERR         4   /* Delta image of another base image */
+
+/*******************************************************************************
+ *                                          Typedefs
+ */
+
+/* Output of the decoder, returns false if the bytes could not be taken */
+typedef bool (*OADLz_outFxn_t)(const uint8_t *pBuf, uint16_t len);
+
+/* Decoder state, it can be stopped and carried on at any byte */
+typedef struct
+{
+    uint8_t  window[OAD_LZ_WINDOW]; /* Last bytes out */
+    uint16_t pos;                   /* Next byte of the window */
+    uint16_t outPos;                /* First byte not passed to the output */
+    uint16_t flags;                 /* Item flags left above a stop bit */
+    int16_t  matchLo;               /* First byte of a copy, -1 for none */
+    uint32_t outDone;               /* Bytes out so far */
+    uint32_t outLeft;               /* Bytes still to come out */
+    OADLz_outFxn_t outFxn;
+    const uint8_t *pBase;           /* Base of a delta image, NULL for none */
+    uint32_t baseLen;               /* Length of the base */
+    uint32_t baseCrc;               /* CRC of the base */
+    uint32_t baseEnd;               /* End of the last copy from the base */
+    uint32_t num;                   /* Number being read */
+    uint32_t copyLen;               /* Length of the copy being read */
+    uint8_t  shift;                 /* Bits of the number read so far */
+    uint8_t  step;                  /* Part of the delta image being read */
+} OADLz_t;
+
+/*******************************************************************************
+ *                                          Functions
+ */
+
+/* Start decoding an image of outLen bytes after the header */
+extern void OADLz_init(OADLz_t *pLz, uint32_t outLen, OADLz_outFxn_t outFxn);
+/* Start decoding a delta image, against a base with the CRC in its header */
+extern void OADLz_initDelta(OADLz_t *pLz, uint32_t outLen,
+                            OADLz_outFxn_t outFxn, const uint8_t *pBase,
+                            uint32_t baseLen, uint32_t baseCrc);
+/* Decode the next bytes of the image, the output goes out of it in order */
+extern uint8_t OADLz_decode(OADLz_t *pLz, const uint8_t *pIn, uint16_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OAD_LZ_H */
@@ -0,0 +1,363 @@
+/******************************************************************************
+
+ @file crc32_bench.c
+
+ @brief Host benchmark of the OAD image CRC
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs CRC32_calc() of crc32.c over a synthetic image in a simulated external
+flash, and the bit at a time CRC it replaces over the same bytes, copied
+through a 256 byte buffer a byte at a time like the old internal flash path
+did. Checks that both give the same CRC for the full image and for images
+of random length and start page, and that CRC32_update() gives it too when
+the image comes in blocks of random size, like an OAD download. Then
+reports the time of each per image.
+
+Build, from OAD:
+  cc -O2 -Iposix/include posix/crc32_bench.c crc32.c -o crc32_bench
+Add -DCRC32_SLICE8 for the 8 bytes at a time variant.
+
+Usage: crc32_bench [-l len] [-n runs] [-s seed]
+  -l  image length, default the 44 page internal flash, 360448 bytes
+  -n  timed runs of each CRC, default 20
+  -s  seed of the image bytes and of the checked lengths, default 1
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "common/cc26xx/flash_interface/flash_interface.h"
+#include "common/cc26xx/oad/oad_image_header.h"
+#include "../crc32.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Image lengths checked against the reference */
+#define BENCH_CHECKS 200
+
+/* Buffer of the reference CRC, like crc32.c */
+#define BENCH_BUF_SZ 256
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* The simulated external flash */
+static uint8_t extFlash[EFL_FLASH_SIZE];
+
+/* State of the random generator */
+static uint32_t benchRandomState = 1;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static uint32_t benchRandom(uint32_t range);
+static uint32_t refCalc(uint8_t page, uint32_t len);
+static uint32_t blockCalc(uint8_t page, uint32_t len);
+static double runTime(bool reference, uint32_t len, uint32_t runs,
+                      uint32_t *pCrc);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t len = MAX_ONCHIP_FLASH_PAGES * INTFLASH_PAGE_SIZE;
+    uint32_t runs = 20;
+    uint32_t seed = 1;
+    uint32_t i;
+    uint32_t crc;
+    uint32_t refCrc;
+    uint32_t failed = 0;
+    double newTime;
+    double refTime;
+    int opt;
+
+    while((opt = getopt(argc, argv, "l:n:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l':
+                len = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                runs = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-l len] [-n runs] [-s seed]\n",
+                        argv[0]);
+                return (2);
+        }
+    }
+    if((len <= IMG_DATA_OFFSET) || (len > EFL_FLASH_SIZE) || (runs == 0))
+    {
+        fprintf(stderr, "image length must be %u to %u bytes\n",
+                (unsigned)IMG_DATA_OFFSET + 1, (unsigned)EFL_FLASH_SIZE);
+        return (2);
+    }
+
+    benchRandomState = (seed != 0) ? seed : 1;
+    for(i = 0; i < EFL_FLASH_SIZE; i++)
+    {
+        extFlash[i] = (uint8_t)benchRandom(0x100);
+    }
+
+    /* Same CRC as the bit at a time one, whatever the length and page */
+    for(i = 0; i <= BENCH_CHECKS; i++)
+    {
+        uint8_t page = 0;
+        uint32_t checkLen = len;
+
+        if(i != 0)
+        {
+            page = (uint8_t)benchRandom(EFL_FLASH_SIZE / EFL_PAGE_SIZE);
+            checkLen = IMG_DATA_OFFSET + 1 +
+                benchRandom(EFL_FLASH_SIZE - (page * EFL_PAGE_SIZE) -
+                            IMG_DATA_OFFSET);
+        }
+        crc = CRC32_calc(page, EFL_PAGE_SIZE, 0, checkLen, true);
+        refCrc = refCalc(page, checkLen);
+        if(crc != refCrc)
+        {
+            printf("page %u length %u: CRC %08x, expected %08x\n",
+                   page, checkLen, crc, refCrc);
+            failed++;
+        }
+        crc = blockCalc(page, checkLen);
+        if(crc != refCrc)
+        {
+            printf("page %u length %u: CRC of blocks %08x, expected %08x\n",
+                   page, checkLen, crc, refCrc);
+            failed++;
+        }
+    }
+
+    refTime = runTime(true, len, runs, &refCrc);
+    newTime = runTime(false, len, runs, &crc);
+
+#ifdef CRC32_SLICE8
+    printf("CRC32_calc, 8 bytes at a time\n");
+#else
+    printf("CRC32_calc, a byte at a time\n");
+#endif
+    printf("image of %u bytes, CRC %08x\n", len, crc);
+    printf("bit at a time: %10.1f us per image\n", refTime * 1e6);
+    printf("CRC32_calc:    %10.1f us per image, %.1f times faster\n",
+           newTime * 1e6, refTime / newTime);
+    printf("%u lengths checked, %u failed\n", BENCH_CHECKS + 1, failed);
+
+    return ((failed != 0) ? 1 : 0);
+}
+
+/*!
+ Read the simulated external flash.
+
+ Public function defined in flash_interface.h
+ */
+uint8_t readFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf,
+                    uint16_t len)
+{
+    uint32_t addr = ((uint32_t)page * EFL_PAGE_SIZE) + offset;
+
+    if((addr + len) > EFL_FLASH_SIZE)
+    {
+        /* Past the end of the flash reads as erased */
+        memset(pBuf, 0xFF, len);
+        if(addr >= EFL_FLASH_SIZE)
+        {
+            return (FLASH_SUCCESS);
+        }
+        len = (uint16_t)(EFL_FLASH_SIZE - addr);
+    }
+    CRC32_memCpy(pBuf, &extFlash[addr], len);
+
+    return (FLASH_SUCCESS);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Random number.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t benchRandom(uint32_t range)
+{
+    benchRandomState ^= benchRandomState << 13;
+    benchRandomState ^= benchRandomState >> 17;
+    benchRandomState ^= benchRandomState << 5;
+
+    return ((range != 0) ? (benchRandomState % range) : 0);
+}
+
+/*!
+ * @brief       CRC of an image a bit at a time, copied through a buffer a
+ *              byte at a time from the last one down.
+ *
+ * @param       page - first page of the image
+ * @param       len - length of the image
+ *
+ * @return      the CRC
+ */
+static uint32_t refCalc(uint8_t page, uint32_t len)
+{
+    static volatile uint8_t buf[BENCH_BUF_SZ];
+    const uint8_t *pImg = &extFlash[(uint32_t)page * EFL_PAGE_SIZE];
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t ofs;
+    uint16_t bufLen;
+    uint16_t n;
+    uint8_t j;
+
+    for(ofs = 0; ofs < len; ofs += BENCH_BUF_SZ)
+    {
+        bufLen = ((len - ofs) < BENCH_BUF_SZ) ? (uint16_t)(len - ofs) :
+                                                BENCH_BUF_SZ;
+        n = bufLen;
+        while(n--)
+        {
+            buf[n] = pImg[ofs + n];
+        }
+        for(n = (ofs == 0) ? IMG_DATA_OFFSET : 0; n < bufLen; n++)
+        {
+            crc ^= buf[n];
+            for(j = 8; j; j--)
+            {
+                crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+            }
+        }
+    }
+
+    return (crc ^ 0xFFFFFFFF);
+}
+
+/*!
+ * @brief       CRC of an image added up a block at a time.
+ *
+ * @param       page - first page of the image
+ * @param       len - length of the image
+ *
+ * @return      the CRC
+ */
+static uint32_t blockCalc(uint8_t page, uint32_t len)
+{
+    const uint8_t *pImg = &extFlash[(uint32_t)page * EFL_PAGE_SIZE];
+    uint32_t crc = 0xFFFFFFFF;
+    uint32_t ofs = IMG_DATA_OFFSET;
+    uint32_t blkLen;
+
+    while(ofs < len)
+    {
+        blkLen = 1 + benchRandom(BENCH_BUF_SZ);
+        if(blkLen > (len - ofs))
+        {
+            blkLen = len - ofs;
+        }
+        crc = CRC32_update(crc, pImg + ofs, blkLen);
+        ofs += blkLen;
+    }
+
+    return (crc ^ 0xFFFFFFFF);
+}
+
+/*!
+ * @brief       Time a CRC of the image at page 0.
+ *
+ * @param       reference - time the bit at a time CRC instead of CRC32_calc()
+ * @param       len - length of the image
+ * @param       runs - number of runs
+ * @param       pCrc - the CRC is put here
+ *
+ * @return      seconds per image, the best of the runs
+ */
+static double runTime(bool reference, uint32_t len, uint32_t runs,
+                      uint32_t *pCrc)
+{
+    struct timespec start;
+    struct timespec end;
+    double best = 0;
+    double t;
+    uint32_t i;
+
+    for(i = 0; i < runs; i++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if(reference)
+        {
+            *pCrc = refCalc(0, len);
+        }
+        else
+        {
+            *pCrc = CRC32_calc(0, EFL_PAGE_SIZE, 0, len, true);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        t = (double)(end.tv_sec - start.tv_sec) +
+            (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+        if((i == 0) || (t < best))
+        {
+            best = t;
+        }
+    }
+
+    return (best);
+}
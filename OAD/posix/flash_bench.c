@@ -0,0 +1,545 @@
+/******************************************************************************
+
+ @file flash_bench.c
+
+ @brief Host benchmark of the external flash write buffer
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs the flash writes of an off-chip OAD download through
+flash_interface_ext_rtos_NVS.c, over an emulated NVS device of the external
+flash, and the same writes straight to NVS_write() as the interface did
+before it combined them. The download erases the meta page and the image
+pages ahead of the blocks, writes the image a block at a time, marks the
+resume bitmap every 8 blocks and writes the metadata at the end, like
+oad.c. Checks that both leave the same bytes in flash, and that a block
+read back before it is flushed reads as written. Then reports the NVS
+calls, SPI transactions and page programs of each.
+
+The device counts the SPI transactions of the NVSSPI25X driver: a status
+read at the start of each call, then for each program page written, 256
+bytes, a write enable, the page program and a status read, and a read for
+each 64 bytes verified before or after. A read is one transaction, a
+sector erase three.
+
+Build, from OAD:
+  cc -O2 -Iposix/include posix/flash_bench.c flash_interface_ext_rtos_NVS.c \
+     -o flash_bench
+
+Usage: flash_bench [-l len] [-b blkSize] [-s seed]
+  -l  image length, default 200000 bytes
+  -b  OAD block size with its 4 byte number, default 20, 64 and 244 in turn
+  -s  seed of the image bytes, default 1
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/cc26xx/flash_interface/flash_interface.h"
+#include "ti_drivers_config.h"
+#include "ti/drivers/NVS.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Program page and verify read of the NVSSPI25X driver */
+#define BENCH_PROG_SZ       256
+#define BENCH_VERIFY_SZ     64
+
+/* Layout of the download, like oad.c */
+#define BENCH_META_PAGE     1
+#define BENCH_IMG_PAGE      4
+#define BENCH_RESUME_OFS    0x100
+#define BENCH_RESUME_LEN    40
+#define BENCH_MAP_OFS       (BENCH_RESUME_OFS + BENCH_RESUME_LEN)
+#define BENCH_META_LEN      48
+#define BENCH_BLK_HDR_SZ    4
+
+/* Image pages erased past the last one written */
+#define BENCH_ERASE_AHEAD   1
+
+/* Counts of the emulated device */
+typedef struct
+{
+    uint32_t calls;
+    uint32_t spi;
+    uint32_t programs;
+} BenchCount_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* The emulated external flash, and what the download left in it unbuffered */
+static uint8_t extFlash[EFL_FLASH_SIZE];
+static uint8_t directFlash[EFL_FLASH_SIZE];
+
+/* The image downloaded */
+static uint8_t *pImg = NULL;
+
+/* The emulated device */
+static NVS_Config benchNvs;
+static BenchCount_t benchCount;
+
+/* State of the random generator */
+static uint32_t benchRandomState = 1;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static uint32_t benchRandom(uint32_t range);
+static bool benchWrite(bool direct, uint32_t addr, uint8_t *pBuf,
+                       uint16_t len);
+static bool benchErase(bool direct, uint16_t page);
+static bool runDownload(bool direct, uint16_t blkSize, uint32_t len);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    static const uint16_t blkSizes[] = {20, 64, 244};
+    uint32_t len = 200000;
+    uint32_t seed = 1;
+    uint16_t blkSize = 0;
+    uint32_t failed = 0;
+    BenchCount_t direct;
+    uint32_t i;
+    uint32_t n;
+    int opt;
+
+    while((opt = getopt(argc, argv, "l:b:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l':
+                len = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                blkSize = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-l len] [-b blkSize] [-s seed]\n",
+                        argv[0]);
+                return (2);
+        }
+    }
+    if((len == 0) ||
+       (len > (EFL_FLASH_SIZE - EXT_FLASH_ADDRESS(BENCH_IMG_PAGE, 0))) ||
+       ((blkSize != 0) && (blkSize <= BENCH_BLK_HDR_SZ)))
+    {
+        fprintf(stderr, "image length must be 1 to %u bytes, block size "
+                "above %u\n",
+                (unsigned)(EFL_FLASH_SIZE - EXT_FLASH_ADDRESS(BENCH_IMG_PAGE, 0)),
+                BENCH_BLK_HDR_SZ);
+        return (2);
+    }
+
+    benchRandomState = (seed != 0) ? seed : 1;
+    pImg = malloc(len);
+    if(pImg == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return (1);
+    }
+    for(i = 0; i < len; i++)
+    {
+        pImg[i] = (uint8_t)benchRandom(0x100);
+    }
+
+    printf("image of %u bytes\n", len);
+    printf("%-10s %-10s %10s %12s %10s\n", "block", "writes", "NVS calls",
+           "SPI trans", "programs");
+
+    for(n = 0; n < (sizeof(blkSizes) / sizeof(blkSizes[0])); n++)
+    {
+        uint16_t size = (blkSize != 0) ? blkSize : blkSizes[n];
+
+        if(!runDownload(true, size, len))
+        {
+            printf("block size %u: download failed, per block\n", size);
+            failed++;
+        }
+        direct = benchCount;
+        memcpy(directFlash, extFlash, sizeof(extFlash));
+
+        if(!runDownload(false, size, len))
+        {
+            printf("block size %u: download failed, combined\n", size);
+            failed++;
+        }
+        if(memcmp(directFlash, extFlash, sizeof(extFlash)) != 0)
+        {
+            printf("block size %u: flash differs from the one written per "
+                   "block\n", size);
+            failed++;
+        }
+
+        printf("%-10u %-10s %10u %12u %10u\n", size, "per block",
+               direct.calls, direct.spi, direct.programs);
+        printf("%-10s %-10s %10u %12u %10u, %.1f times fewer SPI "
+               "transactions\n", "", "combined", benchCount.calls,
+               benchCount.spi, benchCount.programs,
+               (double)direct.spi / benchCount.spi);
+
+        if(blkSize != 0)
+        {
+            break;
+        }
+    }
+
+    printf("%s\n", (failed != 0) ? "FAILED" : "flash contents match");
+
+    return ((failed != 0) ? 1 : 0);
+}
+
+/*!
+ Start the emulated device.
+ */
+void NVS_init(void)
+{
+}
+
+/*!
+ Default parameters of the emulated device.
+ */
+void NVS_Params_init(NVS_Params *params)
+{
+    params->custom = NULL;
+}
+
+/*!
+ Open the emulated device.
+ */
+NVS_Handle NVS_open(uint_least8_t index, NVS_Params *params)
+{
+    (void)params;
+
+    return ((index == CONFIG_NVSEXTERNAL) ? &benchNvs : NULL);
+}
+
+/*!
+ Close the emulated device.
+ */
+void NVS_close(NVS_Handle handle)
+{
+    (void)handle;
+}
+
+/*!
+ Region of the emulated device.
+ */
+void NVS_getAttrs(NVS_Handle handle, NVS_Attrs *attrs)
+{
+    (void)handle;
+    attrs->regionBase = NULL;
+    attrs->regionSize = EFL_FLASH_SIZE;
+    attrs->sectorSize = EFL_PAGE_SIZE;
+}
+
+/*!
+ Read the emulated device, in one transaction.
+ */
+int_fast16_t NVS_read(NVS_Handle handle, size_t offset, void *buffer,
+                      size_t bufferSize)
+{
+    (void)handle;
+    if((offset + bufferSize) > EFL_FLASH_SIZE)
+    {
+        return (NVS_STATUS_ERROR);
+    }
+    benchCount.calls++;
+    benchCount.spi++;
+    memcpy(buffer, &extFlash[offset], bufferSize);
+
+    return (NVS_STATUS_SUCCESS);
+}
+
+/*!
+ Program the emulated device a program page at a time, bits only go from 1
+ to 0.
+ */
+int_fast16_t NVS_write(NVS_Handle handle, size_t offset, void *buffer,
+                       size_t bufferSize, uint_fast16_t flags)
+{
+    const uint8_t *pBuf = buffer;
+    uint32_t verifies = (bufferSize + BENCH_VERIFY_SZ - 1) / BENCH_VERIFY_SZ;
+    size_t n;
+    size_t i;
+
+    (void)handle;
+    if((offset + bufferSize) > EFL_FLASH_SIZE)
+    {
+        return (NVS_STATUS_ERROR);
+    }
+    benchCount.calls++;
+    benchCount.spi++;
+
+    if(flags & NVS_WRITE_PRE_VERIFY)
+    {
+        benchCount.spi += verifies;
+        for(i = 0; i < bufferSize; i++)
+        {
+            if((extFlash[offset + i] & pBuf[i]) != pBuf[i])
+            {
+                return (NVS_STATUS_ERROR);
+            }
+        }
+    }
+
+    for(i = 0; i < bufferSize; i += n)
+    {
+        n = BENCH_PROG_SZ - ((offset + i) & (BENCH_PROG_SZ - 1));
+        if(n > (bufferSize - i))
+        {
+            n = bufferSize - i;
+        }
+        benchCount.spi += 3;
+        benchCount.programs++;
+    }
+    for(i = 0; i < bufferSize; i++)
+    {
+        extFlash[offset + i] &= pBuf[i];
+    }
+
+    if(flags & NVS_WRITE_POST_VERIFY)
+    {
+        benchCount.spi += verifies;
+        if(memcmp(&extFlash[offset], pBuf, bufferSize) != 0)
+        {
+            return (NVS_STATUS_ERROR);
+        }
+    }
+
+    return (NVS_STATUS_SUCCESS);
+}
+
+/*!
+ Erase sectors of the emulated device.
+ */
+int_fast16_t NVS_erase(NVS_Handle handle, size_t offset, size_t size)
+{
+    (void)handle;
+    if(((offset + size) > EFL_FLASH_SIZE) || (offset % EFL_PAGE_SIZE) ||
+       (size % EFL_PAGE_SIZE))
+    {
+        return (NVS_STATUS_ERROR);
+    }
+    benchCount.calls++;
+    benchCount.spi += 3 * (size / EFL_PAGE_SIZE);
+    memset(&extFlash[offset], 0xFF, size);
+
+    return (NVS_STATUS_SUCCESS);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Random number.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t benchRandom(uint32_t range)
+{
+    benchRandomState ^= benchRandomState << 13;
+    benchRandomState ^= benchRandomState >> 17;
+    benchRandomState ^= benchRandomState << 5;
+
+    return ((range != 0) ? (benchRandomState % range) : 0);
+}
+
+/*!
+ * @brief       Write to flash like writeFlashPg(), through the interface or
+ *              straight to the device.
+ *
+ * @param       direct - write straight to the device
+ * @param       addr - address of the write
+ * @param       pBuf - bytes to write
+ * @param       len - number of bytes
+ *
+ * @return      true if written
+ */
+static bool benchWrite(bool direct, uint32_t addr, uint8_t *pBuf,
+                       uint16_t len)
+{
+    if(direct)
+    {
+        return (NVS_write(&benchNvs, addr, pBuf, len, NVS_WRITE_POST_VERIFY) ==
+                NVS_STATUS_SUCCESS);
+    }
+
+    return (writeFlashPg(EXT_FLASH_PAGE(addr), addr & (EFL_PAGE_SIZE - 1), pBuf,
+                         len) == FLASH_SUCCESS);
+}
+
+/*!
+ * @brief       Erase a flash page like eraseFlashPg(), through the interface
+ *              or straight on the device.
+ *
+ * @param       direct - erase straight on the device
+ * @param       page - the page
+ *
+ * @return      true if erased
+ */
+static bool benchErase(bool direct, uint16_t page)
+{
+    if(direct)
+    {
+        return (NVS_erase(&benchNvs, EXT_FLASH_ADDRESS(page, 0),
+                          EFL_PAGE_SIZE) == NVS_STATUS_SUCCESS);
+    }
+
+    return (eraseFlashPg((uint8_t)page) == FLASH_SUCCESS);
+}
+
+/*!
+ * @brief       Write the image to flash like an OAD download. The flash is
+ *              not erased first, like left over from an older image.
+ *
+ * @param       direct - write straight to the device
+ * @param       blkSize - OAD block size
+ * @param       len - image length
+ *
+ * @return      true if the download went through
+ */
+static bool runDownload(bool direct, uint16_t blkSize, uint32_t len)
+{
+    uint8_t resumeRec[BENCH_RESUME_LEN];
+    uint8_t meta[BENCH_META_LEN];
+    uint8_t readBack[256];
+    uint32_t bytesPerBlk = blkSize - BENCH_BLK_HDR_SZ;
+    uint32_t blkTot = (len + bytesPerBlk - 1) / bytesPerBlk;
+    uint32_t imgAddr = EXT_FLASH_ADDRESS(BENCH_IMG_PAGE, 0);
+    uint16_t eraseNext = BENCH_IMG_PAGE;
+    uint16_t eraseEnd = BENCH_IMG_PAGE +
+                        ((len + EFL_PAGE_SIZE - 1) / EFL_PAGE_SIZE);
+    uint16_t lastPage;
+    uint8_t zero = 0;
+    uint32_t blk;
+    uint32_t ofs;
+    uint32_t n;
+    bool ok = true;
+
+    memset(extFlash, 0x5A, sizeof(extFlash));
+    memset(resumeRec, 0x11, sizeof(resumeRec));
+    memset(meta, 0x22, sizeof(meta));
+    memset(&benchCount, 0, sizeof(benchCount));
+    if(!direct)
+    {
+        flash_init();
+        ok = flash_open();
+    }
+
+    ok = ok && benchErase(direct, BENCH_META_PAGE);
+    ok = ok && benchWrite(direct,
+                          EXT_FLASH_ADDRESS(BENCH_META_PAGE, BENCH_RESUME_OFS),
+                          resumeRec, sizeof(resumeRec));
+
+    for(blk = 0; ok && (blk < blkTot); blk++)
+    {
+        ofs = blk * bytesPerBlk;
+        n = ((len - ofs) < bytesPerBlk) ? (len - ofs) : bytesPerBlk;
+
+        // Pages up to the end of the block, and then the one ahead
+        lastPage = EXT_FLASH_PAGE((imgAddr + ofs + n - 1));
+        while(ok && (eraseNext <= lastPage))
+        {
+            ok = benchErase(direct, eraseNext++);
+        }
+        ok = ok && benchWrite(direct, imgAddr + ofs, &pImg[ofs], (uint16_t)n);
+        while(ok && (eraseNext <= (lastPage + BENCH_ERASE_AHEAD)) &&
+              (eraseNext < eraseEnd))
+        {
+            ok = benchErase(direct, eraseNext++);
+        }
+
+        // Resume bitmap, a byte for each 8 blocks
+        if(ok && ((blk % 8) == 7))
+        {
+            ok = benchWrite(direct, EXT_FLASH_ADDRESS(BENCH_META_PAGE,
+                                                      BENCH_MAP_OFS + blk / 8),
+                            &zero, 1);
+        }
+
+        // A block read back before the end reads as written
+        if(ok && (blk == (blkTot / 2)))
+        {
+            if(direct)
+            {
+                ok = (NVS_read(&benchNvs, imgAddr + ofs, readBack, n) ==
+                      NVS_STATUS_SUCCESS);
+            }
+            else
+            {
+                ok = (readFlash(imgAddr + ofs, readBack, n) == FLASH_SUCCESS);
+            }
+            ok = ok && (memcmp(readBack, &pImg[ofs], n) == 0);
+        }
+    }
+
+    ok = ok && benchWrite(direct, EXT_FLASH_ADDRESS(BENCH_META_PAGE, 0), meta,
+                          sizeof(meta));
+    if(!direct)
+    {
+        ok = ok && (flash_flush() == FLASH_SUCCESS);
+        flash_close();
+    }
+
+    return (ok && (memcmp(&extFlash[imgAddr], pImg, len) == 0));
+}
@@ -0,0 +1,83 @@
+/******************************************************************************
+
+ @file flash_interface.h
+
+ @brief Flash interface of a host build of the OAD code, see crc32_bench.c
+        and flash_bench.c
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef OadPosix_flash_interface_h
+#define OadPosix_flash_interface_h
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Sizes of a CC13X2 device and its external flash */
+#define INTFLASH_PAGE_SIZE              0x2000
+#define MAX_ONCHIP_FLASH_PAGES          44
+#define EFL_PAGE_SIZE                   0x1000
+#define EFL_FLASH_SIZE                  0x100000
+
+#define EXT_FLASH_ADDRESS(page, offset) (((page) << 12) + (offset))
+#define EXT_FLASH_PAGE(addr)            (addr >> 12)
+
+#define FLASH_SUCCESS                   0
+#define FLASH_FAILURE                   0xFF
+
+/* The external flash, implemented by the host program */
+extern uint8_t readFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf,
+                           uint16_t len);
+
+/* The rest of the interface, flash_interface_ext_rtos_NVS.c over a host NVS */
+extern void flash_init(void);
+extern bool flash_open(void);
+extern void flash_close(void);
+extern bool hasExternalFlash(void);
+extern uint8_t readFlash(uint_least32_t addr, uint8_t *pBuf, size_t len);
+extern uint8_t writeFlash(uint_least32_t addr, uint8_t *pBuf, size_t len);
+extern uint8_t writeFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf,
+                            uint16_t len);
+extern uint8_t flash_flush(void);
+extern uint8_t eraseFlashPg(uint8_t page);
+
+#endif /* OadPosix_flash_interface_h */
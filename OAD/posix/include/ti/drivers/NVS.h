@@ -0,0 +1,91 @@
+/******************************************************************************
+
+ @file NVS.h
+
+ @brief NVS driver of a host build of the OAD code, the parts
+        flash_interface_ext_rtos_NVS.c uses, implemented by the host program,
+        see flash_bench.c
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef OadPosix_NVS_h
+#define OadPosix_NVS_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define NVS_STATUS_SUCCESS              (0)
+#define NVS_STATUS_ERROR                (-1)
+
+#define NVS_WRITE_ERASE                 (0x1)
+#define NVS_WRITE_PRE_VERIFY            (0x2)
+#define NVS_WRITE_POST_VERIFY           (0x4)
+
+typedef struct
+{
+    void *object;
+} NVS_Config;
+
+typedef NVS_Config *NVS_Handle;
+
+typedef struct
+{
+    void *custom;
+} NVS_Params;
+
+typedef struct
+{
+    void *regionBase;
+    size_t regionSize;
+    size_t sectorSize;
+} NVS_Attrs;
+
+extern void NVS_init(void);
+extern void NVS_Params_init(NVS_Params *params);
+extern NVS_Handle NVS_open(uint_least8_t index, NVS_Params *params);
+extern void NVS_close(NVS_Handle handle);
+extern void NVS_getAttrs(NVS_Handle handle, NVS_Attrs *attrs);
+extern int_fast16_t NVS_read(NVS_Handle handle, size_t offset, void *buffer,
+                             size_t bufferSize);
+extern int_fast16_t NVS_write(NVS_Handle handle, size_t offset, void *buffer,
+                              size_t bufferSize, uint_fast16_t flags);
+extern int_fast16_t NVS_erase(NVS_Handle handle, size_t offset, size_t size);
+
+#endif /* OadPosix_NVS_h */
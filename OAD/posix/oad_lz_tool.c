@@ -0,0 +1,791 @@
+/******************************************************************************
+
+ @file oad_lz_tool.c
+
+ @brief Host tool that makes compressed OAD images
+
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Makes a compressed OAD image, see oad_lz.h, from an OAD image, or with -p a
+delta image against the base image the target runs. The image header is
+kept as is but for IMG_FLAG_COMPRESSED or IMG_FLAG_DELTA and the CRC, which
+is the CRC of the image with the flag set, as it ends up in flash. The
+header ends after its image payload segment, which must be sizeof(imgHdr_t)
+bytes in, as oad.c keeps that many bytes uncompressed. The rest of the image
+is compressed.
+
+A delta copies from the base past its header, the target may have changed
+status fields of the header in flash.
+
+The image made is then decoded with oad_lz.c a block at a time, like the
+target does, and checked against the image and its CRC.
+
+Build, from OAD:
+  cc -O2 -Iposix/include posix/oad_lz_tool.c oad_lz.c crc32.c -o oad_lz_tool
+
+Usage: oad_lz_tool [-b blkSize] [-p base.bin] image.bin out.bin
+  -b  OAD block size with its 4 byte block number, default 244
+  -p  make a delta against this image
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "common/cc26xx/flash_interface/flash_interface.h"
+#include "common/cc26xx/oad/oad_image_header.h"
+#include "../crc32.h"
+#include "../oad_lz.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Size of the hash of 3 bytes */
+#define TOOL_HASH_BITS  16
+#define TOOL_HASH_SZ    (1 << TOOL_HASH_BITS)
+
+/* Earlier matches looked at for each byte */
+#define TOOL_CHAIN_MAX  256
+
+/* Longest copy of a delta looked for */
+#define TOOL_DELTA_MAX  0xFFFF
+
+/* OAD block number in front of each block */
+#define TOOL_BLK_HDR_SZ 4
+
+/* Last bytes with each hash, and the one before each with the same hash */
+typedef struct
+{
+    int32_t head[TOOL_HASH_SZ];
+    int32_t *pPrev;
+} ToolChain_t;
+
+/* An image read */
+typedef struct
+{
+    uint8_t *pBuf;
+    uint32_t len;
+    uint32_t hdrLen;
+} ToolImg_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Image, base of a delta and the image decoded from the one made */
+static ToolImg_t img;
+static ToolImg_t base;
+static uint8_t *pDec = NULL;
+static uint32_t decLen = 0;
+
+/* Hash chains of the image and the base */
+static ToolChain_t imgChain;
+static ToolChain_t baseChain;
+
+/* Output, and its flag byte of the items being put */
+static uint8_t *pOut = NULL;
+static uint32_t outLen = 0;
+static uint32_t flagOfs = 0;
+static uint32_t items = 8;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static bool readImg(const char *pPath, ToolImg_t *pImg);
+static uint32_t hdrEnd(const ToolImg_t *pImg);
+static uint32_t hash3(const uint8_t *p);
+static void chainAdd(ToolChain_t *pChain, const ToolImg_t *pImg, uint32_t pos);
+static uint32_t matchLen(const uint8_t *pA, const uint8_t *pB, uint32_t max);
+static uint32_t findWindow(uint32_t pos, uint32_t max, uint32_t *pDist);
+static uint32_t findBase(uint32_t pos, uint32_t max, uint32_t baseEnd,
+                         uint32_t *pOfs);
+static uint32_t numLen(uint32_t v);
+static void putItem(bool literal);
+static void putNum(uint32_t v);
+static void compress(void);
+static void delta(void);
+static bool decOut(const uint8_t *pBuf, uint16_t len);
+static bool check(uint16_t blkSize);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    const char *pBasePath = NULL;
+    uint16_t blkSize = 244;
+    uint16_t bytesPerBlk;
+    imgFixedHdr_t *pHdr;
+    uint16_t flags;
+    uint16_t flag;
+    uint32_t crc;
+    FILE *pFile;
+    int opt;
+
+    while((opt = getopt(argc, argv, "b:p:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'b':
+                blkSize = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                pBasePath = optarg;
+                break;
+            default:
+                optind = argc;
+                break;
+        }
+    }
+    if(((argc - optind) != 2) || (blkSize <= TOOL_BLK_HDR_SZ))
+    {
+        fprintf(stderr, "usage: %s [-b blkSize] [-p base.bin] image.bin "
+                "out.bin\n", argv[0]);
+        return (2);
+    }
+    bytesPerBlk = blkSize - TOOL_BLK_HDR_SZ;
+
+    if(!readImg(argv[optind], &img) ||
+       ((pBasePath != NULL) && !readImg(pBasePath, &base)))
+    {
+        return (1);
+    }
+
+    memcpy(&flags, &img.pBuf[IMG_FLAGS_OFFSET], sizeof(flags));
+    if(!(flags & IMG_FLAG_COMPRESSED) || !(flags & IMG_FLAG_DELTA))
+    {
+        fprintf(stderr, "the image is compressed or a delta already\n");
+        return (1);
+    }
+
+    /* The CRC is of the image with the flag, as it is in flash */
+    flag = (pBasePath != NULL) ? IMG_FLAG_DELTA : IMG_FLAG_COMPRESSED;
+    flags &= ~flag;
+    memcpy(&img.pBuf[IMG_FLAGS_OFFSET], &flags, sizeof(flags));
+    pHdr = (imgFixedHdr_t *)img.pBuf;
+    crc = CRC32_update(0xFFFFFFFF, &img.pBuf[IMG_DATA_OFFSET],
+                       img.len - IMG_DATA_OFFSET) ^ 0xFFFFFFFF;
+    pHdr->crc32 = crc;
+
+    /* At worst a flag byte for each 8 literals */
+    pOut = malloc(img.len + (img.len / 8) + 16);
+    imgChain.pPrev = malloc(img.len * sizeof(int32_t));
+    pDec = malloc(img.len);
+    if((pOut == NULL) || (imgChain.pPrev == NULL) || (pDec == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return (1);
+    }
+    memcpy(pOut, img.pBuf, img.hdrLen);
+    outLen = img.hdrLen;
+
+    if(pBasePath != NULL)
+    {
+        baseChain.pPrev = malloc(base.len * sizeof(int32_t));
+        if(baseChain.pPrev == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            return (1);
+        }
+        delta();
+    }
+    else
+    {
+        compress();
+    }
+
+    if(!check(blkSize))
+    {
+        return (1);
+    }
+    if(outLen >= img.len)
+    {
+        fprintf(stderr, "the image does not get smaller, %u to %u bytes\n",
+                img.len, outLen);
+        return (1);
+    }
+
+    pFile = fopen(argv[optind + 1], "wb");
+    if((pFile == NULL) || (fwrite(pOut, 1, outLen, pFile) != outLen) ||
+       (fclose(pFile) != 0))
+    {
+        perror(argv[optind + 1]);
+        return (1);
+    }
+
+    printf("image %u bytes, header %u bytes, CRC %08x\n", img.len, img.hdrLen,
+           crc);
+    if(pBasePath != NULL)
+    {
+        printf("base %u bytes, CRC %08x\n", base.len,
+               ((imgFixedHdr_t *)base.pBuf)->crc32);
+    }
+    printf("%s %u bytes, %.1f%%\n", (pBasePath != NULL) ? "delta" : "compressed",
+           outLen, 100.0 * outLen / img.len);
+    printf("blocks of %u bytes: %u to %u\n", blkSize,
+           (img.len + bytesPerBlk - 1) / bytesPerBlk,
+           (outLen + bytesPerBlk - 1) / bytesPerBlk);
+
+    return (0);
+}
+
+/*!
+ Read the decoded image, for CRC32_calc().
+
+ Public function defined in flash_interface.h
+ */
+uint8_t readFlashPg(uint8_t page, uint32_t offset, uint8_t *pBuf,
+                    uint16_t len)
+{
+    uint32_t addr = ((uint32_t)page * EFL_PAGE_SIZE) + offset;
+    uint16_t i;
+
+    for(i = 0; i < len; i++)
+    {
+        pBuf[i] = ((addr + i) < decLen) ? pDec[addr + i] : 0xFF;
+    }
+
+    return (FLASH_SUCCESS);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Read an OAD image.
+ *
+ * @param       pPath - file of the image
+ * @param       pImg - the image is put here
+ *
+ * @return      true if it is an image
+ */
+static bool readImg(const char *pPath, ToolImg_t *pImg)
+{
+    FILE *pFile;
+    long fileLen;
+
+    pFile = fopen(pPath, "rb");
+    if(pFile == NULL)
+    {
+        perror(pPath);
+        return (false);
+    }
+    fseek(pFile, 0, SEEK_END);
+    fileLen = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    pImg->pBuf = malloc((fileLen > 0) ? fileLen : 1);
+    if((pImg->pBuf == NULL) || (fileLen < (long)sizeof(imgFixedHdr_t)) ||
+       (fread(pImg->pBuf, 1, fileLen, pFile) != (size_t)fileLen))
+    {
+        fprintf(stderr, "%s: cannot read an image\n", pPath);
+        fclose(pFile);
+        return (false);
+    }
+    fclose(pFile);
+
+    pImg->len = ((imgFixedHdr_t *)pImg->pBuf)->len;
+    if((pImg->len > (uint32_t)fileLen) || (pImg->len > EFL_FLASH_SIZE))
+    {
+        fprintf(stderr, "%s: image length %u is not that of the file, %ld\n",
+                pPath, pImg->len, fileLen);
+        return (false);
+    }
+    pImg->hdrLen = hdrEnd(pImg);
+    if(pImg->hdrLen == 0)
+    {
+        fprintf(stderr, "%s: no image payload segment in the header\n", pPath);
+        return (false);
+    }
+    /* The target keeps sizeof(imgHdr_t) bytes as they are, no more */
+    if(pImg->hdrLen != sizeof(imgHdr_t))
+    {
+        fprintf(stderr, "%s: header is %u bytes, the target expects %u\n",
+                pPath, pImg->hdrLen, (unsigned)sizeof(imgHdr_t));
+        return (false);
+    }
+
+    return (true);
+}
+
+/*!
+ * @brief       Find the end of the image header, after its image payload
+ *              segment.
+ *
+ * @param       pImg - the image
+ *
+ * @return      length of the header, 0 if it has no payload segment
+ */
+static uint32_t hdrEnd(const ToolImg_t *pImg)
+{
+    uint32_t ofs = ((imgFixedHdr_t *)pImg->pBuf)->hdrLen;
+    uint32_t segLen;
+
+    while((ofs + SEG_LEN_OFFSET + sizeof(segLen)) <= pImg->len)
+    {
+        if(pImg->pBuf[ofs] == IMG_PAYLOAD_SEG_ID)
+        {
+            ofs += sizeof(imgPayloadSeg_t);
+            return ((ofs < pImg->len) ? ofs : 0);
+        }
+        memcpy(&segLen, &pImg->pBuf[ofs + SEG_LEN_OFFSET], sizeof(segLen));
+        if(segLen == 0)
+        {
+            break;
+        }
+        ofs += segLen;
+    }
+
+    return (0);
+}
+
+/*!
+ * @brief       Hash of 3 bytes.
+ *
+ * @param       p - the bytes
+ *
+ * @return      the hash
+ */
+static uint32_t hash3(const uint8_t *p)
+{
+    uint32_t v = ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+
+    return ((v * 2654435761u) >> (32 - TOOL_HASH_BITS));
+}
+
+/*!
+ * @brief       Add the bytes at a position to a hash chain.
+ *
+ * @param       pChain - the hash chain
+ * @param       pImg - image of the chain
+ * @param       pos - the position
+ */
+static void chainAdd(ToolChain_t *pChain, const ToolImg_t *pImg, uint32_t pos)
+{
+    uint32_t h;
+
+    if((pos + OAD_LZ_MIN_MATCH) <= pImg->len)
+    {
+        h = hash3(&pImg->pBuf[pos]);
+        pChain->pPrev[pos] = pChain->head[h];
+        pChain->head[h] = (int32_t)pos;
+    }
+}
+
+/*!
+ * @brief       Number of bytes that match.
+ *
+ * @param       pA - bytes
+ * @param       pB - other bytes
+ * @param       max - most bytes compared
+ *
+ * @return      number of bytes that match
+ */
+static uint32_t matchLen(const uint8_t *pA, const uint8_t *pB, uint32_t max)
+{
+    uint32_t n = 0;
+
+    while((n < max) && (pA[n] == pB[n]))
+    {
+        n++;
+    }
+
+    return (n);
+}
+
+/*!
+ * @brief       Find the longest match of the image bytes at a position in
+ *              the window of the image before it.
+ *
+ * @param       pos - the position
+ * @param       max - longest match
+ * @param       pDist - distance back of the match is put here
+ *
+ * @return      length of the match, 0 for none
+ */
+static uint32_t findWindow(uint32_t pos, uint32_t max, uint32_t *pDist)
+{
+    uint32_t best = 0;
+    uint32_t chain = 0;
+    uint32_t n;
+    int32_t cand;
+
+    if((img.len - pos) < max)
+    {
+        max = img.len - pos;
+    }
+    if(max < OAD_LZ_MIN_MATCH)
+    {
+        return (0);
+    }
+
+    for(cand = imgChain.head[hash3(&img.pBuf[pos])];
+        (cand >= (int32_t)img.hdrLen) &&
+        ((pos - (uint32_t)cand) <= OAD_LZ_WINDOW) &&
+        (chain < TOOL_CHAIN_MAX);
+        cand = imgChain.pPrev[cand], chain++)
+    {
+        n = matchLen(&img.pBuf[cand], &img.pBuf[pos], max);
+        if(n > best)
+        {
+            best = n;
+            *pDist = pos - (uint32_t)cand;
+            if(n == max)
+            {
+                break;
+            }
+        }
+    }
+
+    return ((best >= OAD_LZ_MIN_MATCH) ? best : 0);
+}
+
+/*!
+ * @brief       Find the longest match of the image bytes at a position in
+ *              the base past its header. The bytes after the last copy from
+ *              it are tried first, a copy from there is the shortest.
+ *
+ * @param       pos - the position
+ * @param       max - longest match
+ * @param       baseEnd - end of the last copy from the base
+ * @param       pOfs - start of the match in the base is put here
+ *
+ * @return      length of the match, 0 for none
+ */
+static uint32_t findBase(uint32_t pos, uint32_t max, uint32_t baseEnd,
+                         uint32_t *pOfs)
+{
+    uint32_t best = 0;
+    uint32_t chain = 0;
+    uint32_t n;
+    int32_t cand;
+
+    if((img.len - pos) < max)
+    {
+        max = img.len - pos;
+    }
+    if(max < OAD_LZ_MIN_MATCH)
+    {
+        return (0);
+    }
+
+    if((baseEnd >= base.hdrLen) && (baseEnd < base.len))
+    {
+        n = (base.len - baseEnd < max) ? (base.len - baseEnd) : max;
+        best = matchLen(&base.pBuf[baseEnd], &img.pBuf[pos], n);
+        *pOfs = baseEnd;
+    }
+
+    for(cand = baseChain.head[hash3(&img.pBuf[pos])];
+        (cand >= 0) && (chain < TOOL_CHAIN_MAX) && (best < max);
+        cand = baseChain.pPrev[cand], chain++)
+    {
+        n = (base.len - (uint32_t)cand < max) ? (base.len - (uint32_t)cand) :
+                                               max;
+        n = matchLen(&base.pBuf[cand], &img.pBuf[pos], n);
+        if(n > best)
+        {
+            best = n;
+            *pOfs = (uint32_t)cand;
+        }
+    }
+
+    return ((best >= OAD_LZ_MIN_MATCH) ? best : 0);
+}
+
+/*!
+ * @brief       Length of a number in a delta.
+ *
+ * @param       v - the number
+ *
+ * @return      number of bytes
+ */
+static uint32_t numLen(uint32_t v)
+{
+    uint32_t n = 1;
+
+    while(v >= 0x80)
+    {
+        v >>= 7;
+        n++;
+    }
+
+    return (n);
+}
+
+/*!
+ * @brief       Start an item, after a new flag byte every 8 items.
+ *
+ * @param       literal - the item is a literal byte
+ */
+static void putItem(bool literal)
+{
+    if(items == 8)
+    {
+        flagOfs = outLen++;
+        pOut[flagOfs] = 0;
+        items = 0;
+    }
+    if(literal)
+    {
+        pOut[flagOfs] |= (uint8_t)(1 << items);
+    }
+    items++;
+}
+
+/*!
+ * @brief       Put a number of a delta.
+ *
+ * @param       v - the number
+ */
+static void putNum(uint32_t v)
+{
+    while(v >= 0x80)
+    {
+        pOut[outLen++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    pOut[outLen++] = (uint8_t)v;
+}
+
+/*!
+ * @brief       Compress the image after its header. A match is put off by
+ *              a byte when the next one is longer.
+ */
+static void compress(void)
+{
+    uint32_t pos = img.hdrLen;
+    uint32_t dist = 0;
+    uint32_t nextDist = 0;
+    uint32_t n;
+    uint32_t i;
+
+    memset(imgChain.head, 0xFF, sizeof(imgChain.head));
+
+    while(pos < img.len)
+    {
+        n = findWindow(pos, OAD_LZ_MAX_MATCH, &dist);
+        chainAdd(&imgChain, &img, pos);
+        if((n != 0) &&
+           (findWindow(pos + 1, OAD_LZ_MAX_MATCH, &nextDist) > n))
+        {
+            n = 0;
+        }
+
+        putItem(n == 0);
+        if(n == 0)
+        {
+            pOut[outLen++] = img.pBuf[pos];
+            pos++;
+        }
+        else
+        {
+            pOut[outLen++] = (uint8_t)(dist - 1);
+            pOut[outLen++] = (uint8_t)((((dist - 1) >> 8) << 6) |
+                                       (n - OAD_LZ_MIN_MATCH));
+            for(i = 1; i < n; i++)
+            {
+                chainAdd(&imgChain, &img, pos + i);
+            }
+            pos += n;
+        }
+    }
+}
+
+/*!
+ * @brief       Make a delta of the image after its header against the base.
+ *              Each copy is the one that saves the most bytes.
+ */
+static void delta(void)
+{
+    imgFixedHdr_t *pBaseHdr = (imgFixedHdr_t *)base.pBuf;
+    uint32_t pos = img.hdrLen;
+    uint32_t baseEnd = 0;
+    uint32_t winLen;
+    uint32_t winCost;
+    uint32_t dist = 0;
+    uint32_t baseLen;
+    uint32_t baseCost;
+    uint32_t ofs = 0;
+    uint32_t diff;
+    uint32_t i;
+
+    memset(imgChain.head, 0xFF, sizeof(imgChain.head));
+    memset(baseChain.head, 0xFF, sizeof(baseChain.head));
+    for(i = base.len; i > base.hdrLen; i--)
+    {
+        chainAdd(&baseChain, &base, i - 1);
+    }
+
+    memcpy(&pOut[outLen], &pBaseHdr->crc32, sizeof(uint32_t));
+    memcpy(&pOut[outLen + 4], &pBaseHdr->len, sizeof(uint32_t));
+    outLen += 8;
+
+    while(pos < img.len)
+    {
+        winLen = findWindow(pos, TOOL_DELTA_MAX, &dist);
+        winCost = (winLen != 0) ?
+                  (numLen((winLen - OAD_LZ_MIN_MATCH) << 1) + numLen(dist - 1)) :
+                  0;
+        baseLen = findBase(pos, TOOL_DELTA_MAX, baseEnd, &ofs);
+        diff = (ofs >= baseEnd) ? ((ofs - baseEnd) << 1) :
+                                  (((baseEnd - ofs) << 1) | 1);
+        baseCost = (baseLen != 0) ?
+                   (numLen(((baseLen - OAD_LZ_MIN_MATCH) << 1) | 1) +
+                    numLen(diff)) :
+                   0;
+
+        if((baseLen > baseCost) &&
+           ((baseLen - baseCost) >= (winLen - winCost)))
+        {
+            putItem(false);
+            putNum(((baseLen - OAD_LZ_MIN_MATCH) << 1) | 1);
+            putNum(diff);
+            baseEnd = ofs + baseLen;
+            winLen = baseLen;
+        }
+        else if(winLen > winCost)
+        {
+            putItem(false);
+            putNum((winLen - OAD_LZ_MIN_MATCH) << 1);
+            putNum(dist - 1);
+        }
+        else
+        {
+            putItem(true);
+            pOut[outLen++] = img.pBuf[pos];
+            winLen = 1;
+        }
+
+        for(i = 0; i < winLen; i++)
+        {
+            chainAdd(&imgChain, &img, pos + i);
+        }
+        pos += winLen;
+    }
+}
+
+/*!
+ * @brief       Output of the decoder, after the header of the decoded image.
+ *
+ * @param       pBuf - the bytes
+ * @param       len - number of bytes
+ *
+ * @return      true if they fit the image
+ */
+static bool decOut(const uint8_t *pBuf, uint16_t len)
+{
+    if((decLen + len) > img.len)
+    {
+        return (false);
+    }
+    memcpy(&pDec[decLen], pBuf, len);
+    decLen += len;
+
+    return (true);
+}
+
+/*!
+ * @brief       Decode the image made a block at a time like the target, and
+ *              check it against the image and the CRC in its header.
+ *
+ * @param       blkSize - OAD block size
+ *
+ * @return      true if it decodes to the image
+ */
+static bool check(uint16_t blkSize)
+{
+    static OADLz_t lz;
+    uint32_t bytesPerBlk = blkSize - TOOL_BLK_HDR_SZ;
+    uint32_t ofs;
+    uint32_t start;
+    uint32_t end;
+    uint8_t status = OAD_LZ_MORE;
+
+    memcpy(pDec, pOut, img.hdrLen);
+    decLen = img.hdrLen;
+    if(base.pBuf != NULL)
+    {
+        OADLz_initDelta(&lz, img.len - img.hdrLen, decOut, base.pBuf,
+                        ((imgFixedHdr_t *)base.pBuf)->len,
+                        ((imgFixedHdr_t *)base.pBuf)->crc32);
+    }
+    else
+    {
+        OADLz_init(&lz, img.len - img.hdrLen, decOut);
+    }
+
+    for(ofs = 0; (ofs < outLen) && (status == OAD_LZ_MORE);
+        ofs += bytesPerBlk)
+    {
+        end = ((ofs + bytesPerBlk) < outLen) ? (ofs + bytesPerBlk) : outLen;
+        if(end > img.hdrLen)
+        {
+            start = (ofs > img.hdrLen) ? ofs : img.hdrLen;
+            status = OADLz_decode(&lz, &pOut[start], (uint16_t)(end - start));
+        }
+    }
+
+    if((status != OAD_LZ_DONE) || (decLen != img.len) ||
+       (memcmp(pDec, img.pBuf, img.len) != 0))
+    {
+        fprintf(stderr, "the image made does not decode to the image\n");
+        return (false);
+    }
+    if(CRC32_calc(0, EFL_PAGE_SIZE, 0, img.len, true) !=
+       ((imgFixedHdr_t *)pDec)->crc32)
+    {
+        fprintf(stderr, "CRC of the decoded image does not match\n");
+        return (false);
+    }
+
+    return (true);
+}
@@ -2980,7 +2980,11 @@ static void RemoteDisplay_processConnEvt(Gap_ConnEventRpt_t *pReport)
       if(numPendingMsgs == 0)
       {
           // Reset the system
+#ifdef DMM_SENSOR
+          Ssf_systemReset();
+#else
           SysCtrlSystemReset();
+#endif
       }
       else
       {
@@ -59,6 +59,7 @@
 #include "ti_drivers_config.h"
 
 #include "lpstk/lpstk.h"
+#include "util_timer.h"
 
 /******************************************************************************
  Constants and definitions
@@ -88,6 +89,17 @@ typedef struct
  * */
 #define SENSOR_STARTUP_TIME 1
 
+/*
+ * time in milliseconds the sensor read can be delayed to share a wakeup
+ * with the other application clocks. The sensors are powered while
+ * waiting for the startup clock, so it is not delayed, but other clocks
+ * can be moved to it.
+ * */
+#ifndef SENSOR_READ_CLOCK_SLACK
+#define SENSOR_READ_CLOCK_SLACK 1000
+#endif
+#define SENSOR_STARTUP_CLOCK_SLACK 0
+
 /******************************************************************************
  External variables
  *****************************************************************************/
@@ -150,61 +162,32 @@ void Lpstk_init(void *evntHandle, Lpstk_AccelTiltCb accelCb)
 
 void Lpstk_initSensorReadTimer(Lpstk_SensorMask sensors, uint32_t clockPeriod)
 {
-    Clock_Params clockParams;
-
     periodicReadSensors = sensors;
-    /* Convert clockDuration in milliseconds to ticks. */
-    uint32_t clockTicks = SENSOR_STARTUP_TIME * (1000 / Clock_tickPeriod);
-
-    /* Setup parameters. */
-    Clock_Params_init(&clockParams);
-
-    /* Setup argument. */
-    clockParams.arg = LPSTK_EV_SENSOR_READ_AND_SHUTDOWN;
-
-    /* If period is 0, this is a one-shot timer. */
-    clockParams.period = 0;
-
-    /*
-     Starts immediately after construction if true, otherwise wait for a
-     call to start.
-     */
-    clockParams.startFlag = false;
-
-    /*/ Initialize clock instance. */
-    Clock_construct(&sensor_startUpClock, sensorReadTimeoutCallback, clockTicks, &clockParams);
-    sensor_startUpClockHandle = Clock_handle(&sensor_startUpClock);
-
-    clockTicks = (clockPeriod - SENSOR_STARTUP_TIME) * (1000 / Clock_tickPeriod);
-
-    /* Setup parameters. */
-    //Clock_Params_init(&clockParams);
-
-    /* Setup argument. */
-    clockParams.arg = LPSTK_EV_SENSOR_POWER_UP;
-
-    /* If period is 0, this is a one-shot timer. */
-    clockParams.period = 0;
 
-    /*
-     Starts immediately after construction if true, otherwise wait for a
-     call to start.
-     */
-    clockParams.startFlag = true;
-    Clock_construct(&sensor_readClock, sensorReadTimeoutCallback, clockTicks, &clockParams);
-    sensor_readClockHandle = Clock_handle(&sensor_readClock);
+    /* Reads are coalesced with the other application clocks */
+    sensor_startUpClockHandle = UtilTimer_constructCoalesced(&sensor_startUpClock,
+                                        sensorReadTimeoutCallback,
+                                        SENSOR_STARTUP_TIME,
+                                        SENSOR_STARTUP_CLOCK_SLACK,
+                                        false,
+                                        LPSTK_EV_SENSOR_READ_AND_SHUTDOWN);
+
+    sensor_readClockHandle = UtilTimer_constructCoalesced(&sensor_readClock,
+                                        sensorReadTimeoutCallback,
+                                        (clockPeriod - SENSOR_STARTUP_TIME),
+                                        SENSOR_READ_CLOCK_SLACK,
+                                        true,
+                                        LPSTK_EV_SENSOR_POWER_UP);
 }
 
 void Lpstk_setSensorReadTimer(Lpstk_SensorMask sensors, uint32_t clockPeriod)
 {
-    uint32_t clockTicks = (clockPeriod - SENSOR_STARTUP_TIME) * (1000 / Clock_tickPeriod);
     periodicReadSensors = sensors;
 
-    /* Start clock instance */
-    Clock_stop(sensor_readClockHandle);
-    Clock_setTimeout(sensor_readClockHandle, clockTicks);
-    /* Start clock instance */
-    Clock_start(sensor_readClockHandle);
+    UtilTimer_stop(&sensor_readClock);
+    UtilTimer_setTimeout(sensor_readClockHandle,
+                         (clockPeriod - SENSOR_STARTUP_TIME));
+    UtilTimer_start(&sensor_readClock);
 }
 
 /*!
@@ -231,7 +214,7 @@ void Lpstk_processEvents(void)
         if(sensor_readClockHandle && !Clock_isActive(sensor_readClockHandle))
         {
             /* Start clock instance */
-            Clock_start(sensor_startUpClockHandle);
+            UtilTimer_start(&sensor_startUpClock);
         }
         lpstkSensorMask.powerupMask = (Lpstk_SensorMask)0;
         clearEvent(LPSTK_EV_SENSOR_POWER_UP);
@@ -242,7 +225,7 @@ void Lpstk_processEvents(void)
 
         if(sensor_startUpClockHandle && !Clock_isActive(sensor_startUpClockHandle))
         {
-            Clock_start(sensor_readClockHandle);
+            UtilTimer_start(&sensor_readClock);
         }
 
         lpstkSensorMask.readAndShutdownMask = (Lpstk_SensorMask)0;
@@ -102,7 +102,6 @@ icall_userCfg_t user0Cfg = BLE_USER_CFG;
 #include <dmm/dmm_priority_ble_154sensor.h>
 
 #if defined(RESET_ASSERT)
-#include <driverlib/sys_ctrl.h>
 #include "ssf.h"
 #endif
 
@@ -249,7 +248,7 @@ xdc_Void Main_excHandler(UInt *excStack, UInt lr)
     Ssf_assertInd(MAIN_ASSERT_HWI_TIRTOS);
 
     /* Pull the plug and start over */
-    SysCtrlSystemReset();
+    Ssf_systemReset();
 #else
     //spin here
     while(1);
@@ -415,7 +414,7 @@ void Main_assertHandler(uint8_t assertReason)
     Ssf_assertInd(assertReason);
 
     /* Pull the plug and start over */
-    SysCtrlSystemReset();
+    Ssf_systemReset();
 #else
     Hwi_disable();
     while(1)
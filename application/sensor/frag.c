@@ -0,0 +1,510 @@
+/******************************************************************************
+
+ @file frag.c
+
+ @brief Sensor application fragmentation and reassembly
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <string.h>
+#include <stdint.h>
+
+#include "mac_util.h"
+#include "frag.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Mask with the first n fragment bits set */
+#define FRAG_MASK(n) (((n) >= 32) ? 0xFFFFFFFF : (((uint32_t)1 << (n)) - 1))
+
+/******************************************************************************
+ Structures
+ *****************************************************************************/
+
+/* Outgoing fragmented message */
+typedef struct
+{
+    /* true while the message is being sent */
+    bool active;
+    /* Destination of the message */
+    ApiMac_sAddr_t dstAddr;
+    /* true if the destination is not a sleepy device */
+    bool rxOnIdle;
+    /* Message sequence carried in every fragment */
+    uint8_t msgSeq;
+    /* Number of fragments in the message */
+    uint8_t fragCount;
+    /* Length of the message */
+    uint16_t len;
+    /* Fragments handed to the MAC and waiting for a data confirm */
+    uint32_t pendingMask;
+    /* Fragments acknowledged by the destination */
+    uint32_t ackedMask;
+    /* MSDU handle of each pending fragment */
+    uint8_t msduHandle[FRAG_MAX_FRAGMENTS];
+    /* Retransmissions done for each fragment */
+    uint8_t retries[FRAG_MAX_FRAGMENTS];
+    /* Copy of the message */
+    uint8_t buf[FRAG_MAX_MSG_LEN];
+} fragTxMsg_t;
+
+/* Incoming fragmented message */
+typedef struct
+{
+    /* true while the message is being reassembled */
+    bool active;
+    /* Source of the message */
+    ApiMac_sAddr_t srcAddr;
+    /* Message sequence of the fragments */
+    uint8_t msgSeq;
+    /* Number of fragments in the message */
+    uint8_t fragCount;
+    /* Length of the reassembled message */
+    uint16_t len;
+    /* Fragments received so far */
+    uint32_t rxMask;
+    /* Value of rxAge when a fragment was last received */
+    uint16_t lastRx;
+    /* Reassembly buffer */
+    uint8_t buf[FRAG_MAX_MSG_LEN];
+} fragRxMsg_t;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/* Callback table */
+static Frag_callbacks_t *pFragCallbacks = NULL;
+
+/* Outgoing message */
+static fragTxMsg_t txMsg;
+
+/* Incoming messages */
+static fragRxMsg_t rxMsgs[FRAG_RX_MAX_MSGS];
+
+/* Sequence of the next outgoing message */
+static uint8_t nextMsgSeq = 0;
+
+/* Incremented on every received fragment, used to find the oldest message */
+static uint16_t rxAge = 0;
+
+/******************************************************************************
+ Local function prototypes
+ *****************************************************************************/
+static bool sendFragment(uint8_t fragIdx);
+static void fillTxWindow(void);
+static void txDone(bool success);
+static bool addrMatch(ApiMac_sAddr_t *pAddr1, ApiMac_sAddr_t *pAddr2);
+static fragRxMsg_t *findRxMsg(ApiMac_sAddr_t *pSrcAddr, uint8_t msgSeq);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Initialize the fragmentation module.
+
+ Public function defined in frag.h
+ */
+void Frag_init(Frag_callbacks_t *pCallbacks)
+{
+    pFragCallbacks = pCallbacks;
+
+    Frag_reset();
+}
+
+/*!
+ Send a message that does not fit in a single MAC frame.
+
+ Public function defined in frag.h
+ */
+bool Frag_sendMsg(ApiMac_sAddr_t *pDstAddr, bool rxOnIdle,
+                  uint16_t len, uint8_t *pData)
+{
+    if((pFragCallbacks == NULL) || (txMsg.active == true)
+       || (len == 0) || (len > FRAG_MAX_MSG_LEN))
+    {
+        return (false);
+    }
+
+    memset(&txMsg, 0, sizeof(fragTxMsg_t));
+    memcpy(&txMsg.dstAddr, pDstAddr, sizeof(ApiMac_sAddr_t));
+    memcpy(txMsg.buf, pData, len);
+    txMsg.rxOnIdle = rxOnIdle;
+    txMsg.len = len;
+    txMsg.fragCount = (uint8_t)((len + FRAG_DATA_LEN - 1) / FRAG_DATA_LEN);
+    txMsg.msgSeq = nextMsgSeq++;
+    txMsg.active = true;
+
+    /* The first fragment must make it to the MAC, or nothing was sent */
+    if(sendFragment(0) == false)
+    {
+        txMsg.active = false;
+        return (false);
+    }
+
+    fillTxWindow();
+
+    return (true);
+}
+
+/*!
+ Process a MAC data confirm.
+
+ Public function defined in frag.h
+ */
+bool Frag_processDataCnf(ApiMac_mcpsDataCnf_t *pDataCnf)
+{
+    uint8_t fragIdx;
+
+    if(txMsg.active == false)
+    {
+        return (false);
+    }
+
+    for(fragIdx = 0; fragIdx < txMsg.fragCount; fragIdx++)
+    {
+        if((txMsg.pendingMask & ((uint32_t)1 << fragIdx))
+           && (txMsg.msduHandle[fragIdx] == pDataCnf->msduHandle))
+        {
+            break;
+        }
+    }
+
+    if(fragIdx == txMsg.fragCount)
+    {
+        /* Not one of ours */
+        return (false);
+    }
+
+    txMsg.pendingMask &= ~((uint32_t)1 << fragIdx);
+
+    if(pDataCnf->status == ApiMac_status_success)
+    {
+        txMsg.ackedMask |= ((uint32_t)1 << fragIdx);
+    }
+    else if((txMsg.retries[fragIdx] >= FRAG_MAX_RETRIES)
+            || (sendFragment(fragIdx) == false))
+    {
+        /* Selective retransmit did not work out, give up on the message */
+        txDone(false);
+        return (true);
+    }
+    else
+    {
+        txMsg.retries[fragIdx]++;
+    }
+
+    if(txMsg.ackedMask == FRAG_MASK(txMsg.fragCount))
+    {
+        txDone(true);
+    }
+    else
+    {
+        fillTxWindow();
+    }
+
+    return (true);
+}
+
+/*!
+ Process a received Smsgs_cmdIds_fragment message.
+
+ Public function defined in frag.h
+ */
+void Frag_processDataInd(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    uint8_t *pBuf = pDataInd->msdu.p;
+    uint16_t dataLen;
+    Smsgs_fragmentHdr_t hdr;
+    fragRxMsg_t *pRxMsg;
+
+    if((pFragCallbacks == NULL)
+       || (pDataInd->msdu.len <= SMSGS_FRAGMENT_HDR_LEN))
+    {
+        return;
+    }
+
+    /* Parse the header */
+    hdr.cmdId = (Smsgs_cmdIds_t)*pBuf++;
+    hdr.msgSeq = *pBuf++;
+    hdr.fragIdx = *pBuf++;
+    hdr.fragCount = *pBuf++;
+    hdr.totalLen = Util_parseUint16(pBuf);
+    pBuf += 2;
+    hdr.offset = Util_parseUint16(pBuf);
+    pBuf += 2;
+    dataLen = pDataInd->msdu.len - SMSGS_FRAGMENT_HDR_LEN;
+
+    /* Drop anything that does not fit in a reassembly buffer */
+    if((hdr.fragCount == 0) || (hdr.fragCount > FRAG_MAX_FRAGMENTS)
+       || (hdr.fragIdx >= hdr.fragCount)
+       || (hdr.totalLen > FRAG_MAX_MSG_LEN)
+       || ((uint32_t)hdr.offset + dataLen > hdr.totalLen))
+    {
+        return;
+    }
+
+    pRxMsg = findRxMsg(&pDataInd->srcAddr, hdr.msgSeq);
+
+    if((pRxMsg->active == false) || (pRxMsg->len != hdr.totalLen)
+       || (pRxMsg->fragCount != hdr.fragCount))
+    {
+        /* Start a new message */
+        memset(pRxMsg, 0, sizeof(fragRxMsg_t));
+        memcpy(&pRxMsg->srcAddr, &pDataInd->srcAddr, sizeof(ApiMac_sAddr_t));
+        pRxMsg->msgSeq = hdr.msgSeq;
+        pRxMsg->fragCount = hdr.fragCount;
+        pRxMsg->len = hdr.totalLen;
+        pRxMsg->active = true;
+    }
+
+    pRxMsg->lastRx = ++rxAge;
+
+    /* Duplicates happen when an ACK was lost and the fragment resent */
+    if(pRxMsg->rxMask & ((uint32_t)1 << hdr.fragIdx))
+    {
+        return;
+    }
+
+    memcpy(&pRxMsg->buf[hdr.offset], pBuf, dataLen);
+    pRxMsg->rxMask |= ((uint32_t)1 << hdr.fragIdx);
+
+    if(pRxMsg->rxMask == FRAG_MASK(pRxMsg->fragCount))
+    {
+        ApiMac_mcpsDataInd_t msgInd;
+
+        pRxMsg->active = false;
+
+        /* Fragments of fragments are not supported */
+        if((Smsgs_cmdIds_t)pRxMsg->buf[0] != Smsgs_cmdIds_fragment)
+        {
+            memcpy(&msgInd, pDataInd, sizeof(ApiMac_mcpsDataInd_t));
+            msgInd.msdu.p = pRxMsg->buf;
+            msgInd.msdu.len = pRxMsg->len;
+
+            pFragCallbacks->pfnRxMsg(&msgInd);
+        }
+    }
+}
+
+/*!
+ Abort the message being sent and drop all partial messages.
+
+ Public function defined in frag.h
+ */
+void Frag_reset(void)
+{
+    uint8_t i;
+
+    txMsg.active = false;
+
+    for(i = 0; i < FRAG_RX_MAX_MSGS; i++)
+    {
+        rxMsgs[i].active = false;
+    }
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Build and send one fragment of the outgoing message.
+ *
+ * @param       fragIdx - index of the fragment
+ *
+ * @return      true if handed to the MAC, false if not
+ */
+static bool sendFragment(uint8_t fragIdx)
+{
+    uint8_t frame[FRAG_MAX_FRAME_LEN];
+    uint8_t *pBuf = frame;
+    uint16_t offset = (uint16_t)fragIdx * FRAG_DATA_LEN;
+    uint16_t dataLen = txMsg.len - offset;
+
+    if(dataLen > FRAG_DATA_LEN)
+    {
+        dataLen = FRAG_DATA_LEN;
+    }
+
+    *pBuf++ = (uint8_t)Smsgs_cmdIds_fragment;
+    *pBuf++ = txMsg.msgSeq;
+    *pBuf++ = fragIdx;
+    *pBuf++ = txMsg.fragCount;
+    pBuf = Util_bufferUint16(pBuf, txMsg.len);
+    pBuf = Util_bufferUint16(pBuf, offset);
+    memcpy(pBuf, &txMsg.buf[offset], dataLen);
+
+    if(pFragCallbacks->pfnSend(&txMsg.dstAddr, txMsg.rxOnIdle,
+                               (SMSGS_FRAGMENT_HDR_LEN + dataLen), frame,
+                               &txMsg.msduHandle[fragIdx]) == false)
+    {
+        return (false);
+    }
+
+    txMsg.pendingMask |= ((uint32_t)1 << fragIdx);
+
+    return (true);
+}
+
+/*!
+ * @brief       Send unsent fragments until FRAG_TX_WINDOW are pending.
+ */
+static void fillTxWindow(void)
+{
+    uint8_t fragIdx;
+    uint8_t numPending = 0;
+    uint32_t sentMask = txMsg.pendingMask | txMsg.ackedMask;
+
+    for(fragIdx = 0; fragIdx < txMsg.fragCount; fragIdx++)
+    {
+        if(txMsg.pendingMask & ((uint32_t)1 << fragIdx))
+        {
+            numPending++;
+        }
+    }
+
+    for(fragIdx = 0; (fragIdx < txMsg.fragCount)
+        && (numPending < FRAG_TX_WINDOW); fragIdx++)
+    {
+        if((sentMask & ((uint32_t)1 << fragIdx)) == 0)
+        {
+            if(sendFragment(fragIdx) == false)
+            {
+                /* MAC queue is full, retry on the next data confirm */
+                break;
+            }
+            numPending++;
+        }
+    }
+
+    if(txMsg.pendingMask == 0)
+    {
+        /* Nothing left in the MAC that would trigger another attempt */
+        txDone(false);
+    }
+}
+
+/*!
+ * @brief       Finish the outgoing message and inform the application.
+ *
+ * @param       success - true if every fragment was acknowledged
+ */
+static void txDone(bool success)
+{
+    txMsg.active = false;
+
+    if(pFragCallbacks->pfnTxDone != NULL)
+    {
+        pFragCallbacks->pfnTxDone((Smsgs_cmdIds_t)txMsg.buf[0], success);
+    }
+}
+
+/*!
+ * @brief       Compare two MAC addresses.
+ *
+ * @param       pAddr1 - first address
+ * @param       pAddr2 - second address
+ *
+ * @return      true if both addresses are the same, false if not
+ */
+static bool addrMatch(ApiMac_sAddr_t *pAddr1, ApiMac_sAddr_t *pAddr2)
+{
+    if(pAddr1->addrMode != pAddr2->addrMode)
+    {
+        return (false);
+    }
+
+    if(pAddr1->addrMode == ApiMac_addrType_short)
+    {
+        return (pAddr1->addr.shortAddr == pAddr2->addr.shortAddr);
+    }
+
+    return (memcmp(pAddr1->addr.extAddr, pAddr2->addr.extAddr,
+                   APIMAC_SADDR_EXT_LEN) == 0);
+}
+
+/*!
+ * @brief       Find the reassembly buffer for a message. If the message is
+ *              new, a free buffer or the least recently used one is returned.
+ *
+ * @param       pSrcAddr - source of the message
+ * @param       msgSeq - message sequence
+ *
+ * @return      pointer to the reassembly buffer
+ */
+static fragRxMsg_t *findRxMsg(ApiMac_sAddr_t *pSrcAddr, uint8_t msgSeq)
+{
+    uint8_t i;
+    fragRxMsg_t *pOldest = &rxMsgs[0];
+
+    for(i = 0; i < FRAG_RX_MAX_MSGS; i++)
+    {
+        if((rxMsgs[i].active == true) && (rxMsgs[i].msgSeq == msgSeq)
+           && (addrMatch(&rxMsgs[i].srcAddr, pSrcAddr) == true))
+        {
+            return (&rxMsgs[i]);
+        }
+    }
+
+    for(i = 0; i < FRAG_RX_MAX_MSGS; i++)
+    {
+        if(rxMsgs[i].active == false)
+        {
+            return (&rxMsgs[i]);
+        }
+
+        /* Account for rxAge rolling over */
+        if((uint16_t)(rxAge - rxMsgs[i].lastRx)
+           > (uint16_t)(rxAge - pOldest->lastRx))
+        {
+            pOldest = &rxMsgs[i];
+        }
+    }
+
+    return (pOldest);
+}
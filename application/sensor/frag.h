@@ -0,0 +1,222 @@
+/******************************************************************************
+
+ @file frag.h
+
+ @brief Sensor application fragmentation and reassembly
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef FRAG_H
+#define FRAG_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "api_mac.h"
+#include "smsgs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup Frag Sensor Message Fragmentation
+ <BR>
+ Splits over-the-air messages that do not fit in a single MAC frame into
+ Smsgs_cmdIds_fragment messages, and reassembles them on reception.
+ <BR>
+ Up to FRAG_TX_WINDOW fragments of the outgoing message are handed to the
+ MAC at once. A fragment whose data confirm fails is retransmitted on its
+ own, up to FRAG_MAX_RETRIES times, so a lost frame never costs the whole
+ message.
+ <BR>
+ Received fragments are reassembled in one of FRAG_RX_MAX_MSGS static
+ buffers. When no buffer is free, the least recently used partial message
+ is dropped.
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ Largest MSDU used by the application. Messages longer than this are
+ fragmented. The default fits a 127 byte 2.4GHz frame with MAC security,
+ it can be raised up to MAC_MAX_FRAME_SIZE for 15.4g PHYs.
+ */
+#ifndef FRAG_MAX_FRAME_LEN
+#define FRAG_MAX_FRAME_LEN 90
+#endif
+
+/*! Largest message (before fragmentation) that can be sent or received */
+#ifndef FRAG_MAX_MSG_LEN
+#define FRAG_MAX_MSG_LEN 512
+#endif
+
+/*! Number of fragments that can be outstanding in the MAC at once */
+#ifndef FRAG_TX_WINDOW
+#define FRAG_TX_WINDOW 2
+#endif
+
+/*! Number of times a single fragment is retransmitted before giving up */
+#ifndef FRAG_MAX_RETRIES
+#define FRAG_MAX_RETRIES 3
+#endif
+
+/*! Number of messages that can be reassembled at the same time */
+#ifndef FRAG_RX_MAX_MSGS
+#define FRAG_RX_MAX_MSGS 2
+#endif
+
+/*! Data bytes carried by each fragment */
+#define FRAG_DATA_LEN (FRAG_MAX_FRAME_LEN - SMSGS_FRAGMENT_HDR_LEN)
+
+/*! Maximum number of fragments in one message */
+#define FRAG_MAX_FRAGMENTS \
+    ((FRAG_MAX_MSG_LEN + FRAG_DATA_LEN - 1) / FRAG_DATA_LEN)
+
+#if (FRAG_MAX_FRAGMENTS > 32)
+#error "FRAG_MAX_FRAGMENTS must fit in a 32 bit fragment mask"
+#endif
+
+/*!
+ * @brief       Send a single fragment to the MAC.
+ *
+ * @param       pDstAddr - destination address
+ * @param       rxOnIdle - true if not a sleepy device
+ * @param       len - length of the fragment
+ * @param       pData - pointer to the fragment
+ * @param       pMsduHandle - place to put the MSDU handle used
+ *
+ * @return      true if handed to the MAC, false if not
+ */
+typedef bool (*Frag_sendFp_t)(ApiMac_sAddr_t *pDstAddr, bool rxOnIdle,
+                              uint16_t len, uint8_t *pData,
+                              uint8_t *pMsduHandle);
+
+/*!
+ * @brief       A fragmented message has been sent, or has failed.
+ *
+ * @param       cmdId - command ID of the fragmented message
+ * @param       success - true if every fragment was acknowledged
+ */
+typedef void (*Frag_txDoneFp_t)(Smsgs_cmdIds_t cmdId, bool success);
+
+/*!
+ * @brief       A fragmented message has been reassembled.
+ *
+ * @param       pDataInd - data indication of the last fragment, with the
+ *                         msdu pointing to the reassembled message
+ */
+typedef void (*Frag_rxMsgFp_t)(ApiMac_mcpsDataInd_t *pDataInd);
+
+/*! Fragmentation callback table */
+typedef struct _Frag_callbacks_t
+{
+    /*! Send a fragment */
+    Frag_sendFp_t pfnSend;
+    /*! Fragmented message transmit done */
+    Frag_txDoneFp_t pfnTxDone;
+    /*! Fragmented message received */
+    Frag_rxMsgFp_t pfnRxMsg;
+} Frag_callbacks_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief       Initialize the fragmentation module.
+ *
+ * @param       pCallbacks - pointer to the callback table
+ */
+extern void Frag_init(Frag_callbacks_t *pCallbacks);
+
+/*!
+ * @brief       Send a message that does not fit in a single MAC frame.
+ *
+ * The message is copied, so the caller can free pData on return.
+ *
+ * @param       pDstAddr - destination address
+ * @param       rxOnIdle - true if not a sleepy device
+ * @param       len - length of the message, including its command ID
+ * @param       pData - pointer to the message
+ *
+ * @return      true if the first fragments were sent, false if the message
+ *              is too long, another fragmented message is in progress or
+ *              the MAC refused the first fragment.
+ */
+extern bool Frag_sendMsg(ApiMac_sAddr_t *pDstAddr, bool rxOnIdle,
+                         uint16_t len, uint8_t *pData);
+
+/*!
+ * @brief       Process a MAC data confirm.
+ *
+ * @param       pDataCnf - pointer to the data confirm information
+ *
+ * @return      true if the confirm was for a fragment, false if not
+ */
+extern bool Frag_processDataCnf(ApiMac_mcpsDataCnf_t *pDataCnf);
+
+/*!
+ * @brief       Process a received Smsgs_cmdIds_fragment message.
+ *
+ * The reassembled message is passed to the pfnRxMsg callback once the last
+ * missing fragment is received.
+ *
+ * @param       pDataInd - pointer to the data indication information
+ */
+extern void Frag_processDataInd(ApiMac_mcpsDataInd_t *pDataInd);
+
+/*!
+ * @brief       Abort the message being sent and drop all partial messages.
+ */
+extern void Frag_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FRAG_H */
@@ -0,0 +1,73 @@
+/******************************************************************************
+
+ @file advanced_config.h
+
+ @brief Advanced configuration of the host build of the sensor, see
+        posix/sensor_sim.c
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef SensorPosix_advanced_config_h
+#define SensorPosix_advanced_config_h
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*
+ Stands in for the advanced_config.h of the device project. Only the
+ frequency hopping settings that jdllc.c needs to build are here, none of
+ them are used by the non beacon network of the simulated MAC.
+ */
+
+/*! Short address of the coordinator in frequency hopping mode */
+#define FH_COORD_SHORT_ADDR                 0xAABB
+
+/*! Number of non sleepy neighbours */
+#define FH_NUM_NON_SLEEPY_HOPPING_NEIGHBORS 2
+#define FH_NUM_NON_SLEEPY_FIXED_CHANNEL_NEIGHBORS 2
+
+/*! Channels used for the asynchronous frames */
+#define FH_ASYNC_CHANNEL_MASK               { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+                                              0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+                                              0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+                                              0xFF, 0xFF }
+
+#endif /* SensorPosix_advanced_config_h */
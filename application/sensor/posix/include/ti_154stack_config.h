@@ -0,0 +1,124 @@
+/******************************************************************************
+
+ @file ti_154stack_config.h
+
+ @brief Stack configuration of the host build of the sensor, see
+        posix/sensor_sim.c
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef SensorPosix_ti_154stack_config_h
+#define SensorPosix_ti_154stack_config_h
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include "ti_drivers_config.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*
+ Stands in for the file SysConfig generates for a device build. The
+ simulated MAC of api_mac_posix.h is a non beacon, non frequency hopping
+ network without security, so those are the settings here; the values are
+ the SysConfig defaults of the sensor project unless noted. The intervals
+ can be set on the compiler command line.
+ */
+
+/*! Network operation, non beacon */
+#define CONFIG_MAC_BEACON_ORDER             15
+#define CONFIG_MAC_SUPERFRAME_ORDER         15
+#define CONFIG_FH_ENABLE                    false
+#define CONFIG_RX_ON_IDLE                   false
+#define CONFIG_SECURE                       false
+#define CERTIFICATION_TEST_MODE             false
+
+/*! The simulation has no buttons, so the device joins by itself */
+#define CONFIG_AUTO_START                   1
+
+/*! PAN ID, 0xFFFF to join any PAN */
+#define CONFIG_PAN_ID                       0xFFFF
+
+/*! Radio */
+#define CONFIG_PHY_ID                       (APIMAC_50KBPS_915MHZ_PHY_1)
+#define CONFIG_CHANNEL_PAGE                 (APIMAC_CHANNEL_PAGE_9)
+#define CONFIG_TRANSMIT_POWER               14
+#define CONFIG_CHANNEL_MASK                 { 0x0F, 0x00, 0x00, 0x00, 0x00, \
+                                              0x00, 0x00, 0x00, 0x00, 0x00, \
+                                              0x00, 0x00, 0x00, 0x00, 0x00, \
+                                              0x00, 0x00 }
+
+/*! MAC retries and backoffs */
+#define CONFIG_MAX_RETRIES                  3
+#define CONFIG_MIN_BE                       3
+#define CONFIG_MAX_BE                       5
+#define CONFIG_MAC_MAX_CSMA_BACKOFFS        4
+#define CONFIG_SCAN_DURATION                5
+#define CONFIG_MAX_DATA_FAILURES            3
+
+/*! Application intervals, in milliseconds */
+#ifndef CONFIG_REPORTING_INTERVAL
+#define CONFIG_REPORTING_INTERVAL           300000
+#endif
+#ifndef CONFIG_POLLING_INTERVAL
+#define CONFIG_POLLING_INTERVAL             6000
+#endif
+#define CONFIG_SCAN_BACKOFF_INTERVAL        5000
+#define CONFIG_ORPHAN_BACKOFF_INTERVAL      300000
+
+/*! Frequency hopping, unused by the non beacon network */
+#define CONFIG_FH_NETNAME                   {"FHTest"}
+#define CONFIG_FH_CHANNEL_MASK              { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+                                              0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+                                              0xFF, 0xFF, 0xFF, 0xFF, 0xFF, \
+                                              0xFF, 0xFF }
+#define CONFIG_DWELL_TIME                   250
+#define CONFIG_PAN_ADVERT_SOLICIT_CLK_DURATION 6000
+#define CONFIG_PAN_CONFIG_SOLICIT_CLK_DURATION 6000
+#define CONFIG_FH_START_POLL_DATA_RAND_WINDOW  10000
+#define CONFIG_FH_MAX_ASSOCIATION_ATTEMPTS  3
+
+/*! Default network key, unused without security */
+#define KEY_TABLE_DEFAULT_KEY {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0,\
+                               0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}
+
+#endif /* SensorPosix_ti_154stack_config_h */
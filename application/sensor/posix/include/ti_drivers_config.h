@@ -0,0 +1,75 @@
+/******************************************************************************
+
+ @file ti_drivers_config.h
+
+ @brief Board configuration of the host build of the sensor, see
+        posix/sensor_sim.c
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef SensorPosix_ti_drivers_config_h
+#define SensorPosix_ti_drivers_config_h
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <ti/drivers/ADC.h>
+#include <ti/drivers/GPIO.h>
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*
+ Stands in for the file SysConfig generates for the flowmeter board, with
+ the pins and channels the application uses. The drivers behind them are
+ simulated by posix/sensor_sim.c.
+ */
+
+/*! Blue LED, toggled around a flow measurement */
+#define CONFIG_GPIO_BLED                    0
+
+/*! Flowmeter pulse input */
+#define InterruptPin                        1
+
+/*! Battery voltage divider */
+#define BATTERY_ADC                         0
+
+#endif /* SensorPosix_ti_drivers_config_h */
@@ -0,0 +1,434 @@
+/******************************************************************************
+
+ @file sensor_sim.c
+
+ @brief Host simulation of the sensor application
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs the sensor application unchanged as a host process: Sensor_init() and
+then the Sensor_process() loop of the device, on the simulated kernel of
+sim_rtos.h and the simulated coordinator of api_mac_posix.h, with
+posix/ssf_posix.c in place of ssf.c. The flowmeter pulses, the battery ADC
+and the sleep() of the flow measurement are simulated here.
+
+The device joins the simulated coordinator by itself. After the join, the
+coordinator sends a Configuration Request with the reporting interval, and
+the device reports until the simulated time is over. Then the counts are
+printed, with the wakeups of the simulated device and the real time the
+run took. Simulated time only moves while the application waits, so the
+real time is the time the application code takes to run.
+
+Fails if the device did not join, did not get the Configuration Request,
+or the number of reports doesn't match the reporting interval. The flow
+measurement of one second runs while the reading clock does, so a report
+period is the longer of the two, plus up to the reading clock slack: no
+more reports than one per period, and no fewer than one per period and
+slack, less one for every failed data request.
+
+Build, from application/sensor:
+  S=../../software_stacks/ti15_4stack
+  cc -O2 -DOSAL_PORT_POSIX -DOSAL_PORT2TIRTOS -DCUI_DISABLE
+     -Iposix/include -I$S/posix/include -I$S/posix -I$S/stack_user_api
+     -I$S/osal_port -I$S/services -Ilink_controller -Iutil -I.
+     posix/sensor_sim.c posix/ssf_posix.c sensor.c link_controller/jdllc.c
+     util/mac_util.c util/util_sched.c util/util_timer.c prof.c
+     $S/posix/api_mac_posix.c $S/posix/sim_rtos.c $S/osal_port/osal_port.c
+     $S/osal_port/osal_port_timers.c -o sensor_sim
+
+Usage: sensor_sim [-t hours] [-r interval] [-p pulses] [-f failures]
+                  [-s seed]
+  -t  simulated time, default 24 hours
+  -r  reporting interval set by the coordinator, in milliseconds, 1000
+      to 3600000, default 1000
+  -p  flowmeter pulses per second, default 10
+  -f  data requests to fail with no ack, default 0
+  -s  seed of the simulation, default 1
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_rtos.h"
+#include "api_mac_posix.h"
+#include "ti_drivers_config.h"
+#include "mac_util.h"
+#include "jdllc.h"
+#include "smsgs.h"
+#include "sensor.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Clock ticks in a millisecond */
+#define SIM_TICKS_PER_MS (1000 / SIM_RTOS_TICK_PERIOD)
+
+/* Time after the join that the coordinator sends the Configuration
+   Request, in milliseconds */
+#define SIM_CONFIG_REQ_DELAY 1000
+
+/* Battery ADC counts, about 11 V behind the divider of the board */
+#define SIM_BATTERY_COUNTS 2650
+
+/* Reporting intervals sensor.c takes, in milliseconds */
+#define SIM_MIN_INTERVAL 1000
+#define SIM_MAX_INTERVAL 3600000
+
+/* Flow measurement of sensor.c, sleep(intervalo), in milliseconds */
+#define SIM_MEASURE_MS 1000
+
+/* Slack of the reading clock, the same as ssf_posix.c */
+#ifndef READING_CLOCK_SLACK
+#define READING_CLOCK_SLACK 1000
+#endif
+
+/******************************************************************************
+ External Variables
+ *****************************************************************************/
+
+/* The IEEE address of the simulated MAC */
+extern ApiMac_sAddrExt_t ApiMac_extAddr;
+
+/* Counts a flowmeter pulse, called from the pin interrupt on the device */
+extern void addPulse();
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Flowmeter pulses per second */
+static uint32_t simPulses = 10;
+
+/* The only ADC of the board */
+static uint8_t simAdc;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static bool runUntil(uint64_t stopTime, bool (*pDone)(void));
+static bool isJoined(void);
+static uint16_t makeConfigReq(uint8_t *pBuf, uint32_t reportingInterval,
+                              uint32_t pollingInterval);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t hours = 24;
+    uint32_t interval = 1000;
+    uint32_t failures = 0;
+    uint32_t seed = 1;
+    uint64_t stopTime;
+    uint64_t joinTime;
+    uint64_t configTime;
+    uint32_t reports;
+    uint32_t minReports;
+    uint32_t maxReports;
+    uint32_t period;
+    uint8_t configReq[SMSGS_CONFIG_REQUEST_MSG_LENGTH];
+    uint16_t configReqLen;
+    ApiMacPosix_stats_t stats;
+    clock_t start;
+    double seconds;
+    int opt;
+    int errors = 0;
+
+    while((opt = getopt(argc, argv, "t:r:p:f:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 't':
+                hours = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                interval = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                simPulses = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                failures = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t hours] [-r interval] "
+                        "[-p pulses] [-f failures] [-s seed]\n", argv[0]);
+                return (2);
+        }
+    }
+
+    if((hours == 0) || (seed == 0))
+    {
+        fprintf(stderr, "hours and seed can't be 0\n");
+        return (2);
+    }
+    if((interval < SIM_MIN_INTERVAL) || (interval > SIM_MAX_INTERVAL))
+    {
+        fprintf(stderr, "the device only takes intervals of %u to %u ms\n",
+                SIM_MIN_INTERVAL, SIM_MAX_INTERVAL);
+        return (2);
+    }
+
+    start = clock();
+
+    SimRtos_init();
+    SimRtos_setSeed(seed);
+    stopTime = (uint64_t)hours * 3600 * 1000 * SIM_TICKS_PER_MS;
+
+    /* The IEEE address the device would read from its flash */
+    memset(ApiMac_extAddr, 0, sizeof(ApiMac_sAddrExt_t));
+    ApiMac_extAddr[0] = (uint8_t)seed;
+    ApiMac_extAddr[7] = 0x12;
+
+    Sensor_init(0);
+
+    /* Scan, associate and send the first reports */
+    if(runUntil(stopTime, isJoined) == false)
+    {
+        printf("device did not join\n");
+        return (1);
+    }
+    joinTime = SimRtos_getTime();
+
+    /* Set the reporting interval the way the collector does */
+    configReqLen = makeConfigReq(configReq, interval,
+                                 CONFIG_POLLING_INTERVAL);
+    if(ApiMacPosix_dataInd(configReq, configReqLen,
+                           SIM_CONFIG_REQ_DELAY) == false)
+    {
+        printf("no room for the Configuration Request\n");
+        return (1);
+    }
+    configTime = joinTime + (SIM_CONFIG_REQ_DELAY * SIM_TICKS_PER_MS);
+    ApiMacPosix_setDataCnfStatus(ApiMac_status_noAck, failures);
+
+    runUntil(stopTime, NULL);
+
+    seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+    ApiMacPosix_getStats(&stats);
+
+    /*
+     The reading clock is started again before the flow measurement and runs
+     during it, so a report comes no sooner than the longer of the two after
+     the one before, and no later than its slack after that. The report of
+     the join and one at the default interval can come before the
+     Configuration Request. The counts of Sensor_msgStats are 16 bits, so the
+     reports are counted from the data requests, less the Configuration
+     Response.
+     */
+    reports = stats.dataReqs - stats.dataFails - 1;
+    period = (interval > SIM_MEASURE_MS) ? interval : SIM_MEASURE_MS;
+    minReports = (uint32_t)((stopTime - configTime)
+                            / ((uint64_t)(period + READING_CLOCK_SLACK)
+                               * SIM_TICKS_PER_MS));
+    minReports = (minReports > failures) ? (minReports - failures) : 0;
+    maxReports = (uint32_t)((stopTime - configTime)
+                            / ((uint64_t)period * SIM_TICKS_PER_MS)) + 2;
+
+    printf("simulated %u h in %.3f s, joined after %.3f s\n",
+           hours, seconds, (double)joinTime / (1000.0 * SIM_TICKS_PER_MS));
+    printf("reports: %u sent, %u to %u expected\n",
+           reports, minReports, maxReports);
+    printf("mac: %u data requests, %u failed, %u polls, %u indications\n",
+           stats.dataReqs, stats.dataFails, stats.pollReqs, stats.dataInds);
+    printf("%u wakeups, %.2f per report\n", SimRtos_getWakeups(),
+           (reports != 0) ? ((double)SimRtos_getWakeups() / reports) : 0.0);
+
+    if(Sensor_msgStats.configRequests != 1)
+    {
+        printf("%u Configuration Requests received, expected 1\n",
+               Sensor_msgStats.configRequests);
+        errors++;
+    }
+    if((reports < minReports) || (reports > maxReports))
+    {
+        printf("wrong number of reports\n");
+        errors++;
+    }
+
+    printf("%d errors\n", errors);
+    return ((errors != 0) ? 1 : 0);
+}
+
+/******************************************************************************
+ Simulated drivers
+ *****************************************************************************/
+
+/*
+ The flow measurement sleeps for its sample time while the pin interrupt
+ counts the pulses, the simulated time moves instead, with the pulses.
+ */
+unsigned int sleep(unsigned int seconds)
+{
+    uint32_t i;
+
+    for(i = 0; i < (seconds * simPulses); i++)
+    {
+        addPulse();
+    }
+    SimRtos_advance(seconds * 1000 * SIM_TICKS_PER_MS);
+
+    return (0);
+}
+
+void GPIO_toggle(uint_least8_t index)
+{
+    (void)index;
+}
+
+void GPIO_enableInt(uint_least8_t index)
+{
+    (void)index;
+}
+
+void ADC_Params_init(ADC_Params *params)
+{
+    memset(params, 0, sizeof(ADC_Params));
+}
+
+ADC_Handle ADC_open(uint_least8_t index, ADC_Params *params)
+{
+    (void)params;
+
+    return ((index == BATTERY_ADC) ? (ADC_Handle)&simAdc : NULL);
+}
+
+int_fast16_t ADC_convert(ADC_Handle handle, uint16_t *value)
+{
+    if(handle == NULL)
+    {
+        return (ADC_STATUS_ERROR);
+    }
+
+    *value = SIM_BATTERY_COUNTS;
+    return (ADC_STATUS_SUCCESS);
+}
+
+void ADC_close(ADC_Handle handle)
+{
+    (void)handle;
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Run the application task loop.
+ *
+ * @param       stopTime - simulated time to stop at
+ * @param       pDone - stops the loop early when it returns true, NULL to
+ *                      run until the stop time
+ *
+ * @return      true if stopped by pDone
+ */
+static bool runUntil(uint64_t stopTime, bool (*pDone)(void))
+{
+    SimRtos_setStopTime(stopTime);
+
+    while(SimRtos_getTime() < stopTime)
+    {
+        if((pDone != NULL) && pDone())
+        {
+            return (true);
+        }
+        Sensor_process();
+
+        /* Nothing to do and no clock to wait for */
+        if(SimRtos_stopped() && (Sensor_events == 0) && (Jdllc_events == 0))
+        {
+            break;
+        }
+    }
+
+    return ((pDone != NULL) && pDone());
+}
+
+/*!
+ * @brief       Check if the device joined the network.
+ *
+ * @return      true if joined
+ */
+static bool isJoined(void)
+{
+    uint8_t state = Jdllc_getProvState();
+
+    return ((state == Jdllc_states_joined)
+            || (state == Jdllc_states_rejoined));
+}
+
+/*!
+ * @brief       Build a Configuration Request like the collector sends.
+ *
+ * @param       pBuf - place for the message
+ * @param       reportingInterval - in milliseconds
+ * @param       pollingInterval - in milliseconds
+ *
+ * @return      length of the message
+ */
+static uint16_t makeConfigReq(uint8_t *pBuf, uint32_t reportingInterval,
+                              uint32_t pollingInterval)
+{
+    uint8_t *p = pBuf;
+    uint16_t frameControl = Smsgs_dataFields_msgStats
+                            | Smsgs_dataFields_configSettings;
+
+    *p++ = (uint8_t)Smsgs_cmdIds_configReq;
+    p = Util_bufferUint16(p, frameControl);
+    p = Util_bufferUint32(p, reportingInterval);
+    p = Util_bufferUint32(p, pollingInterval);
+
+    return ((uint16_t)(p - pBuf));
+}
@@ -0,0 +1,641 @@
+/******************************************************************************
+
+ @file smsgs_decode_bench.c
+
+ @brief Host benchmark of the Smsgs over-the-air message decoder
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Makes a recording of over-the-air messages like a collector receives from
+many sensors: Sensor Data Messages with random fields, Configuration
+Requests and Responses, Tracking Responses and Fragments, with some of them
+damaged the way a bad frame would be: truncated, padded, an unknown command
+or an unknown frame control bit.
+
+First checks that Smsgs_decodeView() accepts exactly the good messages, and
+that Smsgs_decodeSensorMsg(), Smsgs_decodeConfigReq() and
+Smsgs_decodeConfigRsp() give back the values that were encoded, the
+profiling field included. Then reports the messages per second of
+Smsgs_decodeBatch() alone, and of Smsgs_decodeBatch() followed by the
+decode of every valid Sensor Data Message.
+
+Build, from application/sensor:
+  cc -O2 -Iposix/include posix/smsgs_decode_bench.c smsgs_decode.c
+     -o smsgs_decode_bench
+
+Usage: smsgs_decode_bench [-m msgs] [-n runs] [-s seed]
+  -m  messages in the recording, default 1000000
+  -n  timed runs, default 5
+  -s  seed of the recording, default 1
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../smsgs_decode.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Longest message of the recording, all sensor data fields and a fragment */
+#define BENCH_MAX_MSG_LEN 160
+
+/* One message in this many is damaged */
+#define BENCH_BAD_RATIO 50
+
+/* Fields the bench encodes, the LPSTK ones are left out */
+#define BENCH_FIELDS (Smsgs_dataFields_tempSensor | \
+                      Smsgs_dataFields_lightSensor | \
+                      Smsgs_dataFields_humiditySensor | \
+                      Smsgs_dataFields_msgStats | \
+                      Smsgs_dataFields_configSettings | \
+                      Smsgs_dataFields_bleSensor | \
+                      Smsgs_dataFields_latencyStats | \
+                      Smsgs_dataFields_profStats)
+
+/* Put little endian values */
+#define BENCH_PUT16(p, v) do { (p)[0] = (uint8_t)(v); \
+                               (p)[1] = (uint8_t)((v) >> 8); } while(0)
+#define BENCH_PUT32(p, v) do { BENCH_PUT16((p), (v)); \
+                               BENCH_PUT16((p) + 2, (v) >> 16); } while(0)
+
+/* A recorded message and what it was encoded from */
+typedef struct
+{
+    uint16_t len;
+    bool valid;
+    Smsgs_sensorMsg_t sensor;
+    Smsgs_configReqMsg_t configReq;
+    Smsgs_configRspMsg_t configRsp;
+} benchMsg_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* State of the random generator */
+static uint32_t benchRandomState = 1;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static uint32_t benchRandom(uint32_t range);
+static uint16_t makeMsg(uint8_t *pBuf, benchMsg_t *pMsg);
+static uint16_t makeSensorMsg(uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg);
+static uint16_t damageMsg(uint8_t *pBuf, uint16_t len);
+static bool checkMsg(const Smsgs_msgView_t *pView, const benchMsg_t *pMsg);
+static double runTime(const uint8_t * const *ppBufs, const uint16_t *pLens,
+                      uint32_t count, Smsgs_msgView_t *pViews, bool decode,
+                      uint32_t runs, uint32_t *pValid);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t count = 1000000;
+    uint32_t runs = 5;
+    uint32_t seed = 1;
+    uint8_t *pRec;
+    const uint8_t **ppBufs;
+    uint16_t *pLens;
+    Smsgs_msgView_t *pViews;
+    benchMsg_t msg;
+    uint32_t numValid = 0;
+    uint32_t numSensor = 0;
+    uint32_t failed = 0;
+    uint32_t valid;
+    uint64_t bytes = 0;
+    uint32_t i;
+    double viewTime;
+    double decodeTime;
+    int opt;
+
+    while((opt = getopt(argc, argv, "m:n:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'm':
+                count = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                runs = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-m msgs] [-n runs] [-s seed]\n",
+                        argv[0]);
+                return (2);
+        }
+    }
+    if((count == 0) || (runs == 0))
+    {
+        fprintf(stderr, "messages and runs must not be 0\n");
+        return (2);
+    }
+
+    pRec = malloc((size_t)count * BENCH_MAX_MSG_LEN);
+    ppBufs = malloc(count * sizeof(ppBufs[0]));
+    pLens = malloc(count * sizeof(pLens[0]));
+    pViews = malloc(count * sizeof(pViews[0]));
+    if((pRec == NULL) || (ppBufs == NULL) || (pLens == NULL) ||
+       (pViews == NULL))
+    {
+        fprintf(stderr, "out of memory\n");
+        return (2);
+    }
+
+    /* Record the messages, checking each one as it is made */
+    benchRandomState = (seed != 0) ? seed : 1;
+    for(i = 0; i < count; i++)
+    {
+        uint8_t *pBuf = &pRec[(size_t)i * BENCH_MAX_MSG_LEN];
+
+        ppBufs[i] = pBuf;
+        pLens[i] = makeMsg(pBuf, &msg);
+        bytes += pLens[i];
+        Smsgs_decodeView(pBuf, pLens[i], &pViews[i]);
+        if(!checkMsg(&pViews[i], &msg))
+        {
+            if(failed < 10)
+            {
+                printf("message %u, command %u, length %u: status %u, "
+                       "expected %s\n", i, pBuf[0], pLens[i],
+                       pViews[i].status, msg.valid ? "valid" : "invalid");
+            }
+            failed++;
+        }
+        if(msg.valid)
+        {
+            numValid++;
+            if(pBuf[0] == Smsgs_cmdIds_sensorData)
+            {
+                numSensor++;
+            }
+        }
+    }
+
+    viewTime = runTime(ppBufs, pLens, count, pViews, false, runs, &valid);
+    if(valid != numValid)
+    {
+        printf("Smsgs_decodeBatch: %u valid, expected %u\n", valid, numValid);
+        failed++;
+    }
+    decodeTime = runTime(ppBufs, pLens, count, pViews, true, runs, &valid);
+
+    printf("%u messages, %u valid, %u sensor data, %.1f bytes each\n",
+           count, numValid, numSensor, (double)bytes / count);
+    printf("views:            %8.2f M messages/s, %8.1f MB/s\n",
+           count / viewTime / 1e6, bytes / viewTime / 1e6);
+    printf("views and decode: %8.2f M messages/s, %8.1f MB/s\n",
+           count / decodeTime / 1e6, bytes / decodeTime / 1e6);
+    printf("%u messages checked, %u failed\n", count, failed);
+
+    free(pViews);
+    free(pLens);
+    free(ppBufs);
+    free(pRec);
+
+    return ((failed != 0) ? 1 : 0);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Random number.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t benchRandom(uint32_t range)
+{
+    benchRandomState ^= benchRandomState << 13;
+    benchRandomState ^= benchRandomState >> 17;
+    benchRandomState ^= benchRandomState << 5;
+
+    return ((range != 0) ? (benchRandomState % range) : 0);
+}
+
+/*!
+ * @brief       Make a random message, mostly Sensor Data Messages.
+ *
+ * @param       pBuf - the message is put here
+ * @param       pMsg - what the message was made from
+ *
+ * @return      length of the message
+ */
+static uint16_t makeMsg(uint8_t *pBuf, benchMsg_t *pMsg)
+{
+    uint32_t kind = benchRandom(20);
+    uint16_t len;
+
+    memset(pMsg, 0, sizeof(benchMsg_t));
+    pMsg->valid = true;
+
+    if(kind < 16)
+    {
+        len = makeSensorMsg(pBuf, &pMsg->sensor);
+    }
+    else if(kind == 16)
+    {
+        Smsgs_configReqMsg_t *pReq = &pMsg->configReq;
+
+        pReq->cmdId = Smsgs_cmdIds_configReq;
+        pReq->frameControl = (uint16_t)(benchRandom(0x10000) & BENCH_FIELDS);
+        pReq->reportingInterval = benchRandom(3600000);
+        pReq->pollingInterval = benchRandom(60000);
+        pBuf[0] = (uint8_t)pReq->cmdId;
+        BENCH_PUT16(&pBuf[1], pReq->frameControl);
+        BENCH_PUT32(&pBuf[3], pReq->reportingInterval);
+        BENCH_PUT32(&pBuf[7], pReq->pollingInterval);
+        len = SMSGS_CONFIG_REQUEST_MSG_LENGTH;
+    }
+    else if(kind == 17)
+    {
+        Smsgs_configRspMsg_t *pRsp = &pMsg->configRsp;
+
+        pRsp->cmdId = Smsgs_cmdIds_configRsp;
+        pRsp->status = (Smsgs_statusValues_t)benchRandom(4);
+        pRsp->frameControl = (uint16_t)(benchRandom(0x10000) & BENCH_FIELDS);
+        pRsp->reportingInterval = benchRandom(3600000);
+        pRsp->pollingInterval = benchRandom(60000);
+        pBuf[0] = (uint8_t)pRsp->cmdId;
+        BENCH_PUT16(&pBuf[1], pRsp->status);
+        BENCH_PUT16(&pBuf[3], pRsp->frameControl);
+        BENCH_PUT32(&pBuf[5], pRsp->reportingInterval);
+        BENCH_PUT32(&pBuf[9], pRsp->pollingInterval);
+        len = SMSGS_CONFIG_RESPONSE_MSG_LENGTH;
+    }
+    else if(kind == 18)
+    {
+        pBuf[0] = Smsgs_cmdIds_trackingRsp;
+        len = SMSGS_TRACKING_RESPONSE_MSG_LENGTH;
+    }
+    else
+    {
+        uint16_t i;
+
+        pBuf[0] = Smsgs_cmdIds_fragment;
+        len = SMSGS_FRAGMENT_HDR_LEN + 1 +
+              (uint16_t)benchRandom(BENCH_MAX_MSG_LEN - SMSGS_FRAGMENT_HDR_LEN);
+        for(i = 1; i < len; i++)
+        {
+            pBuf[i] = (uint8_t)benchRandom(0x100);
+        }
+    }
+
+    if(benchRandom(BENCH_BAD_RATIO) == 0)
+    {
+        len = damageMsg(pBuf, len);
+        pMsg->valid = false;
+    }
+    pMsg->len = len;
+
+    return (len);
+}
+
+/*!
+ * @brief       Make a Sensor Data Message with random fields, encoded like
+ *              sensor.c does.
+ *
+ * @param       pBuf - the message is put here
+ * @param       pMsg - the fields are put here
+ *
+ * @return      length of the message
+ */
+static uint16_t makeSensorMsg(uint8_t *pBuf, Smsgs_sensorMsg_t *pMsg)
+{
+    uint8_t *p = pBuf;
+    uint8_t i;
+
+    pMsg->cmdId = Smsgs_cmdIds_sensorData;
+    for(i = 0; i < SMGS_SENSOR_EXTADDR_LEN; i++)
+    {
+        pMsg->extAddress[i] = (uint8_t)benchRandom(0x100);
+    }
+    pMsg->frameControl = (uint16_t)(benchRandom(0x10000) & BENCH_FIELDS);
+
+    *p++ = (uint8_t)pMsg->cmdId;
+    memcpy(p, pMsg->extAddress, SMGS_SENSOR_EXTADDR_LEN);
+    p += SMGS_SENSOR_EXTADDR_LEN;
+    BENCH_PUT16(p, pMsg->frameControl);
+    p += 2;
+
+    if(pMsg->frameControl & Smsgs_dataFields_tempSensor)
+    {
+        pMsg->tempSensor.ambienceTemp = (int16_t)benchRandom(0x10000);
+        pMsg->tempSensor.objectTemp = (int16_t)benchRandom(0x10000);
+        BENCH_PUT16(p, pMsg->tempSensor.ambienceTemp);
+        BENCH_PUT16(p + 2, pMsg->tempSensor.objectTemp);
+        p += SMSGS_SENSOR_TEMP_LEN;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_lightSensor)
+    {
+        pMsg->lightSensor.rawData = (uint16_t)benchRandom(0x10000);
+        BENCH_PUT16(p, pMsg->lightSensor.rawData);
+        p += SMSGS_SENSOR_LIGHT_LEN;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_humiditySensor)
+    {
+        pMsg->humiditySensor.temp = (uint16_t)benchRandom(0x10000);
+        pMsg->humiditySensor.humidity = (uint16_t)benchRandom(0x10000);
+        BENCH_PUT16(p, pMsg->humiditySensor.temp);
+        BENCH_PUT16(p + 2, pMsg->humiditySensor.humidity);
+        p += SMSGS_SENSOR_HUMIDITY_LEN;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_msgStats)
+    {
+        uint16_t *pStat = (uint16_t *)&pMsg->msgStats;
+
+        for(i = 0; i < (sizeof(Smsgs_msgStatsField_t) / 2); i++)
+        {
+            pStat[i] = (uint16_t)benchRandom(0x10000);
+            BENCH_PUT16(p, pStat[i]);
+            p += 2;
+        }
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_configSettings)
+    {
+        pMsg->configSettings.reportingInterval = benchRandom(3600000);
+        pMsg->configSettings.pollingInterval = benchRandom(60000);
+        BENCH_PUT32(p, pMsg->configSettings.reportingInterval);
+        BENCH_PUT32(p + 4, pMsg->configSettings.pollingInterval);
+        p += SMSGS_SENSOR_CONFIG_SETTINGS_LEN;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_bleSensor)
+    {
+        for(i = 0; i < B_ADDR_LEN; i++)
+        {
+            pMsg->bleSensor.bleAddr[i] = (uint8_t)benchRandom(0x100);
+        }
+        pMsg->bleSensor.manFacID = (uint16_t)benchRandom(0x10000);
+        pMsg->bleSensor.uuid = (uint16_t)benchRandom(0x10000);
+        pMsg->bleSensor.dataLength = (uint8_t)benchRandom(MAX_BLE_DATA_LEN + 1);
+        memcpy(p, pMsg->bleSensor.bleAddr, B_ADDR_LEN);
+        p += B_ADDR_LEN;
+        BENCH_PUT16(p, pMsg->bleSensor.manFacID);
+        BENCH_PUT16(p + 2, pMsg->bleSensor.uuid);
+        p += 4;
+        *p++ = pMsg->bleSensor.dataLength;
+        /* The characteristic value is sent last byte first */
+        for(i = pMsg->bleSensor.dataLength; i != 0; i--)
+        {
+            pMsg->bleSensor.data[i - 1] = (uint8_t)benchRandom(0x100);
+            *p++ = pMsg->bleSensor.data[i - 1];
+        }
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_latencyStats)
+    {
+        pMsg->latencyStats.count = (uint16_t)benchRandom(0x10000);
+        pMsg->latencyStats.p50 = (uint16_t)benchRandom(0x10000);
+        pMsg->latencyStats.p90 = (uint16_t)benchRandom(0x10000);
+        pMsg->latencyStats.p99 = (uint16_t)benchRandom(0x10000);
+        BENCH_PUT16(p, pMsg->latencyStats.count);
+        BENCH_PUT16(p + 2, pMsg->latencyStats.p50);
+        BENCH_PUT16(p + 4, pMsg->latencyStats.p90);
+        BENCH_PUT16(p + 6, pMsg->latencyStats.p99);
+        p += SMSGS_SENSOR_LATENCY_STATS_LEN;
+    }
+    if(pMsg->frameControl & Smsgs_dataFields_profStats)
+    {
+        pMsg->profStats.numEntries =
+            (uint8_t)benchRandom(SMSGS_PROF_MAX_ENTRIES + 1);
+        *p++ = pMsg->profStats.numEntries;
+        for(i = 0; i < pMsg->profStats.numEntries; i++)
+        {
+            pMsg->profStats.meanTime[i] = benchRandom(100000);
+            pMsg->profStats.maxTime[i] = benchRandom(1000000);
+            BENCH_PUT32(p, pMsg->profStats.meanTime[i]);
+            BENCH_PUT32(p + 4, pMsg->profStats.maxTime[i]);
+            p += SMSGS_SENSOR_PROF_ENTRY_LEN;
+        }
+    }
+
+    return ((uint16_t)(p - pBuf));
+}
+
+/*!
+ * @brief       Damage a message so that it is no longer valid.
+ *
+ * @param       pBuf - the message
+ * @param       len - length of the message
+ *
+ * @return      new length of the message
+ */
+static uint16_t damageMsg(uint8_t *pBuf, uint16_t len)
+{
+    switch(benchRandom(4))
+    {
+        case 0:
+            /* Cut short, a fragment needs more than its header */
+            if(pBuf[0] == Smsgs_cmdIds_fragment)
+            {
+                return (1 + (uint16_t)benchRandom(SMSGS_FRAGMENT_HDR_LEN));
+            }
+            return ((uint16_t)benchRandom(len));
+        case 1:
+            /* A byte too many, fragments have no fixed length */
+            if(pBuf[0] != Smsgs_cmdIds_fragment)
+            {
+                pBuf[len] = 0;
+                return (len + 1);
+            }
+            /* fall through */
+        case 2:
+            pBuf[0] = (uint8_t)(Smsgs_cmdIds_fragment + 1 + benchRandom(200));
+            return (len);
+        default:
+            /* A frame control bit the decoder doesn't know */
+            if(pBuf[0] == Smsgs_cmdIds_sensorData)
+            {
+                pBuf[1 + SMGS_SENSOR_EXTADDR_LEN + 1] |= 0x80;
+            }
+            else
+            {
+                pBuf[0] = 0;
+            }
+            return (len);
+    }
+}
+
+/*!
+ * @brief       Check the view and the decode of a recorded message.
+ *
+ * @param       pView - view of the message
+ * @param       pMsg - what the message was made from
+ *
+ * @return      true if the message decoded as made
+ */
+static bool checkMsg(const Smsgs_msgView_t *pView, const benchMsg_t *pMsg)
+{
+    Smsgs_sensorMsg_t sensor;
+    Smsgs_configReqMsg_t configReq;
+    Smsgs_configRspMsg_t configRsp;
+    const Smsgs_sensorMsg_t *pRef = &pMsg->sensor;
+
+    if((pView->status == Smsgs_decodeStatus_success) != pMsg->valid)
+    {
+        return (false);
+    }
+    if(!pMsg->valid)
+    {
+        return (true);
+    }
+
+    switch(pView->cmdId)
+    {
+        case Smsgs_cmdIds_sensorData:
+            /* Only the fields in the frame control are written */
+            memset(&sensor, 0, sizeof(sensor));
+            return (Smsgs_decodeSensorMsg(pView, &sensor)
+                    && (sensor.frameControl == pRef->frameControl)
+                    && !memcmp(sensor.extAddress, pRef->extAddress,
+                               SMGS_SENSOR_EXTADDR_LEN)
+                    && !memcmp(&sensor.tempSensor, &pRef->tempSensor,
+                               sizeof(sensor.tempSensor))
+                    && !memcmp(&sensor.lightSensor, &pRef->lightSensor,
+                               sizeof(sensor.lightSensor))
+                    && !memcmp(&sensor.humiditySensor, &pRef->humiditySensor,
+                               sizeof(sensor.humiditySensor))
+                    && !memcmp(&sensor.msgStats, &pRef->msgStats,
+                               sizeof(sensor.msgStats))
+                    && !memcmp(&sensor.configSettings, &pRef->configSettings,
+                               sizeof(sensor.configSettings))
+                    && !memcmp(&sensor.bleSensor, &pRef->bleSensor,
+                               sizeof(sensor.bleSensor))
+                    && !memcmp(&sensor.latencyStats, &pRef->latencyStats,
+                               sizeof(sensor.latencyStats))
+                    && !memcmp(&sensor.profStats, &pRef->profStats,
+                               sizeof(sensor.profStats)));
+        case Smsgs_cmdIds_configReq:
+            memset(&configReq, 0, sizeof(configReq));
+            return (Smsgs_decodeConfigReq(pView, &configReq)
+                    && !memcmp(&configReq, &pMsg->configReq,
+                               sizeof(configReq)));
+        case Smsgs_cmdIds_configRsp:
+            memset(&configRsp, 0, sizeof(configRsp));
+            return (Smsgs_decodeConfigRsp(pView, &configRsp)
+                    && !memcmp(&configRsp, &pMsg->configRsp,
+                               sizeof(configRsp)));
+        default:
+            return (true);
+    }
+}
+
+/*!
+ * @brief       Time the decode of the recording.
+ *
+ * @param       ppBufs - the messages
+ * @param       pLens - lengths of the messages
+ * @param       count - number of messages
+ * @param       pViews - count views
+ * @param       decode - also decode the valid Sensor Data Messages
+ * @param       runs - number of runs
+ * @param       pValid - number of valid messages is put here
+ *
+ * @return      seconds per recording, the best of the runs
+ */
+static double runTime(const uint8_t * const *ppBufs, const uint16_t *pLens,
+                      uint32_t count, Smsgs_msgView_t *pViews, bool decode,
+                      uint32_t runs, uint32_t *pValid)
+{
+    static volatile uint32_t sink;
+    Smsgs_sensorMsg_t sensor;
+    double best = 0;
+    uint32_t run;
+
+    for(run = 0; run < runs; run++)
+    {
+        struct timespec start;
+        struct timespec end;
+        uint32_t valid = 0;
+        uint32_t done;
+        uint32_t i;
+        double t;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        /* Batches of up to 65535, the count of Smsgs_decodeBatch() */
+        for(done = 0; done < count; done += 0xFFFF)
+        {
+            uint16_t n = ((count - done) < 0xFFFF) ?
+                         (uint16_t)(count - done) : 0xFFFF;
+
+            valid += Smsgs_decodeBatch(&ppBufs[done], &pLens[done], n,
+                                       &pViews[done]);
+            if(decode)
+            {
+                for(i = done; i < (done + n); i++)
+                {
+                    if(Smsgs_decodeSensorMsg(&pViews[i], &sensor))
+                    {
+                        sink += sensor.frameControl;
+                    }
+                }
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        t = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+        if((run == 0) || (t < best))
+        {
+            best = t;
+        }
+        *pValid = valid;
+    }
+
+    return (best);
+}
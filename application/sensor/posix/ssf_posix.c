@@ -0,0 +1,845 @@
+/******************************************************************************
+
+ @file ssf_posix.c
+
+ @brief Sensor Specific Functions of the host build of the sensor, see
+        posix/sensor_sim.c
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Stands in for ssf.c when the sensor application runs as a host process on
+the simulated kernel of sim_rtos.h. The application clocks are the same
+coalesced UtilTimer clocks as in ssf.c, and they set the same events. The
+NV items are kept in RAM, there are no buttons, and the LEDs only keep their
+state. Nothing is displayed, the simulation reports from the counts.
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include <ti/sysbios/knl/Semaphore.h>
+
+#include "util_timer.h"
+#include "mac_util.h"
+#include "api_mac.h"
+#include "jdllc.h"
+#include "osal_port.h"
+
+#include "sensor.h"
+#include "smsgs.h"
+#include "ssf.h"
+#include "ti_154stack_config.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Initial timeout value for the reading clock */
+#define READING_INIT_TIMEOUT_VALUE 100
+
+/* timeout value for trickle timer initialization */
+#define TRICKLE_TIMEOUT_VALUE       30000
+
+/* timeout value for poll timer initialization */
+#define POLL_TIMEOUT_VALUE          30000
+
+#define FH_ASSOC_TIMER              2000
+
+/* timeout value for poll timer initialization */
+#define SCAN_BACKOFF_TIMEOUT_VALUE  60000
+
+/* Clock slack, the same as ssf.c */
+#ifndef READING_CLOCK_SLACK
+#define READING_CLOCK_SLACK         1000
+#endif
+#ifndef TRICKLE_CLOCK_SLACK
+#define TRICKLE_CLOCK_SLACK         200
+#endif
+#ifndef POLL_CLOCK_SLACK
+#define POLL_CLOCK_SLACK            50
+#endif
+#ifndef SCAN_BACKOFF_CLOCK_SLACK
+#define SCAN_BACKOFF_CLOCK_SLACK    500
+#endif
+#ifndef FH_ASSOC_CLOCK_SLACK
+#define FH_ASSOC_CLOCK_SLACK        200
+#endif
+
+/*! Additional Random Delay for Association */
+#define ADD_ASSOCIATION_RANDOM_WINDOW 10000
+
+/* Frame counter save window, the same as ssf.c */
+#define FRAME_COUNTER_SAVE_WINDOW     25
+
+/* Network information, like the NV item of ssf.c */
+typedef struct
+{
+    ApiMac_deviceDescriptor_t device;
+    Llc_netInfo_t parent;
+} nvDeviceInfo_t;
+
+/******************************************************************************
+ Global variables
+ *****************************************************************************/
+
+/* Assert reason for the last reset */
+uint8_t Ssf_resetReseason = 0;
+
+/* Number of times the device has reset */
+uint16_t Ssf_resetCount = 0;
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/* The application's semaphore */
+static Semaphore_Handle sensorSem;
+
+/* Clock/timer resources */
+static Clock_Struct readingClkStruct;
+static Clock_Handle readingClkHandle;
+static Clock_Struct tricklePASClkStruct;
+static Clock_Handle tricklePASClkHandle;
+static Clock_Struct tricklePCSClkStruct;
+static Clock_Handle tricklePCSClkHandle;
+static Clock_Struct pollClkStruct;
+static Clock_Handle pollClkHandle;
+static Clock_Struct scanBackoffClkStruct;
+static Clock_Handle scanBackoffClkHandle;
+static Clock_Struct fhAssocClkStruct;
+static Clock_Handle fhAssocClkHandle;
+
+/* NV items kept in RAM */
+static nvDeviceInfo_t nvNetworkInfo;
+static bool nvNetworkInfoValid = false;
+static Ssf_configSettings_t nvConfigInfo;
+static bool nvConfigInfoValid = false;
+static uint32_t nvFrameCounter = 0;
+static bool nvFrameCounterValid = false;
+
+/* Last frame counter saved */
+static uint32_t lastSavedFrameCounter = 0;
+
+/* LED state */
+static bool led1State = false;
+
+/******************************************************************************
+ Local function prototypes
+ *****************************************************************************/
+static void processReadingTimeoutCallback(UArg a0);
+static void processPASTrickleTimeoutCallback(UArg a0);
+static void processPCSTrickleTimeoutCallback(UArg a0);
+static void processPollTimeoutCallback(UArg a0);
+static void processScanBackoffTimeoutCallback(UArg a0);
+static void processFHAssocTimeoutCallback(UArg a0);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ The application calls this function during initialization
+
+ Public function defined in ssf.h
+ */
+void Ssf_init(void *sem)
+{
+    /* Save off the semaphore */
+    sensorSem = sem;
+}
+
+/*!
+ The application must call this function periodically to
+ process any events that this module needs to process.
+
+ Public function defined in ssf.h
+ */
+void Ssf_processEvents(void)
+{
+}
+
+/*!
+ The application calls this function to indicate that the
+ Sensor's state has changed.
+
+ Public function defined in ssf.h
+ */
+void Ssf_stateChangeUpdate(Jdllc_states_t state)
+{
+    (void)state;
+}
+
+/*!
+ The application calls this function to indicate that it has
+ started or restored the device in a network.
+
+ Public function defined in ssf.h
+ */
+void Ssf_networkUpdate(bool rejoined,
+                       ApiMac_deviceDescriptor_t *pDevInfo,
+                       Llc_netInfo_t  *pParentInfo)
+{
+    (void)rejoined;
+
+    /* check for valid structure pointers, ignore if not */
+    if((pDevInfo != NULL) && (pParentInfo != NULL))
+    {
+        memcpy(&nvNetworkInfo.device, pDevInfo,
+               sizeof(ApiMac_deviceDescriptor_t));
+        memcpy(&nvNetworkInfo.parent, pParentInfo, sizeof(Llc_netInfo_t));
+        nvNetworkInfoValid = true;
+
+        led1State = true;
+    }
+}
+
+/*!
+ The application calls this function to get the device
+ information in a network.
+
+ Public function defined in ssf.h
+ */
+bool Ssf_getNetworkInfo(ApiMac_deviceDescriptor_t *pDevInfo,
+                        Llc_netInfo_t  *pParentInfo)
+{
+    if(nvNetworkInfoValid && (pDevInfo != NULL) && (pParentInfo != NULL))
+    {
+        memcpy(pDevInfo, &nvNetworkInfo.device,
+               sizeof(ApiMac_deviceDescriptor_t));
+        memcpy(pParentInfo, &nvNetworkInfo.parent, sizeof(Llc_netInfo_t));
+
+        return (true);
+    }
+    return (false);
+}
+
+/*!
+ The application calls this function to indicate a Configuration
+ Request message.
+
+ Public function defined in ssf.h
+ */
+void Ssf_configurationUpdate(Smsgs_configRspMsg_t *pRsp)
+{
+    if(pRsp != NULL)
+    {
+        nvConfigInfo.frameControl = pRsp->frameControl;
+        nvConfigInfo.reportingInterval = pRsp->reportingInterval;
+        nvConfigInfo.pollingInterval = pRsp->pollingInterval;
+        nvConfigInfoValid = true;
+    }
+}
+
+/*!
+ The application calls this function to get the saved device configuration.
+
+ Public function defined in ssf.h
+ */
+bool Ssf_getConfigInfo(Ssf_configSettings_t *pInfo)
+{
+    if(nvConfigInfoValid && (pInfo != NULL))
+    {
+        *pInfo = nvConfigInfo;
+        return (true);
+    }
+    return (false);
+}
+
+/*!
+ The application calls this function to indicate that a tracking message
+ was received.
+
+ Public function defined in ssf.h
+ */
+void Ssf_trackingUpdate(ApiMac_sAddr_t *pSrcAddr)
+{
+    (void)pSrcAddr;
+}
+
+/*!
+ The application calls this function to indicate sensor data.
+
+ Public function defined in ssf.h
+ */
+void Ssf_sensorReadingUpdate(Smsgs_sensorMsg_t *pMsg)
+{
+    (void)pMsg;
+}
+
+/*!
+ Initialize the reading clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializeReadingClock(void)
+{
+    /* Initialize the timers needed for this application */
+    readingClkHandle = UtilTimer_constructCoalesced(&readingClkStruct,
+                                        processReadingTimeoutCallback,
+                                        READING_INIT_TIMEOUT_VALUE,
+                                        READING_CLOCK_SLACK,
+                                        false,
+                                        0);
+}
+
+/*!
+ Set the reading clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setReadingClock(uint32_t readingTime)
+{
+    /* Stop the Reading timer */
+    if(UtilTimer_isActive(&readingClkStruct) == true)
+    {
+        UtilTimer_stop(&readingClkStruct);
+    }
+
+    /* Setup timer */
+    if(readingTime)
+    {
+        UtilTimer_setTimeout(readingClkHandle, readingTime);
+        UtilTimer_start(&readingClkStruct);
+    }
+}
+
+/*!
+ Ssf implementation for memory allocation
+
+ Public function defined in ssf.h
+ */
+void *Ssf_malloc(uint16_t size)
+{
+    return OsalPort_malloc(size);
+}
+
+/*!
+ Ssf implementation for memory de-allocation
+
+ Public function defined in ssf.h
+ */
+void Ssf_free(void *ptr)
+{
+    if(ptr != NULL)
+    {
+        OsalPort_free(ptr);
+    }
+}
+
+/*!
+ Initialize the trickle clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializeTrickleClock(void)
+{
+    /* Initialize trickle timer */
+    tricklePASClkHandle = UtilTimer_constructCoalesced(&tricklePASClkStruct,
+                                         processPASTrickleTimeoutCallback,
+                                         TRICKLE_TIMEOUT_VALUE,
+                                         TRICKLE_CLOCK_SLACK,
+                                         false,
+                                         0);
+
+    tricklePCSClkHandle = UtilTimer_constructCoalesced(&tricklePCSClkStruct,
+                                         processPCSTrickleTimeoutCallback,
+                                         TRICKLE_TIMEOUT_VALUE,
+                                         TRICKLE_CLOCK_SLACK,
+                                         false,
+                                         0);
+}
+
+/*!
+ Set the trickle clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setTrickleClock(uint16_t trickleTime, uint8_t frameType)
+{
+    uint16_t randomNum = 0;
+    Clock_Struct *pClkStruct;
+    Clock_Handle clkHandle;
+
+    if(frameType == ApiMac_wisunAsyncFrame_advertisementSolicit)
+    {
+        pClkStruct = &tricklePASClkStruct;
+        clkHandle = tricklePASClkHandle;
+    }
+    else if(frameType == ApiMac_wisunAsyncFrame_configSolicit)
+    {
+        pClkStruct = &tricklePCSClkStruct;
+        clkHandle = tricklePCSClkHandle;
+    }
+    else
+    {
+        return;
+    }
+
+    /* Stop the trickle timer */
+    if(UtilTimer_isActive(pClkStruct) == true)
+    {
+        UtilTimer_stop(pClkStruct);
+    }
+
+    if(trickleTime > 0)
+    {
+        /* Trickle Time has to be a value chosen random between [t/2, t] */
+        randomNum = ((ApiMac_randomByte() << 8) + ApiMac_randomByte());
+        trickleTime = (trickleTime >> 1) +
+                      (randomNum % (trickleTime >> 1));
+        /* Setup timer */
+        UtilTimer_setTimeout(clkHandle, trickleTime);
+        UtilTimer_start(pClkStruct);
+    }
+}
+
+/*!
+ Initialize the poll clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializePollClock(void)
+{
+    /* Initialize the timers needed for this application */
+    pollClkHandle = UtilTimer_constructCoalesced(&pollClkStruct,
+                                     processPollTimeoutCallback,
+                                     POLL_TIMEOUT_VALUE,
+                                     POLL_CLOCK_SLACK,
+                                     false,
+                                     0);
+}
+
+/*!
+ Set the poll clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setPollClock(uint32_t pollTime)
+{
+    /* Stop the poll timer */
+    if(UtilTimer_isActive(&pollClkStruct) == true)
+    {
+        UtilTimer_stop(&pollClkStruct);
+    }
+
+    /* Setup timer */
+    if(pollTime > 0)
+    {
+        UtilTimer_setTimeout(pollClkHandle, pollTime);
+        UtilTimer_start(&pollClkStruct);
+    }
+}
+
+/*!
+ Get the poll clock.
+
+ Public function defined in ssf.h
+ */
+uint32_t Ssf_getPollClock(void)
+{
+    return UtilTimer_getTimeout(pollClkHandle);
+}
+
+/*!
+ Initialize the scan backoff clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializeScanBackoffClock(void)
+{
+    /* Initialize the timers needed for this application */
+    scanBackoffClkHandle = UtilTimer_constructCoalesced(&scanBackoffClkStruct,
+                                           processScanBackoffTimeoutCallback,
+                                           SCAN_BACKOFF_TIMEOUT_VALUE,
+                                           SCAN_BACKOFF_CLOCK_SLACK,
+                                           false,
+                                           0);
+}
+
+/*!
+ Set the scan backoff clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setScanBackoffClock(uint32_t scanBackoffTime)
+{
+    /* Stop the scan backoff timer */
+    Ssf_stopScanBackoffClock();
+
+    /* Setup timer */
+    if(scanBackoffTime > 0)
+    {
+        UtilTimer_setTimeout(scanBackoffClkHandle, scanBackoffTime);
+        UtilTimer_start(&scanBackoffClkStruct);
+    }
+}
+
+/*!
+ Stop the scan backoff clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_stopScanBackoffClock(void)
+{
+    if(UtilTimer_isActive(&scanBackoffClkStruct) == true)
+    {
+        UtilTimer_stop(&scanBackoffClkStruct);
+    }
+}
+
+/*!
+ Initialize the FH Association delay clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_initializeFHAssocClock(void)
+{
+    /* Initialize the timers needed for this application */
+    fhAssocClkHandle = UtilTimer_constructCoalesced(&fhAssocClkStruct,
+                                       processFHAssocTimeoutCallback,
+                                       FH_ASSOC_TIMER,
+                                       FH_ASSOC_CLOCK_SLACK,
+                                       false,
+                                       0);
+}
+
+/*!
+ Set the FH Association delay clock.
+
+ Public function defined in ssf.h
+ */
+void Ssf_setFHAssocClock(uint32_t fhAssocTime)
+{
+    /* Stop the FH association timer */
+    if(UtilTimer_isActive(&fhAssocClkStruct) == true)
+    {
+        UtilTimer_stop(&fhAssocClkStruct);
+    }
+
+    /* Setup timer */
+    if(fhAssocTime)
+    {
+        if(!CERTIFICATION_TEST_MODE)
+        {
+            /* Adding an additional random delay */
+            fhAssocTime = fhAssocTime + (((ApiMac_randomByte() << 8) +
+                          ApiMac_randomByte()) % ADD_ASSOCIATION_RANDOM_WINDOW);
+        }
+        UtilTimer_setTimeout(fhAssocClkHandle, fhAssocTime);
+        UtilTimer_start(&fhAssocClkStruct);
+    }
+}
+
+/*!
+ Update the Frame Counter
+
+ Public function defined in ssf.h
+ */
+void Ssf_updateFrameCounter(ApiMac_sAddr_t *pDevAddr, uint32_t frameCntr)
+{
+    if((pDevAddr == NULL) && (frameCntr >=
+          (lastSavedFrameCounter + FRAME_COUNTER_SAVE_WINDOW)))
+    {
+        nvFrameCounter = frameCntr;
+        nvFrameCounterValid = true;
+        lastSavedFrameCounter = frameCntr;
+    }
+}
+
+/*!
+ Get the Frame Counter
+
+ Public function defined in ssf.h
+ */
+bool Ssf_getFrameCounter(ApiMac_sAddr_t *pDevAddr, uint32_t *pFrameCntr)
+{
+    /* Check for valid pointer */
+    if(pFrameCntr != NULL)
+    {
+        if((pDevAddr == NULL) && nvFrameCounterValid)
+        {
+            /* Set to the next window */
+            *pFrameCntr = nvFrameCounter + FRAME_COUNTER_SAVE_WINDOW;
+            return (true);
+        }
+
+        *pFrameCntr = 0;
+    }
+    return (false);
+}
+
+/*!
+ Display Error
+
+ Public function defined in ssf.h
+ */
+void Ssf_displayError(const char *pTxt, uint8_t code)
+{
+    (void)pTxt;
+    (void)code;
+}
+
+/*!
+ Assert Indication
+
+ Public function defined in ssf.h
+ */
+void Ssf_assertInd(uint8_t reason)
+{
+    Ssf_resetReseason = reason;
+}
+
+/*!
+ Reset the device
+
+ Public function defined in ssf.h
+ */
+void Ssf_systemReset(void)
+{
+    /* There is no device to reset, the simulation ends */
+    exit(1);
+}
+
+/*!
+ Clear network information in NV
+
+ Public function defined in ssf.h
+ */
+void Ssf_clearNetworkInfo(void)
+{
+    nvNetworkInfoValid = false;
+}
+
+/*!
+ Clear all the NV Items
+
+ Public function defined in ssf.h
+ */
+void Ssf_clearAllNVItems(void)
+{
+    Ssf_clearNetworkInfo();
+    nvConfigInfoValid = false;
+    nvFrameCounterValid = false;
+}
+
+/*!
+ Move some NV items ahead of the next compaction, nothing to move in RAM
+
+ Public function defined in ssf.h
+ */
+bool Ssf_compactNvStep(void)
+{
+    return (false);
+}
+
+/*!
+ Read the on-board temperature sensors
+
+ Public function defined in ssf.h
+ */
+int16_t Ssf_readTempSensor(void)
+{
+    return (25);
+}
+
+/*!
+ The application calls this function to toggle an LED.
+
+ Public function defined in ssf.h
+ */
+bool Ssf_toggleLED(void)
+{
+    led1State = !led1State;
+    return (led1State);
+}
+
+/*!
+ The application calls this function to switch on LED.
+
+ Public function defined in ssf.h
+ */
+bool Ssf_turnOnLED(void)
+{
+    led1State = true;
+    return (led1State);
+}
+
+/*!
+ The application calls this function to switch off LED.
+
+ Public function defined in ssf.h
+ */
+bool Ssf_turnOffLED(void)
+{
+    led1State = false;
+    return (led1State);
+}
+
+/*!
+ The application calls this function to switch on LED.
+
+ Public function defined in ssf.h
+ */
+void Ssf_OnLED(void)
+{
+    led1State = true;
+}
+
+/*!
+ The application calls this function to switch off LED.
+
+ Public function defined in ssf.h
+ */
+void Ssf_OffLED(void)
+{
+    led1State = false;
+}
+
+/*!
+ A callback calls this function to post the application task semaphore.
+
+ Public function defined in ssf.h
+ */
+void Ssf_PostAppSem(void)
+{
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Reading timeout handler function.
+ *
+ * @param   a0 - ignored
+ */
+static void processReadingTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Sensor_events, SENSOR_READING_TIMEOUT_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief       Trickle timeout handler function for PA .
+ *
+ * @param       a0 - ignored
+ */
+static void processPASTrickleTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Jdllc_events, JDLLC_PAS_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief       Trickle timeout handler function for PC.
+ *
+ * @param       a0 - ignored
+ */
+static void processPCSTrickleTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Jdllc_events, JDLLC_PCS_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief       Poll timeout handler function  .
+ *
+ * @param       a0 - ignored
+ */
+static void processPollTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Jdllc_events, JDLLC_POLL_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief       Scan backoff timeout handler function  .
+ *
+ * @param       a0 - ignored
+ */
+static void processScanBackoffTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Jdllc_events, JDLLC_SCAN_BACKOFF);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief       FH Assoc Delay timeout handler function  .
+ *
+ * @param       a0 - ignored
+ */
+static void processFHAssocTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    Util_setEvent(&Jdllc_events, JDLLC_ASSOCIATE_REQ_EVT);
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
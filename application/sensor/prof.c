@@ -0,0 +1,191 @@
+/******************************************************************************
+
+ @file prof.c
+
+ @brief Sensor application handler profiling
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+#ifdef FEATURE_PROFILING
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <string.h>
+#include <stdint.h>
+
+#include <ti/devices/DeviceFamily.h>
+#include DeviceFamily_constructPath(inc/hw_types.h)
+#include DeviceFamily_constructPath(inc/hw_memmap.h)
+#include DeviceFamily_constructPath(inc/hw_cpu_dwt.h)
+#include DeviceFamily_constructPath(inc/hw_cpu_scs.h)
+
+#include "prof.h"
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/* Statistics of each handler */
+static Prof_stats_t profStats[Prof_id_max];
+
+/* Name of each handler */
+static const char *profNames[Prof_id_max] =
+{
+    "readSensors",
+    "sensorMsg",
+    "Jdllc",
+    "Ssf",
+    "Lpstk",
+    "MAC",
+    "dataCnf",
+    "dataInd"
+};
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Enable the cycle counter and clear the statistics.
+
+ Public function defined in prof.h
+ */
+void Prof_init(void)
+{
+    uint8_t i;
+
+    memset(profStats, 0, sizeof(profStats));
+    for(i = 0; i < Prof_id_max; i++)
+    {
+        profStats[i].minCycles = 0xFFFFFFFF;
+    }
+
+    /* Enable the trace block, then the DWT cycle counter */
+    HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) = 0;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+}
+
+/*!
+ Start measuring a call.
+
+ Public function defined in prof.h
+ */
+uint32_t Prof_start(void)
+{
+    return (HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT));
+}
+
+/*!
+ Stop measuring a call and add it to the statistics.
+
+ Public function defined in prof.h
+ */
+void Prof_stop(Prof_id_t id, uint32_t start)
+{
+    /* Unsigned arithmetic takes care of the counter wrapping */
+    uint32_t cycles = HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) - start;
+    Prof_stats_t *pStats = &profStats[id];
+
+    pStats->count++;
+    pStats->totalCycles += cycles;
+    if(cycles < pStats->minCycles)
+    {
+        pStats->minCycles = cycles;
+    }
+    if(cycles > pStats->maxCycles)
+    {
+        pStats->maxCycles = cycles;
+    }
+}
+
+/*!
+ Get the statistics of a handler.
+
+ Public function defined in prof.h
+ */
+void Prof_getStats(Prof_id_t id, Prof_stats_t *pStats)
+{
+    memcpy(pStats, &profStats[id], sizeof(Prof_stats_t));
+    if(pStats->count == 0)
+    {
+        pStats->minCycles = 0;
+    }
+}
+
+/*!
+ Get the name of a handler.
+
+ Public function defined in prof.h
+ */
+const char *Prof_getName(Prof_id_t id)
+{
+    return (profNames[id]);
+}
+
+/*!
+ Fill in the profiling field of the sensor data message.
+
+ Public function defined in prof.h
+ */
+void Prof_getField(Smsgs_profStatsField_t *pField)
+{
+    uint8_t i;
+
+    memset(pField, 0, sizeof(Smsgs_profStatsField_t));
+    pField->numEntries = (Prof_id_max < SMSGS_PROF_MAX_ENTRIES) ?
+                    Prof_id_max : SMSGS_PROF_MAX_ENTRIES;
+
+    for(i = 0; i < pField->numEntries; i++)
+    {
+        Prof_stats_t *pStats = &profStats[i];
+
+        if(pStats->count != 0)
+        {
+            pField->meanTime[i] = (uint32_t)(pStats->totalCycles
+                                             / pStats->count) / PROF_CPU_MHZ;
+        }
+        pField->maxTime[i] = pStats->maxCycles / PROF_CPU_MHZ;
+    }
+}
+
+#endif /* FEATURE_PROFILING */
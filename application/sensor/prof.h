@@ -0,0 +1,192 @@
+/******************************************************************************
+
+ @file prof.h
+
+ @brief Sensor application handler profiling
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef PROF_H
+#define PROF_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smsgs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup Prof Sensor Handler Profiling
+ <BR>
+ Measures the CPU cycles spent in the event loop handlers and the MAC
+ callbacks with the Cortex-M DWT cycle counter, and keeps the minimum,
+ maximum, mean and count of each one.
+ <BR>
+ Everything is compiled out unless FEATURE_PROFILING is defined, PROF_RUN()
+ then just makes the call.
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+#ifdef FEATURE_PROFILING
+
+/*! CPU clock, used to convert cycles to microseconds */
+#ifndef PROF_CPU_MHZ
+#define PROF_CPU_MHZ 48
+#endif
+
+/*! Profiled handlers */
+typedef enum
+{
+    /*! readSensors() */
+    Prof_id_readSensors = 0,
+    /*! processSensorMsgEvt() */
+    Prof_id_sensorMsg = 1,
+    /*! Jdllc_process() */
+    Prof_id_jdllcProcess = 2,
+    /*! Ssf_processEvents() */
+    Prof_id_ssfProcess = 3,
+    /*! Lpstk_processEvents() */
+    Prof_id_lpstkProcess = 4,
+    /*! ApiMac_processPending() */
+    Prof_id_macPending = 5,
+    /*! MAC data confirm callback */
+    Prof_id_dataCnf = 6,
+    /*! MAC data indication callback */
+    Prof_id_dataInd = 7,
+    /*! Number of profiled handlers */
+    Prof_id_max = 8
+} Prof_id_t;
+
+/*! Profiling statistics of a handler */
+typedef struct
+{
+    /*! Number of calls */
+    uint32_t count;
+    /*! Fewest cycles of a call */
+    uint32_t minCycles;
+    /*! Most cycles of a call */
+    uint32_t maxCycles;
+    /*! Total cycles of all the calls */
+    uint64_t totalCycles;
+} Prof_stats_t;
+
+/*! Run a call and add its cycles to the statistics of a handler */
+#define PROF_RUN(id, call) \
+    do \
+    { \
+        uint32_t profStart = Prof_start(); \
+        call; \
+        Prof_stop((id), profStart); \
+    } while(0)
+
+#else
+
+#define PROF_RUN(id, call) call
+
+#endif /* FEATURE_PROFILING */
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+#ifdef FEATURE_PROFILING
+
+/*!
+ * @brief       Enable the cycle counter and clear the statistics.
+ */
+extern void Prof_init(void);
+
+/*!
+ * @brief       Start measuring a call.
+ *
+ * @return      current cycle count, to pass to Prof_stop()
+ */
+extern uint32_t Prof_start(void);
+
+/*!
+ * @brief       Stop measuring a call and add it to the statistics.
+ *
+ * @param       id - profiled handler
+ * @param       start - value returned by Prof_start()
+ */
+extern void Prof_stop(Prof_id_t id, uint32_t start);
+
+/*!
+ * @brief       Get the statistics of a handler.
+ *
+ * @param       id - profiled handler
+ * @param       pStats - place to put the statistics
+ */
+extern void Prof_getStats(Prof_id_t id, Prof_stats_t *pStats);
+
+/*!
+ * @brief       Get the name of a handler, for display.
+ *
+ * @param       id - profiled handler
+ *
+ * @return      name of the handler
+ */
+extern const char *Prof_getName(Prof_id_t id);
+
+/*!
+ * @brief       Fill in the profiling field of the sensor data message.
+ *
+ * @param       pField - field to fill in
+ */
+extern void Prof_getField(Smsgs_profStatsField_t *pField);
+
+#endif /* FEATURE_PROFILING */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROF_H */
@@ -52,6 +52,7 @@
 #include <unistd.h>
 #include <stddef.h>
 #include "mac_util.h"
+#include "util_sched.h"
 #include "api_mac.h"
 #include "jdllc.h"
 #include "ssf.h"
@@ -66,6 +67,12 @@
 #include "oad_client.h"
 #endif /* FEATURE_NATIVE_OAD */
 
+#ifdef FEATURE_FRAGMENTATION
+#include "frag.h"
+#endif /* FEATURE_FRAGMENTATION */
+
+#include "prof.h"
+
 #ifdef OSAL_PORT2TIRTOS
 #include <ti/sysbios/knl/Clock.h>
 #else
@@ -131,6 +138,25 @@
 /* App config response marker for the MSDU handle */
 #define APP_CONFIGRSP_MSDU_HANDLE 0x60
 
+/*
+ Number of latency histogram buckets. Bucket 0 holds latencies under 1 ms,
+ bucket n holds 2^(n-1) to 2^n - 1 ms and the last bucket everything above.
+ */
+#define LATENCY_NUM_BUCKETS 16
+
+/* Current tick count */
+#ifdef OSAL_PORT2TIRTOS
+#define SENSOR_GET_TICKS() Clock_getTicks()
+#else
+#define SENSOR_GET_TICKS() ICall_getTicks()
+#endif
+
+/* Sensor event priorities, lower values run first */
+#define SENSOR_PRIORITY_NETWORK 0
+#define SENSOR_PRIORITY_JOIN 1
+#define SENSOR_PRIORITY_REPORT 2
+#define SENSOR_PRIORITY_DISPLAY 3
+
 /* Reporting Interval Min and Max (in milliseconds) */
 #define MIN_REPORTING_INTERVAL 1000
 #define MAX_REPORTING_INTERVAL 3600000
@@ -207,8 +233,20 @@ static ApiMac_sAddr_t collectorAddr = {0};
 /* Join Time Ticks (used for average join time calculations) */
 static uint_fast32_t joinTimeTicks = 0;
 
-/* End to end delay statistics timestamp */
-static uint32_t startSensorMsgTimeStamp = 0;
+/* End to end delay statistics timestamps, indexed by MSDU handle counter */
+static uint32_t msduTimeStamp[MSDU_HANDLE_MAX + 1] = {0};
+
+#ifdef FEATURE_FRAGMENTATION
+/* Timestamp of the first fragment of the fragmented message being sent,
+   its MSDU handle can be reused before the last fragment is confirmed */
+static uint32_t fragTimeStamp = 0;
+#endif /* FEATURE_FRAGMENTATION */
+
+/* Request to data confirm latency histograms, indexed by message type */
+static uint16_t latencyHist[Sensor_latencyType_max][LATENCY_NUM_BUCKETS];
+
+/* Number of messages in each latency histogram */
+static uint16_t latencyCount[Sensor_latencyType_max];
 
 /*! Device's Outgoing MSDU Handle values */
 STATIC uint8_t deviceTxMsduHandle = 0;
@@ -285,9 +323,38 @@ Llc_netInfo_t cachedparentInfo = {0};
  Local function prototypes
  *****************************************************************************/
 static void initializeClocks(void);
+static void initializeScheduler(void);
+static void processStartEvt(void);
+static void processReadingTimeoutEvt(void);
+#ifdef DISPLAY_PER_STATS
+static void processUpdateStatsEvt(void);
+#endif /* DISPLAY_PER_STATS */
+#if (USE_DMM) && !(DMM_CENTRAL)
+static void processProvEvt(void);
+#endif /* USE_DMM && !(DMM_CENTRAL) */
+static void processDisassocEvt(void);
+#ifdef DMM_OAD
+static void processPauseEvt(void);
+static void processResumeEvt(void);
+#endif /* DMM_OAD */
 static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf);
 static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd);
+#ifdef FEATURE_PROFILING
+static void profDataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf);
+static void profDataIndCB(ApiMac_mcpsDataInd_t *pDataInd);
+#endif /* FEATURE_PROFILING */
 static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType);
+static uint32_t getE2EDelay(uint8_t msduHandle);
+static void recordLatency(Sensor_latencyType_t type, uint32_t delay);
+static bool sendDataReq(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
+                        bool rxOnIdle, uint16_t len, uint8_t *pData,
+                        uint8_t *pMsduHandle);
+
+#ifdef FEATURE_FRAGMENTATION
+static bool fragSendCb(ApiMac_sAddr_t *pDstAddr, bool rxOnIdle,
+                       uint16_t len, uint8_t *pData, uint8_t *pMsduHandle);
+static void fragTxDoneCb(Smsgs_cmdIds_t cmdId, bool success);
+#endif /* FEATURE_FRAGMENTATION */
 
 #if !defined(OAD_IMG_A) && !defined(POWER_MEAS)
 static void processSensorMsgEvt(void);
@@ -388,10 +455,17 @@ STATIC ApiMac_callbacks_t Sensor_macCallbacks =
       NULL,
       /*! Poll Indication Callback */
       NULL,
+#ifdef FEATURE_PROFILING
+      /*! Data Confirmation callback */
+      profDataCnfCB,
+      /*! Data Indication callback */
+      profDataIndCB,
+#else
       /*! Data Confirmation callback */
       dataCnfCB,
       /*! Data Indication callback */
       dataIndCB,
+#endif /* FEATURE_PROFILING */
       /*! Purge Confirm callback */
       NULL,
       /*! WiSUN Async Indication callback */
@@ -413,6 +487,18 @@ STATIC Jdllc_callbacks_t jdllcCallbacks =
       /*! State Changed indication callback */
       jdllcStateChangeCb
     };
+#ifdef FEATURE_FRAGMENTATION
+STATIC Frag_callbacks_t fragCallbacks =
+    {
+      /*! Send a fragment */
+      fragSendCb,
+      /*! Fragmented message transmit done */
+      fragTxDoneCb,
+      /*! Fragmented message received */
+      dataIndCB
+    };
+#endif /* FEATURE_FRAGMENTATION */
+
 #ifdef FEATURE_SECURE_COMMISSIONING
 STATIC SM_callbacks_t SMCallbacks =
     {
@@ -532,6 +618,19 @@ void Sensor_init(void)
     /* Register the MAC Callbacks */
     ApiMac_registerCallbacks(&Sensor_macCallbacks);
 
+    /* Register the sensor event handlers */
+    initializeScheduler();
+
+#ifdef FEATURE_PROFILING
+    /* Start the handler profiling */
+    Prof_init();
+#endif /* FEATURE_PROFILING */
+
+#ifdef FEATURE_FRAGMENTATION
+    /* Initialize the message fragmentation */
+    Frag_init(&fragCallbacks);
+#endif /* FEATURE_FRAGMENTATION */
+
     /* Initialize the platform specific functions */
     Ssf_init(sem);
 
@@ -655,145 +754,8 @@ void Sensor_init(void)
  */
 void Sensor_process(void)
 {
-    /* Start the collector device in the network */
-    if(Sensor_events & SENSOR_START_EVT)
-    {
-        ApiMac_deviceDescriptor_t devInfo;
-        Llc_netInfo_t parentInfo;
-#ifdef USE_DMM
-        uint32_t frameCounter = 0;
-
-        /* update policy */
-        DMMPolicy_updateApplicationState(DMMPolicy_StackRole_154Sensor, DMMPOLICY_154_PROVISIONING);
-
-        Sensor_securityInit(frameCounter);
-#endif /* USE_DMM */
-
-        if(Ssf_getNetworkInfo(&devInfo, &parentInfo) == true)
-        {
-            rejoining = true;
-
-            Ssf_configSettings_t configInfo;
-#ifdef FEATURE_MAC_SECURITY
-            ApiMac_status_t stat;
-#endif /* FEATURE_MAC_SECURITY */
-
-            /* Do we have config settings? */
-            if(Ssf_getConfigInfo(&configInfo) == true)
-            {
-                /* Save the config information */
-                configSettings.frameControl = configInfo.frameControl;
-                configSettings.reportingInterval = configInfo.reportingInterval;
-                configSettings.pollingInterval = configInfo.pollingInterval;
-
-                /* Update the polling interval in the LLC */
-                Jdllc_setPollRate(configSettings.pollingInterval);
-            }
-
-            /* Initially, setup the parent as the collector */
-            if(parentInfo.fh == true && CONFIG_RX_ON_IDLE)
-            {
-                collectorAddr.addrMode = ApiMac_addrType_extended;
-                memcpy(&collectorAddr.addr.extAddr,
-                       parentInfo.devInfo.extAddress, APIMAC_SADDR_EXT_LEN);
-            }
-            else
-            {
-                collectorAddr.addrMode = ApiMac_addrType_short;
-                collectorAddr.addr.shortAddr = parentInfo.devInfo.shortAddress;
-            }
-
-#ifdef FEATURE_MAC_SECURITY
-            /* Put the parent in the security device list */
-            stat = Jdllc_addSecDevice(parentInfo.devInfo.panID,
-                                      parentInfo.devInfo.shortAddress,
-                                      &parentInfo.devInfo.extAddress, 0);
-            if(stat != ApiMac_status_success)
-            {
-                Ssf_displayError("Auth Error: 0x", (uint8_t)stat);
-            }
-#endif /* FEATURE_MAC_SECURITY */
-
-#ifdef FEATURE_SECURE_COMMISSIONING
-            if(!CONFIG_FH_ENABLE)
-            {
-                nvDeviceKeyInfo_t devKeyInfo;
-                if(Ssf_getDeviceKeyInfo(&devKeyInfo) == TRUE)
-                {
-                    SM_recoverKeyInfo(devInfo, parentInfo, devKeyInfo);
-#ifdef USE_DMM
-                    RemoteDisplay_updateSmState(SMCOMMISSIONSTATE_SUCCESS);
-#endif /* USE_DMM */
-                }
-
-            }
-#endif /* FEATURE_SECURE_COMMISSIONING */
-            Jdllc_rejoin(&devInfo, &parentInfo);
-        }
-        else
-        {
-            /* Reset flag when joining a new network */
-            rejoining = false;
-
-            /* Get Start Timestamp */
-#ifdef OSAL_PORT2TIRTOS
-            joinTimeTicks = Clock_getTicks();
-#else
-            joinTimeTicks = ICall_getTicks();
-#endif
-            Jdllc_join();
-        }
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_START_EVT);
-    }
-
-
-    /* Is it time to send the next sensor data message? */
-    if(Sensor_events & SENSOR_READING_TIMEOUT_EVT)
-    {
-
-#if !defined(OAD_IMG_A)
-
-        /* In certification test mode, back to back data shall be sent */
-        if(!CERTIFICATION_TEST_MODE)
-        {
-            /* Setup for the next message */
-            Ssf_setReadingClock(configSettings.reportingInterval);
-        }
-
-#ifdef FEATURE_SECURE_COMMISSIONING
-        /* if secure Commissioning feature is enabled, read
-         * sensor data and send it only after the secure
-         * commissioning process is done successfully.
-         * else, do not read and send sensor data.
-         */
-        if(SM_Current_State != SM_CM_InProgress)
-        {
-#endif /* FEATURE_SECURE_COMMISSIONING */
-
-
-#if SENSOR_TEST_RAMP_DATA_SIZE && (CERTIFICATION_TEST_MODE || defined(POWER_MEAS))
-        processSensorRampMsgEvt();
-#endif /* SENSOR_TEST_RAMP_DATA_SIZE */
-
-#if !defined(POWER_MEAS)
-        /* Read sensors */
-        readSensors();
-
-        /* Process Sensor Reading Message Event */
-        processSensorMsgEvt();
-#endif /* POWER_MEAS */
-
-#ifdef FEATURE_SECURE_COMMISSIONING
-        }
-#endif /* FEATURE_SECURE_COMMISSIONING */
-
-#endif //OAD_IMG_A
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_READING_TIMEOUT_EVT);
-    }
+    /* Run the highest priority application event */
+    UtilSched_run();
 
 #if defined(OAD_IMG_A)
     if(Sensor_events & SENSOR_OAD_SEND_RESET_RSP_EVT)
@@ -802,88 +764,25 @@ void Sensor_process(void)
     }
 #endif //OAD_IMG_A
 
-#ifdef DISPLAY_PER_STATS
-    /* Is it time to update the PER display? */
-    if(Sensor_events & SENSOR_UPDATE_STATS_EVT)
-    {
-        Ssf_displayPerStats(&Sensor_msgStats);
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_UPDATE_STATS_EVT);
-   }
-#endif /* DISPLAY_PER_STATS */
 #ifdef LPSTK
     /* Process Launchpad Sensortag specific events */
-    Lpstk_processEvents();
+    PROF_RUN(Prof_id_lpstkProcess, Lpstk_processEvents());
 #endif /* LPSTK */
-#if (USE_DMM) && !(DMM_CENTRAL)
-    /* Is it provision start event? */
-    if(Sensor_events & SENSOR_PROV_EVT)
-    {
-        /* update policy */
-        DMMPolicy_updateApplicationState(DMMPolicy_StackRole_154Sensor, DMMPOLICY_154_PROVISIONING);
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_PROV_EVT);
-    }
-#endif /* USE_DMM && !(DMM_CENTRAL) */
-
-    /* Is it disassociate event? */
-    if(Sensor_events & SENSOR_DISASSOC_EVT)
-    {
-        Jdllc_sendDisassociationRequest();
-
-#ifdef USE_DMM
-#ifdef FEATURE_SECURE_COMMISSIONING
-        RemoteDisplay_updateSmState(SMCOMMISSIONSTATE_IDLE);
-#endif /* FEATURE_SECURE_COMMISSIONING */
-#endif /* USE_DMM */
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_DISASSOC_EVT);
-    }
-
-#ifdef DMM_OAD
-    if(Sensor_events & SENSOR_PAUSE_EVT)
-    {
-        /* Turn off timers to temporarily stop transmissions */
-        Ssf_setPollClock(0);
-        Ssf_setReadingClock(0);
-        if(CONFIG_FH_ENABLE)
-        {
-            Ssf_setTrickleClock(0, ApiMac_wisunAsyncFrame_advertisementSolicit);
-            Ssf_setTrickleClock(0, ApiMac_wisunAsyncFrame_configSolicit);
-        }
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_PAUSE_EVT);
-    }
-    if(Sensor_events & SENSOR_RESUME_EVT)
-    {
-        /* Call SENSOR_START_EVT to re-associate with collector if BLE-OAD fails */
-        Util_setEvent(&Sensor_events, SENSOR_START_EVT);
-
-        /* Wake up the application thread when it waits for clock event */
-        Ssf_PostAppSem();
-
-        /* Clear the event */
-        Util_clearEvent(&Sensor_events, SENSOR_RESUME_EVT);
-    }
-#endif /* DMM_OAD */
 
     /* Process LLC Events */
-    Jdllc_process();
+    PROF_RUN(Prof_id_jdllcProcess, Jdllc_process());
 
     /* Allow the Specific functions to process */
-    Ssf_processEvents();
+    PROF_RUN(Prof_id_ssfProcess, Ssf_processEvents());
 
 #ifdef FEATURE_SECURE_COMMISSIONING
     /* Allow the security manager specific functions to process */
     SM_process();
 #endif /* FEATURE_SECURE_COMMISSIONING */
     /*
-     Don't process ApiMac messages until all of the sensor events
-     are processed.
+     Don't wait for ApiMac messages while there are sensor events to
+     process, but process one between two sensor events so that a burst of
+     events can't starve the MAC indications.
      */
 #ifdef FEATURE_SECURE_COMMISSIONING
     /*only if there are no sensor events and security manager events to handle*/
@@ -892,9 +791,16 @@ void Sensor_process(void)
     if(Sensor_events == 0)
 #endif /* FEATURE_SECURE_COMMISSIONING */
     {
-        /* Wait for response message or events */
+        /* Use the idle time for NV compaction, then wait for response
+           message or events, the next step wakes the application up */
+        (void)Ssf_compactNvStep();
         ApiMac_processIncoming();
     }
+    else
+    {
+        /* Process a waiting response message, if any */
+        PROF_RUN(Prof_id_macPending, ApiMac_processPending());
+    }
 }
 
 /*!
@@ -912,141 +818,373 @@ bool Sensor_sendMsg(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
                     bool rxOnIdle, uint16_t len, uint8_t *pData)
 {
     bool ret = false;
-    /* information about the network */
-    ApiMac_mcpsDataReq_t dataReq;
-
-    /* Timestamp to compute end to end delay */
-#ifdef OSAL_PORT2TIRTOS
-    startSensorMsgTimeStamp = Clock_getTicks();
-#else
-    startSensorMsgTimeStamp = ICall_getTicks();
-#endif
 
-    /* Construct the data request field */
-    memset(&dataReq, 0, sizeof(ApiMac_mcpsDataReq_t));
-    memcpy(&dataReq.dstAddr, pDstAddr, sizeof(ApiMac_sAddr_t));
+    if(type == Smsgs_cmdIds_sensorData || type == Smsgs_cmdIds_rampdata)
+    {
+        Sensor_msgStats.msgsAttempted++;
+    }
+    else if(type == Smsgs_cmdIds_trackingRsp)
+    {
+        Sensor_msgStats.trackingResponseAttempts++;
+    }
+    else if(type == Smsgs_cmdIds_configRsp)
+    {
+        Sensor_msgStats.configResponseAttempts++;
+    }
 
-    /* set the correct address mode. */
-    if(pDstAddr->addrMode == ApiMac_addrType_extended)
+#ifdef FEATURE_FRAGMENTATION
+    if(len > FRAG_MAX_FRAME_LEN)
     {
-        dataReq.srcAddrMode = ApiMac_addrType_extended;
+        /* Too big for a single frame, send it in fragments */
+        fragTimeStamp = SENSOR_GET_TICKS();
+        ret = Frag_sendMsg(pDstAddr, rxOnIdle, len, pData);
     }
     else
+#endif /* FEATURE_FRAGMENTATION */
     {
-        dataReq.srcAddrMode = ApiMac_addrType_short;
+        /* Send the message */
+        ret = sendDataReq(type, pDstAddr, rxOnIdle, len, pData, NULL);
     }
 
-    if(rejoining == true)
+    if(ret == false)
     {
-        /* get the new panID from the mac */
-        ApiMac_mlmeGetReqUint16(ApiMac_attribute_panId,
-                                &(parentInfo.devInfo.panID));
+        /* handle transaction overflow by retrying */
+        if(type == Smsgs_cmdIds_sensorData || type == Smsgs_cmdIds_rampdata)
+        {
+            Ssf_setReadingClock(configSettings.reportingInterval);
+        }
     }
 
-    dataReq.dstPanId = parentInfo.devInfo.panID;
+    return (ret);
+}
 
-    dataReq.msduHandle = getMsduHandle(type);
 
-    dataReq.txOptions.ack = true;
+/*!
+ Send LED Identify Request to collector
 
-    if(CERTIFICATION_TEST_MODE)
-    {
-        dataReq.txOptions.ack = false;
-    }
+ Public function defined in sensor.h
+ */
+void Sensor_sendIdentifyLedRequest(void)
+{
+    uint8_t cmdBytes[SMSGS_INDENTIFY_LED_REQUEST_MSG_LEN];
 
-    if(rxOnIdle == false)
+    /* send the response message directly */
+    cmdBytes[0] = (uint8_t) Smsgs_cmdIds_IdentifyLedReq;
+    cmdBytes[1] = (uint8_t) IDENTIFY_LED_TIME;
+    Sensor_sendMsg(Smsgs_cmdIds_IdentifyLedReq,
+            &collectorAddr, true,
+            SMSGS_INDENTIFY_LED_REQUEST_MSG_LEN,
+            cmdBytes);
+}
+
+/*!
+ Get the request to data confirm latency percentiles of a message type
+
+ Public function defined in sensor.h
+ */
+void Sensor_getLatencyStats(Sensor_latencyType_t type,
+                            Smsgs_latencyStatsField_t *pStats)
+{
+    uint16_t *pHist = latencyHist[type];
+    uint16_t count = latencyCount[type];
+    uint16_t target[3];
+    uint16_t *pResult[3];
+    uint32_t cumulative = 0;
+    uint8_t pct = 0;
+    uint8_t bucket;
+
+    memset(pStats, 0, sizeof(Smsgs_latencyStatsField_t));
+    pStats->count = count;
+    if(count == 0)
     {
-        dataReq.txOptions.indirect = true;
+        return;
     }
 
-    dataReq.msdu.len = len;
-    dataReq.msdu.p = pData;
+    /* Rank of the 50th, 90th and 99th percentile, rounded up */
+    target[0] = (uint16_t)(((uint32_t)count * 50 + 99) / 100);
+    target[1] = (uint16_t)(((uint32_t)count * 90 + 99) / 100);
+    target[2] = (uint16_t)(((uint32_t)count * 99 + 99) / 100);
+    pResult[0] = &pStats->p50;
+    pResult[1] = &pStats->p90;
+    pResult[2] = &pStats->p99;
 
-#ifdef FEATURE_MAC_SECURITY
-#ifdef FEATURE_SECURE_COMMISSIONING
+    for(bucket = 0; (bucket < LATENCY_NUM_BUCKETS) && (pct < 3); bucket++)
     {
-        extern ApiMac_sAddrExt_t ApiMac_extAddr;
-        SM_getSrcDeviceSecurityInfo(ApiMac_extAddr, SM_Sensor_SAddress, &dataReq.sec);
+        cumulative += pHist[bucket];
+        while((pct < 3) && (cumulative >= target[pct]))
+        {
+            /* Report the upper bound of the bucket */
+            if(bucket == (LATENCY_NUM_BUCKETS - 1))
+            {
+                *pResult[pct] = 0xFFFF;
+            }
+            else
+            {
+                *pResult[pct] = (uint16_t)((1UL << bucket) - 1);
+            }
+            pct++;
+        }
     }
-#else
-    Jdllc_securityFill(&dataReq.sec);
+}
+
+#ifdef FEATURE_SECURE_COMMISSIONING
+/*!
+ * @brief Sets the Security Authentication Mode
+ *
+ *  Public function defined in sensor.h
+ */
+extern void Sensor_setSmAuthMethod(SMMsgs_authMethod_t authMethod)
+{
+    smAuthMethod = authMethod;
+}
+
+/*!
+ * @brief Gets the Security Authentication Mode
+ *
+ *  Public function defined in sensor.h
+ */
+extern SMMsgs_authMethod_t Sensor_getSmAuthMethod(void)
+{
+    return smAuthMethod;
+}
 #endif /* FEATURE_SECURE_COMMISSIONING */
-#endif /* FEATURE_MAC_SECURITY */
 
-    if(type == Smsgs_cmdIds_sensorData || type == Smsgs_cmdIds_rampdata)
-    {
-        Sensor_msgStats.msgsAttempted++;
-    }
-    else if(type == Smsgs_cmdIds_trackingRsp)
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Register the sensor event handlers with the scheduler.
+ */
+static void initializeScheduler(void)
+{
+    UtilSched_init(&Sensor_events);
+
+    UtilSched_register(SENSOR_DISASSOC_EVT, SENSOR_PRIORITY_NETWORK,
+                       processDisassocEvt);
+#ifdef DMM_OAD
+    UtilSched_register(SENSOR_PAUSE_EVT, SENSOR_PRIORITY_NETWORK,
+                       processPauseEvt);
+    UtilSched_register(SENSOR_RESUME_EVT, SENSOR_PRIORITY_JOIN,
+                       processResumeEvt);
+#endif /* DMM_OAD */
+    UtilSched_register(SENSOR_START_EVT, SENSOR_PRIORITY_JOIN,
+                       processStartEvt);
+#if (USE_DMM) && !(DMM_CENTRAL)
+    UtilSched_register(SENSOR_PROV_EVT, SENSOR_PRIORITY_JOIN,
+                       processProvEvt);
+#endif /* USE_DMM && !(DMM_CENTRAL) */
+    UtilSched_register(SENSOR_READING_TIMEOUT_EVT, SENSOR_PRIORITY_REPORT,
+                       processReadingTimeoutEvt);
+#ifdef DISPLAY_PER_STATS
+    UtilSched_register(SENSOR_UPDATE_STATS_EVT, SENSOR_PRIORITY_DISPLAY,
+                       processUpdateStatsEvt);
+#endif /* DISPLAY_PER_STATS */
+}
+
+/*!
+ * @brief       Start the sensor device in the network.
+ */
+static void processStartEvt(void)
+{
+    ApiMac_deviceDescriptor_t devInfo;
+    Llc_netInfo_t parentInfo;
+#ifdef USE_DMM
+    uint32_t frameCounter = 0;
+
+    /* update policy */
+    DMMPolicy_updateApplicationState(DMMPolicy_StackRole_154Sensor, DMMPOLICY_154_PROVISIONING);
+
+    Sensor_securityInit(frameCounter);
+#endif /* USE_DMM */
+
+    if(Ssf_getNetworkInfo(&devInfo, &parentInfo) == true)
     {
-        Sensor_msgStats.trackingResponseAttempts++;
+        rejoining = true;
+
+        Ssf_configSettings_t configInfo;
+#ifdef FEATURE_MAC_SECURITY
+        ApiMac_status_t stat;
+#endif /* FEATURE_MAC_SECURITY */
+
+        /* Do we have config settings? */
+        if(Ssf_getConfigInfo(&configInfo) == true)
+        {
+            /* Save the config information */
+            configSettings.frameControl = configInfo.frameControl;
+            configSettings.reportingInterval = configInfo.reportingInterval;
+            configSettings.pollingInterval = configInfo.pollingInterval;
+
+            /* Update the polling interval in the LLC */
+            Jdllc_setPollRate(configSettings.pollingInterval);
+        }
+
+        /* Initially, setup the parent as the collector */
+        if(parentInfo.fh == true && CONFIG_RX_ON_IDLE)
+        {
+            collectorAddr.addrMode = ApiMac_addrType_extended;
+            memcpy(&collectorAddr.addr.extAddr,
+                   parentInfo.devInfo.extAddress, APIMAC_SADDR_EXT_LEN);
+        }
+        else
+        {
+            collectorAddr.addrMode = ApiMac_addrType_short;
+            collectorAddr.addr.shortAddr = parentInfo.devInfo.shortAddress;
+        }
+
+#ifdef FEATURE_MAC_SECURITY
+        /* Put the parent in the security device list */
+        stat = Jdllc_addSecDevice(parentInfo.devInfo.panID,
+                                  parentInfo.devInfo.shortAddress,
+                                  &parentInfo.devInfo.extAddress, 0);
+        if(stat != ApiMac_status_success)
+        {
+            Ssf_displayError("Auth Error: 0x", (uint8_t)stat);
+        }
+#endif /* FEATURE_MAC_SECURITY */
+
+#ifdef FEATURE_SECURE_COMMISSIONING
+        if(!CONFIG_FH_ENABLE)
+        {
+            nvDeviceKeyInfo_t devKeyInfo;
+            if(Ssf_getDeviceKeyInfo(&devKeyInfo) == TRUE)
+            {
+                SM_recoverKeyInfo(devInfo, parentInfo, devKeyInfo);
+#ifdef USE_DMM
+                RemoteDisplay_updateSmState(SMCOMMISSIONSTATE_SUCCESS);
+#endif /* USE_DMM */
+            }
+
+        }
+#endif /* FEATURE_SECURE_COMMISSIONING */
+        Jdllc_rejoin(&devInfo, &parentInfo);
     }
-    else if(type == Smsgs_cmdIds_configRsp)
+    else
     {
-        Sensor_msgStats.configResponseAttempts++;
+        /* Reset flag when joining a new network */
+        rejoining = false;
+
+        /* Get Start Timestamp */
+#ifdef OSAL_PORT2TIRTOS
+        joinTimeTicks = Clock_getTicks();
+#else
+        joinTimeTicks = ICall_getTicks();
+#endif
+        Jdllc_join();
     }
+}
 
-    /* Send the message */
-    if(ApiMac_mcpsDataReq(&dataReq) == ApiMac_status_success)
+/*!
+ * @brief       Time to send the next sensor data message.
+ */
+static void processReadingTimeoutEvt(void)
+{
+#if !defined(OAD_IMG_A)
+
+    /* In certification test mode, back to back data shall be sent */
+    if(!CERTIFICATION_TEST_MODE)
     {
-        ret = true;
+        /* Setup for the next message */
+        Ssf_setReadingClock(configSettings.reportingInterval);
     }
-    else
+
+#ifdef FEATURE_SECURE_COMMISSIONING
+    /* if secure Commissioning feature is enabled, read
+     * sensor data and send it only after the secure
+     * commissioning process is done successfully.
+     * else, do not read and send sensor data.
+     */
+    if(SM_Current_State != SM_CM_InProgress)
     {
-        /* handle transaction overflow by retrying */
-        if(type == Smsgs_cmdIds_sensorData || type == Smsgs_cmdIds_rampdata)
-        {
-            Ssf_setReadingClock(configSettings.reportingInterval);
-        }
+#endif /* FEATURE_SECURE_COMMISSIONING */
+
+
+#if SENSOR_TEST_RAMP_DATA_SIZE && (CERTIFICATION_TEST_MODE || defined(POWER_MEAS))
+    processSensorRampMsgEvt();
+#endif /* SENSOR_TEST_RAMP_DATA_SIZE */
+
+#if !defined(POWER_MEAS)
+    /* Read sensors */
+    PROF_RUN(Prof_id_readSensors, readSensors());
+
+    /* Process Sensor Reading Message Event */
+    PROF_RUN(Prof_id_sensorMsg, processSensorMsgEvt());
+#endif /* POWER_MEAS */
+
+#ifdef FEATURE_SECURE_COMMISSIONING
     }
+#endif /* FEATURE_SECURE_COMMISSIONING */
 
-    return (ret);
+#endif //OAD_IMG_A
 }
 
+#ifdef DISPLAY_PER_STATS
+/*!
+ * @brief       Update the PER display.
+ */
+static void processUpdateStatsEvt(void)
+{
+    Ssf_displayPerStats(&Sensor_msgStats);
+    Ssf_displayLatencyStats();
+#ifdef FEATURE_PROFILING
+    Ssf_displayProfStats();
+#endif /* FEATURE_PROFILING */
+}
+#endif /* DISPLAY_PER_STATS */
 
+#if (USE_DMM) && !(DMM_CENTRAL)
 /*!
- Send LED Identify Request to collector
+ * @brief       Start provisioning.
+ */
+static void processProvEvt(void)
+{
+    /* update policy */
+    DMMPolicy_updateApplicationState(DMMPolicy_StackRole_154Sensor, DMMPOLICY_154_PROVISIONING);
+}
+#endif /* USE_DMM && !(DMM_CENTRAL) */
 
- Public function defined in sensor.h
+/*!
+ * @brief       Disassociate from the network.
  */
-void Sensor_sendIdentifyLedRequest(void)
+static void processDisassocEvt(void)
 {
-    uint8_t cmdBytes[SMSGS_INDENTIFY_LED_REQUEST_MSG_LEN];
+    Jdllc_sendDisassociationRequest();
 
-    /* send the response message directly */
-    cmdBytes[0] = (uint8_t) Smsgs_cmdIds_IdentifyLedReq;
-    cmdBytes[1] = (uint8_t) IDENTIFY_LED_TIME;
-    Sensor_sendMsg(Smsgs_cmdIds_IdentifyLedReq,
-            &collectorAddr, true,
-            SMSGS_INDENTIFY_LED_REQUEST_MSG_LEN,
-            cmdBytes);
+#ifdef USE_DMM
+#ifdef FEATURE_SECURE_COMMISSIONING
+    RemoteDisplay_updateSmState(SMCOMMISSIONSTATE_IDLE);
+#endif /* FEATURE_SECURE_COMMISSIONING */
+#endif /* USE_DMM */
 }
 
-#ifdef FEATURE_SECURE_COMMISSIONING
+#ifdef DMM_OAD
 /*!
- * @brief Sets the Security Authentication Mode
- *
- *  Public function defined in sensor.h
+ * @brief       Pause the 15.4 sensor.
  */
-extern void Sensor_setSmAuthMethod(SMMsgs_authMethod_t authMethod)
+static void processPauseEvt(void)
 {
-    smAuthMethod = authMethod;
+    /* Turn off timers to temporarily stop transmissions */
+    Ssf_setPollClock(0);
+    Ssf_setReadingClock(0);
+    if(CONFIG_FH_ENABLE)
+    {
+        Ssf_setTrickleClock(0, ApiMac_wisunAsyncFrame_advertisementSolicit);
+        Ssf_setTrickleClock(0, ApiMac_wisunAsyncFrame_configSolicit);
+    }
 }
 
 /*!
- * @brief Gets the Security Authentication Mode
- *
- *  Public function defined in sensor.h
+ * @brief       Resume the 15.4 sensor.
  */
-extern SMMsgs_authMethod_t Sensor_getSmAuthMethod(void)
+static void processResumeEvt(void)
 {
-    return smAuthMethod;
-}
-#endif /* FEATURE_SECURE_COMMISSIONING */
+    /* Call SENSOR_START_EVT to re-associate with collector if BLE-OAD fails */
+    Util_setEvent(&Sensor_events, SENSOR_START_EVT);
 
-/******************************************************************************
- Local Functions
- *****************************************************************************/
+    /* Wake up the application thread when it waits for clock event */
+    Ssf_PostAppSem();
+}
+#endif /* DMM_OAD */
 
 /*!
  * @brief       Initialize the clocks.
@@ -1133,6 +1271,14 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
     /* Make sure the message came from the app */
     if(pDataCnf->msduHandle & APP_MARKER_MSDU_HANDLE)
     {
+#ifdef FEATURE_FRAGMENTATION
+        /* Fragments are retransmitted and accounted for by the frag module */
+        if(Frag_processDataCnf(pDataCnf) == true)
+        {
+            return;
+        }
+#endif /* FEATURE_FRAGMENTATION */
+
         /* What message type was the original request? */
         if((pDataCnf->msduHandle & APP_MASK_MSDU_HANDLE)
            == APP_SENSOR_MSDU_HANDLE)
@@ -1150,28 +1296,9 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
                 Util_setEvent(&Sensor_events, SENSOR_UPDATE_STATS_EVT);
 #endif /* DISPLAY_PER_STATS */
                 /* Calculate end to end delay */
-#ifdef OSAL_PORT2TIRTOS
-                if(Clock_getTicks() < startSensorMsgTimeStamp)
-                {
-                    endToEndDelay = Clock_getTicks() +
-                                    (0xFFFFFFFF-startSensorMsgTimeStamp);
-                }
-                else
-                {
-                    endToEndDelay = Clock_getTicks() - startSensorMsgTimeStamp;
-                }
-#else
-                if(ICall_getTicks() < startSensorMsgTimeStamp)
-                {
-                    endToEndDelay = ICall_getTicks() +
-                                    (0xFFFFFFFF-startSensorMsgTimeStamp);
-                }
-                else
-                {
-                    endToEndDelay = ICall_getTicks() - startSensorMsgTimeStamp;
-                }
-#endif
-                endToEndDelay = endToEndDelay/TICKPERIOD_MS_US;
+                endToEndDelay = getE2EDelay(pDataCnf->msduHandle);
+                recordLatency(Sensor_latencyType_sensorData, endToEndDelay);
+
                 if ( (totalE2EDelaySum + endToEndDelay ) < totalE2EDelaySum)
                 {
                     /* totalE2EDelaySum is wrapped around,reset the sent count 1 */
@@ -1205,6 +1332,8 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
             if(pDataCnf->status == ApiMac_status_success)
             {
                 Sensor_msgStats.trackingResponseSent++;
+                recordLatency(Sensor_latencyType_trackingRsp,
+                              getE2EDelay(pDataCnf->msduHandle));
             }
         }
         if((pDataCnf->msduHandle & APP_MASK_MSDU_HANDLE)
@@ -1213,6 +1342,8 @@ static void dataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
             if(pDataCnf->status == ApiMac_status_success)
             {
                 Sensor_msgStats.configResponseSent++;
+                recordLatency(Sensor_latencyType_configRsp,
+                              getE2EDelay(pDataCnf->msduHandle));
             }
         }
     }
@@ -1344,6 +1475,13 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
                 break;
 #endif
 
+#ifdef FEATURE_FRAGMENTATION
+            case Smsgs_cmdIds_fragment:
+                /* Reassembled messages come back through this callback */
+                Frag_processDataInd(pDataInd);
+                break;
+#endif /* FEATURE_FRAGMENTATION */
+
 #ifdef FEATURE_NATIVE_OAD
             case Smsgs_cmdIds_oad:
                 //Index past the Smsgs_cmdId
@@ -1427,6 +1565,28 @@ static void dataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
     }
 }
 
+#ifdef FEATURE_PROFILING
+/*!
+ * @brief      Profiled MAC Data Confirm callback.
+ *
+ * @param      pDataCnf - pointer to the data confirm information
+ */
+static void profDataCnfCB(ApiMac_mcpsDataCnf_t *pDataCnf)
+{
+    PROF_RUN(Prof_id_dataCnf, dataCnfCB(pDataCnf));
+}
+
+/*!
+ * @brief      Profiled MAC Data Indication callback.
+ *
+ * @param      pDataInd - pointer to the data indication information
+ */
+static void profDataIndCB(ApiMac_mcpsDataInd_t *pDataInd)
+{
+    PROF_RUN(Prof_id_dataInd, dataIndCB(pDataInd));
+}
+#endif /* FEATURE_PROFILING */
+
 /*!
  * @brief      Get the next MSDU Handle
  *             <BR>
@@ -1474,6 +1634,196 @@ static uint8_t getMsduHandle(Smsgs_cmdIds_t msgType)
     return (msduHandle);
 }
 
+/*!
+ * @brief   Get the time since a message was handed to the MAC
+ *
+ * @param   msduHandle - MSDU handle of the message
+ *
+ * @return  delay in milliseconds
+ */
+static uint32_t getE2EDelay(uint8_t msduHandle)
+{
+    /* Unsigned arithmetic takes care of the tick counter wrapping */
+    uint32_t delay = SENSOR_GET_TICKS()
+                    - msduTimeStamp[msduHandle & MSDU_HANDLE_MAX];
+
+    return (delay / TICKPERIOD_MS_US);
+}
+
+/*!
+ * @brief   Add a message latency to the histogram of its type
+ *
+ * @param   type - message type
+ * @param   delay - request to data confirm latency in milliseconds
+ */
+static void recordLatency(Sensor_latencyType_t type, uint32_t delay)
+{
+    uint16_t *pHist = latencyHist[type];
+    uint8_t bucket = 0;
+
+    /* Bucket is the number of significant bits of the delay */
+    while((delay != 0) && (bucket < (LATENCY_NUM_BUCKETS - 1)))
+    {
+        delay >>= 1;
+        bucket++;
+    }
+
+    if(latencyCount[type] == 0xFFFF)
+    {
+        uint8_t i;
+
+        /* Halve the histogram so the older messages fade out */
+        latencyCount[type] = 0;
+        for(i = 0; i < LATENCY_NUM_BUCKETS; i++)
+        {
+            pHist[i] >>= 1;
+            latencyCount[type] += pHist[i];
+        }
+    }
+
+    pHist[bucket]++;
+    latencyCount[type]++;
+}
+
+/*!
+ * @brief   Build and send a single MAC data request
+ *
+ * @param   type - message type
+ * @param   pDstAddr - destination address
+ * @param   rxOnIdle - true if not a sleepy device
+ * @param   len - length of payload
+ * @param   pData - pointer to the buffer
+ * @param   pMsduHandle - place to put the MSDU handle used, may be NULL
+ *
+ * @return  true if sent, false if not
+ */
+static bool sendDataReq(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
+                        bool rxOnIdle, uint16_t len, uint8_t *pData,
+                        uint8_t *pMsduHandle)
+{
+    /* information about the network */
+    ApiMac_mcpsDataReq_t dataReq;
+
+    /* Construct the data request field */
+    memset(&dataReq, 0, sizeof(ApiMac_mcpsDataReq_t));
+    memcpy(&dataReq.dstAddr, pDstAddr, sizeof(ApiMac_sAddr_t));
+
+    /* set the correct address mode. */
+    if(pDstAddr->addrMode == ApiMac_addrType_extended)
+    {
+        dataReq.srcAddrMode = ApiMac_addrType_extended;
+    }
+    else
+    {
+        dataReq.srcAddrMode = ApiMac_addrType_short;
+    }
+
+    if(rejoining == true)
+    {
+        /* get the new panID from the mac */
+        ApiMac_mlmeGetReqUint16(ApiMac_attribute_panId,
+                                &(parentInfo.devInfo.panID));
+    }
+
+    dataReq.dstPanId = parentInfo.devInfo.panID;
+
+    dataReq.msduHandle = getMsduHandle(type);
+
+    /* Timestamp to compute end to end delay */
+    msduTimeStamp[dataReq.msduHandle & MSDU_HANDLE_MAX] = SENSOR_GET_TICKS();
+
+    if(pMsduHandle != NULL)
+    {
+        *pMsduHandle = dataReq.msduHandle;
+    }
+
+    dataReq.txOptions.ack = true;
+
+    if(CERTIFICATION_TEST_MODE)
+    {
+        dataReq.txOptions.ack = false;
+    }
+
+    if(rxOnIdle == false)
+    {
+        dataReq.txOptions.indirect = true;
+    }
+
+    dataReq.msdu.len = len;
+    dataReq.msdu.p = pData;
+
+#ifdef FEATURE_MAC_SECURITY
+#ifdef FEATURE_SECURE_COMMISSIONING
+    {
+        extern ApiMac_sAddrExt_t ApiMac_extAddr;
+        SM_getSrcDeviceSecurityInfo(ApiMac_extAddr, SM_Sensor_SAddress, &dataReq.sec);
+    }
+#else
+    Jdllc_securityFill(&dataReq.sec);
+#endif /* FEATURE_SECURE_COMMISSIONING */
+#endif /* FEATURE_MAC_SECURITY */
+
+    /* Send the message */
+    return (ApiMac_mcpsDataReq(&dataReq) == ApiMac_status_success);
+}
+
+#ifdef FEATURE_FRAGMENTATION
+/*!
+ * @brief   Fragmentation callback to send a single fragment
+ *
+ * @param   pDstAddr - destination address
+ * @param   rxOnIdle - true if not a sleepy device
+ * @param   len - length of the fragment
+ * @param   pData - pointer to the fragment
+ * @param   pMsduHandle - place to put the MSDU handle used
+ *
+ * @return  true if sent, false if not
+ */
+static bool fragSendCb(ApiMac_sAddr_t *pDstAddr, bool rxOnIdle,
+                       uint16_t len, uint8_t *pData, uint8_t *pMsduHandle)
+{
+    return (sendDataReq(Smsgs_cmdIds_fragment, pDstAddr, rxOnIdle, len, pData,
+                        pMsduHandle));
+}
+
+/*!
+ * @brief   Fragmentation callback when a fragmented message is done
+ *
+ * @param   cmdId - command ID of the fragmented message
+ * @param   success - true if every fragment was acknowledged
+ */
+static void fragTxDoneCb(Smsgs_cmdIds_t cmdId, bool success)
+{
+    if(success == true)
+    {
+        /* From the first fragment request to the last data confirm */
+        uint32_t delay = (SENSOR_GET_TICKS() - fragTimeStamp)
+                         / TICKPERIOD_MS_US;
+
+        if(cmdId == Smsgs_cmdIds_sensorData || cmdId == Smsgs_cmdIds_rampdata)
+        {
+            Sensor_msgStats.msgsSent++;
+            recordLatency(Sensor_latencyType_sensorData, delay);
+        }
+        else if(cmdId == Smsgs_cmdIds_trackingRsp)
+        {
+            Sensor_msgStats.trackingResponseSent++;
+            recordLatency(Sensor_latencyType_trackingRsp, delay);
+        }
+        else if(cmdId == Smsgs_cmdIds_configRsp)
+        {
+            Sensor_msgStats.configResponseSent++;
+            recordLatency(Sensor_latencyType_configRsp, delay);
+        }
+    }
+    else if(cmdId == Smsgs_cmdIds_sensorData || cmdId == Smsgs_cmdIds_rampdata)
+    {
+        /* Try again at the next reporting interval */
+        Ssf_setReadingClock(configSettings.reportingInterval);
+    }
+}
+#endif /* FEATURE_FRAGMENTATION */
+
 /*!
  @brief  Build and send fixed size ramp data
  */
@@ -1549,6 +1899,17 @@ static void processSensorMsgEvt(void)
         memcpy(&sensor.msgStats, &Sensor_msgStats,
                sizeof(Smsgs_msgStatsField_t));
     }
+    if(sensor.frameControl & Smsgs_dataFields_latencyStats)
+    {
+        Sensor_getLatencyStats(Sensor_latencyType_sensorData,
+                               &sensor.latencyStats);
+    }
+#ifdef FEATURE_PROFILING
+    if(sensor.frameControl & Smsgs_dataFields_profStats)
+    {
+        Prof_getField(&sensor.profStats);
+    }
+#endif /* FEATURE_PROFILING */
     if(sensor.frameControl & Smsgs_dataFields_configSettings)
     {
         sensor.configSettings.pollingInterval = configSettings.pollingInterval;
@@ -1767,6 +2128,17 @@ static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr, Smsgs_sensorMsg_t *pMsg)
         len += pMsg->bleSensor.dataLength;
     }
 #endif
+    if(pMsg->frameControl & Smsgs_dataFields_latencyStats)
+    {
+        len += SMSGS_SENSOR_LATENCY_STATS_LEN;
+    }
+#ifdef FEATURE_PROFILING
+    if(pMsg->frameControl & Smsgs_dataFields_profStats)
+    {
+        len += SMSGS_SENSOR_PROF_STATS_LEN
+               + (pMsg->profStats.numEntries * SMSGS_SENSOR_PROF_ENTRY_LEN);
+    }
+#endif /* FEATURE_PROFILING */
 
     pMsgBuf = (uint8_t *)Ssf_malloc(len);
     if(pMsgBuf)
@@ -1877,6 +2249,26 @@ static bool sendSensorMessage(ApiMac_sAddr_t *pDstAddr, Smsgs_sensorMsg_t *pMsg)
             }
         }
 #endif
+        if(pMsg->frameControl & Smsgs_dataFields_latencyStats)
+        {
+            pBuf = Util_bufferUint16(pBuf, pMsg->latencyStats.count);
+            pBuf = Util_bufferUint16(pBuf, pMsg->latencyStats.p50);
+            pBuf = Util_bufferUint16(pBuf, pMsg->latencyStats.p90);
+            pBuf = Util_bufferUint16(pBuf, pMsg->latencyStats.p99);
+        }
+#ifdef FEATURE_PROFILING
+        if(pMsg->frameControl & Smsgs_dataFields_profStats)
+        {
+            uint8_t i;
+
+            *pBuf++ = pMsg->profStats.numEntries;
+            for(i = 0; i < pMsg->profStats.numEntries; i++)
+            {
+                pBuf = Util_bufferUint32(pBuf, pMsg->profStats.meanTime[i]);
+                pBuf = Util_bufferUint32(pBuf, pMsg->profStats.maxTime[i]);
+            }
+        }
+#endif /* FEATURE_PROFILING */
 
         ret = Sensor_sendMsg(Smsgs_cmdIds_sensorData, pDstAddr, true, len, pMsgBuf);
 
@@ -2120,6 +2512,16 @@ static uint16_t validateFrameControl(uint16_t frameControl)
         newFrameControl |= Smsgs_dataFields_bleSensor;
     }
 #endif
+    if(frameControl & Smsgs_dataFields_latencyStats)
+    {
+        newFrameControl |= Smsgs_dataFields_latencyStats;
+    }
+#ifdef FEATURE_PROFILING
+    if(frameControl & Smsgs_dataFields_profStats)
+    {
+        newFrameControl |= Smsgs_dataFields_profStats;
+    }
+#endif /* FEATURE_PROFILING */
 
     return (newFrameControl);
 }
@@ -2276,6 +2678,11 @@ static void jdllcDisassocIndCb(ApiMac_sAddrExt_t *pExtAddress,
     /* OAD abort with no auto resume */
     OADClient_abort(false);
 #endif //FEATURE_NATIVE_OAD
+
+#ifdef FEATURE_FRAGMENTATION
+    /* Drop any fragmented message in progress */
+    Frag_reset();
+#endif /* FEATURE_FRAGMENTATION */
 }
 
 /*!
@@ -2307,6 +2714,11 @@ static void jdllcDisassocCnfCb(ApiMac_sAddrExt_t *pExtAddress,
     /* OAD abort with no auto resume */
     OADClient_abort(false);
 #endif //FEATURE_NATIVE_OAD
+
+#ifdef FEATURE_FRAGMENTATION
+    /* Drop any fragmented message in progress */
+    Frag_reset();
+#endif /* FEATURE_FRAGMENTATION */
 }
 
 /*!
@@ -123,6 +123,19 @@ typedef enum
     Sensor_status_invalid_state = 1
 } Sensor_status_t;
 
+/*! Message types with a latency histogram */
+typedef enum
+{
+    /*! Sensor Data and Ramp Data messages */
+    Sensor_latencyType_sensorData = 0,
+    /*! Tracking Response messages */
+    Sensor_latencyType_trackingRsp = 1,
+    /*! Configuration Response messages */
+    Sensor_latencyType_configRsp = 2,
+    /*! Number of message types */
+    Sensor_latencyType_max = 3
+} Sensor_latencyType_t;
+
 /******************************************************************************
  Structures
  *****************************************************************************/
@@ -192,6 +205,17 @@ extern bool Sensor_sendMsg(Smsgs_cmdIds_t type, ApiMac_sAddr_t *pDstAddr,
  */
 extern void Sensor_sendIdentifyLedRequest(void);
 
+/*!
+ * @brief   Get the request to data confirm latency percentiles of a
+ *          message type. A fragmented message counts once, from the request
+ *          of its first fragment to the confirm of its last one.
+ *
+ * @param   type - message type
+ * @param   pStats - place to put the latency statistics
+ */
+extern void Sensor_getLatencyStats(Sensor_latencyType_t type,
+                                   Smsgs_latencyStatsField_t *pStats);
+
 
 #ifdef FEATURE_SECURE_COMMISSIONING
 /*!
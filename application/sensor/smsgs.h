@@ -164,6 +164,38 @@ The <b>Sensor Ramp Data Message</b> is defined as:
      - Polling Interval - in millseconds (32 bits) - If the sensor device is
      a sleep device, this states how often the device polls its parent for
      data. This field is 0 if the device doesn't sleep.
+ <BR>
+ The <b>Latency Statistics Field</b> summarizes the time from a Sensor Data
+ Message request to its MAC data confirm, in milliseconds. The percentiles
+ come from a log2 histogram, each value is the upper bound of the histogram
+ bucket that holds the percentile:
+     - count - uint16_t - number of messages in the histogram
+     - p50 - uint16_t - 50th percentile (median) latency
+     - p90 - uint16_t - 90th percentile latency
+     - p99 - uint16_t - 99th percentile latency
+ <BR>
+ The <b>Profiling Field</b> reports the time spent in the sensor's event
+ loop handlers and MAC callbacks, in microseconds. It is only sent by
+ sensors built with FEATURE_PROFILING:
+     - numEntries - uint8_t - number of handlers that follow
+     - For each handler, in the order of Prof_id_t (prof.h):
+         - meanTime - uint32_t - mean time of a call
+         - maxTime - uint32_t - longest call
+ <BR>
+ The <b>Fragment Message</b> carries one piece of a message that is too
+ large for a single MAC frame, it is defined as:
+     - Command ID - [Smsgs_cmdIds_fragment](@ref Smsgs_cmdIds) (1 byte)
+     - Message Sequence - (8 bits) - identifies the fragmented message, all
+     fragments of the same message carry the same value.
+     - Fragment Index - (8 bits) - index of this fragment, starting at 0.
+     - Fragment Count - (8 bits) - total number of fragments in the message.
+     - Total Length - (16 bits) - length of the reassembled message.
+     - Offset - (16 bits) - offset of this fragment's data in the
+     reassembled message.
+     - Fragment Data - the rest of the frame.
+ <BR>
+ The reassembled message is a complete over-the-air message, starting with
+ its own Command ID.
  */
 
 /******************************************************************************
@@ -195,6 +227,14 @@ The <b>Sensor Ramp Data Message</b> is defined as:
 #define SMSGS_SENSOR_MSG_STATS_LEN 44
 /*! Length of the configSettings portion of the sensor data message */
 #define SMSGS_SENSOR_CONFIG_SETTINGS_LEN 8
+/*! Length of the latencyStats portion of the sensor data message */
+#define SMSGS_SENSOR_LATENCY_STATS_LEN 8
+/*! Maximum number of handlers in the profStats portion */
+#define SMSGS_PROF_MAX_ENTRIES 8
+/*! Length of the fixed part of the profStats portion */
+#define SMSGS_SENSOR_PROF_STATS_LEN 1
+/*! Length of each handler in the profStats portion */
+#define SMSGS_SENSOR_PROF_ENTRY_LEN 8
 /*! Toggle Led Request message length (over-the-air length) */
 #define SMSGS_TOGGLE_LED_REQUEST_MSG_LEN 1
 /*! Toggle Led Request message length (over-the-air length) */
@@ -207,6 +247,8 @@ The <b>Sensor Ramp Data Message</b> is defined as:
 #define SMSGS_DEVICE_TYPE_REQUEST_MSG_LEN 1
 /*! Device type response message length (over-the-air length) */
 #define SMSGS_DEVICE_TYPE_RESPONSE_MSG_LEN 3
+/*! Fragment message header length (over-the-air length) */
+#define SMSGS_FRAGMENT_HDR_LEN 8
 /*! Length of a BLE Device Address */
 #define B_ADDR_LEN 6
 /*! Length of the ble sensor portion of the sensor data length not including variable data field */
@@ -258,6 +300,8 @@ The <b>Sensor Ramp Data Message</b> is defined as:
     Smsgs_cmdIds_turnOnLedReq = 18,
     /*Turn off LED message, sent from the collector to the sensor */
     Smsgs_cmdIds_turnOffLedReq = 19,
+    /*! Fragment of a larger message, sent/received from both collector and sensor */
+    Smsgs_cmdIds_fragment = 20,
 
  } Smsgs_cmdIds_t;
 
@@ -286,6 +330,10 @@ typedef enum
     Smsgs_dataFields_accelSensor = 0x0040,
 #endif /* LPSTK */
     Smsgs_dataFields_bleSensor = 0x0080,
+    /*! Message Latency Statistics */
+    Smsgs_dataFields_latencyStats = 0x0100,
+    /*! Handler Profiling */
+    Smsgs_dataFields_profStats = 0x0200,
 } Smsgs_dataFields_t;
 
 /*!
@@ -567,6 +615,34 @@ typedef struct _Smsgs_powerMeastatsField_t
 } Smsgs_powerMeastatsField_t;
 #endif
 
+/*!
+ Latency Statistics Field
+ */
+typedef struct _Smsgs_latencystatsfield_t
+{
+    /*! Number of messages in the latency histogram */
+    uint16_t count;
+    /*! 50th percentile latency, in milliseconds */
+    uint16_t p50;
+    /*! 90th percentile latency, in milliseconds */
+    uint16_t p90;
+    /*! 99th percentile latency, in milliseconds */
+    uint16_t p99;
+} Smsgs_latencyStatsField_t;
+
+/*!
+ Profiling Field
+ */
+typedef struct _Smsgs_profstatsfield_t
+{
+    /*! Number of handlers in meanTime and maxTime */
+    uint8_t numEntries;
+    /*! Mean time of a call of each handler, in microseconds */
+    uint32_t meanTime[SMSGS_PROF_MAX_ENTRIES];
+    /*! Longest call of each handler, in microseconds */
+    uint32_t maxTime[SMSGS_PROF_MAX_ENTRIES];
+} Smsgs_profStatsField_t;
+
 /*!
  Message Statistics Field
  */
@@ -638,8 +714,37 @@ typedef struct _Smsgs_sensormsg_t
      is set in frameControl.
      */
     Smsgs_bleSensorField_t bleSensor;
+    /*!
+     Latency Statistics field - valid only if Smsgs_dataFields_latencyStats
+     is set in frameControl.
+     */
+    Smsgs_latencyStatsField_t latencyStats;
+    /*!
+     Profiling field - valid only if Smsgs_dataFields_profStats
+     is set in frameControl.
+     */
+    Smsgs_profStatsField_t profStats;
 } Smsgs_sensorMsg_t;
 
+/*!
+ Fragment message header: sent/received from both collector and sensor.
+ */
+typedef struct _Smsgs_fragmenthdr_t
+{
+    /*! Command ID - 1 byte */
+    Smsgs_cmdIds_t cmdId;
+    /*! Message Sequence - 1 byte */
+    uint8_t msgSeq;
+    /*! Fragment Index - 1 byte */
+    uint8_t fragIdx;
+    /*! Fragment Count - 1 byte */
+    uint8_t fragCount;
+    /*! Total length of the reassembled message - 2 bytes */
+    uint16_t totalLen;
+    /*! Offset of the fragment data in the reassembled message - 2 bytes */
+    uint16_t offset;
+} Smsgs_fragmentHdr_t;
+
 /*!
  Broadcast Cmd Request message: sent from controller to the sensor.
  */
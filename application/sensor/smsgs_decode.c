@@ -0,0 +1,574 @@
+/******************************************************************************
+
+ @file smsgs_decode.c
+
+ @brief Sensor over-the-air message decoder
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <string.h>
+#include <stdint.h>
+
+#include "smsgs_decode.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Highest command ID known by the decoder */
+#define DECODE_MAX_CMD_ID Smsgs_cmdIds_fragment
+
+/* Message length is checked by the message specific code */
+#define DECODE_LEN_VARIABLE 0
+
+/* Offset of the data length in the BLE Sensor Field */
+#define DECODE_BLE_DATA_LEN_OFFSET (B_ADDR_LEN + 4)
+
+/* Length of the Message Statistics Field, as buffered by the sensor */
+#define DECODE_MSG_STATS_LEN (sizeof(Smsgs_msgStatsField_t))
+
+/* Parse little endian values, the buffer may be unaligned */
+#define DECODE_UINT16(p) ((uint16_t)((p)[0] | ((uint16_t)(p)[1] << 8)))
+#define DECODE_UINT32(p) ((uint32_t)(p)[0] | ((uint32_t)(p)[1] << 8) | \
+                          ((uint32_t)(p)[2] << 16) | ((uint32_t)(p)[3] << 24))
+
+/******************************************************************************
+ Local variables
+ *****************************************************************************/
+
+/* Length of each message, indexed by command ID, 0 if not fixed */
+static const uint8_t cmdLen[DECODE_MAX_CMD_ID + 1] =
+{
+    /* 0 - not used */
+    DECODE_LEN_VARIABLE,
+    /* Smsgs_cmdIds_configReq */
+    SMSGS_CONFIG_REQUEST_MSG_LENGTH,
+    /* Smsgs_cmdIds_configRsp */
+    SMSGS_CONFIG_RESPONSE_MSG_LENGTH,
+    /* Smsgs_cmdIds_trackingReq */
+    SMSGS_TRACKING_REQUEST_MSG_LENGTH,
+    /* Smsgs_cmdIds_trackingRsp */
+    SMSGS_TRACKING_RESPONSE_MSG_LENGTH,
+    /* Smsgs_cmdIds_sensorData */
+    DECODE_LEN_VARIABLE,
+    /* Smsgs_cmdIds_toggleLedReq */
+    SMSGS_TOGGLE_LED_REQUEST_MSG_LEN,
+    /* Smsgs_cmdIds_toggleLedRsp */
+    SMSGS_TOGGLE_LED_RESPONSE_MSG_LEN,
+    /* Smsgs_cmdIds_rampdata */
+    DECODE_LEN_VARIABLE,
+    /* Smsgs_cmdIds_oad */
+    DECODE_LEN_VARIABLE,
+    /* Smgs_cmdIds_broadcastCtrlMsg */
+    SMSGS_BROADCAST_CMD_LENGTH,
+    /* Smgs_cmdIds_KeyExchangeMsg */
+    DECODE_LEN_VARIABLE,
+    /* Smsgs_cmdIds_IdentifyLedReq */
+    SMSGS_INDENTIFY_LED_REQUEST_MSG_LEN,
+    /* Smsgs_cmdIds_IdentifyLedRsp */
+    SMSGS_INDENTIFY_LED_RESPONSE_MSG_LEN,
+    /* Smgs_cmdIds_CommissionStart */
+    DECODE_LEN_VARIABLE,
+    /* Smgs_cmdIds_CommissionMsg */
+    DECODE_LEN_VARIABLE,
+    /* Smsgs_cmdIds_DeviceTypeReq */
+    SMSGS_DEVICE_TYPE_REQUEST_MSG_LEN,
+    /* Smsgs_cmdIds_DeviceTypeRsp */
+    SMSGS_DEVICE_TYPE_RESPONSE_MSG_LEN,
+    /* Smsgs_cmdIds_turnOnLedReq */
+    SMSGS_TOGGLE_LED_REQUEST_MSG_LEN,
+    /* Smsgs_cmdIds_turnOffLedReq */
+    SMSGS_TOGGLE_LED_REQUEST_MSG_LEN,
+    /* Smsgs_cmdIds_fragment */
+    DECODE_LEN_VARIABLE
+};
+
+/*
+ Length of each Sensor Data Message field, indexed by the bit position of
+ the field in the frame control. 0 for the BLE Sensor and Profiling
+ Fields, their length depends on their content.
+ */
+static const uint8_t fieldLen[SMSGS_DECODE_MAX_FIELDS] =
+{
+    /* Smsgs_dataFields_tempSensor */
+    SMSGS_SENSOR_TEMP_LEN,
+    /* Smsgs_dataFields_lightSensor */
+    SMSGS_SENSOR_LIGHT_LEN,
+    /* Smsgs_dataFields_humiditySensor */
+    SMSGS_SENSOR_HUMIDITY_LEN,
+    /* Smsgs_dataFields_msgStats */
+    DECODE_MSG_STATS_LEN,
+    /* Smsgs_dataFields_configSettings */
+    SMSGS_SENSOR_CONFIG_SETTINGS_LEN,
+    /* Smsgs_dataFields_hallEffectSensor - flux (float) */
+    4,
+    /* Smsgs_dataFields_accelSensor - 3 axis and 2 tilt bytes */
+    8,
+    /* Smsgs_dataFields_bleSensor */
+    0,
+    /* Smsgs_dataFields_latencyStats */
+    SMSGS_SENSOR_LATENCY_STATS_LEN,
+    /* Smsgs_dataFields_profStats */
+    0
+};
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static Smsgs_decodeStatus_t decodeSensorView(Smsgs_msgView_t *pView);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Validate a received message and build a view of it.
+
+ Public function defined in smsgs_decode.h
+ */
+Smsgs_decodeStatus_t Smsgs_decodeView(const uint8_t *pBuf, uint16_t len,
+                                      Smsgs_msgView_t *pView)
+{
+    Smsgs_decodeStatus_t status = Smsgs_decodeStatus_success;
+    uint8_t cmdId;
+
+    memset(pView, 0, sizeof(Smsgs_msgView_t));
+    pView->pBuf = pBuf;
+    pView->len = len;
+
+    if((pBuf == NULL) || (len == 0))
+    {
+        pView->status = Smsgs_decodeStatus_tooShort;
+        return (pView->status);
+    }
+
+    cmdId = pBuf[0];
+    pView->cmdId = (Smsgs_cmdIds_t)cmdId;
+
+    if((cmdId == 0) || (cmdId > DECODE_MAX_CMD_ID))
+    {
+        status = Smsgs_decodeStatus_unknownCmd;
+    }
+    else if(cmdLen[cmdId] != DECODE_LEN_VARIABLE)
+    {
+        if(len != cmdLen[cmdId])
+        {
+            status = Smsgs_decodeStatus_badLength;
+        }
+        else if(cmdId == Smsgs_cmdIds_configReq)
+        {
+            pView->frameControl = DECODE_UINT16(&pBuf[1]);
+        }
+        else if(cmdId == Smsgs_cmdIds_configRsp)
+        {
+            pView->frameControl = DECODE_UINT16(&pBuf[3]);
+        }
+    }
+    else if(cmdId == Smsgs_cmdIds_sensorData)
+    {
+        status = decodeSensorView(pView);
+    }
+    else if(cmdId == Smsgs_cmdIds_fragment)
+    {
+        if(len <= SMSGS_FRAGMENT_HDR_LEN)
+        {
+            status = Smsgs_decodeStatus_tooShort;
+        }
+    }
+
+    if((status == Smsgs_decodeStatus_success)
+       && (pView->frameControl & ~SMSGS_DECODE_KNOWN_FIELDS))
+    {
+        status = Smsgs_decodeStatus_badFrameControl;
+    }
+
+    pView->status = status;
+
+    return (status);
+}
+
+/*!
+ Validate many received messages.
+
+ Public function defined in smsgs_decode.h
+ */
+uint16_t Smsgs_decodeBatch(const uint8_t * const *ppBufs,
+                           const uint16_t *pLens, uint16_t count,
+                           Smsgs_msgView_t *pViews)
+{
+    uint16_t numValid = 0;
+    uint16_t i;
+
+    for(i = 0; i < count; i++)
+    {
+        if(Smsgs_decodeView(ppBufs[i], pLens[i], &pViews[i])
+           == Smsgs_decodeStatus_success)
+        {
+            numValid++;
+        }
+    }
+
+    return (numValid);
+}
+
+/*!
+ Check if a field is present in a Sensor Data Message view.
+
+ Public function defined in smsgs_decode.h
+ */
+const uint8_t *Smsgs_decodeField(const Smsgs_msgView_t *pView,
+                                 Smsgs_dataFields_t field)
+{
+    uint8_t bit;
+
+    if((pView->status != Smsgs_decodeStatus_success)
+       || (pView->cmdId != Smsgs_cmdIds_sensorData)
+       || ((pView->frameControl & field) == 0))
+    {
+        return (NULL);
+    }
+
+    for(bit = 0; bit < SMSGS_DECODE_MAX_FIELDS; bit++)
+    {
+        if((uint16_t)field == (uint16_t)(1 << bit))
+        {
+            return (&pView->pBuf[pView->fieldOffset[bit]]);
+        }
+    }
+
+    return (NULL);
+}
+
+/*!
+ Decode a Sensor Data Message.
+
+ Public function defined in smsgs_decode.h
+ */
+bool Smsgs_decodeSensorMsg(const Smsgs_msgView_t *pView,
+                           Smsgs_sensorMsg_t *pMsg)
+{
+    const uint8_t *pBuf;
+
+    if((pView->status != Smsgs_decodeStatus_success)
+       || (pView->cmdId != Smsgs_cmdIds_sensorData))
+    {
+        return (false);
+    }
+
+    pMsg->cmdId = Smsgs_cmdIds_sensorData;
+    memcpy(pMsg->extAddress, &pView->pBuf[1], SMGS_SENSOR_EXTADDR_LEN);
+    pMsg->frameControl = pView->frameControl;
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_tempSensor);
+    if(pBuf != NULL)
+    {
+        pMsg->tempSensor.ambienceTemp = (int16_t)DECODE_UINT16(pBuf);
+        pMsg->tempSensor.objectTemp = (int16_t)DECODE_UINT16(pBuf + 2);
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_lightSensor);
+    if(pBuf != NULL)
+    {
+        pMsg->lightSensor.rawData = DECODE_UINT16(pBuf);
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_humiditySensor);
+    if(pBuf != NULL)
+    {
+        pMsg->humiditySensor.temp = DECODE_UINT16(pBuf);
+        pMsg->humiditySensor.humidity = DECODE_UINT16(pBuf + 2);
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_msgStats);
+    if(pBuf != NULL)
+    {
+        /* Every statistic is a uint16_t, in the order of the structure */
+        uint16_t *pStat = (uint16_t *)&pMsg->msgStats;
+        uint8_t i;
+
+        for(i = 0; i < (DECODE_MSG_STATS_LEN / 2); i++)
+        {
+            pStat[i] = DECODE_UINT16(pBuf);
+            pBuf += 2;
+        }
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_configSettings);
+    if(pBuf != NULL)
+    {
+        pMsg->configSettings.reportingInterval = DECODE_UINT32(pBuf);
+        pMsg->configSettings.pollingInterval = DECODE_UINT32(pBuf + 4);
+    }
+
+#ifdef LPSTK
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_hallEffectSensor);
+    if(pBuf != NULL)
+    {
+        /* The sensor sends the flux converted to an integer */
+        pMsg->hallEffectSensor.flux = (float)DECODE_UINT32(pBuf);
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_accelSensor);
+    if(pBuf != NULL)
+    {
+        pMsg->accelerometerSensor.xAxis = (int16_t)DECODE_UINT16(pBuf);
+        pMsg->accelerometerSensor.yAxis = (int16_t)DECODE_UINT16(pBuf + 2);
+        pMsg->accelerometerSensor.zAxis = (int16_t)DECODE_UINT16(pBuf + 4);
+        pMsg->accelerometerSensor.xTiltDet = pBuf[6];
+        pMsg->accelerometerSensor.yTiltDet = pBuf[7];
+    }
+#endif /* LPSTK */
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_bleSensor);
+    if(pBuf != NULL)
+    {
+        uint8_t i;
+
+        memcpy(pMsg->bleSensor.bleAddr, pBuf, B_ADDR_LEN);
+        pBuf += B_ADDR_LEN;
+        pMsg->bleSensor.manFacID = DECODE_UINT16(pBuf);
+        pBuf += 2;
+        pMsg->bleSensor.uuid = DECODE_UINT16(pBuf);
+        pBuf += 2;
+        pMsg->bleSensor.dataLength = *pBuf++;
+
+        /* The characteristic value is sent last byte first */
+        i = pMsg->bleSensor.dataLength;
+        while(i != 0)
+        {
+            i--;
+            pMsg->bleSensor.data[i] = *pBuf++;
+        }
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_latencyStats);
+    if(pBuf != NULL)
+    {
+        pMsg->latencyStats.count = DECODE_UINT16(pBuf);
+        pMsg->latencyStats.p50 = DECODE_UINT16(pBuf + 2);
+        pMsg->latencyStats.p90 = DECODE_UINT16(pBuf + 4);
+        pMsg->latencyStats.p99 = DECODE_UINT16(pBuf + 6);
+    }
+
+    pBuf = Smsgs_decodeField(pView, Smsgs_dataFields_profStats);
+    if(pBuf != NULL)
+    {
+        uint8_t i;
+
+        pMsg->profStats.numEntries = *pBuf++;
+        for(i = 0; i < pMsg->profStats.numEntries; i++)
+        {
+            pMsg->profStats.meanTime[i] = DECODE_UINT32(pBuf);
+            pMsg->profStats.maxTime[i] = DECODE_UINT32(pBuf + 4);
+            pBuf += SMSGS_SENSOR_PROF_ENTRY_LEN;
+        }
+    }
+
+    return (true);
+}
+
+/*!
+ Decode a Configuration Request Message.
+
+ Public function defined in smsgs_decode.h
+ */
+bool Smsgs_decodeConfigReq(const Smsgs_msgView_t *pView,
+                           Smsgs_configReqMsg_t *pMsg)
+{
+    const uint8_t *pBuf = pView->pBuf;
+
+    if((pView->status != Smsgs_decodeStatus_success)
+       || (pView->cmdId != Smsgs_cmdIds_configReq))
+    {
+        return (false);
+    }
+
+    pMsg->cmdId = Smsgs_cmdIds_configReq;
+    pMsg->frameControl = DECODE_UINT16(&pBuf[1]);
+    pMsg->reportingInterval = DECODE_UINT32(&pBuf[3]);
+    pMsg->pollingInterval = DECODE_UINT32(&pBuf[7]);
+
+    return (true);
+}
+
+/*!
+ Decode a Configuration Response Message.
+
+ Public function defined in smsgs_decode.h
+ */
+bool Smsgs_decodeConfigRsp(const Smsgs_msgView_t *pView,
+                           Smsgs_configRspMsg_t *pMsg)
+{
+    const uint8_t *pBuf = pView->pBuf;
+
+    if((pView->status != Smsgs_decodeStatus_success)
+       || (pView->cmdId != Smsgs_cmdIds_configRsp))
+    {
+        return (false);
+    }
+
+    pMsg->cmdId = Smsgs_cmdIds_configRsp;
+    pMsg->status = (Smsgs_statusValues_t)DECODE_UINT16(&pBuf[1]);
+    pMsg->frameControl = DECODE_UINT16(&pBuf[3]);
+    pMsg->reportingInterval = DECODE_UINT32(&pBuf[5]);
+    pMsg->pollingInterval = DECODE_UINT32(&pBuf[9]);
+
+    return (true);
+}
+
+/*!
+ Decode a Fragment Message header.
+
+ Public function defined in smsgs_decode.h
+ */
+const uint8_t *Smsgs_decodeFragmentHdr(const Smsgs_msgView_t *pView,
+                                       Smsgs_fragmentHdr_t *pHdr)
+{
+    const uint8_t *pBuf = pView->pBuf;
+
+    if((pView->status != Smsgs_decodeStatus_success)
+       || (pView->cmdId != Smsgs_cmdIds_fragment))
+    {
+        return (NULL);
+    }
+
+    pHdr->cmdId = Smsgs_cmdIds_fragment;
+    pHdr->msgSeq = pBuf[1];
+    pHdr->fragIdx = pBuf[2];
+    pHdr->fragCount = pBuf[3];
+    pHdr->totalLen = DECODE_UINT16(&pBuf[4]);
+    pHdr->offset = DECODE_UINT16(&pBuf[6]);
+
+    return (&pBuf[SMSGS_FRAGMENT_HDR_LEN]);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Validate a Sensor Data Message and find its fields.
+ *
+ * @param       pView - view with pBuf and len set
+ *
+ * @return      Smsgs_decodeStatus_success if the message is valid
+ */
+static Smsgs_decodeStatus_t decodeSensorView(Smsgs_msgView_t *pView)
+{
+    const uint8_t *pBuf = pView->pBuf;
+    uint16_t offset = SMSGS_BASIC_SENSOR_LEN;
+    uint8_t bit;
+
+    if(pView->len < SMSGS_BASIC_SENSOR_LEN)
+    {
+        return (Smsgs_decodeStatus_tooShort);
+    }
+
+    /* Frame control follows the command ID and the extended address */
+    pView->frameControl = DECODE_UINT16(&pBuf[1 + SMGS_SENSOR_EXTADDR_LEN]);
+    if(pView->frameControl & ~SMSGS_DECODE_KNOWN_FIELDS)
+    {
+        return (Smsgs_decodeStatus_badFrameControl);
+    }
+
+    /* Fields are in the order of the frame control bits, low bit first */
+    for(bit = 0; bit < SMSGS_DECODE_MAX_FIELDS; bit++)
+    {
+        uint16_t len = fieldLen[bit];
+
+        if((pView->frameControl & (1 << bit)) == 0)
+        {
+            continue;
+        }
+
+        if((1 << bit) == Smsgs_dataFields_bleSensor)
+        {
+            uint8_t dataLength;
+
+            if((offset + SMSGS_SENSOR_BLE_LEN) > pView->len)
+            {
+                return (Smsgs_decodeStatus_badLength);
+            }
+
+            dataLength = pBuf[offset + DECODE_BLE_DATA_LEN_OFFSET];
+            if(dataLength > MAX_BLE_DATA_LEN)
+            {
+                return (Smsgs_decodeStatus_badLength);
+            }
+            len = SMSGS_SENSOR_BLE_LEN + dataLength;
+        }
+        else if((1 << bit) == Smsgs_dataFields_profStats)
+        {
+            uint8_t numEntries;
+
+            if((offset + SMSGS_SENSOR_PROF_STATS_LEN) > pView->len)
+            {
+                return (Smsgs_decodeStatus_badLength);
+            }
+
+            numEntries = pBuf[offset];
+            if(numEntries > SMSGS_PROF_MAX_ENTRIES)
+            {
+                return (Smsgs_decodeStatus_badLength);
+            }
+            len = SMSGS_SENSOR_PROF_STATS_LEN
+                  + (numEntries * SMSGS_SENSOR_PROF_ENTRY_LEN);
+        }
+
+        if((offset + len) > pView->len)
+        {
+            return (Smsgs_decodeStatus_badLength);
+        }
+
+        pView->fieldOffset[bit] = offset;
+        offset += len;
+    }
+
+    if(offset != pView->len)
+    {
+        return (Smsgs_decodeStatus_badLength);
+    }
+
+    return (Smsgs_decodeStatus_success);
+}
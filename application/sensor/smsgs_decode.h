@@ -0,0 +1,231 @@
+/******************************************************************************
+
+ @file smsgs_decode.h
+
+ @brief Sensor over-the-air message decoder
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef SMSGS_DECODE_H
+#define SMSGS_DECODE_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "smsgs.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup SmsgsDecode Sensor Over-the-air Message Decoder
+ <BR>
+ Validates and decodes the over-the-air messages defined in smsgs.h. It has
+ no dependency on the MAC or the RTOS, so the same code can be used by the
+ sensor, the collector and host side tools that process recorded frames.
+ <BR>
+ Decoding is done in two steps:
+     - Smsgs_decodeView() checks the command ID, the frame control field and
+     the length of a received buffer, and records where each data field
+     starts. Nothing is copied, the view points into the caller's buffer,
+     which must stay valid while the view is used.
+     - The Smsgs_decodeXxx() functions copy the fields of a valid view into
+     the message structures of smsgs.h, when the caller needs them.
+ <BR>
+ Smsgs_decodeBatch() validates many buffers in one call.
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*! Number of data fields that can be present in a Sensor Data Message */
+#define SMSGS_DECODE_MAX_FIELDS 10
+
+/*!
+ Data fields this decoder knows how to parse, the LPSTK hall effect and
+ accelerometer fields are included even if LPSTK is not defined.
+ */
+#define SMSGS_DECODE_KNOWN_FIELDS 0x03FF
+
+/*! Decode status values */
+typedef enum
+{
+    /*! The message is valid */
+    Smsgs_decodeStatus_success = 0,
+    /*! The buffer is empty or shorter than the fixed part of the message */
+    Smsgs_decodeStatus_tooShort = 1,
+    /*! The buffer length does not match the fields of the message */
+    Smsgs_decodeStatus_badLength = 2,
+    /*! The command ID is unknown */
+    Smsgs_decodeStatus_unknownCmd = 3,
+    /*! The frame control field has a bit this decoder doesn't know */
+    Smsgs_decodeStatus_badFrameControl = 4
+} Smsgs_decodeStatus_t;
+
+/*! Zero-copy view of a received message */
+typedef struct _Smsgs_msgview_t
+{
+    /*! Result of the validation */
+    Smsgs_decodeStatus_t status;
+    /*! Command ID of the message */
+    Smsgs_cmdIds_t cmdId;
+    /*! Start of the message (the command ID) */
+    const uint8_t *pBuf;
+    /*! Length of the message */
+    uint16_t len;
+    /*!
+     Frame control field, for the messages that have one. Zero for the
+     others.
+     */
+    uint16_t frameControl;
+    /*!
+     Offset of each Sensor Data Message field in pBuf, indexed by the bit
+     position of the field in the frame control. Zero if the field is not
+     present.
+     */
+    uint16_t fieldOffset[SMSGS_DECODE_MAX_FIELDS];
+} Smsgs_msgView_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief       Validate a received message and build a view of it.
+ *
+ * @param       pBuf - pointer to the message, starting with the command ID
+ * @param       len - length of the message
+ * @param       pView - view to fill in
+ *
+ * @return      Smsgs_decodeStatus_success if the message is valid, also
+ *              stored in pView->status.
+ */
+extern Smsgs_decodeStatus_t Smsgs_decodeView(const uint8_t *pBuf,
+                                             uint16_t len,
+                                             Smsgs_msgView_t *pView);
+
+/*!
+ * @brief       Validate many received messages.
+ *
+ * @param       ppBufs - array of pointers to the messages
+ * @param       pLens - array of message lengths
+ * @param       count - number of messages
+ * @param       pViews - array of count views to fill in, the status of each
+ *                       message is in its view
+ *
+ * @return      number of valid messages
+ */
+extern uint16_t Smsgs_decodeBatch(const uint8_t * const *ppBufs,
+                                  const uint16_t *pLens, uint16_t count,
+                                  Smsgs_msgView_t *pViews);
+
+/*!
+ * @brief       Check if a field is present in a Sensor Data Message view.
+ *
+ * @param       pView - valid Smsgs_cmdIds_sensorData view
+ * @param       field - one of Smsgs_dataFields_t
+ *
+ * @return      pointer to the field in the message, NULL if not present
+ */
+extern const uint8_t *Smsgs_decodeField(const Smsgs_msgView_t *pView,
+                                        Smsgs_dataFields_t field);
+
+/*!
+ * @brief       Decode a Sensor Data Message.
+ *
+ * Only the fields set in pMsg->frameControl are written.
+ *
+ * @param       pView - valid Smsgs_cmdIds_sensorData view
+ * @param       pMsg - message to fill in
+ *
+ * @return      true if decoded, false if the view is not a valid Sensor Data
+ *              Message
+ */
+extern bool Smsgs_decodeSensorMsg(const Smsgs_msgView_t *pView,
+                                  Smsgs_sensorMsg_t *pMsg);
+
+/*!
+ * @brief       Decode a Configuration Request Message.
+ *
+ * @param       pView - valid Smsgs_cmdIds_configReq view
+ * @param       pMsg - message to fill in
+ *
+ * @return      true if decoded, false if the view is not a valid
+ *              Configuration Request Message
+ */
+extern bool Smsgs_decodeConfigReq(const Smsgs_msgView_t *pView,
+                                  Smsgs_configReqMsg_t *pMsg);
+
+/*!
+ * @brief       Decode a Configuration Response Message.
+ *
+ * @param       pView - valid Smsgs_cmdIds_configRsp view
+ * @param       pMsg - message to fill in
+ *
+ * @return      true if decoded, false if the view is not a valid
+ *              Configuration Response Message
+ */
+extern bool Smsgs_decodeConfigRsp(const Smsgs_msgView_t *pView,
+                                  Smsgs_configRspMsg_t *pMsg);
+
+/*!
+ * @brief       Decode a Fragment Message header.
+ *
+ * @param       pView - valid Smsgs_cmdIds_fragment view
+ * @param       pHdr - header to fill in
+ *
+ * @return      pointer to the fragment data, NULL if the view is not a valid
+ *              Fragment Message
+ */
+extern const uint8_t *Smsgs_decodeFragmentHdr(const Smsgs_msgView_t *pView,
+                                              Smsgs_fragmentHdr_t *pHdr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SMSGS_DECODE_H */
@@ -69,6 +69,7 @@
 #include <aon_event.h>
 #include <ioc.h>
 #include <driverlib/aon_batmon.h>
+#include <driverlib/sys_ctrl.h>
 
 #include "ti_drivers_config.h"
 
@@ -80,11 +81,13 @@
 
 #include "macconfig.h"
 #include "nvocmp.h"
+#include "nvcache.h"
 
 #include "sensor.h"
 #include "smsgs.h"
 #include "ssf.h"
 #include "ti_154stack_config.h"
+#include "prof.h"
 
 #ifdef FEATURE_NATIVE_OAD
 #include "oad_client.h"
@@ -115,6 +118,7 @@
 #define KEY_EVENT               0x0001
 #define SENSOR_UI_INPUT_EVT     0x0002
 #define SENSOR_SEND_COLLECTOR_IDENT_EVT  0x0004
+#define SSF_NV_FLUSH_EVT        0x0008
 
 /* NV Item ID - the device's network information */
 #define SSF_NV_NETWORK_INFO_ID 0x0001
@@ -142,6 +146,29 @@
 /* timeout value for poll timer initialization */
 #define SCAN_BACKOFF_TIMEOUT_VALUE  60000
 
+/*
+ Time the application clocks can expire late, in milliseconds, so that
+ expiries close to each other are handled in a single wakeup.
+ */
+#ifndef READING_CLOCK_SLACK
+#define READING_CLOCK_SLACK         1000
+#endif
+#ifndef TRICKLE_CLOCK_SLACK
+#define TRICKLE_CLOCK_SLACK         200
+#endif
+#ifndef POLL_CLOCK_SLACK
+#define POLL_CLOCK_SLACK            50
+#endif
+#ifndef SCAN_BACKOFF_CLOCK_SLACK
+#define SCAN_BACKOFF_CLOCK_SLACK    500
+#endif
+#ifndef FH_ASSOC_CLOCK_SLACK
+#define FH_ASSOC_CLOCK_SLACK        200
+#endif
+#ifndef PROVISIONING_CLOCK_SLACK
+#define PROVISIONING_CLOCK_SLACK    10
+#endif
+
 /*! NV driver item ID for reset reason */
 #define NVID_RESET {NVINTF_SYSID_APP, SSF_NV_RESET_REASON_ID, 0}
 
@@ -156,6 +183,40 @@
  */
 #define FRAME_COUNTER_SAVE_WINDOW     25
 
+/* NV items are moved ahead of a compaction when the driver is built for it */
+#if defined(NV_RESTORE) && defined(NVOCMP_BGCOMPACT) && NVOCMP_BGCOMPACT
+#define NV_COMPACT_STEPS
+#endif
+
+/*!
+ Number of NV items moved ahead of a compaction each time the application
+ has nothing else to do
+ */
+#ifndef NV_COMPACT_STEP_ITEMS
+#define NV_COMPACT_STEP_ITEMS         4
+#endif
+/*!
+ Time between two of those steps, in milliseconds, so the application
+ waits for events in between instead of keeping the CPU busy
+ */
+#ifndef NV_COMPACT_STEP_INTERVAL
+#define NV_COMPACT_STEP_INTERVAL      100
+#endif
+#ifndef NV_COMPACT_STEP_SLACK
+#define NV_COMPACT_STEP_SLACK         100
+#endif
+
+/*!
+ Time hot NV items are kept in RAM after they are written, in milliseconds.
+ Writes in this time are combined into one flash write.
+ */
+#ifndef NV_FLUSH_TIMEOUT_VALUE
+#define NV_FLUSH_TIMEOUT_VALUE        60000
+#endif
+#ifndef NV_FLUSH_CLOCK_SLACK
+#define NV_FLUSH_CLOCK_SLACK          10000
+#endif
+
 #if (USE_DMM) && !(DMM_CENTRAL)
 #define PROVISIONING_ASSOC_TIMER    1000
 #define PROVISIONING_DISASSOC_TIMER 10
@@ -246,6 +307,19 @@ static uint16_t events = 0;
 /* NV Function Pointers */
 static NVINTF_nvFuncts_t *pNV = NULL;
 
+#ifdef NV_RESTORE
+/* NV Function Pointers of the hot item cache */
+static NVINTF_nvFuncts_t nvCacheFps;
+
+/* hot item flush timer */
+static Clock_Struct nvFlushClkStruct;
+#endif
+
+#ifdef NV_COMPACT_STEPS
+/* timer of the next compaction step */
+static Clock_Struct nvCompactClkStruct;
+#endif
+
 /* The last saved frame counter */
 static uint32_t lastSavedFrameCounter = 0;
 
@@ -268,6 +342,12 @@ static Button_Handle gRightButtonHandle;
 static Button_Handle gLeftButtonHandle;
 uint32_t sensorStatusLine;
 uint32_t perStatusLine;
+uint32_t latencyStatusLine;
+#if defined(DISPLAY_PER_STATS) && defined(FEATURE_PROFILING)
+uint32_t profStatusLine;
+/* Handler shown on the profiling status line */
+static Prof_id_t profDisplayId = Prof_id_readSensors;
+#endif /* DISPLAY_PER_STATS && FEATURE_PROFILING */
 #if defined(USE_DMM) && defined(BLOCK_MODE_TEST) && !defined(CUI_DISABLE)
 uint32_t ssfStatusLineBlockModeTestState;
 
@@ -293,9 +373,21 @@ static void processPASTrickleTimeoutCallback(UArg a0);
 static void processPollTimeoutCallback(UArg a0);
 static void processScanBackoffTimeoutCallback(UArg a0);
 static void processFHAssocTimeoutCallback(UArg a0);
+#ifdef NV_RESTORE
+static void processNvFlushTimeoutCallback(UArg a0);
+static void nvCacheDirtyCallback(void);
+#endif
+#ifdef NV_COMPACT_STEPS
+static void processNvCompactTimeoutCallback(UArg a0);
+#endif
 #if (USE_DMM) && !(DMM_CENTRAL)
 static void processProvisioningCallback(UArg a0);
 #endif /* USE_DMM && !DMM_CENTRAL */
+#ifdef FEATURE_NATIVE_OAD
+static uint8_t writeOadInfo(NVINTF_stageItem write, uint16_t *pOadBlock,
+                            uint8_t *pOadImgHdr, uint8_t *pOadImgId,
+                            ApiMac_sAddr_t *pOadServerAddr);
+#endif /* FEATURE_NATIVE_OAD */
 
 #ifndef CUI_DISABLE
 static uint8_t moveCursorLeft(uint8_t col, uint8_t left_boundary, uint8_t right_boundary, uint8_t skip_space);
@@ -436,8 +528,39 @@ void Ssf_init(void *sem)
 #endif //FEATURE_NATIVE_OAD
 
 #ifdef NV_RESTORE
-    /* Save off the NV Function Pointers */
-    pNV = &Main_user1Cfg.nvFps;
+    /* Save off the NV Function Pointers, behind the hot item cache */
+    NVCACHE_loadApiPtrs(&nvCacheFps, &Main_user1Cfg.nvFps);
+    pNV = &nvCacheFps;
+
+    {
+        /* Items rewritten often, that can go back to an older value */
+        NVINTF_itemID_t id;
+
+        id.systemID = NVINTF_SYSID_APP;
+        id.itemID = SSF_NV_CONFIG_INFO_ID;
+        id.subID = 0;
+        (void)NVCACHE_addHotItem(id);
+#ifdef FEATURE_NATIVE_OAD
+        id.itemID = SSF_NV_OAD_ID;
+        (void)NVCACHE_addHotItem(id);
+#endif
+    }
+
+    UtilTimer_constructCoalesced(&nvFlushClkStruct,
+                                 processNvFlushTimeoutCallback,
+                                 NV_FLUSH_TIMEOUT_VALUE,
+                                 NV_FLUSH_CLOCK_SLACK,
+                                 false,
+                                 0);
+    NVCACHE_setDirtyCb(nvCacheDirtyCallback);
+#endif
+#ifdef NV_COMPACT_STEPS
+    UtilTimer_constructCoalesced(&nvCompactClkStruct,
+                                 processNvCompactTimeoutCallback,
+                                 NV_COMPACT_STEP_INTERVAL,
+                                 NV_COMPACT_STEP_SLACK,
+                                 false,
+                                 0);
 #endif
 
     /* Save off the semaphore */
@@ -450,7 +573,10 @@ void Ssf_init(void *sem)
     clientParams.maxStatusLines = 1;
 
 #ifdef DISPLAY_PER_STATS
+    clientParams.maxStatusLines += 2;
+#ifdef FEATURE_PROFILING
     clientParams.maxStatusLines++;
+#endif /* FEATURE_PROFILING */
 #endif /* DISPLAY_PER_STATS */
 #ifdef FEATURE_SECURE_COMMISSIONING
     clientParams.maxStatusLines++;
@@ -516,6 +642,10 @@ void Ssf_init(void *sem)
     CUI_statusLineResourceRequest(ssfCuiHndl, "Status", false, &sensorStatusLine);
 #ifdef DISPLAY_PER_STATS
     CUI_statusLineResourceRequest(ssfCuiHndl, "Sensor PER", false, &perStatusLine);
+    CUI_statusLineResourceRequest(ssfCuiHndl, "Latency p50/90/99", false, &latencyStatusLine);
+#ifdef FEATURE_PROFILING
+    CUI_statusLineResourceRequest(ssfCuiHndl, "Profile", false, &profStatusLine);
+#endif /* FEATURE_PROFILING */
 #endif
 #if defined(USE_DMM) && defined(BLOCK_MODE_TEST)
   CUI_statusLineResourceRequest(ssfCuiHndl, "BLOCK MODE TEST STATUS", false, &ssfStatusLineBlockModeTestState);
@@ -662,6 +792,20 @@ void Ssf_processEvents(void)
         Util_clearEvent(&events, SENSOR_SEND_COLLECTOR_IDENT_EVT);
     }
 
+#ifdef NV_RESTORE
+    if(events & SSF_NV_FLUSH_EVT)
+    {
+        /* Write the hot NV items to flash */
+        if(NVCACHE_flush() != NVINTF_SUCCESS)
+        {
+            /* Try again later */
+            nvCacheDirtyCallback();
+        }
+
+        Util_clearEvent(&events, SSF_NV_FLUSH_EVT);
+    }
+#endif
+
 }
 
 #ifndef CUI_DISABLE
@@ -938,35 +1082,36 @@ bool Ssf_getNetworkInfo(ApiMac_deviceDescriptor_t *pDevInfo,
  */
 void Ssf_oadInfoUpdate(uint16_t *pOadBlock, uint8_t *pOadImgHdr, uint8_t *pOadImgId, ApiMac_sAddr_t *pOadServerAddr)
 {
-    NVINTF_itemID_t id;
-
-    /* Setup NV ID */
-    id.systemID = NVINTF_SYSID_APP;
-    id.itemID = SSF_NV_OAD_ID;
-    id.subID = 0;
-    /* Write the NV item */
-    pNV->writeItem(id, sizeof(uint16_t), pOadBlock);
-
-    if(pOadImgHdr != NULL)
-    {
-        id.subID = 1;
-        /* Write the NV item */
-        pNV->writeItem(id, sizeof(uint8_t) * OADProtocol_IMAGE_ID_LEN, pOadImgHdr);
-    }
-
-    if(pOadImgId != NULL)
-    {
-        id.subID = 2;
-        /* Write the NV item */
-        pNV->writeItem(id, sizeof(uint8_t), pOadImgId);
+    /*
+     The items describe one download, so they are written together when the
+     driver has transactions: a reset in between must not mix the block of
+     one image with the header of another. The block number alone, written
+     for every block, stays in its hot cache entry until the next flush.
+     */
+    if(((pOadImgHdr != NULL) || (pOadImgId != NULL) || (pOadServerAddr != NULL))
+       && (pNV->beginTxn != NULL) && (pNV->stageItem != NULL)
+       && (pNV->commitTxn != NULL) && (pNV->abortTxn != NULL)
+       && (pNV->beginTxn() == NVINTF_SUCCESS))
+    {
+        if(writeOadInfo(pNV->stageItem, pOadBlock, pOadImgHdr, pOadImgId,
+                        pOadServerAddr) != NVINTF_SUCCESS)
+        {
+            (void)pNV->abortTxn();
+        }
+        else if(pNV->commitTxn() == NVINTF_SUCCESS)
+        {
+            /* The cached block number is loaded again from the commit */
+            return;
+        }
     }
 
-    if(pOadServerAddr != NULL)
-    {
-        id.subID = 3;
-        /* Write the NV item */
-        pNV->writeItem(id, sizeof(ApiMac_sAddr_t), pOadServerAddr);
-    }
+    /*
+     The block number alone, no transaction, or it failed and nothing was
+     written: write the items one at a time, which also puts the block number
+     back in its cache entry
+     */
+    (void)writeOadInfo(pNV->writeItem, pOadBlock, pOadImgHdr, pOadImgId,
+                       pOadServerAddr);
 }
 
 /*!
@@ -1144,10 +1289,10 @@ void Ssf_sensorReadingUpdate(Smsgs_sensorMsg_t *pMsg)
 void Ssf_initializeReadingClock(void)
 {
     /* Initialize the timers needed for this application */
-    readingClkHandle = UtilTimer_construct(&readingClkStruct,
+    readingClkHandle = UtilTimer_constructCoalesced(&readingClkStruct,
                                         processReadingTimeoutCallback,
                                         READING_INIT_TIMEOUT_VALUE,
-                                        0,
+                                        READING_CLOCK_SLACK,
                                         false,
                                         0);
 }
@@ -1224,17 +1369,17 @@ void Ssf_free(void *ptr)
 void Ssf_initializeTrickleClock(void)
 {
     /* Initialize trickle timer */
-    tricklePASClkHandle = UtilTimer_construct(&tricklePASClkStruct,
+    tricklePASClkHandle = UtilTimer_constructCoalesced(&tricklePASClkStruct,
                                          processPASTrickleTimeoutCallback,
                                          TRICKLE_TIMEOUT_VALUE,
-                                         0,
+                                         TRICKLE_CLOCK_SLACK,
                                          false,
                                          0);
 
-    tricklePCSClkHandle = UtilTimer_construct(&tricklePCSClkStruct,
+    tricklePCSClkHandle = UtilTimer_constructCoalesced(&tricklePCSClkStruct,
                                          processPCSTrickleTimeoutCallback,
                                          TRICKLE_TIMEOUT_VALUE,
-                                         0,
+                                         TRICKLE_CLOCK_SLACK,
                                          false,
                                          0);
 }
@@ -1296,10 +1441,10 @@ void Ssf_setTrickleClock(uint16_t trickleTime, uint8_t frameType)
 void Ssf_initializePollClock(void)
 {
     /* Initialize the timers needed for this application */
-    pollClkHandle = UtilTimer_construct(&pollClkStruct,
+    pollClkHandle = UtilTimer_constructCoalesced(&pollClkStruct,
                                      processPollTimeoutCallback,
                                      POLL_TIMEOUT_VALUE,
-                                     0,
+                                     POLL_CLOCK_SLACK,
                                      false,
                                      0);
 }
@@ -1360,10 +1505,10 @@ uint32_t Ssf_getPollClock(void)
 void Ssf_initializeScanBackoffClock(void)
 {
     /* Initialize the timers needed for this application */
-    scanBackoffClkHandle = UtilTimer_construct(&scanBackoffClkStruct,
+    scanBackoffClkHandle = UtilTimer_constructCoalesced(&scanBackoffClkStruct,
                                            processScanBackoffTimeoutCallback,
                                            SCAN_BACKOFF_TIMEOUT_VALUE,
-                                           0,
+                                           SCAN_BACKOFF_CLOCK_SLACK,
                                            false,
                                            0);
 }
@@ -1411,10 +1556,10 @@ void Ssf_stopScanBackoffClock(void)
 void Ssf_initializeFHAssocClock(void)
 {
     /* Initialize the timers needed for this application */
-    fhAssocClkHandle = UtilTimer_construct(&fhAssocClkStruct,
+    fhAssocClkHandle = UtilTimer_constructCoalesced(&fhAssocClkStruct,
                                        processFHAssocTimeoutCallback,
                                        FH_ASSOC_TIMER,
-                                        0,
+                                        FH_ASSOC_CLOCK_SLACK,
                                         false,
                                         0);
 }
@@ -1456,10 +1601,10 @@ void Ssf_setFHAssocClock(uint32_t fhAssocTime)
 void Ssf_initializeProvisioningClock(void)
 {
     /* Initialize the timers needed for this application */
-    provisioningClkHandle = UtilTimer_construct(&provisioningClkStruct,
+    provisioningClkHandle = UtilTimer_constructCoalesced(&provisioningClkStruct,
                                        processProvisioningCallback,
                                        FH_ASSOC_TIMER,
-                                        0,
+                                        PROVISIONING_CLOCK_SLACK,
                                         false,
                                         0);
 }
@@ -1642,6 +1787,21 @@ void Ssf_assertInd(uint8_t reason)
     }
 }
 
+/*!
+ Reset the device
+
+ Public function defined in ssf.h
+ */
+void Ssf_systemReset(void)
+{
+#ifdef NV_RESTORE
+    /* Keep the hot NV items across the reset */
+    (void)NVCACHE_flush();
+#endif
+
+    SysCtrlSystemReset();
+}
+
 /*!
 
  Clear network information in NV
@@ -1714,6 +1874,30 @@ void Ssf_clearAllNVItems(void)
     }
 }
 
+/*!
+ Move some NV items ahead of the next compaction
+
+ Public function defined in ssf.h
+ */
+bool Ssf_compactNvStep(void)
+{
+#ifdef NV_COMPACT_STEPS
+    if(UtilTimer_isActive(&nvCompactClkStruct) == true)
+    {
+        /* Not time for the next step yet */
+        return (true);
+    }
+
+    if(NVOCMP_compactStep(NV_COMPACT_STEP_ITEMS) == true)
+    {
+        /* Wake up the application for the next step */
+        UtilTimer_start(&nvCompactClkStruct);
+        return (true);
+    }
+#endif
+    return (false);
+}
+
 /*!
  Read the on-board temperature sensors
 
@@ -1911,6 +2095,58 @@ void Ssf_SmPasskeyEntry(SM_passkeyEntry_t passkeyAction)
  Local Functions
  *****************************************************************************/
 
+#ifdef FEATURE_NATIVE_OAD
+/*!
+ * @brief       Write or stage the OAD info items.
+ *
+ * @param       write - pNV->writeItem or pNV->stageItem
+ * @param       pOadBlock - block number
+ * @param       pOadImgHdr - image header, NULL to leave it
+ * @param       pOadImgId - image ID, NULL to leave it
+ * @param       pOadServerAddr - server address, NULL to leave it
+ *
+ * @return      NVINTF_SUCCESS or the first failure
+ */
+static uint8_t writeOadInfo(NVINTF_stageItem write, uint16_t *pOadBlock,
+                            uint8_t *pOadImgHdr, uint8_t *pOadImgId,
+                            ApiMac_sAddr_t *pOadServerAddr)
+{
+    NVINTF_itemID_t id;
+    uint8_t status;
+
+    /* Setup NV ID */
+    id.systemID = NVINTF_SYSID_APP;
+    id.itemID = SSF_NV_OAD_ID;
+    id.subID = 0;
+    /* Write the NV item */
+    status = write(id, sizeof(uint16_t), pOadBlock);
+
+    if((status == NVINTF_SUCCESS) && (pOadImgHdr != NULL))
+    {
+        id.subID = 1;
+        /* Write the NV item */
+        status = write(id, sizeof(uint8_t) * OADProtocol_IMAGE_ID_LEN,
+                       pOadImgHdr);
+    }
+
+    if((status == NVINTF_SUCCESS) && (pOadImgId != NULL))
+    {
+        id.subID = 2;
+        /* Write the NV item */
+        status = write(id, sizeof(uint8_t), pOadImgId);
+    }
+
+    if((status == NVINTF_SUCCESS) && (pOadServerAddr != NULL))
+    {
+        id.subID = 3;
+        /* Write the NV item */
+        status = write(id, sizeof(ApiMac_sAddr_t), pOadServerAddr);
+    }
+
+    return (status);
+}
+#endif /* FEATURE_NATIVE_OAD */
+
 #ifndef DMM_CENTRAL
 /*!
  * @brief   Reading timeout handler function.
@@ -1928,6 +2164,49 @@ static void processReadingTimeoutCallback(UArg a0)
 }
 #endif /* !DMM_CENTRAL */
 
+#ifdef NV_RESTORE
+/*!
+ * @brief       NV flush timeout handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processNvFlushTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    events |= SSF_NV_FLUSH_EVT;
+
+    /* Wake up the application thread when it waits for clock event */
+    Semaphore_post(sensorSem);
+}
+
+/*!
+ * @brief       Called when a hot NV item is written, starts the flush timer
+ */
+static void nvCacheDirtyCallback(void)
+{
+    if(UtilTimer_isActive(&nvFlushClkStruct) == false)
+    {
+        UtilTimer_start(&nvFlushClkStruct);
+    }
+}
+#endif
+
+#ifdef NV_COMPACT_STEPS
+/*!
+ * @brief       NV compaction step timeout handler function.
+ *
+ * @param       a0 - ignored
+ */
+static void processNvCompactTimeoutCallback(UArg a0)
+{
+    (void)a0; /* Parameter is not used */
+
+    /* Wake up the application thread, the next step runs when it is idle */
+    Semaphore_post(sensorSem);
+}
+#endif
+
 /*!
  * @brief       Key event handler function
  *
@@ -2033,6 +2312,53 @@ void Ssf_displayPerStats(Smsgs_msgStatsField_t* pstats)
 
     CUI_statusLinePrintf(ssfCuiHndl, perStatusLine, "%d.%03d%%", (per / 1000), (per % 1000));
 }
+
+/*!
+ * @brief       The application calls this function to print the message latency percentiles to the display.
+ */
+void Ssf_displayLatencyStats(void)
+{
+    Smsgs_latencyStatsField_t data;
+    Smsgs_latencyStatsField_t track;
+    Smsgs_latencyStatsField_t config;
+
+    Sensor_getLatencyStats(Sensor_latencyType_sensorData, &data);
+    Sensor_getLatencyStats(Sensor_latencyType_trackingRsp, &track);
+    Sensor_getLatencyStats(Sensor_latencyType_configRsp, &config);
+
+    CUI_statusLinePrintf(ssfCuiHndl, latencyStatusLine,
+                         "Data %d/%d/%d Trk %d/%d/%d Cfg %d/%d/%d ms",
+                         data.p50, data.p90, data.p99,
+                         track.p50, track.p90, track.p99,
+                         config.p50, config.p90, config.p99);
+}
+
+#ifdef FEATURE_PROFILING
+/*!
+ * @brief       The application calls this function to print the handler profiling to the display, one handler per call.
+ */
+void Ssf_displayProfStats(void)
+{
+    Prof_stats_t stats;
+    uint32_t meanCycles = 0;
+
+    Prof_getStats(profDisplayId, &stats);
+    if(stats.count != 0)
+    {
+        meanCycles = (uint32_t)(stats.totalCycles / stats.count);
+    }
+
+    CUI_statusLinePrintf(ssfCuiHndl, profStatusLine,
+                         "%s n=%lu min/mean/max %lu/%lu/%lu cyc",
+                         Prof_getName(profDisplayId),
+                         (unsigned long)stats.count,
+                         (unsigned long)stats.minCycles,
+                         (unsigned long)meanCycles,
+                         (unsigned long)stats.maxCycles);
+
+    profDisplayId = (Prof_id_t)((profDisplayId + 1) % Prof_id_max);
+}
+#endif /* FEATURE_PROFILING */
 #endif /* DISPLAY_PER_STATS */
 
 /**
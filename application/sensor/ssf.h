@@ -387,6 +387,13 @@ extern void Ssf_displayError(const char *pTxt, uint8_t code);
  */
 extern void Ssf_assertInd(uint8_t reason);
 
+/*!
+ * @brief       Write the hot NV items held in RAM to flash and reset the
+ *              device. Every intentional reset goes through this function,
+ *              a reset without it loses the last writes of those items.
+ */
+extern void Ssf_systemReset(void);
+
 /*!
  * @brief       The application calls this function to clear the network
  *              information from NV
@@ -398,6 +405,19 @@ extern void Ssf_clearNetworkInfo(void);
  */
 extern void Ssf_clearAllNVItems(void);
 
+/*!
+ * @brief       The application calls this function when it has nothing else
+ *              to do, so NV items are moved ahead of the next compaction and
+ *              NV writes don't have to wait for it. Only does something when
+ *              the NV driver is built with NVOCMP_BGCOMPACT. A step is taken
+ *              every NV_COMPACT_STEP_INTERVAL at most, a clock wakes the
+ *              application for the next one, so it can wait for events in
+ *              between.
+ *
+ * @return      true if there is more to move, false if not
+ */
+extern bool Ssf_compactNvStep(void);
+
 /*!
  * @brief       The application calls this function to get the
  *              temperature from the onboard sensor
@@ -443,6 +463,18 @@ extern void Ssf_OffLED(void);
  * @brief       The application calls this function to print updated PER stats to the display.
  */
 extern void Ssf_displayPerStats(Smsgs_msgStatsField_t* stats);
+
+/*!
+ * @brief       The application calls this function to print the message latency percentiles to the display.
+ */
+extern void Ssf_displayLatencyStats(void);
+
+#ifdef FEATURE_PROFILING
+/*!
+ * @brief       The application calls this function to print the handler profiling to the display, one handler per call.
+ */
+extern void Ssf_displayProfStats(void);
+#endif /* FEATURE_PROFILING */
 #endif /* DISPLAY_PER_STATS */
 
 #if (USE_DMM) && !(DMM_CENTRAL)
@@ -52,7 +52,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 
-#ifndef __unix__
+#if !defined(__unix__) || defined(OSAL_PORT_POSIX)
 #include <ti/drivers/dpl/HwiP.h>
 #else
 #include "stdlib.h"
@@ -336,7 +336,7 @@ uint8_t *Util_bufferUint32(uint8_t *pBuf, uint32_t val)
  */
 void Util_clearEvent(uint16_t *pEvent, uint16_t event)
 {
-#ifndef __unix__
+#if !defined(__unix__) || defined(OSAL_PORT_POSIX)
     uint32_t key;
 
     /* Enter critical section */
@@ -349,7 +349,7 @@ void Util_clearEvent(uint16_t *pEvent, uint16_t event)
     *pEvent &= ~(event);
 
     /* Exit critical section */
-#ifndef __unix__
+#if !defined(__unix__) || defined(OSAL_PORT_POSIX)
     HwiP_restore(key);
 #else
     _ATOMIC_global_unlock();
@@ -363,7 +363,7 @@ void Util_clearEvent(uint16_t *pEvent, uint16_t event)
  */
 void Util_setEvent(uint16_t *pEvent, uint16_t event)
 {
-#ifndef __unix__
+#if !defined(__unix__) || defined(OSAL_PORT_POSIX)
     uint32_t key;
 
     /* Enter critical section */
@@ -376,7 +376,7 @@ void Util_setEvent(uint16_t *pEvent, uint16_t event)
     *pEvent |= event;
 
     /* Exit critical section */
-#ifndef __unix__
+#if !defined(__unix__) || defined(OSAL_PORT_POSIX)
     HwiP_restore(key);
 #else
     _ATOMIC_global_unlock();
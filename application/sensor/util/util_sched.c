@@ -0,0 +1,241 @@
+/******************************************************************************
+
+ @file util_sched.c
+
+ @brief Priority event scheduler
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+
+#include <string.h>
+
+#include <ti/sysbios/knl/Clock.h>
+
+#include "mac_util.h"
+#include "util_sched.h"
+
+/******************************************************************************
+ Constants and Typedefs
+ *****************************************************************************/
+
+/* Registered event */
+typedef struct
+{
+    /* Event bit */
+    uint16_t event;
+    /* Priority, lower values run first */
+    uint8_t priority;
+    /* true once the scheduler has seen the event pending */
+    bool pending;
+    /* Tick count when the event was first seen pending */
+    uint32_t pendingTicks;
+    /* Event handler */
+    UtilSched_handlerFp_t pfnHandler;
+    /* Queueing delay statistics */
+    UtilSched_stats_t stats;
+} schedEntry_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Event bit mask */
+static uint16_t *pSchedEvents = NULL;
+
+/* Registered events, sorted by priority */
+static schedEntry_t schedTable[UTIL_SCHED_MAX_EVENTS];
+
+/* Number of registered events */
+static uint8_t schedNumEntries = 0;
+
+/* Events with a registered handler */
+static uint16_t schedRegistered = 0;
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Initialize the scheduler.
+
+ Public function defined in util_sched.h
+ */
+void UtilSched_init(uint16_t *pEvents)
+{
+    pSchedEvents = pEvents;
+    schedNumEntries = 0;
+    schedRegistered = 0;
+    memset(schedTable, 0, sizeof(schedTable));
+}
+
+/*!
+ Register the handler of an event.
+
+ Public function defined in util_sched.h
+ */
+bool UtilSched_register(uint16_t event, uint8_t priority,
+                        UtilSched_handlerFp_t pfnHandler)
+{
+    uint8_t i;
+
+    if((schedNumEntries >= UTIL_SCHED_MAX_EVENTS) || (pfnHandler == NULL)
+       || (event == 0) || (event & (event - 1)) || (schedRegistered & event))
+    {
+        return (false);
+    }
+
+    /* Keep the table sorted, after the entries of the same priority */
+    i = schedNumEntries;
+    while((i > 0) && (schedTable[i - 1].priority > priority))
+    {
+        schedTable[i] = schedTable[i - 1];
+        i--;
+    }
+
+    memset(&schedTable[i], 0, sizeof(schedEntry_t));
+    schedTable[i].event = event;
+    schedTable[i].priority = priority;
+    schedTable[i].pfnHandler = pfnHandler;
+
+    schedNumEntries++;
+    schedRegistered |= event;
+
+    return (true);
+}
+
+/*!
+ Run the highest priority pending event.
+
+ Public function defined in util_sched.h
+ */
+bool UtilSched_run(void)
+{
+    uint16_t events;
+    uint32_t now;
+    schedEntry_t *pRun = NULL;
+    uint8_t i;
+
+    if(pSchedEvents == NULL)
+    {
+        return (false);
+    }
+
+    events = *pSchedEvents & schedRegistered;
+    if(events == 0)
+    {
+        return (false);
+    }
+
+    now = Clock_getTicks();
+
+    for(i = 0; i < schedNumEntries; i++)
+    {
+        schedEntry_t *pEntry = &schedTable[i];
+
+        if(events & pEntry->event)
+        {
+            /* Start the queueing delay of newly set events */
+            if(pEntry->pending == false)
+            {
+                pEntry->pending = true;
+                pEntry->pendingTicks = now;
+            }
+
+            /*
+             Highest priority first, and the longest pending of equal
+             priorities so an event that keeps setting itself can't starve
+             the others.
+             */
+            if((pRun == NULL)
+               || ((pEntry->priority == pRun->priority)
+                   && ((int32_t)(pEntry->pendingTicks - pRun->pendingTicks)
+                       < 0)))
+            {
+                pRun = pEntry;
+            }
+        }
+    }
+
+    /* Clear first, so the handler can set the event again */
+    Util_clearEvent(pSchedEvents, pRun->event);
+    pRun->pending = false;
+
+    {
+        UtilSched_stats_t *pStats = &pRun->stats;
+        uint32_t delay = ((now - pRun->pendingTicks) * Clock_tickPeriod)
+                        / 1000;
+
+        pStats->count++;
+        pStats->totalDelay += delay;
+        if(delay > pStats->maxDelay)
+        {
+            pStats->maxDelay = delay;
+        }
+    }
+
+    pRun->pfnHandler();
+
+    return (true);
+}
+
+/*!
+ Get the queueing delay statistics of an event.
+
+ Public function defined in util_sched.h
+ */
+bool UtilSched_getStats(uint16_t event, UtilSched_stats_t *pStats)
+{
+    uint8_t i;
+
+    for(i = 0; i < schedNumEntries; i++)
+    {
+        if(schedTable[i].event == event)
+        {
+            memcpy(pStats, &schedTable[i].stats, sizeof(UtilSched_stats_t));
+            return (true);
+        }
+    }
+
+    return (false);
+}
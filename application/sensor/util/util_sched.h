@@ -0,0 +1,163 @@
+/******************************************************************************
+
+ @file util_sched.h
+
+ @brief Priority event scheduler
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef UtilSched_H
+#define UtilSched_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup Sched Event Scheduler
+ <BR>
+ Run-to-completion scheduler for the events of a task's event bit mask.
+ <BR>
+ A handler and a priority are registered for each event. Every call to
+ UtilSched_run() clears the highest priority pending event and calls its
+ handler, so the caller can do other work, like processing MAC messages,
+ between two events. Events that have no registered handler are left in
+ the bit mask.
+ <BR>
+ The time from the scheduler first seeing an event pending to the call of
+ its handler is recorded for each event.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup Sched
+ * @{
+ */
+
+/*! Maximum number of events, one per bit of the event mask */
+#define UTIL_SCHED_MAX_EVENTS 16
+
+/*! Highest priority */
+#define UTIL_SCHED_PRIORITY_HIGHEST 0
+
+/*! Lowest priority */
+#define UTIL_SCHED_PRIORITY_LOWEST 255
+
+/*! Event handler */
+typedef void (*UtilSched_handlerFp_t)(void);
+
+/*! Event queueing delay statistics */
+typedef struct
+{
+    /*! Number of times the handler was called */
+    uint32_t count;
+    /*! Sum of the queueing delays, in milliseconds */
+    uint32_t totalDelay;
+    /*! Largest queueing delay, in milliseconds */
+    uint32_t maxDelay;
+} UtilSched_stats_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Initialize the scheduler.
+ *
+ * @param   pEvents - pointer to the event bit mask to schedule
+ */
+extern void UtilSched_init(uint16_t *pEvents);
+
+/*!
+ * @brief   Register the handler of an event.
+ *
+ * Events with the same priority run in the order they were set, or in the
+ * order they were registered if set at the same time.
+ *
+ * @param   event - event bit
+ * @param   priority - UTIL_SCHED_PRIORITY_HIGHEST (runs first) to
+ *                     UTIL_SCHED_PRIORITY_LOWEST
+ * @param   pfnHandler - function called when the event is set
+ *
+ * @return  true if registered, false if the table is full or the event is
+ *          not a single bit
+ */
+extern bool UtilSched_register(uint16_t event, uint8_t priority,
+                               UtilSched_handlerFp_t pfnHandler);
+
+/*!
+ * @brief   Run the highest priority pending event.
+ *
+ * The event is cleared before its handler is called, so the handler can
+ * set it again.
+ *
+ * @return  true if a handler was called, false if no registered event was
+ *          pending
+ */
+extern bool UtilSched_run(void);
+
+/*!
+ * @brief   Get the queueing delay statistics of an event.
+ *
+ * @param   event - event bit
+ * @param   pStats - place to put the statistics
+ *
+ * @return  true if the event is registered, false if not
+ */
+extern bool UtilSched_getStats(uint16_t event, UtilSched_stats_t *pStats);
+
+/*! @} end group Sched */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UtilSched_H */
@@ -54,6 +54,7 @@
 #include <stdbool.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Queue.h>
+#include <ti/drivers/dpl/HwiP.h>
 
 #include "util_timer.h"
 
@@ -71,6 +72,46 @@ typedef struct _queueRec_
     uint8_t *pData;      /* pointer to app data */
 } queueRec_t;
 
+/* Coalesced clock */
+typedef struct
+{
+    /* Clock instance, NULL if the entry is free */
+    Clock_Struct *pClock;
+    /* Application callback and argument */
+    Clock_FuncPtr pfnCallback;
+    UArg arg;
+    /* Requested timeout, in ticks */
+    uint32_t timeout;
+    /* Time the clock can expire late, in ticks */
+    uint32_t slack;
+    /* Earliest expiry tick of the running clock */
+    uint32_t deadline;
+    /* Actual expiry tick of the running clock */
+    uint32_t expiry;
+} coalescedClock_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Coalesced clocks */
+static coalescedClock_t coalescedClocks[UTIL_TIMER_MAX_COALESCED];
+
+/* Wakeup statistics */
+static UtilTimer_wakeupStats_t wakeupStats;
+
+/* Tick of the last coalesced clock expiry */
+static uint32_t lastExpiryTick;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static coalescedClock_t *findCoalesced(Clock_Handle handle);
+static bool canMoveGroup(uint32_t expiry, uint32_t newExpiry);
+static void moveGroup(uint32_t now, uint32_t expiry, uint32_t newExpiry);
+static void startCoalesced(coalescedClock_t *pEntry);
+static void coalescedCallback(UArg arg);
+
 /******************************************************************************
  Public Functions
  *****************************************************************************/
@@ -111,6 +152,58 @@ Clock_Handle UtilTimer_construct(Clock_Struct *pClock, Clock_FuncPtr clockCB,
     return Clock_handle(pClock);
 }
 
+/*!
+ Initialize a TIRTOS Timer/Clock instance that coalesces its expiry.
+
+ Public function defined in util_timer.h
+ */
+Clock_Handle UtilTimer_constructCoalesced(Clock_Struct *pClock,
+                                          Clock_FuncPtr clockCB,
+                                          uint32_t clockDuration,
+                                          uint32_t slack,
+                                          uint8_t startFlag,
+                                          UArg arg)
+{
+    coalescedClock_t *pEntry = NULL;
+    uint8_t i;
+
+    /* Reuse the entry of a clock constructed again */
+    for(i = 0; i < UTIL_TIMER_MAX_COALESCED; i++)
+    {
+        if(coalescedClocks[i].pClock == pClock)
+        {
+            pEntry = &coalescedClocks[i];
+            break;
+        }
+        if((pEntry == NULL) && (coalescedClocks[i].pClock == NULL))
+        {
+            pEntry = &coalescedClocks[i];
+        }
+    }
+
+    if(pEntry == NULL)
+    {
+        return (NULL);
+    }
+
+    pEntry->pClock = pClock;
+    pEntry->pfnCallback = clockCB;
+    pEntry->arg = arg;
+    pEntry->timeout = clockDuration * (1000 / Clock_tickPeriod);
+    pEntry->slack = slack * (1000 / Clock_tickPeriod);
+
+    /* The clock calls back through the entry to count the wakeups */
+    UtilTimer_construct(pClock, coalescedCallback, clockDuration, 0, false,
+                        (UArg)pEntry);
+
+    if(startFlag)
+    {
+        startCoalesced(pEntry);
+    }
+
+    return Clock_handle(pClock);
+}
+
 /*!
  Start a timer/clock.
 
@@ -119,6 +212,13 @@ Clock_Handle UtilTimer_construct(Clock_Struct *pClock, Clock_FuncPtr clockCB,
 void UtilTimer_start(Clock_Struct *pClock)
 {
     Clock_Handle handle = Clock_handle(pClock);
+    coalescedClock_t *pEntry = findCoalesced(handle);
+
+    if(pEntry != NULL)
+    {
+        startCoalesced(pEntry);
+        return;
+    }
 
     /* Start clock instance */
     Clock_start(handle);
@@ -157,6 +257,13 @@ void UtilTimer_stop(Clock_Struct *pClock)
  */
 void UtilTimer_setTimeout(Clock_Handle handle, uint32_t timeout)
 {
+    coalescedClock_t *pEntry = findCoalesced(handle);
+
+    if(pEntry != NULL)
+    {
+        pEntry->timeout = timeout * UtilTimer_MS_ADJUSTMENT;
+    }
+
     Clock_setTimeout(handle, (timeout * UtilTimer_MS_ADJUSTMENT));
 }
 
@@ -170,8 +277,30 @@ void UtilTimer_setTimeout(Clock_Handle handle, uint32_t timeout)
 uint32_t UtilTimer_getTimeout(Clock_Handle handle)
 {
     uint32_t timeout;
-
-    timeout = Clock_getTimeout(handle);
+    coalescedClock_t *pEntry = findCoalesced(handle);
+
+    if(pEntry != NULL)
+    {
+        uintptr_t key = HwiP_disable();
+
+        /*
+         The clock timeout may have been moved later, report the ticks left
+         to the earliest expiry, like Clock_getTimeout() does for a running
+         clock, or the requested timeout if it is stopped.
+         */
+        timeout = pEntry->timeout;
+        if(Clock_isActive(handle))
+        {
+            int32_t left = (int32_t)(pEntry->deadline - Clock_getTicks());
+
+            timeout = (left > 0) ? (uint32_t)left : 0;
+        }
+        HwiP_restore(key);
+    }
+    else
+    {
+        timeout = Clock_getTimeout(handle);
+    }
 
     return (timeout / UtilTimer_MS_ADJUSTMENT);
 }
@@ -186,5 +315,228 @@ uint32_t UtilTimer_getTimeout(Clock_Handle handle)
  */
 void UtilTimer_setFunc(Clock_Handle handle, Clock_FuncPtr fxn, UArg arg)
 {
+    coalescedClock_t *pEntry = findCoalesced(handle);
+
+    if(pEntry != NULL)
+    {
+        uintptr_t key = HwiP_disable();
+
+        pEntry->pfnCallback = fxn;
+        pEntry->arg = arg;
+        HwiP_restore(key);
+        return;
+    }
+
     Clock_setFunc(handle, fxn, arg);
 }
+
+/*!
+ Get the wakeup statistics of the coalesced clocks.
+
+ Public function defined in util_timer.h
+ */
+void UtilTimer_getWakeupStats(UtilTimer_wakeupStats_t *pStats)
+{
+    uintptr_t key = HwiP_disable();
+
+    memcpy(pStats, &wakeupStats, sizeof(UtilTimer_wakeupStats_t));
+    HwiP_restore(key);
+}
+
+/*!
+ Clear the wakeup statistics of the coalesced clocks.
+
+ Public function defined in util_timer.h
+ */
+void UtilTimer_resetWakeupStats(void)
+{
+    uintptr_t key = HwiP_disable();
+
+    memset(&wakeupStats, 0, sizeof(UtilTimer_wakeupStats_t));
+    HwiP_restore(key);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Find the entry of a coalesced clock.
+ *
+ * @param   handle - clock handle
+ *
+ * @return  entry of the clock, NULL if not a coalesced clock
+ */
+static coalescedClock_t *findCoalesced(Clock_Handle handle)
+{
+    uint8_t i;
+
+    for(i = 0; i < UTIL_TIMER_MAX_COALESCED; i++)
+    {
+        if((coalescedClocks[i].pClock != NULL)
+           && (Clock_handle(coalescedClocks[i].pClock) == handle))
+        {
+            return (&coalescedClocks[i]);
+        }
+    }
+
+    return (NULL);
+}
+
+/*!
+ * @brief   Check if all the running clocks that expire on a tick can expire
+ *          later, within their slack.
+ *
+ * @param   expiry - current expiry tick of the clocks
+ * @param   newExpiry - later expiry tick
+ *
+ * @return  true if all the clocks can be moved
+ */
+static bool canMoveGroup(uint32_t expiry, uint32_t newExpiry)
+{
+    uint8_t i;
+
+    for(i = 0; i < UTIL_TIMER_MAX_COALESCED; i++)
+    {
+        coalescedClock_t *pEntry = &coalescedClocks[i];
+
+        if((pEntry->pClock != NULL) && (pEntry->expiry == expiry)
+           && Clock_isActive(Clock_handle(pEntry->pClock))
+           && ((int32_t)(newExpiry - (pEntry->deadline + pEntry->slack)) > 0))
+        {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+/*!
+ * @brief   Move all the running clocks that expire on a tick to a later
+ *          tick.
+ *
+ * @param   now - current tick
+ * @param   expiry - current expiry tick of the clocks
+ * @param   newExpiry - later expiry tick
+ */
+static void moveGroup(uint32_t now, uint32_t expiry, uint32_t newExpiry)
+{
+    uint8_t i;
+
+    for(i = 0; i < UTIL_TIMER_MAX_COALESCED; i++)
+    {
+        coalescedClock_t *pEntry = &coalescedClocks[i];
+
+        if((pEntry->pClock != NULL) && (pEntry->expiry == expiry)
+           && Clock_isActive(Clock_handle(pEntry->pClock)))
+        {
+            Clock_Handle handle = Clock_handle(pEntry->pClock);
+
+            Clock_stop(handle);
+            Clock_setTimeout(handle, newExpiry - now);
+            Clock_start(handle);
+            pEntry->expiry = newExpiry;
+            wakeupStats.coalesced++;
+        }
+    }
+}
+
+/*!
+ * @brief   Start a coalesced clock.
+ *
+ * The clock expires on the earliest expiry of another running clock that
+ * falls within its slack. If there is none, running clocks that expire
+ * before it and whose slack reaches its deadline are moved to expire with
+ * it instead.
+ *
+ * @param   pEntry - coalesced clock
+ */
+static void startCoalesced(coalescedClock_t *pEntry)
+{
+    Clock_Handle handle = Clock_handle(pEntry->pClock);
+    coalescedClock_t *pJoin = NULL;
+    uint32_t now;
+    uint8_t i;
+    uintptr_t key;
+
+    key = HwiP_disable();
+
+    if(Clock_isActive(handle))
+    {
+        Clock_stop(handle);
+    }
+
+    now = Clock_getTicks();
+    /* A one-shot clock needs a timeout of at least one tick */
+    pEntry->deadline = now + ((pEntry->timeout != 0) ? pEntry->timeout : 1);
+    pEntry->expiry = pEntry->deadline;
+
+    for(i = 0; i < UTIL_TIMER_MAX_COALESCED; i++)
+    {
+        coalescedClock_t *pOther = &coalescedClocks[i];
+
+        if((pOther == pEntry) || (pOther->pClock == NULL)
+           || !Clock_isActive(Clock_handle(pOther->pClock)))
+        {
+            continue;
+        }
+
+        if(((int32_t)(pOther->expiry - pEntry->deadline) >= 0)
+           && ((int32_t)(pOther->expiry - (pEntry->deadline + pEntry->slack))
+               <= 0)
+           && ((pJoin == NULL)
+               || ((int32_t)(pOther->expiry - pJoin->expiry) < 0)))
+        {
+            pJoin = pOther;
+        }
+    }
+
+    if(pJoin != NULL)
+    {
+        pEntry->expiry = pJoin->expiry;
+        wakeupStats.coalesced++;
+    }
+    else
+    {
+        for(i = 0; i < UTIL_TIMER_MAX_COALESCED; i++)
+        {
+            coalescedClock_t *pOther = &coalescedClocks[i];
+
+            if((pOther != pEntry) && (pOther->pClock != NULL)
+               && Clock_isActive(Clock_handle(pOther->pClock))
+               && ((int32_t)(pOther->expiry - pEntry->deadline) < 0)
+               && canMoveGroup(pOther->expiry, pEntry->deadline))
+            {
+                moveGroup(now, pOther->expiry, pEntry->deadline);
+            }
+        }
+    }
+
+    Clock_setTimeout(handle, pEntry->expiry - now);
+    Clock_start(handle);
+
+    HwiP_restore(key);
+}
+
+/*!
+ * @brief   Expiry callback of the coalesced clocks.
+ *
+ * @param   arg - coalesced clock entry
+ */
+static void coalescedCallback(UArg arg)
+{
+    coalescedClock_t *pEntry = (coalescedClock_t *)arg;
+    uint32_t now = Clock_getTicks();
+
+    wakeupStats.expiries++;
+    if((wakeupStats.wakeups == 0) || (now != lastExpiryTick))
+    {
+        wakeupStats.wakeups++;
+        lastExpiryTick = now;
+    }
+
+    if(pEntry->pfnCallback != NULL)
+    {
+        pEntry->pfnCallback(pEntry->arg);
+    }
+}
@@ -63,6 +63,16 @@ extern "C"
  <BR>
  Timer/Clock functions.
  <BR>
+ One-shot clocks constructed with UtilTimer_constructCoalesced() declare a
+ slack, the time they can expire late without harm. When such a clock is
+ started, its expiry is moved within its slack to the expiry of another
+ coalesced clock, or the other clock is moved within its own slack to this
+ one, so both are handled in a single wakeup from standby.
+ UtilTimer_start(), UtilTimer_setTimeout(), UtilTimer_getTimeout() and
+ UtilTimer_setFunc() work the same way on these clocks, the timeout is the
+ earliest expiry: for a running clock UtilTimer_getTimeout() returns the time
+ left to it, 0 once it has passed while the clock waits for its group.
+ <BR>
  */
 
 /******************************************************************************
@@ -74,6 +84,20 @@ extern "C"
  * @{
  */
 
+/*! Maximum number of coalesced clocks */
+#define UTIL_TIMER_MAX_COALESCED 10
+
+/*! Wakeup statistics of the coalesced clocks */
+typedef struct
+{
+    /*! Number of clock expiries */
+    uint32_t expiries;
+    /*! Number of clock ticks with one or more expiries */
+    uint32_t wakeups;
+    /*! Number of times a clock was moved to share an expiry */
+    uint32_t coalesced;
+} UtilTimer_wakeupStats_t;
+
 /******************************************************************************
  Function Prototypes
  *****************************************************************************/
@@ -98,6 +122,25 @@ extern Clock_Handle UtilTimer_construct(Clock_Struct *pClock,
                                         uint8_t startFlag,
                                         UArg arg);
 
+/*!
+ * @brief   Initialize a TIRTOS Clock instance that coalesces its expiry with
+ *          the other coalesced clocks.
+ * @param   pClock        - pointer to clock instance structure.
+ * @param   clockCB       - callback function upon clock expiration.
+ * @param   clockDuration - longevity of clock timer in milliseconds
+ * @param   slack         - time the clock can expire late, in milliseconds
+ * @param   startFlag     - TRUE to start immediately, FALSE to wait.
+ * @param   arg           - argument passed to callback function.
+ * @return  Clock_Handle  - a handle to the clock instance, NULL if there is
+ *                          no room for another coalesced clock.
+ */
+extern Clock_Handle UtilTimer_constructCoalesced(Clock_Struct *pClock,
+                                                 Clock_FuncPtr clockCB,
+                                                 uint32_t clockDuration,
+                                                 uint32_t slack,
+                                                 uint8_t startFlag,
+                                                 UArg arg);
+
 /*!
  * @brief   Start a Timer/Clock.
  *
@@ -147,6 +190,17 @@ extern uint32_t UtilTimer_getTimeout(Clock_Handle handle);
  */
 extern void UtilTimer_setFunc(Clock_Handle handle, Clock_FuncPtr fxn, UArg arg);
 
+/*!
+ * @brief   Get the wakeup statistics of the coalesced clocks.
+ * @param   pStats - place to put the statistics
+ */
+extern void UtilTimer_getWakeupStats(UtilTimer_wakeupStats_t *pStats);
+
+/*!
+ * @brief   Clear the wakeup statistics of the coalesced clocks.
+ */
+extern void UtilTimer_resetWakeupStats(void);
+
 /*! @} end group TimerClock */
 
 #ifdef __cplusplus
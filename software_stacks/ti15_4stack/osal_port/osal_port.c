@@ -91,6 +91,8 @@ typedef struct
     Semaphore_Handle taskSem;
     bool conservePower;
     uint32_t* pEventFlag;
+    void *qTail;       /* last message of qHandle */
+    uint16_t qCount;   /* number of messages in qHandle */
 } TaskEntry;
 
 // required for rtos_heaposal.h
@@ -108,6 +110,10 @@ typedef struct
 /* instantiate variable referenced in ROM but not used */
 uint16_t *macTasksEvents = 0;
 
+/* Task IDs are the index of the task in taskTbl */
+#define OsalPort_TASK_ENTRY(taskId) \
+    ((((taskId) < taskCnt) && ((taskId) < MAX_TASKS)) ? &taskTbl[(taskId)] : NULL)
+
 /**
  * @internal
  * Wakeup schedule data structure definition
@@ -130,6 +136,11 @@ extern void ICall_heapFree(void *blk);
 #define OsalPort_heapMalloc         ICall_heapMalloc
 #define OsalPort_heapRealloc        ICall_heapRealloc
 #define OsalPort_heapFree           ICall_heapFree
+#elif defined(OSAL_PORT_POSIX)
+// Host build on the simulated kernel, use the C library heap
+#define OsalPort_heapMalloc         malloc
+#define OsalPort_heapRealloc        realloc
+#define OsalPort_heapFree           free
 #else
 /***** Public function definitions *****/
 /* Implementing a simple heap using heapmgr.h template.
@@ -179,6 +190,188 @@ static uint32_t OsalPort_heapCSState;
 #endif
 #endif // USE_DMM
 
+#ifdef OsalPort_POOL_ENABLE
+/*********************************************************************
+ * Block pools
+ *
+ * Fixed size blocks in front of the heap for the small buffers that
+ * are allocated and freed all the time (messages, timers). Taking a
+ * block is a pop from a free list, so it takes the same time whatever
+ * the state of the heap, and the heap doesn't get fragmented by them.
+ * Allocations that find their class empty try the larger classes, and
+ * the ones that are too big, or find no free block, fall back to the
+ * heap.
+ */
+#define OsalPort_POOL_ALIGN(size)   (((size) + 7) & ~7)
+
+#define OsalPort_POOL_ARENA_SIZE                                            \
+    ((OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_0) * OsalPort_POOL_BLK_CNT_0) + \
+     (OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_1) * OsalPort_POOL_BLK_CNT_1) + \
+     (OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_2) * OsalPort_POOL_BLK_CNT_2) + \
+     (OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_3) * OsalPort_POOL_BLK_CNT_3))
+
+typedef struct
+{
+    uint8_t *pStart;    /* first block */
+    uint8_t *pEnd;      /* end of the last block */
+    void *pFree;        /* free list, linked through the first word */
+    uint16_t blkSize;
+    uint16_t blkCnt;
+    uint16_t blkUsed;
+    uint16_t blkMax;
+    uint32_t fallback;
+} OsalPort_PoolClass;
+
+static const uint16_t poolBlkSize[OsalPort_POOL_NUM_CLASSES] =
+{
+    OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_0),
+    OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_1),
+    OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_2),
+    OsalPort_POOL_ALIGN(OsalPort_POOL_BLK_SIZE_3)
+};
+
+static const uint16_t poolBlkCnt[OsalPort_POOL_NUM_CLASSES] =
+{
+    OsalPort_POOL_BLK_CNT_0,
+    OsalPort_POOL_BLK_CNT_1,
+    OsalPort_POOL_BLK_CNT_2,
+    OsalPort_POOL_BLK_CNT_3
+};
+
+static OsalPort_PoolClass poolClass[OsalPort_POOL_NUM_CLASSES];
+
+/* 64 bit words so all blocks are 8 byte aligned, like heap blocks */
+static uint64_t poolArena[(OsalPort_POOL_ARENA_SIZE / 8) + 1];
+
+static bool poolInitDone = false;
+
+/*********************************************************************
+ * @fn      OsalPort_poolInit
+ *
+ * @brief   Builds the free list of each size class. Called with
+ *          interrupts disabled.
+ */
+static void OsalPort_poolInit(void)
+{
+    uint8_t *pBlk = (uint8_t *)poolArena;
+    uint8_t i;
+    uint16_t j;
+
+    for(i = 0; i < OsalPort_POOL_NUM_CLASSES; i++)
+    {
+        OsalPort_PoolClass *pClass = &poolClass[i];
+
+        pClass->blkSize = poolBlkSize[i];
+        pClass->blkCnt = poolBlkCnt[i];
+        pClass->pStart = pBlk;
+        pClass->pFree = NULL;
+
+        for(j = 0; j < pClass->blkCnt; j++)
+        {
+            *(void **)pBlk = pClass->pFree;
+            pClass->pFree = pBlk;
+            pBlk += pClass->blkSize;
+        }
+
+        pClass->pEnd = pBlk;
+    }
+
+    poolInitDone = true;
+}
+
+/*********************************************************************
+ * @fn      OsalPort_poolMalloc
+ *
+ * @brief   Takes a block from the smallest class that fits and has a
+ *          free block, or from the heap.
+ */
+static void *OsalPort_poolMalloc(uint32_t size)
+{
+    void *pBlk = NULL;
+    uint32_t key;
+    uint8_t i;
+
+    key = OsalPort_enterCS();
+
+    if(poolInitDone == false)
+    {
+        OsalPort_poolInit();
+    }
+
+    for(i = 0; i < OsalPort_POOL_NUM_CLASSES; i++)
+    {
+        OsalPort_PoolClass *pClass = &poolClass[i];
+
+        if((pClass->blkCnt == 0) || (size > pClass->blkSize))
+        {
+            continue;
+        }
+
+        pBlk = pClass->pFree;
+        if(pBlk != NULL)
+        {
+            pClass->pFree = *(void **)pBlk;
+            pClass->blkUsed++;
+            if(pClass->blkUsed > pClass->blkMax)
+            {
+                pClass->blkMax = pClass->blkUsed;
+            }
+            break;
+        }
+
+        // Class empty, a larger block wastes less than the heap
+        pClass->fallback++;
+    }
+
+    OsalPort_leaveCS(key);
+
+    if(pBlk == NULL)
+    {
+        pBlk = OsalPort_heapMalloc(size);
+    }
+
+    return (pBlk);
+}
+
+/*********************************************************************
+ * @fn      OsalPort_poolFree
+ *
+ * @brief   Returns a block to its class, or to the heap if it is not
+ *          a pool block.
+ */
+static void OsalPort_poolFree(void *buf)
+{
+    uint8_t *pBlk = (uint8_t *)buf;
+    uint32_t key;
+    uint8_t i;
+
+    if((pBlk >= (uint8_t *)poolArena) &&
+       (pBlk < ((uint8_t *)poolArena + OsalPort_POOL_ARENA_SIZE)))
+    {
+        key = OsalPort_enterCS();
+
+        for(i = 0; i < OsalPort_POOL_NUM_CLASSES; i++)
+        {
+            OsalPort_PoolClass *pClass = &poolClass[i];
+
+            if(pBlk < pClass->pEnd)
+            {
+                *(void **)pBlk = pClass->pFree;
+                pClass->pFree = pBlk;
+                pClass->blkUsed--;
+                break;
+            }
+        }
+
+        OsalPort_leaveCS(key);
+    }
+    else if(buf != NULL)
+    {
+        OsalPort_heapFree(buf);
+    }
+}
+#endif /* OsalPort_POOL_ENABLE */
+
 /*********************************************************************
  * @fn      OsalPort_registerTask
  *
@@ -203,6 +396,8 @@ uint8_t OsalPort_registerTask(void* taskHndl, void* taskSem, uint32_t* pEvent)
         taskTbl[taskCnt].taskHndl = taskHndl;
         taskTbl[taskCnt].taskSem = taskSem;
         taskTbl[taskCnt].qHandle = NULL;
+        taskTbl[taskCnt].qTail = NULL;
+        taskTbl[taskCnt].qCount = 0;
         taskTbl[taskCnt].conservePower = false;
         taskTbl[taskCnt].pEventFlag = pEvent;
     }
@@ -309,7 +504,7 @@ uint8_t OsalPort_msgDeallocate( uint8_t *pMsg )
  */
 uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
 
     if(pMsg == NULL)
@@ -318,22 +513,32 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
     }
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_TASK_ENTRY(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
-
-            OsalPort_msgEnqueue(&taskTbl[taskIdx].qHandle, pMsg );
-            OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+        return OsalPort_INVALID_TASK;
+    }
 
-            OsalPort_leaveCS(key);
+    key = OsalPort_enterCS();
 
-            return OsalPort_SUCCESS;
-        }
+    // Add message to end of queue
+    OsalPort_MSG_NEXT( pMsg ) = NULL;
+    if ( pTask->qHandle == NULL )
+    {
+        pTask->qHandle = pMsg;
     }
+    else
+    {
+        OsalPort_MSG_NEXT( pTask->qTail ) = pMsg;
+    }
+    pTask->qTail = pMsg;
+    pTask->qCount++;
+
+    OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
 
-    return OsalPort_INVALID_TASK;
+    OsalPort_leaveCS(key);
+
+    return OsalPort_SUCCESS;
 }
 
 /**************************************************************************************************
@@ -356,30 +561,27 @@ uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg )
  */
 OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
 
     key = OsalPort_enterCS();
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_TASK_ENTRY(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
-
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
-            {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-                break;
-              }
+        pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
 
-              pHdr = OsalPort_MSG_NEXT(pHdr);
-            }
+        // Look through the tasks queue for a message that matches the task_id and event parameters.
+        while (pHdr != NULL)
+        {
+          if (((OsalPort_EventHdr *)pHdr)->event == event)
+          {
             break;
+          }
+
+          pHdr = OsalPort_MSG_NEXT(pHdr);
         }
     }
 
@@ -403,33 +605,68 @@ OsalPort_EventHdr* OsalPort_msgFind(uint8_t taskId, uint8_t event)
  */
 uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint8_t* pMsg = NULL;
+    uint32_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_TASK_ENTRY(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            pMsg = OsalPort_msgDequeue( &taskTbl[taskIdx].qHandle );
+        return NULL;
+    }
 
-            // Are there any more messages?
-            if ( OsalPort_MSG_Q_EMPTY(&taskTbl[taskIdx].qHandle) )
-            {
-                // Clear message event
-                OsalPort_clearEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
-            else
-            {
-                // Signal the task that another message is waiting
-                OsalPort_setEvent(taskIdx, OsalPort_SYS_EVENT_MSG);
-            }
+    // Hold off interrupts
+    key = OsalPort_enterCS();
 
-        }
+    if ( pTask->qHandle != NULL )
+    {
+        // Dequeue message
+        pMsg = pTask->qHandle;
+        pTask->qHandle = OsalPort_MSG_NEXT( pMsg );
+        OsalPort_MSG_NEXT( pMsg ) = NULL;
+        OsalPort_MSG_ID( pMsg ) = OsalPort_TASK_NO_TASK;
+        pTask->qCount--;
     }
 
+    // Are there any more messages?
+    if ( pTask->qHandle == NULL )
+    {
+        pTask->qTail = NULL;
+
+        // Clear message event
+        OsalPort_clearEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    }
+    else
+    {
+        // Signal the task that another message is waiting
+        OsalPort_setEvent(destinationTask, OsalPort_SYS_EVENT_MSG);
+    }
+
+    // Re-enable interrupts
+    OsalPort_leaveCS(key);
+
     return pMsg;
 }
 
+/*********************************************************************
+ * @fn      OsalPort_msgCount
+ *
+ * @brief
+ *
+ *    This function is called to get the number of messages waiting in
+ *    the queue of a task.
+ *
+ * @param   uint8_t taskId - receiving tasks ID
+ *
+ * @return  number of messages, 0 if the task is not valid
+ */
+uint16_t OsalPort_msgCount( uint8_t taskId )
+{
+    TaskEntry *pTask = OsalPort_TASK_ENTRY(taskId);
+
+    return (pTask != NULL) ? pTask->qCount : 0;
+}
+
 /*********************************************************************
  * @fn      OsalPort_setEvent
  *
@@ -445,30 +682,27 @@ uint8_t *OsalPort_msgReceive( uint8_t destinationTask )
  */
 uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
 {
-    uint8_t taskIdx;
-    uint8_t status = OsalPort_INVALID_TASK;
+    TaskEntry *pTask;
     uint32_t key;
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_TASK_ENTRY(destinationTask);
+    if(pTask == NULL)
     {
-        if(taskTbl[taskIdx].taskId == destinationTask)
-        {
-            key = OsalPort_enterCS();
-
-            *taskTbl[taskIdx].pEventFlag |= (uint32_t)eventFlag;
+        return OsalPort_INVALID_TASK;
+    }
 
-            if(taskTbl[taskIdx].taskSem)
-            {
-                Semaphore_post(taskTbl[taskIdx].taskSem);
-            }
+    key = OsalPort_enterCS();
 
-            status = OsalPort_SUCCESS;
+    *pTask->pEventFlag |= (uint32_t)eventFlag;
 
-            OsalPort_leaveCS(key);
-        }
+    if(pTask->taskSem)
+    {
+        Semaphore_post(pTask->taskSem);
     }
 
-    return status;
+    OsalPort_leaveCS(key);
+
+    return OsalPort_SUCCESS;
 }
 
 /*********************************************************************
@@ -484,15 +718,12 @@ uint8_t OsalPort_setEvent( uint8_t destinationTask, uint32_t eventFlag )
  */
 uint32_t OsalPort_waitEvent(uint8_t taskId)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask = OsalPort_TASK_ENTRY(taskId);
 
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
-        {
-            Semaphore_pend(taskTbl[taskIdx].taskSem, BIOS_WAIT_FOREVER);
-            return *taskTbl[taskIdx].pEventFlag;
-        }
+        Semaphore_pend(pTask->taskSem, BIOS_WAIT_FOREVER);
+        return *pTask->pEventFlag;
     }
 
     return 0;
@@ -539,13 +770,26 @@ void OsalPort_blockOnEvent(void*  taskHndl)
  */
 void OsalPort_clearEvent(uint8_t TaskID, uint32_t eventFlag)
 {
+    TaskEntry *pTask;
     uint8_t taskIdx;
     uint32_t key;
 
+    if(TaskID != OsalPort_TASK_NO_TASK)
+    {
+        pTask = OsalPort_TASK_ENTRY(TaskID);
+        if(pTask != NULL)
+        {
+            key = OsalPort_enterCS();
+            *pTask->pEventFlag &=  ~(uint32_t)eventFlag;
+            OsalPort_leaveCS(key);
+        }
+        return;
+    }
+
+    /* Use the current running task */
     for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
     {
-        if( ((TaskID != OsalPort_TASK_NO_TASK) && (taskTbl[taskIdx].taskId == TaskID)) ||
-            ((TaskID == OsalPort_TASK_NO_TASK) && (taskTbl[taskIdx].taskHndl == Task_self())))
+        if(taskTbl[taskIdx].taskHndl == Task_self())
         {
             key = OsalPort_enterCS();
             *taskTbl[taskIdx].pEventFlag &=  ~(uint32_t)eventFlag;
@@ -613,7 +857,7 @@ void OsalPort_msgEnqueue( OsalPort_MsgQ *pQ, void *pMsg )
  */
 uint8_t OsalPort_msgEnqueueMax( OsalPort_MsgQ *pQ, void *pMsg, uint8_t max )
 {
-    void *list;
+    void *list = NULL;
     uint32_t key;
     uint32_t qCount = 0;
     uint8_t status = 0;
@@ -621,15 +865,26 @@ uint8_t OsalPort_msgEnqueueMax( OsalPort_MsgQ *pQ, void *pMsg, uint8_t max )
     // Hold off interrupts
     key = OsalPort_enterCS();
 
-    // Find element count
+    // Find element count, no need to count past max
     if(*pQ != NULL)
     {
-        for ( list = *pQ; OsalPort_MSG_NEXT( list ) != NULL; list = OsalPort_MSG_NEXT( list ), qCount++ );
+        for ( list = *pQ; (OsalPort_MSG_NEXT( list ) != NULL) && (qCount < max); list = OsalPort_MSG_NEXT( list ), qCount++ );
     }
 
     if(qCount < max)
     {
-        OsalPort_msgEnqueue(pQ, pMsg);
+        // The count stopped at the end of queue, add the message there
+        if (pMsg) {
+            OsalPort_MSG_NEXT( pMsg ) = NULL;
+            if ( *pQ == NULL )
+            {
+                *pQ = pMsg;
+            }
+            else
+            {
+                OsalPort_MSG_NEXT( list ) = pMsg;
+            }
+        }
         status = 1;
     }
 
@@ -688,7 +943,7 @@ void *OsalPort_msgDequeue( OsalPort_MsgQ *pQ )
  */
 OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
 {
-    uint8_t taskIdx;
+    TaskEntry *pTask;
     uint32_t key;
     OsalPort_MsgHdr *pHdr = NULL;
     OsalPort_MsgHdr *pPrev = NULL;
@@ -697,35 +952,37 @@ OsalPort_EventHdr* OsalPort_msgFindDequeue(uint8_t taskId, uint8_t event)
     key = OsalPort_enterCS();
 
     /*find dest task */
-    for(taskIdx = 0; taskIdx < taskCnt; taskIdx++)
+    pTask = OsalPort_TASK_ENTRY(taskId);
+    if(pTask != NULL)
     {
-        if(taskTbl[taskIdx].taskId == taskId)
+        pHdr = (OsalPort_MsgHdr*) pTask->qHandle;
+
+        // Look through the tasks queue for a message that matches the task_id and event parameters.
+        while (pHdr != NULL)
         {
-            pHdr = (OsalPort_MsgHdr*) taskTbl[taskIdx].qHandle;
+          if (((OsalPort_EventHdr *)pHdr)->event == event)
+          {
 
-            // Look through the tasks queue for a message that matches the task_id and event parameters.
-            while (pHdr != NULL)
+            if(pPrev == NULL)
             {
-              if (((OsalPort_EventHdr *)pHdr)->event == event)
-              {
-
-                if(pPrev == NULL)
-                {
-                  OsalPort_MSG_Q_HEAD(&taskTbl[taskIdx].qHandle) = OsalPort_MSG_NEXT(pHdr);
-                }
-                else
-                {
-                  OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
-                }
-                OsalPort_MSG_NEXT( pHdr ) = NULL;
-                OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
-                break;
-              }
-
-              pPrev = pHdr;
-              pHdr = OsalPort_MSG_NEXT(pHdr);
+              OsalPort_MSG_Q_HEAD(&pTask->qHandle) = OsalPort_MSG_NEXT(pHdr);
             }
+            else
+            {
+              OsalPort_MSG_NEXT(pPrev) = OsalPort_MSG_NEXT(pHdr);
+            }
+            if(pTask->qTail == pHdr)
+            {
+              pTask->qTail = pPrev;
+            }
+            pTask->qCount--;
+            OsalPort_MSG_NEXT( pHdr ) = NULL;
+            OsalPort_MSG_ID( pHdr ) = OsalPort_TASK_NO_TASK;
             break;
+          }
+
+          pPrev = pHdr;
+          pHdr = OsalPort_MSG_NEXT(pHdr);
         }
     }
 
@@ -1096,7 +1353,11 @@ void *OsalPort_revmemcpy( void *dst, const void *src, unsigned int len )
  */
 void* OsalPort_malloc(uint32_t size)
 {
+#ifdef OsalPort_POOL_ENABLE
+    return (OsalPort_poolMalloc(size));
+#else
     return (OsalPort_heapMalloc(size));
+#endif
 }
 
 /*********************************************************************
@@ -1112,7 +1373,64 @@ void* OsalPort_malloc(uint32_t size)
  */
 void OsalPort_free(void* buf)
 {
+#ifdef OsalPort_POOL_ENABLE
+    OsalPort_poolFree(buf);
+#else
     OsalPort_heapFree(buf);
+#endif
+}
+
+/*********************************************************************
+ * @fn      OsalPort_heapMgrGetPoolMetrics
+ *
+ * @brief
+ *
+ *   Gets the metrics of a block pool size class.
+ *
+ * @param   poolId - size class, 0 to OsalPort_POOL_NUM_CLASSES - 1
+ * @param   pBlkSize - block size of the class
+ * @param   pBlkCnt - number of blocks of the class
+ * @param   pBlkUsed - number of blocks allocated now
+ * @param   pBlkMax - most blocks ever allocated at the same time
+ * @param   pFallback - number of allocations taken from the heap
+ *
+ * @return  OsalPort_SUCCESS or OsalPort_INVALIDPARAMETER
+ */
+uint8_t OsalPort_heapMgrGetPoolMetrics(uint8_t poolId,
+                                       uint32_t *pBlkSize,
+                                       uint32_t *pBlkCnt,
+                                       uint32_t *pBlkUsed,
+                                       uint32_t *pBlkMax,
+                                       uint32_t *pFallback)
+{
+#ifdef OsalPort_POOL_ENABLE
+    uint32_t key;
+#endif
+
+    if(poolId >= OsalPort_POOL_NUM_CLASSES)
+    {
+        return OsalPort_INVALIDPARAMETER;
+    }
+
+#ifdef OsalPort_POOL_ENABLE
+    key = OsalPort_enterCS();
+
+    *pBlkSize = poolBlkSize[poolId];
+    *pBlkCnt = poolBlkCnt[poolId];
+    *pBlkUsed = poolClass[poolId].blkUsed;
+    *pBlkMax = poolClass[poolId].blkMax;
+    *pFallback = poolClass[poolId].fallback;
+
+    OsalPort_leaveCS(key);
+#else
+    *pBlkSize = 0;
+    *pBlkCnt = 0;
+    *pBlkUsed = 0;
+    *pBlkMax = 0;
+    *pFallback = 0;
+#endif
+
+    return OsalPort_SUCCESS;
 }
 
 /*********************************************************************
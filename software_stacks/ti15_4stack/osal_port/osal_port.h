@@ -96,6 +96,43 @@ extern "C"
 #define OsalPort_PWR_CONSERVE 0
 #define OsalPort_PWR_HOLD     1
 
+/*** Block pools in front of the heap ***/
+/* Define OsalPort_POOL_ENABLE to take the small allocations from fixed
+ * size blocks instead of the heap, otherwise all allocations come from
+ * the heap and the pools take no RAM.
+ * Each size class has a block size in bytes, rounded up to 8, and a
+ * number of blocks. Classes must be in increasing block size, a class
+ * with no blocks is not used. The blocks are static RAM, 3.5 KB with the
+ * defaults: the auto-size heap of the .cfg (HEAPMGR_CONFIG 0x80) shrinks
+ * by as much on its own, a fixed HEAPMGR_SIZE must be reduced by hand.
+ * Pools trade RAM for allocation time, they don't add memory. */
+#ifndef OsalPort_POOL_BLK_SIZE_0
+#define OsalPort_POOL_BLK_SIZE_0   32
+#endif
+#ifndef OsalPort_POOL_BLK_CNT_0
+#define OsalPort_POOL_BLK_CNT_0    16
+#endif
+#ifndef OsalPort_POOL_BLK_SIZE_1
+#define OsalPort_POOL_BLK_SIZE_1   64
+#endif
+#ifndef OsalPort_POOL_BLK_CNT_1
+#define OsalPort_POOL_BLK_CNT_1    16
+#endif
+#ifndef OsalPort_POOL_BLK_SIZE_2
+#define OsalPort_POOL_BLK_SIZE_2   128
+#endif
+#ifndef OsalPort_POOL_BLK_CNT_2
+#define OsalPort_POOL_BLK_CNT_2    8
+#endif
+#ifndef OsalPort_POOL_BLK_SIZE_3
+#define OsalPort_POOL_BLK_SIZE_3   256
+#endif
+#ifndef OsalPort_POOL_BLK_CNT_3
+#define OsalPort_POOL_BLK_CNT_3    4
+#endif
+
+#define OsalPort_POOL_NUM_CLASSES  4
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -224,6 +261,21 @@ extern uint8_t OsalPort_msgSend( uint8_t destinationTask, uint8_t *pMsg );
  */
 extern uint8_t *OsalPort_msgReceive( uint8_t taskId );
 
+/*********************************************************************
+ * @fn      OsalPort_msgCount
+ *
+ * @brief
+ *
+ *    This function is called to get the number of messages waiting in
+ *    the queue of a task. The count is kept as messages are sent and
+ *    received, so the queue is not walked.
+ *
+ * @param   uint8_t taskId - receiving tasks ID
+ *
+ * @return  number of messages, 0 if the task is not valid
+ */
+extern uint16_t OsalPort_msgCount( uint8_t taskId );
+
 /**************************************************************************************************
  * @fn          OsalPort_msgFind
  *
@@ -542,6 +594,34 @@ void* OsalPort_malloc(uint32_t size);
  */
 void OsalPort_free(void* buf);
 
+/*********************************************************************
+ * @fn      OsalPort_heapMgrGetPoolMetrics
+ *
+ * @brief
+ *
+ *   Gets the metrics of a block pool size class. Allocations that find
+ *   their class empty are counted as fallbacks of that class, and are
+ *   taken from the next larger class that has a free block, or from the
+ *   heap. Allocations bigger than the largest class always go to the heap
+ *   and are not counted. Without OsalPort_POOL_ENABLE every class has no
+ *   blocks.
+ *
+ * @param   poolId - size class, 0 to OsalPort_POOL_NUM_CLASSES - 1
+ * @param   pBlkSize - block size of the class
+ * @param   pBlkCnt - number of blocks of the class
+ * @param   pBlkUsed - number of blocks allocated now
+ * @param   pBlkMax - most blocks ever allocated at the same time
+ * @param   pFallback - number of allocations that found the class empty
+ *
+ * @return  OsalPort_SUCCESS or OsalPort_INVALIDPARAMETER
+ */
+uint8_t OsalPort_heapMgrGetPoolMetrics(uint8_t poolId,
+                                       uint32_t *pBlkSize,
+                                       uint32_t *pBlkCnt,
+                                       uint32_t *pBlkUsed,
+                                       uint32_t *pBlkMax,
+                                       uint32_t *pFallback);
+
 
 /*********************************************************************
  * @fn      OsalPort_malloc
@@ -55,15 +55,43 @@
 
 /***** Defines *****/
 
+/*
+ * Timer wheel: WHEEL_LEVELS levels of WHEEL_SLOTS slots. A slot of level n
+ * covers WHEEL_SLOTS^n ms, so the levels reach 32 ms, 1 s, 32 s, 17 min,
+ * 9 h and 12 days, more than OsalPortTimers_TIMERS_MAX_TIMEOUT.
+ */
+#define WHEEL_LEVELS        6
+#define WHEEL_LEVEL_SHIFT   5
+#define WHEEL_SLOTS         (1 << WHEEL_LEVEL_SHIFT)
+#define WHEEL_SLOT_MASK     (WHEEL_SLOTS - 1)
+
+/* Shift of the slot time of a level */
+#define WHEEL_SHIFT(level)  ((level) * WHEEL_LEVEL_SHIFT)
+
+/* End of a timer list */
+#define TIMER_NONE          0xFFFF
+
+/* Clock ticks in a millisecond */
+#define TICKS_PER_MS        (1000 / Clock_tickPeriod)
+
+/*
+ * Longest hardware clock timeout in ms, so the millisecond time base is
+ * updated well before the 32 bit tick count wraps.
+ */
+#define MAX_CLOCK_TIMEOUT   (60UL * 60UL * 1000UL)
+
 /***** Typedefs *****/
 
 typedef struct
 {
-    Clock_Handle clockHandle;
-    uint8_t taskId;
+    uint64_t expires;   /* expiry time, in ms */
+    uint32_t period;    /* reload period in ms, 0 for a one shot timer */
     uint32_t eventId;
-    bool reload;
-    void* pNext;
+    uint8_t taskId;
+    uint8_t slot;       /* wheel slot, level * WHEEL_SLOTS + index */
+    uint16_t next;      /* wheel slot list */
+    uint16_t prev;
+    uint16_t hashNext;  /* lookup chain, free list when not used */
 } TimerEntry_t;
 
 /***** Variable declarations *****/
@@ -71,13 +99,47 @@ static uint8_t stackTaskID;
 static uint32_t stackEventID;
 
 /***** Private variables *****/
-static TimerEntry_t* pTimerEntries = NULL;
-static TimerEntry_t* pDeleteTimerEntries = NULL;
+static TimerEntry_t timerEntries[OsalPortTimers_MAX_TIMERS];
+
+/* First timer of each wheel slot, and the slots that have timers */
+static uint16_t wheelSlots[WHEEL_LEVELS * WHEEL_SLOTS];
+static uint32_t wheelBitmap[WHEEL_LEVELS];
+
+/* First timer of each (taskId, eventId) lookup chain */
+static uint16_t hashTable[OsalPortTimers_HASH_SIZE];
+
+static uint16_t freeEntries;
+static bool timersInitialized = false;
+
+/* Running timers and failed starts */
+static OsalPortTimers_Stats_t timerStats;
+
+/* Time the wheel was last advanced to, in ms */
+static uint64_t wheelTime;
+
+/* Millisecond time base */
+static uint64_t timeBaseMs;
+static uint32_t timeBaseTicks;
+
+/* Clock driving the wheel, programmed to the next expiry */
+static Clock_Struct wheelClock;
+static bool wheelClockActive = false;
+static uint64_t wheelClockExpiry;
 
 /***** Private function definitions *****/
 static void timerCb(xdc_UArg arg);
+static void initTimers(void);
+static uint64_t getTime(void);
+static uint16_t hashIndex(uint8_t taskId, uint32_t eventId);
+static uint16_t getTimerEntry(uint8_t taskId, uint32_t eventId);
 static uint8_t createTimerEntry(uint8_t taskId, uint32_t eventId, uint32_t timeout, bool reload);
-static TimerEntry_t* getTimerEntry(uint8_t taskId, uint32_t eventId);
+static void freeTimerEntry(uint16_t idx);
+static void wheelInsert(uint16_t idx, uint64_t now);
+static void wheelRemove(uint16_t idx);
+static void wheelAdvance(uint64_t now);
+static void wheelSchedule(uint64_t now);
+static uint8_t lowestBit(uint32_t value);
+static uint32_t rotateRight(uint32_t value, uint8_t shift);
 
 /***** Public function definitions *****/
 
@@ -86,7 +148,7 @@ static TimerEntry_t* getTimerEntry(uint8_t taskId, uint32_t eventId);
  *
  * @brief
  *
- *    This function is used to create and start a TIRTOS timer.
+ *    This function is used to start a timer.
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -109,7 +171,7 @@ uint8_t OsalPortTimers_startTimer(uint8_t taskId, uint32_t eventId, uint32_t tim
  *
  * @brief
  *
- *    This function is used to create and start a TIRTOS timer that reloads
+ *    This function is used to start a timer that reloads
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -132,7 +194,7 @@ uint8_t OsalPortTimers_startReloadTimer(uint8_t taskId, uint32_t eventId, uint32
  *
  * @brief
  *
- *    This function is used to create and stop a TIRTOS timer
+ *    This function is used to stop a timer
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -142,40 +204,16 @@ uint8_t OsalPortTimers_startReloadTimer(uint8_t taskId, uint32_t eventId, uint32
  */
 uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId)
 {
-    TimerEntry_t* pTimerEntry;
-
+    uint16_t idx;
+    uint64_t expires;
     uintptr_t key;
 
     //Enter Critial Section
     key = OsalPort_enterCS();
 
-    pTimerEntry = getTimerEntry(taskId, eventId);
+    idx = timersInitialized ? getTimerEntry(taskId, eventId) : TIMER_NONE;
 
-    //Stop clock, remove from list and free memory
-    if(pTimerEntry != NULL)
-    {
-        Clock_stop(pTimerEntry->clockHandle);
-        Clock_delete(&(pTimerEntry->clockHandle));
-
-        //is it first in list
-        if(pTimerEntry == pTimerEntries)
-        {
-            pTimerEntries = pTimerEntry->pNext;
-            OsalPort_free(pTimerEntry);
-        }
-        else
-        {
-            //find prev entry
-            TimerEntry_t* pTimerEntryPrev = pTimerEntries;
-            while(pTimerEntryPrev->pNext != pTimerEntry)
-            {
-                pTimerEntryPrev = pTimerEntryPrev->pNext;
-            }
-            pTimerEntryPrev->pNext = pTimerEntry->pNext;
-            OsalPort_free(pTimerEntry);
-        }
-    }
-    else
+    if(idx == TIMER_NONE)
     {
         //Leave Critical Section
         OsalPort_leaveCS(key);
@@ -183,6 +221,17 @@ uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId)
         return OsalPort_INVALIDPARAMETER;
     }
 
+    //Remove from the wheel and free the entry
+    expires = timerEntries[idx].expires;
+    wheelRemove(idx);
+    freeTimerEntry(idx);
+
+    //Only move the clock if it was set for this timer
+    if(wheelClockActive && (expires == wheelClockExpiry))
+    {
+        wheelSchedule(getTime());
+    }
+
     //Leave Critical Section
     OsalPort_leaveCS(key);
 
@@ -190,34 +239,37 @@ uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId)
 }
 
 /*********************************************************************
- * @fn      OsalPortTimers_stopTimer
+ * @fn      OsalPortTimers_getTimerTimeout
  *
  * @brief
  *
- *    This function is used to create and stop a TIRTOS timer
+ *    This function is used to get the time left before a timer expires
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
  * @param   uint32_t   eventId - event to post
  *
- * @return  OsalPort status code
+ * @return  time left in ms, 0 if the timer is not running
  */
 uint32_t OsalPortTimers_getTimerTimeout(uint8_t taskId, uint32_t eventId)
 {
-    TimerEntry_t* pTimerEntry;
-    uint32_t timeoutTicks;
+    uint16_t idx;
+    uint64_t now;
     uint32_t timeout = 0; /* timeout in ms */
     uintptr_t key;
 
     //Enter Critial Section
     key = OsalPort_enterCS();
 
-    pTimerEntry = getTimerEntry(taskId, eventId);
+    idx = timersInitialized ? getTimerEntry(taskId, eventId) : TIMER_NONE;
 
-    if(pTimerEntry != NULL)
+    if(idx != TIMER_NONE)
     {
-        timeoutTicks = Clock_getTimeout(pTimerEntry->clockHandle);
-        timeout = timeoutTicks / (1000 / Clock_tickPeriod);
+        now = getTime();
+        if(timerEntries[idx].expires > now)
+        {
+            timeout = (uint32_t)(timerEntries[idx].expires - now);
+        }
     }
 
     //Leave Critical Section
@@ -226,30 +278,43 @@ uint32_t OsalPortTimers_getTimerTimeout(uint8_t taskId, uint32_t eventId)
     return timeout;
 }
 
+/*********************************************************************
+ * @fn      OsalPortTimers_getStats
+ *
+ * @brief
+ *
+ *    This function is used to get the timer statistics
+ *
+ *
+ * @param   OsalPortTimers_Stats_t *pStats - statistics are put here
+ *
+ * @return  none
+ */
+void OsalPortTimers_getStats(OsalPortTimers_Stats_t *pStats)
+{
+    uintptr_t key;
+
+    //Enter Critial Section
+    key = OsalPort_enterCS();
+
+    *pStats = timerStats;
+
+    //Leave Critical Section
+    OsalPort_leaveCS(key);
+}
+
 /*********************************************************************
  * @fn      OsalPortTimers_cleanUpTimers
  *
  * @brief Clean up inactive Osal Port Timers outside of SWI context
  *
+ *        Timers are kept in a static table and freed when they expire,
+ *        there is nothing left to clean up.
  *
- * @return  Timer entry
+ * @return  none
  */
 void OsalPortTimers_cleanUpTimers(void)
 {
-  if (pDeleteTimerEntries != NULL) {
-    TimerEntry_t *current = pDeleteTimerEntries;
-    TimerEntry_t *next;
-
-    // free the entire pDeleteTimerEntries list
-    while (current != NULL)
-    {
-        next = current->pNext;
-        Clock_delete(&(current->clockHandle));
-        OsalPort_free(current);
-        current = next;
-    }
-    pDeleteTimerEntries = NULL;
-  }
 }
 
 /*********************************************************************
@@ -274,61 +339,148 @@ void OsalPortTimers_registerCleanupEvent(uint8_t taskID, uint32_t eventID)
  *
  * @brief
  *
- *    This function is the timer callback function send to send events
- *    when the timeout happens.
+ *    This function is the callback of the clock driving the timer wheel,
+ *    it sends the events of the timers that have expired.
  *
  *
- * @param   void*    arg - pointer to the Timer Entry that has expired
+ * @param   void*    arg - not used
  *
  * @return  none
  */
 static void timerCb(xdc_UArg arg)
 {
-    TimerEntry_t* pTimerEntry = (TimerEntry_t*) arg;
+    uint64_t now;
+    uintptr_t key;
+
+    (void)arg;
+
+    //Enter Critial Section
+    key = OsalPort_enterCS();
+
+    wheelClockActive = false;
 
-    /* Set event */
-    OsalPort_setEvent( pTimerEntry->taskId, pTimerEntry->eventId );
+    now = getTime();
+    wheelAdvance(now);
+    wheelSchedule(now);
 
-    /* if it is not a reload timer then free the entry */
-    if(!pTimerEntry->reload)
+    //Leave Critical Section
+    OsalPort_leaveCS(key);
+}
+
+/*********************************************************************
+ * @fn      initTimers
+ *
+ * @brief
+ *
+ *    This function is used to initialize the timer table, the wheel and
+ *    the clock driving it. Called in a critical section.
+ *
+ * @return  none
+ */
+static void initTimers(void)
+{
+    Clock_Params clkParams;
+    uint16_t i;
+
+    for(i = 0; i < (WHEEL_LEVELS * WHEEL_SLOTS); i++)
+    {
+        wheelSlots[i] = TIMER_NONE;
+    }
+    for(i = 0; i < WHEEL_LEVELS; i++)
     {
-        Clock_stop(pTimerEntry->clockHandle);
+        wheelBitmap[i] = 0;
+    }
+    for(i = 0; i < OsalPortTimers_HASH_SIZE; i++)
+    {
+        hashTable[i] = TIMER_NONE;
+    }
 
-        // find the element in the timer list and
-        // extract it by updating prev and next ptrs
-        if(pTimerEntry == pTimerEntries)
-        {
-            pTimerEntries = pTimerEntry->pNext;
-        }
-        else
-        {
-            TimerEntry_t* pPrevTimerEntry = pTimerEntries;
-            while(pPrevTimerEntry->pNext != pTimerEntry)
-            {
-                pPrevTimerEntry = pPrevTimerEntry->pNext;
-            }
-            pPrevTimerEntry->pNext = pTimerEntry->pNext;
-        }
+    //Chain all the entries in the free list
+    for(i = 0; i < OsalPortTimers_MAX_TIMERS; i++)
+    {
+        timerEntries[i].hashNext = (i + 1 < OsalPortTimers_MAX_TIMERS) ?
+                                   (i + 1) : TIMER_NONE;
+    }
+    freeEntries = 0;
 
-        // add the element in the removal list, to be freed
-        // outside of SWI context
-        TimerEntry_t *pDeleteTimerEntry = pDeleteTimerEntries;
-        pTimerEntry->pNext = NULL; // remove node from linked list above
-        if(pDeleteTimerEntry == NULL)
-        {
-            pDeleteTimerEntries = pTimerEntry;
-        }
-        else
-        {
-            while(pDeleteTimerEntry->pNext != NULL)
-            {
-                pDeleteTimerEntry = pDeleteTimerEntry->pNext;
-            }
-            pDeleteTimerEntry->pNext = pTimerEntry;
-        }
-        
-        OsalPort_setEvent( stackTaskID, stackEventID );
+    timeBaseTicks = Clock_getTicks();
+    timeBaseMs = 0;
+    wheelTime = 0;
+
+    Clock_Params_init(&clkParams);
+    clkParams.period = 0;
+    clkParams.startFlag = false;
+    Clock_construct(&wheelClock, timerCb, 1, &clkParams);
+    wheelClockActive = false;
+
+    timersInitialized = true;
+}
+
+/*********************************************************************
+ * @fn      getTime
+ *
+ * @brief
+ *
+ *    This function is used to get the time since the timers were
+ *    initialized. Called in a critical section.
+ *
+ * @return  time in ms
+ */
+static uint64_t getTime(void)
+{
+    uint32_t elapsed = (Clock_getTicks() - timeBaseTicks) / TICKS_PER_MS;
+
+    //Only move the base by whole ms so no time is lost
+    timeBaseMs += elapsed;
+    timeBaseTicks += elapsed * TICKS_PER_MS;
+
+    return timeBaseMs;
+}
+
+/*********************************************************************
+ * @fn      hashIndex
+ *
+ * @brief
+ *
+ *    This function is used to get the lookup chain of a timer.
+ *
+ * @param   uint8_t    taskId - task ID to post event to when timer expires
+ * @param   uint32_t   eventId - event to post
+ *
+ * @return  index in hashTable
+ */
+static uint16_t hashIndex(uint8_t taskId, uint32_t eventId)
+{
+    uint32_t hash = (eventId ^ (eventId >> 13) ^ ((uint32_t)taskId * 0x9E37U));
+
+    return (uint16_t)((hash ^ (hash >> 7)) & (OsalPortTimers_HASH_SIZE - 1));
+}
+
+/*********************************************************************
+ * @fn      getTimerEntry
+ *
+ * @brief
+ *
+ *    This function is used to find the entry of a running timer.
+ *
+ * @param   uint8_t    taskId - task ID to post event to when timer expires
+ * @param   uint32_t   eventId - event to post
+ *
+ * @return  Timer entry index, TIMER_NONE if not found
+ */
+static uint16_t getTimerEntry(uint8_t taskId, uint32_t eventId)
+{
+    uint16_t idx = hashTable[hashIndex(taskId, eventId)];
+
+    /* iterate through the chain and find one that matches taskId and eventId */
+    while((idx != TIMER_NONE) &&
+          !((timerEntries[idx].taskId == taskId) &&
+            (timerEntries[idx].eventId == eventId)))
+    {
+        idx = timerEntries[idx].hashNext;
     }
+
+    return idx;
 }
 
 /*********************************************************************
@@ -336,7 +488,8 @@ static void timerCb(xdc_UArg arg)
  *
  * @brief
  *
- *    This function is used to create a TIRTOS timer an timer entry.
+ *    This function is used to start a timer, or restart it if it is
+ *    already running.
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
  * @param   uint32_t   eventId - event to post
@@ -347,111 +500,406 @@ static void timerCb(xdc_UArg arg)
  */
 static uint8_t createTimerEntry(uint8_t taskId, uint32_t eventId, uint32_t timeout, bool reload)
 {
-    Clock_Params clkParams;
-    TimerEntry_t* pNewTimerEntry;
-    uint8_t status = OsalPort_NO_TIMER_AVAIL;
-    uint32_t timeoutTicks = (timeout * (1000 / Clock_tickPeriod));
+    uint16_t idx;
+    uint64_t now;
     uintptr_t key;
 
+    //A timer needs at least one ms to expire after it is started
+    if(timeout == 0)
+    {
+        timeout = 1;
+    }
+
     //Enter Critial Section
     key = OsalPort_enterCS();
 
+    if(!timersInitialized)
+    {
+        initTimers();
+    }
+
+    //Bring the wheel to the current time before adding to it
+    now = getTime();
+    wheelAdvance(now);
+
     //check for existing timer
-    pNewTimerEntry = getTimerEntry(taskId, eventId);
-    
-    if(pNewTimerEntry)
+    idx = getTimerEntry(taskId, eventId);
+
+    if(idx != TIMER_NONE)
     {
-        //reset the time out
-        Clock_stop(pNewTimerEntry->clockHandle);
-        Clock_setTimeout(pNewTimerEntry->clockHandle, timeoutTicks);
-        Clock_start(pNewTimerEntry->clockHandle);
+        //reset the time out, the reload period is kept
+        wheelRemove(idx);
     }
     else
     {
-        pNewTimerEntry = OsalPort_malloc(sizeof(TimerEntry_t));
+        idx = freeEntries;
 
-        if(pNewTimerEntry != NULL)
+        if(idx == TIMER_NONE)
         {
-            Clock_Params_init(&clkParams);
-            if(reload)
-            {
-                clkParams.period = timeoutTicks;
-            }
-            else
+            //Count the failure, the caller may not check the status
+            timerStats.noTimerAvail++;
+            OsalPortTimers_NO_TIMER_HOOK(taskId, eventId);
+
+            //Leave Critical Section
+            OsalPort_leaveCS(key);
+
+            return OsalPort_NO_TIMER_AVAIL;
+        }
+
+        freeEntries = timerEntries[idx].hashNext;
+        timerStats.used++;
+        if(timerStats.used > timerStats.maxUsed)
+        {
+            timerStats.maxUsed = timerStats.used;
+        }
+
+        timerEntries[idx].taskId = taskId;
+        timerEntries[idx].eventId = eventId;
+        timerEntries[idx].period = reload ? timeout : 0;
+
+        //add to the lookup chain
+        timerEntries[idx].hashNext = hashTable[hashIndex(taskId, eventId)];
+        hashTable[hashIndex(taskId, eventId)] = idx;
+    }
+
+    timerEntries[idx].expires = now + timeout;
+    wheelInsert(idx, now);
+
+    //Only move the clock if this timer expires first
+    if(!wheelClockActive || (timerEntries[idx].expires < wheelClockExpiry))
+    {
+        wheelSchedule(now);
+    }
+
+    //Leave Critical Section
+    OsalPort_leaveCS(key);
+
+    return OsalPort_SUCCESS;
+}
+
+/*********************************************************************
+ * @fn      freeTimerEntry
+ *
+ * @brief
+ *
+ *    This function is used to remove a timer from its lookup chain and
+ *    return its entry to the free list.
+ *
+ * @param   uint16_t   idx - timer entry index
+ *
+ * @return  none
+ */
+static void freeTimerEntry(uint16_t idx)
+{
+    uint16_t *pIdx = &hashTable[hashIndex(timerEntries[idx].taskId,
+                                          timerEntries[idx].eventId)];
+
+    while(*pIdx != idx)
+    {
+        pIdx = &timerEntries[*pIdx].hashNext;
+    }
+    *pIdx = timerEntries[idx].hashNext;
+
+    timerEntries[idx].hashNext = freeEntries;
+    freeEntries = idx;
+    timerStats.used--;
+}
+
+/*********************************************************************
+ * @fn      wheelInsert
+ *
+ * @brief
+ *
+ *    This function is used to add a timer to the wheel slot of its expiry
+ *    time. The wheel must have been advanced to now.
+ *
+ * @param   uint16_t   idx - timer entry index
+ * @param   uint64_t   now - current time in ms
+ *
+ * @return  none
+ */
+static void wheelInsert(uint16_t idx, uint64_t now)
+{
+    TimerEntry_t *pEntry = &timerEntries[idx];
+    uint64_t slotTime = 0;
+    uint8_t level;
+    uint8_t slot;
+
+    //Lowest level whose slots reach the expiry time
+    for(level = 0; level < WHEEL_LEVELS; level++)
+    {
+        slotTime = pEntry->expires >> WHEEL_SHIFT(level);
+        if((slotTime - (now >> WHEEL_SHIFT(level))) < WHEEL_SLOTS)
+        {
+            break;
+        }
+    }
+
+    if(level == WHEEL_LEVELS)
+    {
+        //Beyond the wheel, park in the last slot, it is added again then
+        level = WHEEL_LEVELS - 1;
+        slotTime = (now >> WHEEL_SHIFT(level)) + WHEEL_SLOTS - 1;
+    }
+
+    slot = (uint8_t)(slotTime & WHEEL_SLOT_MASK);
+    pEntry->slot = (level * WHEEL_SLOTS) + slot;
+
+    pEntry->prev = TIMER_NONE;
+    pEntry->next = wheelSlots[pEntry->slot];
+    if(pEntry->next != TIMER_NONE)
+    {
+        timerEntries[pEntry->next].prev = idx;
+    }
+    wheelSlots[pEntry->slot] = idx;
+    wheelBitmap[level] |= (1UL << slot);
+}
+
+/*********************************************************************
+ * @fn      wheelRemove
+ *
+ * @brief
+ *
+ *    This function is used to remove a timer from its wheel slot.
+ *
+ * @param   uint16_t   idx - timer entry index
+ *
+ * @return  none
+ */
+static void wheelRemove(uint16_t idx)
+{
+    TimerEntry_t *pEntry = &timerEntries[idx];
+
+    if(pEntry->prev != TIMER_NONE)
+    {
+        timerEntries[pEntry->prev].next = pEntry->next;
+    }
+    else
+    {
+        wheelSlots[pEntry->slot] = pEntry->next;
+        if(pEntry->next == TIMER_NONE)
+        {
+            wheelBitmap[pEntry->slot / WHEEL_SLOTS] &=
+                ~(1UL << (pEntry->slot & WHEEL_SLOT_MASK));
+        }
+    }
+
+    if(pEntry->next != TIMER_NONE)
+    {
+        timerEntries[pEntry->next].prev = pEntry->prev;
+    }
+}
+
+/*********************************************************************
+ * @fn      wheelAdvance
+ *
+ * @brief
+ *
+ *    This function is used to move the wheel to the current time. The
+ *    timers of the slots passed since the last call are sent if they have
+ *    expired, or added again to a lower level.
+ *
+ * @param   uint64_t   now - current time in ms
+ *
+ * @return  none
+ */
+static void wheelAdvance(uint64_t now)
+{
+    uint8_t level;
+
+    if(now <= wheelTime)
+    {
+        return;
+    }
+
+    for(level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint64_t first = (wheelTime >> WHEEL_SHIFT(level)) + 1;
+        uint64_t last = now >> WHEEL_SHIFT(level);
+        uint32_t passed;
+
+        if(last < first)
+        {
+            //The higher levels have not moved either
+            break;
+        }
+
+        //Slots passed since the last call
+        if((last - first) >= (WHEEL_SLOTS - 1))
+        {
+            passed = 0xFFFFFFFF;
+        }
+        else
+        {
+            passed = (0xFFFFFFFFUL >> (WHEEL_SLOTS - 1 - (last - first)));
+            passed = rotateRight(passed, (WHEEL_SLOTS - (first & WHEEL_SLOT_MASK))
+                                         & WHEEL_SLOT_MASK);
+        }
+        passed &= wheelBitmap[level];
+
+        while(passed != 0)
+        {
+            uint8_t slot = lowestBit(passed);
+            uint16_t idx = wheelSlots[(level * WHEEL_SLOTS) + slot];
+
+            passed &= (passed - 1);
+
+            //Take the whole slot, its timers are sent or added again
+            wheelSlots[(level * WHEEL_SLOTS) + slot] = TIMER_NONE;
+            wheelBitmap[level] &= ~(1UL << slot);
+
+            while(idx != TIMER_NONE)
             {
-                clkParams.period = 0;
+                TimerEntry_t *pEntry = &timerEntries[idx];
+                uint16_t next = pEntry->next;
+
+                if(pEntry->expires <= now)
+                {
+                    /* Set event */
+                    OsalPort_setEvent(pEntry->taskId, pEntry->eventId);
+
+                    if(pEntry->period != 0)
+                    {
+                        pEntry->expires += pEntry->period;
+                        if(pEntry->expires <= now)
+                        {
+                            pEntry->expires = now + pEntry->period;
+                        }
+                        wheelInsert(idx, now);
+                    }
+                    else
+                    {
+                        freeTimerEntry(idx);
+                    }
+                }
+                else
+                {
+                    wheelInsert(idx, now);
+                }
+
+                idx = next;
             }
+        }
+    }
+
+    wheelTime = now;
+}
+
+/*********************************************************************
+ * @fn      wheelSchedule
+ *
+ * @brief
+ *
+ *    This function is used to set the clock to the earliest expiry of the
+ *    wheel. The wheel must have been advanced to now.
+ *
+ * @param   uint64_t   now - current time in ms
+ *
+ * @return  none
+ */
+static void wheelSchedule(uint64_t now)
+{
+    uint64_t next = 0;
+    bool found = false;
+    uint32_t timeout;
+    uint32_t ticks;
+    uint8_t level;
+
+    /*
+     * The slots of a level are in time order from the one after the wheel
+     * time, so the earliest timer of a level is in its first used slot.
+     */
+    for(level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint8_t start;
+        uint8_t slot;
+        uint16_t idx;
 
-            clkParams.startFlag = true;
-            clkParams.arg = (UArg) pNewTimerEntry;
+        if(wheelBitmap[level] == 0)
+        {
+            continue;
+        }
 
-            pNewTimerEntry->clockHandle = Clock_create(timerCb, timeoutTicks, &clkParams, NULL);
+        start = (uint8_t)(((wheelTime >> WHEEL_SHIFT(level)) + 1)
+                          & WHEEL_SLOT_MASK);
+        slot = (start + lowestBit(rotateRight(wheelBitmap[level], start)))
+               & WHEEL_SLOT_MASK;
 
-            if(pNewTimerEntry->clockHandle != NULL)
+        for(idx = wheelSlots[(level * WHEEL_SLOTS) + slot]; idx != TIMER_NONE;
+            idx = timerEntries[idx].next)
+        {
+            if(!found || (timerEntries[idx].expires < next))
             {
-            	pNewTimerEntry->taskId = taskId;
-	            pNewTimerEntry->eventId = eventId;
-	            pNewTimerEntry->reload = reload;
-	            pNewTimerEntry->pNext = NULL;
-
-	            if(pTimerEntries == NULL)
-	            {
-	                pTimerEntries = pNewTimerEntry;
-	            }
-	            else
-	            {
-	                TimerEntry_t* pLastTimerEntry = pTimerEntries;
-	                while(pLastTimerEntry->pNext != NULL)
-	                {
-	                    pLastTimerEntry = pLastTimerEntry->pNext;
-	                }
-	                pLastTimerEntry->pNext = pNewTimerEntry;
-	            }
-
-	            Clock_setTimeout(pNewTimerEntry->clockHandle, timeoutTicks);
-	            Clock_start(pNewTimerEntry->clockHandle);
-
-	            status = OsalPort_SUCCESS;
+                next = timerEntries[idx].expires;
+                found = true;
             }
-            else
-            {
-            	OsalPort_free(pNewTimerEntry);				
-            }       		            
         }
     }
 
-    //Leave Critical Section
-    OsalPort_leaveCS(key);
+    Clock_stop(Clock_handle(&wheelClock));
+    wheelClockActive = false;
 
-    return status;
-}
+    if(found)
+    {
+        timeout = (next > now) ? (uint32_t)((next - now) < MAX_CLOCK_TIMEOUT ?
+                                            (next - now) : MAX_CLOCK_TIMEOUT)
+                               : 1;
 
+        //Count from the start of the current ms, not from now
+        ticks = (timeout * TICKS_PER_MS) - (Clock_getTicks() - timeBaseTicks);
+        if((int32_t)ticks <= 0)
+        {
+            ticks = 1;
+        }
+
+        Clock_setTimeout(Clock_handle(&wheelClock), ticks);
+        Clock_start(Clock_handle(&wheelClock));
+
+        wheelClockActive = true;
+        wheelClockExpiry = now + timeout;
+    }
+}
 
 /*********************************************************************
- * @fn      getTimerEntry
+ * @fn      lowestBit
  *
  * @brief
  *
- *    This function is used to create a TIRTOS timer an timer entry.
+ *    This function is used to find the lowest bit set in a word.
  *
- * @param   uint8_t    taskId - task ID to post event to when timer expires
- * @param   uint32_t   eventId - event to post
+ * @param   uint32_t   value - word, not 0
  *
- * @return  Timer entry
+ * @return  bit position
  */
-static TimerEntry_t* getTimerEntry(uint8_t taskId, uint32_t eventId)
+static uint8_t lowestBit(uint32_t value)
 {
-    TimerEntry_t* pTimerEntry;
+    static const uint8_t debruijnBits[32] =
+    {
+        0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+        31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+    };
 
-    pTimerEntry = pTimerEntries;
+    return debruijnBits[(uint32_t)((value & (0 - value)) * 0x077CB531U) >> 27];
+}
 
-    /* iterate through entries and find one that matches taskId and eventId */
-    while( (pTimerEntry != NULL) &&
-           !((pTimerEntry->taskId == taskId) &&
-             (pTimerEntry->eventId == eventId)) )
+/*********************************************************************
+ * @fn      rotateRight
+ *
+ * @brief
+ *
+ *    This function is used to rotate a word right.
+ *
+ * @param   uint32_t   value - word
+ * @param   uint8_t    shift - 0 to 31 bits
+ *
+ * @return  rotated word
+ */
+static uint32_t rotateRight(uint32_t value, uint8_t shift)
+{
+    if(shift == 0)
     {
-        pTimerEntry = pTimerEntry->pNext;
+        return value;
     }
 
-    return pTimerEntry;
+    return ((value >> shift) | (value << (32 - shift)));
 }
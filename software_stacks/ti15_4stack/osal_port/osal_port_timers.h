@@ -74,10 +74,47 @@ extern "C"
  */
 #define OsalPortTimers_TIMERS_MAX_TIMEOUT 0x28f5c28e /* unit is ms*/
 
+/*
+ * Number of timers that can run at the same time, 24 bytes of RAM each.
+ * Size it from the worst case of the build: the timers the MAC runs at once,
+ * more with frequency hopping and security, plus the ones of the
+ * application. OsalPortTimers_getStats() gives the most timers that ran at
+ * once; read it after the worst case use of the device, like joining and
+ * rejoining with data traffic, and add a margin. A start that finds no free
+ * entry returns OsalPort_NO_TIMER_AVAIL, is counted in the statistics and
+ * calls OsalPortTimers_NO_TIMER_HOOK().
+ */
+#ifndef OsalPortTimers_MAX_TIMERS
+#define OsalPortTimers_MAX_TIMERS 64
+#endif
+
+/* Size of the timer lookup table, a power of 2 */
+#ifndef OsalPortTimers_HASH_SIZE
+#define OsalPortTimers_HASH_SIZE 64
+#endif
+
+/*
+ * Called in a critical section when a timer can't be started because all
+ * the entries are in use. The MAC does not check the status of its timer
+ * starts, so a build can make this fatal, for example with
+ * -D"OsalPortTimers_NO_TIMER_HOOK(taskId, eventId)=assertHandler()".
+ */
+#ifndef OsalPortTimers_NO_TIMER_HOOK
+#define OsalPortTimers_NO_TIMER_HOOK(taskId, eventId)
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+/* Timer statistics */
+typedef struct
+{
+    uint16_t used;          /* timers running now */
+    uint16_t maxUsed;       /* most timers running at once */
+    uint32_t noTimerAvail;  /* starts that found no free entry */
+} OsalPortTimers_Stats_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -113,7 +150,7 @@ extern void OsalPortTimers_cleanUpTimers(void);
  *
  * @brief
  *
- *    This function is used to create and start a TIRTOS timer.
+ *    This function is used to start a timer.
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -129,7 +166,7 @@ extern uint8_t OsalPortTimers_startTimer(uint8_t taskId, uint32_t eventId, uint3
  *
  * @brief
  *
- *    This function is used to create and start a TIRTOS timer that reloads
+ *    This function is used to start a timer that reloads
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -145,7 +182,7 @@ extern uint8_t OsalPortTimers_startReloadTimer(uint8_t taskId, uint32_t eventId,
  *
  * @brief
  *
- *    This function is used to create and stop a TIRTOS timer
+ *    This function is used to stop a timer
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -160,7 +197,7 @@ extern uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId);
  *
  * @brief
  *
- *    This function is used to create and stop a TIRTOS timer
+ *    This function is used to stop a timer
  *
  *
  * @param   uint8_t    taskId - task ID to post event to when timer expires
@@ -170,6 +207,20 @@ extern uint8_t OsalPortTimers_stopTimer(uint8_t taskId, uint32_t eventId);
  */
 extern uint32_t OsalPortTimers_getTimerTimeout(uint8_t taskId, uint32_t eventId); 
 
+/*********************************************************************
+ * @fn      OsalPortTimers_getStats
+ *
+ * @brief
+ *
+ *    This function is used to get the timer statistics
+ *
+ *
+ * @param   OsalPortTimers_Stats_t *pStats - statistics are put here
+ *
+ * @return  none
+ */
+extern void OsalPortTimers_getStats(OsalPortTimers_Stats_t *pStats);
+
 
 /*********************************************************************
 *********************************************************************/
@@ -0,0 +1,838 @@
+/******************************************************************************
+
+ @file api_mac_posix.c
+
+ @brief Simulated MAC behind the ApiMac interface, for host builds
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <string.h>
+#include <stdlib.h>
+
+#include "sim_rtos.h"
+#include "osal_port.h"
+#include "api_mac.h"
+#include "api_mac_posix.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Simulated MAC events */
+typedef enum
+{
+    macEvent_dataCnf,
+    macEvent_assocCnf,
+    macEvent_beaconNotifyInd,
+    macEvent_scanCnf,
+    macEvent_pollCnf,
+    macEvent_disassocCnf,
+    macEvent_wsAsyncCnf,
+    macEvent_dataInd
+} macEventType_t;
+
+/* Event waiting for delivery */
+typedef struct
+{
+    macEventType_t type;
+    /* Simulated time of delivery */
+    uint64_t due;
+    union
+    {
+        ApiMac_mcpsDataCnf_t dataCnf;
+        ApiMac_mlmeAssociateCnf_t assocCnf;
+        ApiMac_mlmeBeaconNotifyInd_t beaconNotifyInd;
+        ApiMac_mlmeScanCnf_t scanCnf;
+        ApiMac_mlmePollCnf_t pollCnf;
+        ApiMac_mlmeDisassociateCnf_t disassocCnf;
+        ApiMac_mlmeWsAsyncCnf_t wsAsyncCnf;
+        ApiMac_mcpsDataInd_t dataInd;
+    } data;
+} macEvent_t;
+
+/* Superframe specification of the coordinator beacon: non beacon mode,
+   PAN coordinator, association permitted */
+#define COORD_SUPERFRAME_SPEC 0xCFFF
+
+/******************************************************************************
+ Global Variables
+ *****************************************************************************/
+
+/* The MAC's IEEE address, set by the application before ApiMac_init() */
+ApiMac_sAddrExt_t ApiMac_extAddr;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+static ApiMac_callbacks_t *pMacCallbacks = NULL;
+
+static Semaphore_Struct appSem;
+static uint32_t appEvents = 0;
+
+/* Events in delivery order */
+static macEvent_t macEvents[API_MAC_POSIX_MAX_EVENTS];
+static uint8_t numMacEvents = 0;
+
+/* Posts the application semaphore when the first event is due */
+static Clock_Struct deliveryClock;
+
+/* Scalar PIB attributes, all the attribute IDs are below 0x100 */
+static uint32_t pibValues[0x100];
+
+static const ApiMac_sAddrExt_t coordExtAddr =
+    { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08 };
+
+static ApiMac_status_t dataCnfStatus = ApiMac_status_success;
+static uint32_t dataCnfStatusCount = 0;
+
+static ApiMacPosix_stats_t macStats;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static macEvent_t *addEvent(macEventType_t type, uint32_t delay);
+static void scheduleDelivery(void);
+static void deliveryClockCb(UArg arg);
+static bool deliverEvent(void);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Initialize the simulated MAC.
+
+ Public function defined in api_mac.h
+ */
+void *ApiMac_init(uint8_t macTaskId, bool enableFH)
+{
+    Semaphore_Params semParam;
+    Clock_Params clockParams;
+
+    (void)macTaskId;
+    (void)enableFH;
+
+    Semaphore_Params_init(&semParam);
+    semParam.mode = Semaphore_Mode_BINARY;
+    Semaphore_construct(&appSem, 0, &semParam);
+
+    OsalPort_registerTask(Task_self(), Semaphore_handle(&appSem), &appEvents);
+
+    Clock_Params_init(&clockParams);
+    Clock_construct(&deliveryClock, deliveryClockCb, 0, &clockParams);
+
+    numMacEvents = 0;
+    memset(pibValues, 0, sizeof(pibValues));
+    memset(&macStats, 0, sizeof(macStats));
+
+    return (Semaphore_handle(&appSem));
+}
+
+void ApiMac_registerCallbacks(ApiMac_callbacks_t *pCallbacks)
+{
+    pMacCallbacks = pCallbacks;
+}
+
+/* Wait for the next application event or MAC event, like the device */
+void ApiMac_processIncoming(void)
+{
+    if(Semaphore_pend(Semaphore_handle(&appSem), BIOS_WAIT_FOREVER))
+    {
+        deliverEvent();
+    }
+}
+
+bool ApiMac_processPending(void)
+{
+    return (deliverEvent());
+}
+
+ApiMac_status_t ApiMac_mcpsDataReq(ApiMac_mcpsDataReq_t *pData)
+{
+    macEvent_t *pEvent = addEvent(macEvent_dataCnf, API_MAC_POSIX_CNF_DELAY);
+
+    if(pEvent == NULL)
+    {
+        return (ApiMac_status_transactionOverflow);
+    }
+
+    macStats.dataReqs++;
+
+    pEvent->data.dataCnf.msduHandle = pData->msduHandle;
+    pEvent->data.dataCnf.timestamp = Clock_getTicks();
+    pEvent->data.dataCnf.status = dataCnfStatus;
+    if(dataCnfStatus != ApiMac_status_success)
+    {
+        macStats.dataFails++;
+        if(--dataCnfStatusCount == 0)
+        {
+            dataCnfStatus = ApiMac_status_success;
+        }
+    }
+
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mcpsPurgeReq(uint8_t msduHandle)
+{
+    (void)msduHandle;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeAssociateReq(ApiMac_mlmeAssociateReq_t *pData)
+{
+    macEvent_t *pEvent = addEvent(macEvent_assocCnf, API_MAC_POSIX_CNF_DELAY);
+
+    if(pEvent == NULL)
+    {
+        return (ApiMac_status_transactionOverflow);
+    }
+
+    macStats.assocReqs++;
+
+    pibValues[ApiMac_attribute_panId] = pData->coordPanId;
+    pibValues[ApiMac_attribute_coordShortAddress] =
+        pData->coordAddress.addr.shortAddr;
+    pibValues[ApiMac_attribute_shortAddress] = API_MAC_POSIX_DEVICE_ADDR;
+
+    pEvent->data.assocCnf.status = ApiMac_assocStatus_success;
+    pEvent->data.assocCnf.assocShortAddress = API_MAC_POSIX_DEVICE_ADDR;
+
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeDisassociateReq(ApiMac_mlmeDisassociateReq_t *pData)
+{
+    macEvent_t *pEvent = addEvent(macEvent_disassocCnf,
+                                  API_MAC_POSIX_CNF_DELAY);
+
+    if(pEvent == NULL)
+    {
+        return (ApiMac_status_transactionOverflow);
+    }
+
+    pEvent->data.disassocCnf.status = ApiMac_status_success;
+    pEvent->data.disassocCnf.deviceAddress = pData->deviceAddress;
+    pEvent->data.disassocCnf.panId = pData->devicePanId;
+
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmePollReq(ApiMac_mlmePollReq_t *pData)
+{
+    macEvent_t *pEvent = addEvent(macEvent_pollCnf, API_MAC_POSIX_CNF_DELAY);
+
+    (void)pData;
+
+    if(pEvent == NULL)
+    {
+        return (ApiMac_status_transactionOverflow);
+    }
+
+    macStats.pollReqs++;
+
+    pEvent->data.pollCnf.status = ApiMac_status_noData;
+
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeResetReq(bool setDefaultPib)
+{
+    if(setDefaultPib)
+    {
+        memset(pibValues, 0, sizeof(pibValues));
+    }
+    return (ApiMac_status_success);
+}
+
+/* Every scan finds the coordinator on the first channel scanned */
+ApiMac_status_t ApiMac_mlmeScanReq(ApiMac_mlmeScanReq_t *pData)
+{
+    macEvent_t *pBeacon;
+    macEvent_t *pEvent;
+    uint8_t channel = 0;
+    uint8_t i;
+
+    if(numMacEvents > (API_MAC_POSIX_MAX_EVENTS - 2))
+    {
+        return (ApiMac_status_transactionOverflow);
+    }
+
+    macStats.scanReqs++;
+
+    for(i = 0; i < (APIMAC_154G_CHANNEL_BITMAP_SIZ * 8); i++)
+    {
+        if(pData->scanChannels[i / 8] & (1 << (i % 8)))
+        {
+            channel = i;
+            break;
+        }
+    }
+
+    pBeacon = addEvent(macEvent_beaconNotifyInd, API_MAC_POSIX_CNF_DELAY);
+    pBeacon->data.beaconNotifyInd.beaconType = ApiMac_beaconType_normal;
+    pBeacon->data.beaconNotifyInd.panDesc.coordAddress.addrMode =
+        ApiMac_addrType_short;
+    pBeacon->data.beaconNotifyInd.panDesc.coordAddress.addr.shortAddr =
+        API_MAC_POSIX_COORD_ADDR;
+    pBeacon->data.beaconNotifyInd.panDesc.coordPanId = API_MAC_POSIX_PAN_ID;
+    pBeacon->data.beaconNotifyInd.panDesc.superframeSpec =
+        COORD_SUPERFRAME_SPEC;
+    pBeacon->data.beaconNotifyInd.panDesc.logicalChannel = channel;
+    pBeacon->data.beaconNotifyInd.panDesc.linkQuality = 0xFF;
+    pBeacon->data.beaconNotifyInd.panDesc.timestamp = Clock_getTicks();
+
+    pEvent = addEvent(macEvent_scanCnf, API_MAC_POSIX_CNF_DELAY);
+    pEvent->data.scanCnf.status = ApiMac_status_success;
+    pEvent->data.scanCnf.scanType = pData->scanType;
+    pEvent->data.scanCnf.channelPage = pData->channelPage;
+    pEvent->data.scanCnf.phyId = pData->phyID;
+
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSyncReq(ApiMac_mlmeSyncReq_t *pData)
+{
+    (void)pData;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeWSAsyncReq(ApiMac_mlmeWSAsyncReq_t *pData)
+{
+    macEvent_t *pEvent = addEvent(macEvent_wsAsyncCnf,
+                                  API_MAC_POSIX_CNF_DELAY);
+
+    (void)pData;
+
+    if(pEvent == NULL)
+    {
+        return (ApiMac_status_transactionOverflow);
+    }
+
+    pEvent->data.wsAsyncCnf.status = ApiMac_status_success;
+
+    return (ApiMac_status_success);
+}
+
+/******************************************************************************
+ PIB
+ *****************************************************************************/
+
+ApiMac_status_t ApiMac_mlmeGetReqBool(ApiMac_attribute_bool_t pibAttribute,
+                                      bool *pValue)
+{
+    *pValue = (pibValues[pibAttribute & 0xFF] != 0);
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeGetReqUint8(ApiMac_attribute_uint8_t pibAttribute,
+                                       uint8_t *pValue)
+{
+    *pValue = (uint8_t)pibValues[pibAttribute & 0xFF];
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeGetReqUint16(
+                ApiMac_attribute_uint16_t pibAttribute, uint16_t *pValue)
+{
+    *pValue = (uint16_t)pibValues[pibAttribute & 0xFF];
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeGetReqUint32(
+                ApiMac_attribute_uint32_t pibAttribute, uint32_t *pValue)
+{
+    *pValue = pibValues[pibAttribute & 0xFF];
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeGetReqArray(ApiMac_attribute_array_t pibAttribute,
+                                       uint8_t *pValue)
+{
+    if(pibAttribute == ApiMac_attribute_extendedAddress)
+    {
+        memcpy(pValue, ApiMac_extAddr, APIMAC_SADDR_EXT_LEN);
+    }
+    else if(pibAttribute == ApiMac_attribute_coordExtendedAddress)
+    {
+        memcpy(pValue, coordExtAddr, APIMAC_SADDR_EXT_LEN);
+    }
+    else
+    {
+        return (ApiMac_status_unsupportedAttribute);
+    }
+
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetReqBool(ApiMac_attribute_bool_t pibAttribute,
+                                      bool value)
+{
+    pibValues[pibAttribute & 0xFF] = value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetReqUint8(ApiMac_attribute_uint8_t pibAttribute,
+                                       uint8_t value)
+{
+    pibValues[pibAttribute & 0xFF] = value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetReqUint16(
+                ApiMac_attribute_uint16_t pibAttribute, uint16_t value)
+{
+    pibValues[pibAttribute & 0xFF] = value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetReqUint32(
+                ApiMac_attribute_uint32_t pibAttribute, uint32_t value)
+{
+    pibValues[pibAttribute & 0xFF] = value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetReqArray(ApiMac_attribute_array_t pibAttribute,
+                                       uint8_t *pValue)
+{
+    if(pibAttribute == ApiMac_attribute_extendedAddress)
+    {
+        memcpy(ApiMac_extAddr, pValue, APIMAC_SADDR_EXT_LEN);
+    }
+    return (ApiMac_status_success);
+}
+
+/* Frequency hopping and security are accepted and ignored */
+
+ApiMac_status_t ApiMac_mlmeSetFhReqUint8(
+                ApiMac_FHAttribute_uint8_t pibAttribute, uint8_t value)
+{
+    (void)pibAttribute;
+    (void)value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetFhReqUint16(
+                ApiMac_FHAttribute_uint16_t pibAttribute, uint16_t value)
+{
+    (void)pibAttribute;
+    (void)value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetFhReqUint32(
+                ApiMac_FHAttribute_uint32_t pibAttribute, uint32_t value)
+{
+    (void)pibAttribute;
+    (void)value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetFhReqArray(
+                ApiMac_FHAttribute_array_t pibAttribute, uint8_t *pValue)
+{
+    (void)pibAttribute;
+    (void)pValue;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetSecurityReqUint8(
+                ApiMac_securityAttribute_uint8_t pibAttribute, uint8_t value)
+{
+    (void)pibAttribute;
+    (void)value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetSecurityReqUint16(
+                ApiMac_securityAttribute_uint16_t pibAttribute, uint16_t value)
+{
+    (void)pibAttribute;
+    (void)value;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetSecurityReqArray(
+                ApiMac_securityAttribute_array_t pibAttribute, uint8_t *pValue)
+{
+    (void)pibAttribute;
+    (void)pValue;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_mlmeSetSecurityReqStruct(
+                ApiMac_securityAttribute_struct_t pibAttribute, void *pValue)
+{
+    (void)pibAttribute;
+    (void)pValue;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_secAddDevice(ApiMac_secAddDevice_t *pAddDevice)
+{
+    (void)pAddDevice;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_secDeleteDevice(ApiMac_sAddrExt_t *pExtAddr)
+{
+    (void)pExtAddr;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_secDeleteAllDevices(void)
+{
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_secAddKeyInitFrameCounter(
+                ApiMac_secAddKeyInitFrameCounter_t *pInfo)
+{
+    (void)pInfo;
+    return (ApiMac_status_success);
+}
+
+/******************************************************************************
+ Miscellaneous
+ *****************************************************************************/
+
+uint8_t ApiMac_randomByte(void)
+{
+    return ((uint8_t)Random_getNumber());
+}
+
+ApiMac_status_t ApiMac_updatePanId(uint16_t panId)
+{
+    pibValues[ApiMac_attribute_panId] = panId;
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_srcMatchEnable(void)
+{
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_startFH(void)
+{
+    return (ApiMac_status_success);
+}
+
+ApiMac_status_t ApiMac_enableFH(void)
+{
+    return (ApiMac_status_success);
+}
+
+/* No IEs are ever received, so there is nothing to parse */
+ApiMac_status_t ApiMac_parsePayloadGroupIEs(uint8_t *pPayload,
+                                            uint16_t payloadLen,
+                                            ApiMac_payloadIeRec_t **pList)
+{
+    (void)pPayload;
+    (void)payloadLen;
+    *pList = NULL;
+    return (ApiMac_status_noData);
+}
+
+ApiMac_status_t ApiMac_parsePayloadSubIEs(uint8_t *pContent,
+                                          uint16_t contentLen,
+                                          ApiMac_payloadIeRec_t **pList)
+{
+    (void)pContent;
+    (void)contentLen;
+    *pList = NULL;
+    return (ApiMac_status_noData);
+}
+
+void ApiMac_freeIEList(ApiMac_payloadIeRec_t *pList)
+{
+    while(pList)
+    {
+        ApiMac_payloadIeRec_t *pTmp = pList;
+
+        pList = pTmp->pNext;
+        OsalPort_free(pTmp);
+    }
+}
+
+/******************************************************************************
+ Simulation control
+ *****************************************************************************/
+
+/*!
+ Deliver a data indication from the coordinator.
+
+ Public function defined in api_mac_posix.h
+ */
+bool ApiMacPosix_dataInd(const uint8_t *pMsdu, uint16_t len, uint32_t delay)
+{
+    macEvent_t *pEvent;
+    uint8_t *pCopy;
+
+    pCopy = malloc((len != 0) ? len : 1);
+    if(pCopy == NULL)
+    {
+        return (false);
+    }
+
+    pEvent = addEvent(macEvent_dataInd, delay);
+    if(pEvent == NULL)
+    {
+        free(pCopy);
+        return (false);
+    }
+
+    memcpy(pCopy, pMsdu, len);
+
+    pEvent->data.dataInd.srcAddr.addrMode = ApiMac_addrType_short;
+    pEvent->data.dataInd.srcAddr.addr.shortAddr = API_MAC_POSIX_COORD_ADDR;
+    pEvent->data.dataInd.dstAddr.addrMode = ApiMac_addrType_short;
+    pEvent->data.dataInd.dstAddr.addr.shortAddr =
+        (uint16_t)pibValues[ApiMac_attribute_shortAddress];
+    pEvent->data.dataInd.srcPanId = API_MAC_POSIX_PAN_ID;
+    pEvent->data.dataInd.dstPanId = API_MAC_POSIX_PAN_ID;
+    pEvent->data.dataInd.mpduLinkQuality = 0xFF;
+    pEvent->data.dataInd.rssi = -40;
+    pEvent->data.dataInd.msdu.p = pCopy;
+    pEvent->data.dataInd.msdu.len = len;
+
+    return (true);
+}
+
+/*!
+ Set the status of the next data confirms.
+
+ Public function defined in api_mac_posix.h
+ */
+void ApiMacPosix_setDataCnfStatus(ApiMac_status_t status, uint32_t count)
+{
+    dataCnfStatus = (count != 0) ? status : ApiMac_status_success;
+    dataCnfStatusCount = count;
+}
+
+/*!
+ Get the request counts.
+
+ Public function defined in api_mac_posix.h
+ */
+void ApiMacPosix_getStats(ApiMacPosix_stats_t *pStats)
+{
+    memcpy(pStats, &macStats, sizeof(ApiMacPosix_stats_t));
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Queue an event, after the events due at the same time or
+ *          earlier.
+ *
+ * @param   type - event type
+ * @param   delay - time until delivery, in milliseconds
+ *
+ * @return  event to fill in, NULL if the queue is full
+ */
+static macEvent_t *addEvent(macEventType_t type, uint32_t delay)
+{
+    uint64_t due = SimRtos_getTime() + (delay * (1000 / Clock_tickPeriod));
+    uint8_t i;
+
+    if(numMacEvents >= API_MAC_POSIX_MAX_EVENTS)
+    {
+        return (NULL);
+    }
+
+    i = numMacEvents;
+    while((i > 0) && (macEvents[i - 1].due > due))
+    {
+        macEvents[i] = macEvents[i - 1];
+        i--;
+    }
+
+    memset(&macEvents[i], 0, sizeof(macEvent_t));
+    macEvents[i].type = type;
+    macEvents[i].due = due;
+    numMacEvents++;
+
+    scheduleDelivery();
+
+    return (&macEvents[i]);
+}
+
+/*!
+ * @brief   Start the delivery clock for the first event.
+ */
+static void scheduleDelivery(void)
+{
+    uint64_t now = SimRtos_getTime();
+
+    Clock_stop(Clock_handle(&deliveryClock));
+
+    if(numMacEvents != 0)
+    {
+        Clock_setTimeout(Clock_handle(&deliveryClock),
+                         (macEvents[0].due > now) ?
+                         (uint32_t)(macEvents[0].due - now) : 0);
+        Clock_start(Clock_handle(&deliveryClock));
+    }
+}
+
+/*!
+ * @brief   Delivery clock function, wakes up the application.
+ *
+ * @param   arg - not used
+ */
+static void deliveryClockCb(UArg arg)
+{
+    (void)arg;
+    Semaphore_post(Semaphore_handle(&appSem));
+}
+
+/*!
+ * @brief   Deliver the first event if it is due.
+ *
+ * @return  true if an event was delivered
+ */
+static bool deliverEvent(void)
+{
+    macEvent_t event;
+    uint8_t i;
+
+    if((numMacEvents == 0) || (macEvents[0].due > SimRtos_getTime()))
+    {
+        return (false);
+    }
+
+    event = macEvents[0];
+    numMacEvents--;
+    for(i = 0; i < numMacEvents; i++)
+    {
+        macEvents[i] = macEvents[i + 1];
+    }
+
+    scheduleDelivery();
+
+    /* Wake up again for the next event already due */
+    if((numMacEvents != 0) && (macEvents[0].due <= SimRtos_getTime()))
+    {
+        Semaphore_post(Semaphore_handle(&appSem));
+    }
+
+    if(pMacCallbacks == NULL)
+    {
+        if(event.type == macEvent_dataInd)
+        {
+            free(event.data.dataInd.msdu.p);
+        }
+        return (true);
+    }
+
+    switch(event.type)
+    {
+        case macEvent_dataCnf:
+            if(pMacCallbacks->pDataCnfCb != NULL)
+            {
+                pMacCallbacks->pDataCnfCb(&event.data.dataCnf);
+            }
+            break;
+
+        case macEvent_assocCnf:
+            if(pMacCallbacks->pAssocCnfCb != NULL)
+            {
+                pMacCallbacks->pAssocCnfCb(&event.data.assocCnf);
+            }
+            break;
+
+        case macEvent_beaconNotifyInd:
+            if(pMacCallbacks->pBeaconNotifyIndCb != NULL)
+            {
+                pMacCallbacks->pBeaconNotifyIndCb(&event.data.beaconNotifyInd);
+            }
+            break;
+
+        case macEvent_scanCnf:
+            if(pMacCallbacks->pScanCnfCb != NULL)
+            {
+                pMacCallbacks->pScanCnfCb(&event.data.scanCnf);
+            }
+            break;
+
+        case macEvent_pollCnf:
+            if(pMacCallbacks->pPollCnfCb != NULL)
+            {
+                pMacCallbacks->pPollCnfCb(&event.data.pollCnf);
+            }
+            break;
+
+        case macEvent_disassocCnf:
+            if(pMacCallbacks->pDisassociateCnfCb != NULL)
+            {
+                pMacCallbacks->pDisassociateCnfCb(&event.data.disassocCnf);
+            }
+            break;
+
+        case macEvent_wsAsyncCnf:
+            if(pMacCallbacks->pWsAsyncCnfCb != NULL)
+            {
+                pMacCallbacks->pWsAsyncCnfCb(&event.data.wsAsyncCnf);
+            }
+            break;
+
+        case macEvent_dataInd:
+            macStats.dataInds++;
+            if(pMacCallbacks->pDataIndCb != NULL)
+            {
+                pMacCallbacks->pDataIndCb(&event.data.dataInd);
+            }
+            free(event.data.dataInd.msdu.p);
+            break;
+
+        default:
+            break;
+    }
+
+    return (true);
+}
@@ -0,0 +1,162 @@
+/******************************************************************************
+
+ @file api_mac_posix.h
+
+ @brief Simulated MAC behind the ApiMac interface, for host builds
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef ApiMacPosix_H
+#define ApiMacPosix_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "api_mac.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup ApiMacPosix Simulated MAC
+ <BR>
+ Implements the ApiMac interface of api_mac.h without a radio, on top of
+ the simulated kernel of sim_rtos.h. A single coordinator answers the
+ device: scans find it, association succeeds, data requests are
+ acknowledged and polls find no data. Each confirm is delivered through the
+ registered callbacks by ApiMac_processIncoming(), after the simulated air
+ time.
+ <BR>
+ Tests can inject data indications, like configuration requests from the
+ collector, and make data requests fail to exercise the retry paths.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup ApiMacPosix
+ * @{
+ */
+
+/*! Simulated time between a request and its confirm, in milliseconds */
+#ifndef API_MAC_POSIX_CNF_DELAY
+#define API_MAC_POSIX_CNF_DELAY 5
+#endif
+
+/*! Number of confirms and indications that can wait for delivery */
+#ifndef API_MAC_POSIX_MAX_EVENTS
+#define API_MAC_POSIX_MAX_EVENTS 16
+#endif
+
+/*! PAN ID of the simulated coordinator */
+#define API_MAC_POSIX_PAN_ID 0x0001
+
+/*! Short address of the simulated coordinator */
+#define API_MAC_POSIX_COORD_ADDR 0xAABB
+
+/*! Short address given to the device when it associates */
+#define API_MAC_POSIX_DEVICE_ADDR 0x0001
+
+/*! Request counts */
+typedef struct
+{
+    /*! Data requests */
+    uint32_t dataReqs;
+    /*! Data requests confirmed with a failure */
+    uint32_t dataFails;
+    /*! Poll requests */
+    uint32_t pollReqs;
+    /*! Scan requests */
+    uint32_t scanReqs;
+    /*! Association requests */
+    uint32_t assocReqs;
+    /*! Data indications delivered */
+    uint32_t dataInds;
+} ApiMacPosix_stats_t;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Deliver a data indication from the coordinator.
+ *
+ * @param   pMsdu - payload, copied
+ * @param   len - payload length
+ * @param   delay - simulated time before delivery, in milliseconds
+ *
+ * @return  true if queued, false if there is no room
+ */
+extern bool ApiMacPosix_dataInd(const uint8_t *pMsdu, uint16_t len,
+                                uint32_t delay);
+
+/*!
+ * @brief   Set the status of the next data confirms.
+ *
+ * @param   status - ApiMac_status_success, or a failure like
+ *                   ApiMac_status_noAck
+ * @param   count - number of data confirms to give this status, then
+ *                  the status goes back to success
+ */
+extern void ApiMacPosix_setDataCnfStatus(ApiMac_status_t status,
+                                         uint32_t count);
+
+/*!
+ * @brief   Get the request counts.
+ *
+ * @param   pStats - place to put the counts
+ */
+extern void ApiMacPosix_getStats(ApiMacPosix_stats_t *pStats);
+
+/*! @} end group ApiMacPosix */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ApiMacPosix_H */
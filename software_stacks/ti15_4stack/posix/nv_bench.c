@@ -0,0 +1,1351 @@
+/******************************************************************************
+
+ @file nv_bench.c
+
+ @brief NV driver benchmark and power loss check, for host builds
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs a workload of NV item operations through nvocmp.c over the simulated
+flash of nv_linux.c, and reports:
+  - write amplification: bytes written to flash for each byte of item data
+  - compactions: item operations that had to erase a page
+  - simulated flash time of each operation kind: median, 90th and 99th
+    percentile and maximum
+  - erases of each page
+  - item CRCs: after the run, the CRC of every item copy on the flash is
+    computed bit by bit a byte at a time, through 32 byte copies like the
+    driver did before, and in place like it does now. The three have to
+    agree with each other and with the CRC in the item header.
+  - after the run, a boot from the flash it left: the simulated flash time
+    of initNV and of reading every item once. Build once more with
+    -DNVOCMP_RAMIDX=0 to compare the boot and the reads without the RAM
+    index.
+
+With -f, the workload instead runs in child processes that lose power at a
+random write or erase. Each child first boots from the flash the previous
+one left, and checks that every item reads back as last written, except the
+item of the interrupted operation, which can have its old or its new value.
+
+Workloads:
+  sensor - the NV use of the sensor application, one reporting interval at a
+           time: the frame counter saved every 25 frames, configuration
+           rewrites, mostly with the same value, rejoins, resets, and now and
+           then an OAD that saves its block number for each block.
+  random - writes, creates, deletes and reads of random lengths on 40 items.
+  fill   - 40 cold items of 80 bytes, then rewrites of 4 hot ones, so each
+           compaction has much to copy.
+  txn    - transactions of 1 to 4 of 12 items, and single writes. After a
+           power loss in a commit the items of the transaction must all have
+           their old values or all their new ones.
+
+Build, from software_stacks/ti15_4stack:
+  cc -O2 -DNV_LINUX -DNVOCMP_POSIX_MUTEX -Iposix -Iservices -I../../drivers/nv
+     posix/nv_bench.c posix/nv_linux.c services/nvocmp.c services/crc.c
+     -lpthread -o nv_bench
+Options of the driver, like -DNVOCMP_NVPAGES=3, go on the same line.
+
+Usage: nv_bench [-w sensor|random|fill|txn] [-n ops] [-s seed] [-c items]
+                [-f trials] [-i file] [-u]
+  -n  item operations, default 100000
+  -s  seed of the workload, default 1
+  -c  call NVOCMP_compactStep(items) after each operation, needs a build
+      with -DNVOCMP_BGCOMPACT=1
+  -f  power loss trials, instead of the benchmark
+  -i  keep the flash in this file
+  -u  the flash is not addressable, the driver computes CRCs from block
+      reads
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "nvocmp.h"
+#include "nv_linux.h"
+#include "crc.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Items and their largest length */
+#define BENCH_MAX_ITEMS 48
+#define BENCH_MAX_LEN   96
+
+/* Operations a workload step can queue */
+#define BENCH_MAX_QUEUE 16
+
+/* Writes and erases a child runs, at most, before it loses power */
+#define BENCH_FAULT_WINDOW 3000
+
+/* Seconds a child can run before it is taken as stuck */
+#define BENCH_FAULT_TIMEOUT 20
+
+/* Items of a transaction, at most */
+#define BENCH_MAX_TXN 4
+
+/* Item layout of nvocmp.c, to find the items on the flash */
+#define BENCH_PGDATAOFS  16
+#define BENCH_ITEMHDRLEN 7
+#define BENCH_HDRCRCINC  5
+#define BENCH_SIGNATURE  0x96
+
+/* CRC8 polynomial of crc.c */
+#define BENCH_CRC_POLY   0x97
+
+/* Block of the copies the driver used to compute CRCs from */
+#define BENCH_CRC_BLOCK  32
+
+/* Default of nvocmp.c, only to label the boot numbers */
+#ifndef NVOCMP_RAMIDX
+#define NVOCMP_RAMIDX 1
+#endif
+
+/* Item operations */
+typedef enum
+{
+    BENCH_WRITE,
+    BENCH_CREATE,
+    BENCH_DELETE,
+    BENCH_READ,
+    BENCH_STAGE,
+    BENCH_COMMIT,
+    BENCH_COMPACT,
+    BENCH_OP_KINDS
+} benchKind_t;
+
+/* Item operation */
+typedef struct
+{
+    benchKind_t kind;
+    uint8_t item;
+    uint16_t len;
+    uint8_t data[BENCH_MAX_LEN];
+} benchOp_t;
+
+/* Expected state of an item */
+typedef struct
+{
+    NVINTF_itemID_t id;
+    bool live;
+    uint16_t len;
+    uint8_t data[BENCH_MAX_LEN];
+} benchItem_t;
+
+/* State shared with the child processes */
+typedef struct
+{
+    benchItem_t items[BENCH_MAX_ITEMS];
+    uint8_t numItems;
+    /* Operation in progress and the state of its item before it */
+    bool inFlight;
+    benchOp_t op;
+    benchItem_t before;
+    /* Writes staged for the next commit and the state of their items
+       before it */
+    benchOp_t txn[BENCH_MAX_TXN];
+    benchItem_t txnBefore[BENCH_MAX_TXN];
+    uint8_t txnItems;
+    /* Workload position */
+    uint32_t random;
+    uint32_t tick;
+    uint32_t done;
+    /* Bytes of item data written */
+    uint64_t userBytes;
+} benchShared_t;
+
+/* Workload step, queues the operations of the next step */
+typedef void (*benchWorkload_t)(void);
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+static const char * const kindNames[BENCH_OP_KINDS] =
+{
+    "write", "create", "delete", "read", "stage", "commit", "compact"
+};
+
+static NVINTF_nvFuncts_t nv;
+
+static benchShared_t *pBench;
+
+/* Operations queued by the workload */
+static benchOp_t queue[BENCH_MAX_QUEUE];
+static uint8_t queued;
+static uint8_t next;
+
+/* Simulated time of each operation, in nanoseconds, for each kind */
+static uint32_t *pTimes[BENCH_OP_KINDS];
+static uint32_t numTimes[BENCH_OP_KINDS];
+
+/* Operations that erased a page */
+static uint32_t compactions;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static uint32_t benchRandom(uint32_t range);
+static uint8_t addItem(uint16_t itemID, uint16_t subID);
+static benchOp_t *queueOp(benchKind_t kind, uint8_t item, uint16_t len);
+static void fillRandom(benchOp_t *pOp);
+static void sensorWorkload(void);
+static void randomWorkload(void);
+static void fillWorkload(void);
+static void txnWorkload(void);
+static bool runOp(const benchOp_t *pOp, uint16_t compactItems);
+static int checkItems(bool report);
+static void checkTxn(void);
+static bool itemReads(const benchItem_t *pItem, bool live, uint16_t len,
+                      const uint8_t *pData);
+static void runWorkload(benchWorkload_t workload, uint32_t ops,
+                        uint16_t compactItems);
+static int benchRun(benchWorkload_t workload, uint32_t ops,
+                    uint16_t compactItems, bool image);
+static void report(void);
+static int checkCrcs(void);
+static uint8_t bitCrc(uint8_t crc, const uint8_t *pData, uint16_t len);
+static uint8_t blockCrc(uint8_t crc, const uint8_t *pData, uint16_t len);
+static int bootTimes(void);
+static int cmpTimes(const void *pA, const void *pB);
+static void powerLost(void);
+static int faultTrials(benchWorkload_t workload, uint32_t ops, uint32_t trials,
+                       uint16_t compactItems);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    benchWorkload_t workload = sensorWorkload;
+    uint32_t ops = 100000;
+    uint32_t seed = 1;
+    uint32_t trials = 0;
+    uint16_t compactItems = 0;
+    bool image = false;
+    int opt;
+    int bad;
+    int status;
+    pid_t pid;
+
+    while((opt = getopt(argc, argv, "w:n:s:c:f:i:u")) != -1)
+    {
+        switch(opt)
+        {
+            case 'w':
+                if(strcmp(optarg, "random") == 0)
+                {
+                    workload = randomWorkload;
+                }
+                else if(strcmp(optarg, "fill") == 0)
+                {
+                    workload = fillWorkload;
+                }
+                else if(strcmp(optarg, "txn") == 0)
+                {
+                    workload = txnWorkload;
+                }
+                else if(strcmp(optarg, "sensor") != 0)
+                {
+                    fprintf(stderr, "unknown workload %s\n", optarg);
+                    return (2);
+                }
+                break;
+            case 'n':
+                ops = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'c':
+                compactItems = (uint16_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'f':
+                trials = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                NvLinux_setFile(optarg);
+                image = true;
+                break;
+            case 'u':
+                NvLinux_setAddressable(false);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-w sensor|random|fill|txn] [-n ops] "
+                        "[-s seed] [-c items] [-f trials] [-i file] [-u]\n",
+                        argv[0]);
+                return (2);
+        }
+    }
+
+#if !(defined(NVOCMP_BGCOMPACT) && NVOCMP_BGCOMPACT)
+    if(compactItems != 0)
+    {
+        fprintf(stderr, "-c needs a build with -DNVOCMP_BGCOMPACT=1\n");
+        return (2);
+    }
+#endif
+
+    pBench = mmap(NULL, sizeof(benchShared_t), PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(pBench == MAP_FAILED)
+    {
+        perror("mmap");
+        return (2);
+    }
+    memset(pBench, 0, sizeof(benchShared_t));
+    pBench->random = (seed != 0) ? seed : 1;
+
+    /* The workload declares its items on its first step */
+    workload();
+    NvLinux_format();
+
+    if(trials != 0)
+    {
+        bad = faultTrials(workload, ops, trials, compactItems);
+        return (bad != 0);
+    }
+
+    /* The driver initializes once per reset, so the run gets a process of
+       its own and the boot after it can be timed here */
+    fflush(stdout);
+    pid = fork();
+    if(pid < 0)
+    {
+        perror("fork");
+        return (2);
+    }
+    if(pid == 0)
+    {
+        exit(benchRun(workload, ops, compactItems, image) != 0);
+    }
+    bad = ((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) ||
+           (WEXITSTATUS(status) != 0));
+
+    bad += bootTimes();
+
+    return (bad != 0);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Random number of the workload.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t benchRandom(uint32_t range)
+{
+    uint32_t x = pBench->random;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    pBench->random = x;
+
+    return (x % range);
+}
+
+/*!
+ * @brief       Declare an item of the workload.
+ *
+ * @param       itemID - item ID of the application system
+ * @param       subID - sub ID
+ *
+ * @return      item index
+ */
+static uint8_t addItem(uint16_t itemID, uint16_t subID)
+{
+    uint8_t i;
+    benchItem_t *pItem;
+
+    for(i = 0; i < pBench->numItems; i++)
+    {
+        pItem = &pBench->items[i];
+        if((pItem->id.itemID == itemID) && (pItem->id.subID == subID))
+        {
+            return (i);
+        }
+    }
+
+    pItem = &pBench->items[pBench->numItems];
+    pItem->id.systemID = NVINTF_SYSID_APP;
+    pItem->id.itemID = itemID;
+    pItem->id.subID = subID;
+
+    return (pBench->numItems++);
+}
+
+/*!
+ * @brief       Queue an operation of the current workload step.
+ *
+ * @param       kind - operation
+ * @param       item - item index
+ * @param       len - data length, for writes and creates
+ *
+ * @return      queued operation, to fill in its data
+ */
+static benchOp_t *queueOp(benchKind_t kind, uint8_t item, uint16_t len)
+{
+    benchOp_t *pOp = &queue[queued++];
+
+    pOp->kind = kind;
+    pOp->item = item;
+    pOp->len = len;
+
+    return (pOp);
+}
+
+/*!
+ * @brief       Fill the data of an operation with random bytes.
+ *
+ * @param       pOp - operation
+ */
+static void fillRandom(benchOp_t *pOp)
+{
+    uint16_t i;
+
+    for(i = 0; i < pOp->len; i++)
+    {
+        pOp->data[i] = (uint8_t)benchRandom(0x100);
+    }
+}
+
+/*!
+ * @brief       One reporting interval of the sensor application.
+ */
+static void sensorWorkload(void)
+{
+    /* Item IDs of ssf.c */
+    uint8_t nwk = addItem(0x0001, 0);
+    uint8_t cfg = addItem(0x0002, 0);
+    uint8_t frm = addItem(0x0004, 0);
+    uint8_t rst = addItem(0x0005, 0);
+    uint8_t cnt = addItem(0x0006, 0);
+    uint8_t oad = addItem(0x0007, 0);
+    uint8_t hdr = addItem(0x0007, 1);
+    uint8_t img = addItem(0x0007, 2);
+    uint8_t srv = addItem(0x0007, 3);
+    uint32_t tick = pBench->tick++;
+    uint32_t oadTick = tick % 50000;
+    benchOp_t *pOp;
+
+    if(tick % 10000 == 0)
+    {
+        /* Reset: reason, count, then the saved state is read back */
+        queueOp(BENCH_READ, rst, 1);
+        queueOp(BENCH_DELETE, rst, 0);
+        queueOp(BENCH_READ, cnt, 2);
+        pOp = queueOp(BENCH_WRITE, cnt, 2);
+        pOp->data[0] = (uint8_t)(tick / 10000);
+        pOp->data[1] = (uint8_t)(tick / 10000 >> 8);
+        queueOp(BENCH_READ, nwk, 24);
+        queueOp(BENCH_READ, cfg, 6);
+        queueOp(BENCH_READ, frm, 4);
+    }
+
+    if(tick % 5000 == 0)
+    {
+        /* Joined or rejoined the network */
+        pOp = queueOp(BENCH_WRITE, nwk, 24);
+        fillRandom(pOp);
+    }
+
+    if(tick % 25 == 0)
+    {
+        /* Frame counter went past the save window */
+        pOp = queueOp(BENCH_WRITE, frm, 4);
+        memcpy(pOp->data, &tick, sizeof(tick));
+    }
+
+    if(tick % 200 == 100)
+    {
+        /* Configuration request, the same settings most of the time */
+        pOp = queueOp(BENCH_WRITE, cfg, 6);
+        memset(pOp->data, 0, 6);
+        pOp->data[0] = (benchRandom(10) == 0) ? (uint8_t)tick : 0x5A;
+    }
+
+    if(oadTick == 40000)
+    {
+        /* OAD starts, its state is saved in one transaction */
+        pOp = queueOp(BENCH_STAGE, oad, 2);
+        memset(pOp->data, 0, 2);
+        pOp = queueOp(BENCH_STAGE, hdr, 16);
+        fillRandom(pOp);
+        pOp = queueOp(BENCH_STAGE, img, 1);
+        pOp->data[0] = 1;
+        pOp = queueOp(BENCH_STAGE, srv, 10);
+        fillRandom(pOp);
+        queueOp(BENCH_COMMIT, oad, 0);
+    }
+
+    if((oadTick > 40000) && (oadTick < 42000))
+    {
+        /* OAD block received */
+        pOp = queueOp(BENCH_WRITE, oad, 2);
+        pOp->data[0] = (uint8_t)(oadTick - 40000);
+        pOp->data[1] = (uint8_t)((oadTick - 40000) >> 8);
+    }
+
+    if(oadTick == 42000)
+    {
+        /* OAD done */
+        queueOp(BENCH_DELETE, oad, 0);
+        queueOp(BENCH_DELETE, hdr, 0);
+        queueOp(BENCH_DELETE, img, 0);
+        queueOp(BENCH_DELETE, srv, 0);
+    }
+}
+
+/*!
+ * @brief       One random operation.
+ */
+static void randomWorkload(void)
+{
+    uint8_t i;
+    uint32_t r;
+    benchOp_t *pOp;
+
+    while(pBench->numItems < 40)
+    {
+        addItem((uint16_t)(pBench->numItems % 8 + 1),
+                (uint16_t)(pBench->numItems / 8));
+    }
+
+    i = (uint8_t)benchRandom(pBench->numItems);
+    r = benchRandom(10);
+    if(r < 7)
+    {
+        pOp = queueOp(BENCH_WRITE, i, (uint16_t)(1 + benchRandom(63)));
+        fillRandom(pOp);
+    }
+    else if(r < 8)
+    {
+        queueOp(BENCH_DELETE, i, 0);
+    }
+    else if(r < 9)
+    {
+        pOp = queueOp(BENCH_CREATE, i, 4);
+        memcpy(pOp->data, "abcd", 4);
+    }
+    else
+    {
+        queueOp(BENCH_READ, i, 1);
+    }
+}
+
+/*!
+ * @brief       One cold or hot item write.
+ */
+static void fillWorkload(void)
+{
+    uint32_t tick = pBench->tick++;
+    benchOp_t *pOp;
+
+    while(pBench->numItems < 44)
+    {
+        addItem((uint16_t)(0x100 + pBench->numItems), 0);
+    }
+
+    if(tick < 40)
+    {
+        pOp = queueOp(BENCH_WRITE, (uint8_t)(4 + tick), 80);
+    }
+    else if(benchRandom(10) != 0)
+    {
+        pOp = queueOp(BENCH_WRITE, (uint8_t)benchRandom(4), 8);
+    }
+    else
+    {
+        pOp = queueOp(BENCH_WRITE, (uint8_t)(4 + benchRandom(40)), 80);
+    }
+    fillRandom(pOp);
+}
+
+/*!
+ * @brief       One transaction or single write.
+ */
+static void txnWorkload(void)
+{
+    uint8_t i;
+    uint8_t n;
+    uint8_t first;
+    benchOp_t *pOp;
+
+    while(pBench->numItems < 12)
+    {
+        addItem((uint16_t)(0x200 + pBench->numItems), 0);
+    }
+
+    if(benchRandom(4) == 0)
+    {
+        pOp = queueOp(BENCH_WRITE, (uint8_t)benchRandom(pBench->numItems),
+                      (uint16_t)(1 + benchRandom(40)));
+        fillRandom(pOp);
+        return;
+    }
+
+    n = (uint8_t)(1 + benchRandom(BENCH_MAX_TXN));
+    first = (uint8_t)benchRandom(pBench->numItems - n + 1);
+    for(i = 0; i < n; i++)
+    {
+        pOp = queueOp(BENCH_STAGE, (uint8_t)(first + i),
+                      (uint16_t)(1 + benchRandom(40)));
+        fillRandom(pOp);
+    }
+    queueOp(BENCH_COMMIT, first, 0);
+}
+
+/*!
+ * @brief       Run an item operation and check its result.
+ *
+ * @param       pOp - operation
+ * @param       compactItems - items to compact afterwards, 0 for none
+ *
+ * @return      true if the result is as expected
+ */
+static bool runOp(const benchOp_t *pOp, uint16_t compactItems)
+{
+    benchItem_t *pItem = &pBench->items[pOp->item];
+    NvLinux_stats_t s0;
+    NvLinux_stats_t s1;
+    uint8_t buf[BENCH_MAX_LEN];
+    uint8_t status;
+    uint8_t expected = NVINTF_SUCCESS;
+    uint8_t i;
+    bool ok;
+
+    pBench->before = *pItem;
+    pBench->op = *pOp;
+    pBench->inFlight = true;
+
+    NvLinux_getStats(&s0);
+    switch(pOp->kind)
+    {
+        case BENCH_WRITE:
+            status = nv.writeItem(pItem->id, pOp->len, (void *)pOp->data);
+            break;
+        case BENCH_CREATE:
+            status = nv.createItem(pItem->id, pOp->len, (void *)pOp->data);
+            expected = pItem->live ? NVINTF_EXIST : NVINTF_SUCCESS;
+            break;
+        case BENCH_DELETE:
+            status = nv.deleteItem(pItem->id);
+            expected = pItem->live ? NVINTF_SUCCESS : NVINTF_NOTFOUND;
+            break;
+        case BENCH_STAGE:
+            if(nv.beginTxn == NULL)
+            {
+                /* No transactions, the items are written one at a time */
+                status = nv.writeItem(pItem->id, pOp->len, (void *)pOp->data);
+                break;
+            }
+            if(pBench->txnItems == 0)
+            {
+                status = nv.beginTxn();
+                /* Transactions do not nest */
+                if((status == NVINTF_SUCCESS)
+                   && (nv.beginTxn() != NVINTF_FAILURE))
+                {
+                    status = NVINTF_FAILURE;
+                }
+                if(status != NVINTF_SUCCESS)
+                {
+                    break;
+                }
+            }
+            /* The driver reads the data when committing */
+            pBench->txn[pBench->txnItems] = *pOp;
+            status = nv.stageItem(pItem->id, pOp->len,
+                                  pBench->txn[pBench->txnItems].data);
+            pBench->txnItems++;
+            break;
+        case BENCH_COMMIT:
+            for(i = 0; i < pBench->txnItems; i++)
+            {
+                pBench->txnBefore[i] = pBench->items[pBench->txn[i].item];
+            }
+            status = (pBench->txnItems != 0) ? nv.commitTxn() : NVINTF_SUCCESS;
+            break;
+        default:
+            status = nv.readItem(pItem->id, 0,
+                                 pItem->live ? pItem->len : pOp->len, buf);
+            expected = pItem->live ? NVINTF_SUCCESS : NVINTF_NOTFOUND;
+            break;
+    }
+    NvLinux_getStats(&s1);
+
+    ok = (status == expected);
+    if(ok && (pOp->kind == BENCH_READ) && pItem->live)
+    {
+        ok = (memcmp(buf, pItem->data, pItem->len) == 0);
+    }
+    if(!ok)
+    {
+        fprintf(stderr, "%s of item %u.%u: status %u, expected %u\n",
+                kindNames[pOp->kind], pItem->id.itemID, pItem->id.subID,
+                status, expected);
+    }
+
+    if(status == NVINTF_SUCCESS)
+    {
+        if((pOp->kind == BENCH_WRITE) || (pOp->kind == BENCH_CREATE) ||
+           ((pOp->kind == BENCH_STAGE) && (nv.beginTxn == NULL)))
+        {
+            pItem->live = true;
+            pItem->len = pOp->len;
+            memcpy(pItem->data, pOp->data, pOp->len);
+            pBench->userBytes += pOp->len;
+        }
+        else if(pOp->kind == BENCH_DELETE)
+        {
+            pItem->live = false;
+        }
+        else if(pOp->kind == BENCH_COMMIT)
+        {
+            for(i = 0; i < pBench->txnItems; i++)
+            {
+                const benchOp_t *pStaged = &pBench->txn[i];
+                benchItem_t *pStagedItem = &pBench->items[pStaged->item];
+
+                pStagedItem->live = true;
+                pStagedItem->len = pStaged->len;
+                memcpy(pStagedItem->data, pStaged->data, pStaged->len);
+                pBench->userBytes += pStaged->len;
+            }
+        }
+    }
+    if(pOp->kind == BENCH_COMMIT)
+    {
+        pBench->txnItems = 0;
+    }
+    pBench->inFlight = false;
+
+    if(pTimes[pOp->kind] != NULL)
+    {
+        pTimes[pOp->kind][numTimes[pOp->kind]++] = (uint32_t)(s1.time - s0.time);
+    }
+    if(s1.erases != s0.erases)
+    {
+        compactions++;
+    }
+
+#if defined(NVOCMP_BGCOMPACT) && NVOCMP_BGCOMPACT
+    if(compactItems != 0)
+    {
+        NvLinux_getStats(&s0);
+        (void)NVOCMP_compactStep(compactItems);
+        NvLinux_getStats(&s1);
+
+        if(pTimes[BENCH_COMPACT] != NULL)
+        {
+            pTimes[BENCH_COMPACT][numTimes[BENCH_COMPACT]++] =
+                (uint32_t)(s1.time - s0.time);
+        }
+        if(s1.erases != s0.erases)
+        {
+            compactions++;
+        }
+    }
+#else
+    (void)compactItems;
+#endif
+
+    return (ok);
+}
+
+/*!
+ * @brief       Check all the items read back as expected. After a power
+ *              loss, the item of the interrupted operation can have its
+ *              state from before or after the operation. Items are updated
+ *              to the state found, so one loss is only reported once.
+ *
+ * @param       report - false to only take the state found
+ *
+ * @return      number of items that are not as expected
+ */
+static int checkItems(bool report)
+{
+    uint8_t i;
+    int bad = 0;
+
+    if(pBench->inFlight && (pBench->op.kind == BENCH_COMMIT))
+    {
+        checkTxn();
+    }
+
+    for(i = 0; i < pBench->numItems; i++)
+    {
+        benchItem_t *pItem = &pBench->items[i];
+        uint8_t buf[BENCH_MAX_LEN];
+        uint32_t len = nv.getItemLen(pItem->id);
+        uint8_t status = NVINTF_NOTFOUND;
+        bool found;
+
+        if((len != 0) && (len <= BENCH_MAX_LEN))
+        {
+            status = nv.readItem(pItem->id, 0, (uint16_t)len, buf);
+        }
+        found = (status == NVINTF_SUCCESS);
+
+        if(pBench->inFlight && (pBench->op.item == i))
+        {
+            const benchOp_t *pOp = &pBench->op;
+            bool isAfter;
+            bool isBefore;
+
+            if(pOp->kind == BENCH_DELETE)
+            {
+                isAfter = !found;
+            }
+            else if((pOp->kind == BENCH_READ) ||
+                    ((pOp->kind == BENCH_CREATE) && pBench->before.live))
+            {
+                isAfter = false;
+            }
+            else
+            {
+                isAfter = found && (len == pOp->len) &&
+                          (memcmp(buf, pOp->data, len) == 0);
+            }
+            isBefore = pBench->before.live ?
+                       (found && (len == pBench->before.len) &&
+                        (memcmp(buf, pBench->before.data, len) == 0)) :
+                       !found;
+
+            if(isAfter && !isBefore)
+            {
+                pItem->live = found;
+                pItem->len = (uint16_t)len;
+                memcpy(pItem->data, buf, len);
+                continue;
+            }
+            if(isBefore)
+            {
+                continue;
+            }
+        }
+        else if(pItem->live ? (found && (len == pItem->len) &&
+                               (memcmp(buf, pItem->data, len) == 0)) :
+                              !found)
+        {
+            continue;
+        }
+
+        if(report)
+        {
+            fprintf(stderr, "item %u.%u: length %u, status %u\n",
+                    pItem->id.itemID, pItem->id.subID, len, status);
+            bad++;
+        }
+
+        pItem->live = found;
+        pItem->len = (uint16_t)len;
+        if(found)
+        {
+            memcpy(pItem->data, buf, len);
+        }
+    }
+    pBench->inFlight = false;
+    pBench->txnItems = 0;
+
+    return (bad);
+}
+
+/*!
+ * @brief       Take the state of the items of an interrupted commit from
+ *              after it, if they all have it. Otherwise they are expected
+ *              to all have their state from before it, and checkItems()
+ *              reports the ones that don't.
+ */
+static void checkTxn(void)
+{
+    uint8_t i;
+    bool allAfter = true;
+    bool allBefore = true;
+
+    for(i = 0; i < pBench->txnItems; i++)
+    {
+        const benchOp_t *pOp = &pBench->txn[i];
+        const benchItem_t *pBefore = &pBench->txnBefore[i];
+        const benchItem_t *pItem = &pBench->items[pOp->item];
+
+        allAfter = allAfter && itemReads(pItem, true, pOp->len, pOp->data);
+        allBefore = allBefore && itemReads(pItem, pBefore->live, pBefore->len,
+                                           pBefore->data);
+    }
+
+    if(allAfter && !allBefore)
+    {
+        for(i = 0; i < pBench->txnItems; i++)
+        {
+            const benchOp_t *pOp = &pBench->txn[i];
+            benchItem_t *pItem = &pBench->items[pOp->item];
+
+            pItem->live = true;
+            pItem->len = pOp->len;
+            memcpy(pItem->data, pOp->data, pOp->len);
+        }
+    }
+    else if(!allBefore)
+    {
+        fprintf(stderr, "transaction of %u items only partly committed\n",
+                pBench->txnItems);
+    }
+
+    /* The items are checked like the others now */
+    pBench->inFlight = false;
+}
+
+/*!
+ * @brief       Check an item reads back with the given state.
+ *
+ * @param       pItem - item
+ * @param       live - true if the item should exist
+ * @param       len - length it should have
+ * @param       pData - data it should have
+ *
+ * @return      true if it does
+ */
+static bool itemReads(const benchItem_t *pItem, bool live, uint16_t len,
+                      const uint8_t *pData)
+{
+    uint8_t buf[BENCH_MAX_LEN];
+    uint32_t nvLen = nv.getItemLen(pItem->id);
+
+    if(!live)
+    {
+        return (nvLen == 0);
+    }
+
+    return ((nvLen == len) &&
+            (nv.readItem(pItem->id, 0, len, buf) == NVINTF_SUCCESS) &&
+            (memcmp(buf, pData, len) == 0));
+}
+
+/*!
+ * @brief       Run the workload until the given number of operations is
+ *              done.
+ *
+ * @param       workload - workload step
+ * @param       ops - item operations, counted from the start of the run
+ * @param       compactItems - items to compact after each operation
+ */
+static void runWorkload(benchWorkload_t workload, uint32_t ops,
+                        uint16_t compactItems)
+{
+    while(pBench->done < ops)
+    {
+        if(next == queued)
+        {
+            queued = 0;
+            next = 0;
+            workload();
+            continue;
+        }
+        (void)runOp(&queue[next++], compactItems);
+        pBench->done++;
+    }
+}
+
+/*!
+ * @brief       Boot, run the workload and report.
+ *
+ * @param       workload - workload step
+ * @param       ops - item operations
+ * @param       compactItems - items to compact after each operation
+ * @param       image - true if the flash came from a file
+ *
+ * @return      number of items that are not as expected, or 1 if the driver
+ *              did not initialize
+ */
+static int benchRun(benchWorkload_t workload, uint32_t ops,
+                    uint16_t compactItems, bool image)
+{
+    uint8_t k;
+    int bad;
+
+    NVOCMP_loadApiPtrsExt(&nv);
+    if(nv.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        fprintf(stderr, "initNV failed\n");
+        return (1);
+    }
+    /* Items of an image are taken as they are */
+    bad = checkItems(!image);
+
+    for(k = 0; k < BENCH_OP_KINDS; k++)
+    {
+        pTimes[k] = malloc((ops + 1) * sizeof(uint32_t));
+    }
+
+    NvLinux_clearStats();
+    runWorkload(workload, ops, compactItems);
+    bad += checkItems(true);
+
+    report();
+    printf("bad items %d\n", bad);
+    bad += checkCrcs();
+
+    return (bad);
+}
+
+/*!
+ * @brief       Print the statistics of the run.
+ */
+static void report(void)
+{
+    NvLinux_stats_t stats;
+    uint8_t k;
+    uint8_t pg;
+
+    NvLinux_getStats(&stats);
+
+    printf("item operations %u, item bytes written %llu\n", pBench->done,
+           (unsigned long long)pBench->userBytes);
+    printf("flash writes %u, bytes %u, write amplification %.2f\n",
+           stats.writes, stats.writeBytes,
+           pBench->userBytes ? (double)stats.writeBytes / pBench->userBytes : 0);
+    printf("flash reads %u, bytes %u\n", stats.reads, stats.readBytes);
+    printf("compactions %u, erases %u, failed writes %u\n", compactions,
+           stats.erases, stats.writeErrors);
+    printf("simulated flash time %.3f s\n", stats.time / 1e9);
+
+    printf("%-8s %8s %10s %10s %10s %10s (us)\n", "", "count", "median",
+           "90%", "99%", "max");
+    for(k = 0; k < BENCH_OP_KINDS; k++)
+    {
+        uint32_t n = numTimes[k];
+        uint32_t *pT = pTimes[k];
+
+        if(n == 0)
+        {
+            continue;
+        }
+        qsort(pT, n, sizeof(uint32_t), cmpTimes);
+        printf("%-8s %8u %10.1f %10.1f %10.1f %10.1f\n", kindNames[k], n,
+               pT[n / 2] / 1e3, pT[n * 9 / 10] / 1e3, pT[n * 99 / 100] / 1e3,
+               pT[n - 1] / 1e3);
+    }
+
+    printf("page erases:");
+    for(pg = 0; pg < NVOCMP_NVPAGES; pg++)
+    {
+        printf(" %u", stats.pageErases[pg]);
+    }
+    printf("\n");
+}
+
+/*!
+ * @brief       Compute the CRC of every item copy on the flash the three
+ *              ways and compare them, and with the CRC in its header.
+ *
+ * @return      number of item copies where they differ
+ */
+static int checkCrcs(void)
+{
+    const uint8_t *pFlash = NvLinux_getFlash();
+    uint32_t copies = 0;
+    int bad = 0;
+    uint8_t pg;
+
+    for(pg = 0; pg < NVOCMP_NVPAGES; pg++)
+    {
+        const uint8_t *pPage = pFlash + pg * NV_LINUX_PAGE_SIZE;
+        uint16_t top = NV_LINUX_PAGE_SIZE;
+
+        /* Items grow up from the page header, the signature is last */
+        while((top > BENCH_PGDATAOFS) && (pPage[top - 1] == 0xFF))
+        {
+            top--;
+        }
+
+        while((top >= BENCH_PGDATAOFS + BENCH_ITEMHDRLEN) &&
+              (pPage[top - 1] == BENCH_SIGNATURE))
+        {
+            const uint8_t *pHdr = pPage + top - BENCH_ITEMHDRLEN;
+            uint16_t len = ((pHdr[3] & 0x3F) << 6) | ((pHdr[4] >> 2) & 0x3F);
+            uint8_t hdrCrc = ((pHdr[4] & 0x3) << 6) | ((pHdr[5] >> 2) & 0x3F);
+            /* The length bits of the header are the last byte in */
+            uint8_t finalByte = (len & 0x3F) << 2;
+            const uint8_t *pData;
+            uint16_t crcLen = len + BENCH_HDRCRCINC - 1;
+            uint8_t bits;
+            uint8_t blocks;
+            uint8_t inPlace;
+
+            if(len > top - BENCH_ITEMHDRLEN - BENCH_PGDATAOFS)
+            {
+                break;
+            }
+            pData = pHdr - len;
+
+            bits = bitCrc(bitCrc(0, pData, crcLen), &finalByte, 1);
+            blocks = blockCrc(blockCrc(0, pData, crcLen), &finalByte, 1);
+            inPlace = crc_update(crc_update(0, pData, crcLen), &finalByte, 1);
+
+            if((bits != inPlace) || (blocks != inPlace) || (hdrCrc != inPlace))
+            {
+                fprintf(stderr, "page %u offset %u: CRC bit by bit %02x, "
+                        "in blocks %02x, in place %02x, header %02x\n", pg,
+                        (unsigned)(pData - pPage), bits, blocks, inPlace,
+                        hdrCrc);
+                bad++;
+            }
+            copies++;
+            top -= BENCH_ITEMHDRLEN + len;
+        }
+    }
+
+    printf("item CRCs of %u copies, %d differ\n", copies, bad);
+
+    return (bad);
+}
+
+/*!
+ * @brief       CRC8 computed bit by bit, a byte at a time, without the table
+ *              of crc.c.
+ *
+ * @param       crc - CRC so far
+ * @param       pData - bytes
+ * @param       len - number of bytes
+ *
+ * @return      CRC
+ */
+static uint8_t bitCrc(uint8_t crc, const uint8_t *pData, uint16_t len)
+{
+    uint8_t bit;
+
+    while(len--)
+    {
+        crc ^= *pData++;
+        for(bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ BENCH_CRC_POLY) :
+                                 (uint8_t)(crc << 1);
+        }
+    }
+
+    return (crc);
+}
+
+/*!
+ * @brief       CRC8 computed through copies of up to BENCH_CRC_BLOCK bytes,
+ *              the way the driver read the flash for it before.
+ *
+ * @param       crc - CRC so far
+ * @param       pData - bytes
+ * @param       len - number of bytes
+ *
+ * @return      CRC
+ */
+static uint8_t blockCrc(uint8_t crc, const uint8_t *pData, uint16_t len)
+{
+    uint8_t tmp[BENCH_CRC_BLOCK];
+
+    while(len > 0)
+    {
+        uint16_t rdLen = (len < BENCH_CRC_BLOCK) ? len : BENCH_CRC_BLOCK;
+
+        memcpy(tmp, pData, rdLen);
+        crc = crc_update(crc, tmp, rdLen);
+        pData += rdLen;
+        len -= rdLen;
+    }
+
+    return (crc);
+}
+
+/*!
+ * @brief       Boot from the flash the run left, and read every item once.
+ *
+ * @return      number of items that are not as expected, or 1 if the driver
+ *              did not initialize
+ */
+static int bootTimes(void)
+{
+    NvLinux_stats_t boot;
+    NvLinux_stats_t reads;
+    int bad;
+
+    NvLinux_clearStats();
+    NVOCMP_loadApiPtrsExt(&nv);
+    if(nv.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        fprintf(stderr, "initNV failed after the run\n");
+        return (1);
+    }
+    NvLinux_getStats(&boot);
+
+    NvLinux_clearStats();
+    bad = checkItems(true);
+    NvLinux_getStats(&reads);
+
+    printf("RAM index %s\n", NVOCMP_RAMIDX ? "on" : "off");
+    printf("boot: flash reads %u, bytes %u, time %.1f us\n", boot.reads,
+           boot.readBytes, boot.time / 1e3);
+    printf("reads of the %u items: flash reads %u, bytes %u, time %.1f us\n",
+           pBench->numItems, reads.reads, reads.readBytes, reads.time / 1e3);
+
+    return (bad);
+}
+
+/*!
+ * @brief       Compare two operation times, for qsort().
+ */
+static int cmpTimes(const void *pA, const void *pB)
+{
+    uint32_t a = *(const uint32_t *)pA;
+    uint32_t b = *(const uint32_t *)pB;
+
+    return ((a > b) - (a < b));
+}
+
+/*!
+ * @brief       Power loss callback, the child process ends here.
+ */
+static void powerLost(void)
+{
+    _exit(0);
+}
+
+/*!
+ * @brief       Run the workload in child processes that lose power.
+ *
+ * @param       workload - workload step
+ * @param       ops - item operations of all the trials together, at most
+ * @param       trials - number of power losses
+ * @param       compactItems - items to compact after each operation
+ *
+ * @return      number of trials that failed
+ */
+static int faultTrials(benchWorkload_t workload, uint32_t ops, uint32_t trials,
+                       uint16_t compactItems)
+{
+    uint32_t t;
+    int failed = 0;
+
+    for(t = 0; t < trials; t++)
+    {
+        uint32_t cut = benchRandom(BENCH_FAULT_WINDOW);
+        uint32_t seed = benchRandom(0xFFFFFFFF) + 1;
+        int status;
+        pid_t pid = fork();
+
+        if(pid < 0)
+        {
+            perror("fork");
+            return (failed + 1);
+        }
+
+        if(pid == 0)
+        {
+            /* Power can be lost while booting too */
+            NvLinux_setFault(cut, seed, powerLost);
+            alarm(BENCH_FAULT_TIMEOUT);
+
+            NVOCMP_loadApiPtrsExt(&nv);
+            if(nv.initNV(NULL) != NVINTF_SUCCESS)
+            {
+                fprintf(stderr, "trial %u: initNV failed\n", t);
+                _exit(1);
+            }
+            if(checkItems(true) != 0)
+            {
+                fprintf(stderr, "trial %u: items lost after a power loss "
+                        "%u operations in\n", t, pBench->done);
+                _exit(1);
+            }
+
+            /* The queue of the parent is stale, start a new step */
+            queued = 0;
+            next = 0;
+            runWorkload(workload, ops, compactItems);
+            _exit(0);
+        }
+
+        if((waitpid(pid, &status, 0) != pid) || !WIFEXITED(status) ||
+           (WEXITSTATUS(status) != 0))
+        {
+            failed++;
+            if(WIFSIGNALED(status) && (WTERMSIG(status) == SIGALRM))
+            {
+                /* The next boot would get stuck the same way */
+                fprintf(stderr, "trial %u: stuck\n", t);
+                t++;
+                break;
+            }
+            if(WIFSIGNALED(status))
+            {
+                fprintf(stderr, "trial %u: crashed\n", t);
+            }
+        }
+        if(pBench->done >= ops)
+        {
+            /* Nothing left to interrupt */
+            t++;
+            break;
+        }
+    }
+
+    printf("%u power losses, %d failed\n", t, failed);
+
+    return (failed);
+}
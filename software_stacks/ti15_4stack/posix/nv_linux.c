@@ -0,0 +1,422 @@
+/******************************************************************************
+
+ @file nv_linux.c
+
+ @brief Simulated NV flash behind the NV_LINUX hooks of nvocmp.c
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <string.h>
+#include <sys/mman.h>
+
+#include "nv_linux.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Size of all the pages */
+#define NV_LINUX_FLASH_SIZE (NVOCMP_NVPAGES * NV_LINUX_PAGE_SIZE)
+
+/* State shared with child processes */
+typedef struct
+{
+    uint8_t flash[NV_LINUX_FLASH_SIZE];
+    NvLinux_stats_t stats;
+    /* Writes and erases left before the fault, when a fault is set */
+    uint32_t faultOps;
+} NvLinux_shared_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Shared state, mapped on first use */
+static NvLinux_shared_t *pShared = NULL;
+
+/* File the pages are kept in, NULL for none */
+static const char *pFilePath = NULL;
+
+/* Power loss callback, NULL for none */
+static NvLinux_faultCb_t faultFxn = NULL;
+
+/* State of the random generator of the cut */
+static uint32_t faultRandom = 1;
+
+/* True if the driver can read the pages in place */
+static bool addressable = true;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static NvLinux_shared_t *getShared(void);
+static bool cutNow(void);
+static uint32_t cutRandom(uint32_t range);
+static void losePower(void);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Erase all the pages.
+
+ Public function defined in nv_linux.h
+ */
+void NvLinux_format(void)
+{
+    NvLinux_shared_t *pSh = getShared();
+
+    memset(pSh->flash, 0xFF, sizeof(pSh->flash));
+    memset(&pSh->stats, 0, sizeof(pSh->stats));
+}
+
+/*!
+ Set the file of the pages.
+
+ Public function defined in nv_linux.h
+ */
+void NvLinux_setFile(const char *pPath)
+{
+    pFilePath = pPath;
+}
+
+/*!
+ Set whether the pages can be read in place.
+
+ Public function defined in nv_linux.h
+ */
+void NvLinux_setAddressable(bool inPlace)
+{
+    addressable = inPlace;
+}
+
+/*!
+ Set a power loss.
+
+ Public function defined in nv_linux.h
+ */
+void NvLinux_setFault(uint32_t ops, uint32_t seed, NvLinux_faultCb_t fxn)
+{
+    getShared()->faultOps = ops;
+    faultRandom = (seed != 0) ? seed : 1;
+    faultFxn = fxn;
+}
+
+/*!
+ Get the flash statistics.
+
+ Public function defined in nv_linux.h
+ */
+void NvLinux_getStats(NvLinux_stats_t *pStats)
+{
+    *pStats = getShared()->stats;
+}
+
+/*!
+ Clear the flash statistics.
+
+ Public function defined in nv_linux.h
+ */
+void NvLinux_clearStats(void)
+{
+    memset(&getShared()->stats, 0, sizeof(NvLinux_stats_t));
+}
+
+/*!
+ Get the pages.
+
+ Public function defined in nv_linux.h
+ */
+uint8_t *NvLinux_getFlash(void)
+{
+    return (getShared()->flash);
+}
+
+/*!
+ Load the pages from the file, if there is one.
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_init(void)
+{
+    NvLinux_shared_t *pSh = getShared();
+    FILE *pFile;
+
+    if(pFilePath == NULL)
+    {
+        return;
+    }
+
+    pFile = fopen(pFilePath, "rb");
+    if(pFile != NULL)
+    {
+        if(fread(pSh->flash, 1, sizeof(pSh->flash), pFile)
+           != sizeof(pSh->flash))
+        {
+            /* Not an image of these pages, start over */
+            memset(pSh->flash, 0xFF, sizeof(pSh->flash));
+        }
+        fclose(pFile);
+    }
+}
+
+/*!
+ Save the pages to the file, if there is one.
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_save(void)
+{
+    FILE *pFile;
+
+    if(pFilePath == NULL)
+    {
+        return;
+    }
+
+    pFile = fopen(pFilePath, "wb");
+    if(pFile != NULL)
+    {
+        (void)fwrite(getShared()->flash, 1, NV_LINUX_FLASH_SIZE, pFile);
+        fclose(pFile);
+    }
+}
+
+/*!
+ Get the address of the pages, for the driver.
+
+ Public function defined in nv_linux.h
+ */
+void *NV_LINUX_regionBase(void)
+{
+    return (addressable ? (void *)getShared()->flash :
+                          NVS_REGION_NOT_ADDRESSABLE);
+}
+
+/*!
+ Read from a page.
+
+ Public function defined in nv_linux.h
+ */
+void NV_LINUX_read(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len)
+{
+    NvLinux_shared_t *pSh = getShared();
+
+    if(((uint32_t)off + len) > NV_LINUX_PAGE_SIZE)
+    {
+        NVOCMP_ASSERT(false, "NV_LINUX read past the page")
+    }
+
+    memcpy(pBuf, &pSh->flash[pg * NV_LINUX_PAGE_SIZE + off], len);
+
+    pSh->stats.reads++;
+    pSh->stats.readBytes += len;
+    pSh->stats.time += (uint64_t)len * NV_LINUX_BYTE_READ_NS;
+}
+
+/*!
+ Write to a page, clearing bits only.
+
+ Public function defined in nv_linux.h
+ */
+int NV_LINUX_write(uint8_t pg, uint16_t off, uint8_t *pBuf, uint16_t len)
+{
+    NvLinux_shared_t *pSh = getShared();
+    uint8_t *pDst = &pSh->flash[pg * NV_LINUX_PAGE_SIZE + off];
+    uint16_t i;
+    int status = 0;
+
+    if(((uint32_t)off + len) > NV_LINUX_PAGE_SIZE)
+    {
+        NVOCMP_ASSERT(false, "NV_LINUX write past the page")
+    }
+
+    if(cutNow())
+    {
+        /* Some bytes get programmed, the next one only partly */
+        uint16_t done = (uint16_t)cutRandom(len);
+
+        for(i = 0; i < done; i++)
+        {
+            pDst[i] &= pBuf[i];
+        }
+        if(done < len)
+        {
+            pDst[done] &= (uint8_t)(pBuf[done] | cutRandom(0x100));
+        }
+        losePower();
+        return (-1);
+    }
+
+    for(i = 0; i < len; i++)
+    {
+        if((pDst[i] & pBuf[i]) != pBuf[i])
+        {
+            /* Only an erase sets bits, post verify catches it */
+            status = -1;
+        }
+        pDst[i] &= pBuf[i];
+    }
+
+    pSh->stats.writes++;
+    pSh->stats.writeBytes += len;
+    pSh->stats.time += (uint64_t)((len + 3) / 4) * NV_LINUX_WORD_WRITE_NS;
+    if(status != 0)
+    {
+        pSh->stats.writeErrors++;
+    }
+
+    return (status);
+}
+
+/*!
+ Erase a page.
+
+ Public function defined in nv_linux.h
+ */
+int NV_LINUX_erase(uint8_t pg)
+{
+    NvLinux_shared_t *pSh = getShared();
+    uint8_t *pDst = &pSh->flash[pg * NV_LINUX_PAGE_SIZE];
+
+    if(pg >= NVOCMP_NVPAGES)
+    {
+        NVOCMP_ASSERT(false, "NV_LINUX erase past the region")
+    }
+
+    if(cutNow())
+    {
+        /* Part of the page is erased */
+        memset(pDst, 0xFF, cutRandom(NV_LINUX_PAGE_SIZE));
+        losePower();
+        return (-1);
+    }
+
+    memset(pDst, 0xFF, NV_LINUX_PAGE_SIZE);
+
+    pSh->stats.erases++;
+    pSh->stats.pageErases[pg]++;
+    pSh->stats.time += NV_LINUX_PAGE_ERASE_NS;
+
+    return (0);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Get the shared state, mapping it the first time.
+ *
+ * @return      shared state
+ */
+static NvLinux_shared_t *getShared(void)
+{
+    if(pShared == NULL)
+    {
+        void *pMap = mmap(NULL, sizeof(NvLinux_shared_t),
+                          PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS,
+                          -1, 0);
+
+        if(pMap == MAP_FAILED)
+        {
+            NVOCMP_ASSERT(false, "NV_LINUX cannot map the flash")
+        }
+        pShared = (NvLinux_shared_t *)pMap;
+        memset(pShared->flash, 0xFF, sizeof(pShared->flash));
+    }
+
+    return (pShared);
+}
+
+/*!
+ * @brief       Count a write or erase against the fault.
+ *
+ * @return      true if power is lost in this operation
+ */
+static bool cutNow(void)
+{
+    NvLinux_shared_t *pSh = getShared();
+
+    if(faultFxn == NULL)
+    {
+        return (false);
+    }
+
+    if(pSh->faultOps != 0)
+    {
+        pSh->faultOps--;
+        return (false);
+    }
+
+    return (true);
+}
+
+/*!
+ * @brief       Random number for the cut.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t cutRandom(uint32_t range)
+{
+    faultRandom ^= faultRandom << 13;
+    faultRandom ^= faultRandom >> 17;
+    faultRandom ^= faultRandom << 5;
+
+    return ((range != 0) ? (faultRandom % range) : 0);
+}
+
+/*!
+ * @brief       Lose power, the fault is used up.
+ */
+static void losePower(void)
+{
+    NvLinux_faultCb_t fxn = faultFxn;
+
+    faultFxn = NULL;
+    fxn();
+}
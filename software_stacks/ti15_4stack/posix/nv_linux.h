@@ -0,0 +1,254 @@
+/******************************************************************************
+
+ @file nv_linux.h
+
+ @brief Simulated NV flash behind the NV_LINUX hooks of nvocmp.c
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef NvLinux_H
+#define NvLinux_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup NvLinux Simulated NV Flash
+ <BR>
+ A host build of nvocmp.c defines NV_LINUX, and the driver then reads,
+ writes and erases its pages through the NV_LINUX_ functions below instead
+ of NVS. This module implements them over RAM with the rules of the device
+ flash: an erase sets a whole page to 0xFF, and a write can only clear
+ bits. A write that would set a bit fails, like NVS_write() with post
+ verify.
+ <BR>
+ Each operation is counted and charged a simulated time from the typical
+ timings of the device, so the cost of a driver change can be measured
+ without a device. The pages are in memory shared with child processes:
+ a process can lose power in the middle of an operation, see
+ NvLinux_setFault(), and a new process can boot from what is left, like the
+ device would after a reset.
+ <BR>
+ The pages can be loaded from and saved to a file, see NvLinux_setFile().
+ The driver saves after each change.
+ <BR>
+ Like the internal flash of the device, the pages are addressable: the
+ driver gets their address from NVS_Attrs.regionBase and computes item CRCs
+ in place. Reads in place are not counted in the statistics. With
+ NvLinux_setAddressable(false) the pages are like an external flash, and
+ the driver reads them in blocks.
+ <BR>
+ A host build compiles nvocmp.c and crc.c with NV_LINUX and
+ NVOCMP_POSIX_MUTEX defined, this directory in the include path, and the
+ same NVOCMP_NVPAGES for nvocmp.c and nv_linux.c.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup NvLinux
+ * @{
+ */
+
+/*! Number of NV pages, must match the driver */
+#ifndef NVOCMP_NVPAGES
+#define NVOCMP_NVPAGES 2
+#endif
+
+/*! Size of a flash page */
+#define NV_LINUX_PAGE_SIZE 0x2000
+
+/*! Simulated time to program a 32 bit flash word, in nanoseconds */
+#ifndef NV_LINUX_WORD_WRITE_NS
+#define NV_LINUX_WORD_WRITE_NS 8000
+#endif
+
+/*! Simulated time to erase a flash page, in nanoseconds */
+#ifndef NV_LINUX_PAGE_ERASE_NS
+#define NV_LINUX_PAGE_ERASE_NS 8000000
+#endif
+
+/*! Simulated time to read a byte, in nanoseconds */
+#ifndef NV_LINUX_BYTE_READ_NS
+#define NV_LINUX_BYTE_READ_NS 21
+#endif
+
+/*! NVS types used by the driver */
+typedef void *NVS_Handle;
+typedef struct
+{
+    void *regionBase;
+    uint32_t sectorSize;
+    uint32_t regionSize;
+} NVS_Attrs;
+
+/*! regionBase of pages that can't be read in place */
+#define NVS_REGION_NOT_ADDRESSABLE ((void *)(uintptr_t)0xFFFFFFFFU)
+
+/*! There is a single region, any non NULL value does for its handle */
+#define NVS_HANDLE ((NVS_Handle)1)
+
+/*! There is no supply voltage to check */
+#define NVOCMP_FLASHACCESS(err)
+
+#ifndef NVDEBUG
+/*! A failed driver assert ends the process, alerts are ignored */
+#define NVOCMP_ASSERT(cond, message) \
+    { if(!(cond)) { fprintf(stderr, "NVOCMP assert: %s\n", (message)); \
+                    abort(); } }
+#define NVOCMP_ALERT(cond, message)
+#endif
+
+/*! Flash statistics */
+typedef struct
+{
+    /*! Read operations */
+    uint32_t reads;
+    /*! Bytes read */
+    uint32_t readBytes;
+    /*! Write operations */
+    uint32_t writes;
+    /*! Bytes written */
+    uint32_t writeBytes;
+    /*! Page erases */
+    uint32_t erases;
+    /*! Page erases, for each page */
+    uint32_t pageErases[NVOCMP_NVPAGES];
+    /*! Writes that tried to set a bit */
+    uint32_t writeErrors;
+    /*! Simulated time of all the operations, in nanoseconds */
+    uint64_t time;
+} NvLinux_stats_t;
+
+/*! Called when power is lost, see NvLinux_setFault() */
+typedef void (*NvLinux_faultCb_t)(void);
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Erase all the pages and clear the statistics.
+ */
+extern void NvLinux_format(void);
+
+/*!
+ * @brief   Set a file the pages are loaded from by NV_LINUX_init() and saved
+ *          to by NV_LINUX_save().
+ *
+ * @param   pPath - file name, NULL to keep the pages in memory only
+ */
+extern void NvLinux_setFile(const char *pPath);
+
+/*!
+ * @brief   Set whether the driver can read the pages in place. Takes effect
+ *          at the next NV_LINUX_regionBase().
+ *
+ * @param   addressable - true to give the driver the address of the pages,
+ *                        the default, false to have it read them in blocks
+ */
+extern void NvLinux_setAddressable(bool addressable);
+
+/*!
+ * @brief   Lose power in the middle of a later write or erase. A write
+ *          stops after a random number of bytes, an erase after a random
+ *          part of the page, and the callback is called. The callback is
+ *          expected not to return, it ends the process; if it returns,
+ *          the operation fails.
+ *
+ * @param   ops - number of writes and erases that complete first, the
+ *                operation after them is cut
+ * @param   seed - seed of the random cut
+ * @param   fxn - callback, NULL to cancel the fault
+ */
+extern void NvLinux_setFault(uint32_t ops, uint32_t seed,
+                             NvLinux_faultCb_t fxn);
+
+/*!
+ * @brief   Get the flash statistics.
+ *
+ * @param   pStats - place to put the statistics
+ */
+extern void NvLinux_getStats(NvLinux_stats_t *pStats);
+
+/*!
+ * @brief   Clear the flash statistics.
+ */
+extern void NvLinux_clearStats(void);
+
+/*!
+ * @brief   Get the pages, to inspect or change them.
+ *
+ * @return  first byte of page 0, the pages follow each other
+ */
+extern uint8_t *NvLinux_getFlash(void);
+
+/*!
+ * @brief   Driver hooks, called by nvocmp.c when NV_LINUX is defined.
+ */
+extern void NV_LINUX_init(void);
+extern void NV_LINUX_save(void);
+extern void *NV_LINUX_regionBase(void);
+extern void NV_LINUX_read(uint8_t pg, uint16_t off, uint8_t *pBuf,
+                          uint16_t len);
+extern int NV_LINUX_write(uint8_t pg, uint16_t off, uint8_t *pBuf,
+                          uint16_t len);
+extern int NV_LINUX_erase(uint8_t pg);
+
+/*! @} end group NvLinux */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NvLinux_H */
@@ -0,0 +1,301 @@
+/******************************************************************************
+
+ @file nvcache_bench.c
+
+ @brief NV hot item cache check, for host builds
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs an OAD download through nvcache.c over nvocmp.c and the simulated flash
+of nv_linux.c, with the NV calls Ssf_oadInfoUpdate() of the sensor
+application makes:
+  - the download starts with the block number, image header, image ID and
+    server address in one transaction
+  - each block received writes the block number alone, with writeItem()
+The block number item is hot. The check is that the block number writes
+stay in its RAM copy: no flash writes until NVCACHE_flush(), reads through
+the cache see the last block, and after the flush the driver does too.
+
+Then reports the flash writes of the blocks against writing each block
+number in a transaction of its own, like the download start.
+
+Build, from software_stacks/ti15_4stack:
+  cc -O2 -DNV_LINUX -DNVOCMP_POSIX_MUTEX -Iposix -Iservices -I../../drivers/nv
+     posix/nvcache_bench.c posix/nv_linux.c services/nvcache.c
+     services/nvocmp.c services/crc.c -lpthread -o nvcache_bench
+
+Usage: nvcache_bench [-n blocks]
+  -n  blocks of the download, default 1000
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "nvocmp.h"
+#include "nvcache.h"
+#include "nv_linux.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* OAD item of ssf.c, the block number is sub ID 0 */
+#define BENCH_OAD_ID        0x0007
+#define BENCH_OAD_BLOCK     0
+#define BENCH_OAD_IMG_HDR   1
+#define BENCH_OAD_IMG_ID    2
+#define BENCH_OAD_SERVER    3
+
+/* Lengths of the items, as ssf.c writes them */
+#define BENCH_IMG_HDR_LEN   16
+#define BENCH_SERVER_LEN    10
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Functions of the driver and of the cache over it */
+static NVINTF_nvFuncts_t driverFps;
+static NVINTF_nvFuncts_t nvFps;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static NVINTF_itemID_t oadId(uint16_t subID);
+static bool startDownload(void);
+static bool blockReads(const NVINTF_nvFuncts_t *pFps, uint16_t block);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t blocks = 1000;
+    uint16_t block;
+    uint32_t i;
+    NvLinux_stats_t cached;
+    NvLinux_stats_t flush;
+    NvLinux_stats_t txn;
+    int bad = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                blocks = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n blocks]\n", argv[0]);
+                return (2);
+        }
+    }
+    if((blocks == 0) || (blocks > 0xFFFF))
+    {
+        fprintf(stderr, "blocks must be 1 to 65535\n");
+        return (2);
+    }
+
+    NvLinux_format();
+    NVOCMP_loadApiPtrsExt(&driverFps);
+    NVCACHE_loadApiPtrs(&nvFps, &driverFps);
+    (void)NVCACHE_addHotItem(oadId(BENCH_OAD_BLOCK));
+    if(nvFps.initNV(NULL) != NVINTF_SUCCESS)
+    {
+        fprintf(stderr, "initNV failed\n");
+        return (1);
+    }
+
+    if(!startDownload())
+    {
+        fprintf(stderr, "the download start was not written\n");
+        return (1);
+    }
+
+    /* Block numbers, like the OAD client writes them */
+    NvLinux_clearStats();
+    for(i = 1; i <= blocks; i++)
+    {
+        block = (uint16_t)i;
+        if(nvFps.writeItem(oadId(BENCH_OAD_BLOCK), sizeof(block), &block)
+           != NVINTF_SUCCESS)
+        {
+            fprintf(stderr, "block %u: writeItem failed\n", i);
+            return (1);
+        }
+    }
+    NvLinux_getStats(&cached);
+    if(cached.writes != 0)
+    {
+        fprintf(stderr, "block numbers went to flash, %u writes\n",
+                cached.writes);
+        bad++;
+    }
+    if(!blockReads(&nvFps, block))
+    {
+        fprintf(stderr, "the cache doesn't read the last block\n");
+        bad++;
+    }
+
+    NvLinux_clearStats();
+    if(NVCACHE_flush() != NVINTF_SUCCESS)
+    {
+        fprintf(stderr, "flush failed\n");
+        bad++;
+    }
+    NvLinux_getStats(&flush);
+    if((flush.writes == 0) || !blockReads(&driverFps, block))
+    {
+        fprintf(stderr, "the flush didn't write the last block\n");
+        bad++;
+    }
+
+    /* The same block numbers, each in a transaction */
+    NvLinux_clearStats();
+    for(i = 1; i <= blocks; i++)
+    {
+        block = (uint16_t)i;
+        if((nvFps.beginTxn() != NVINTF_SUCCESS) ||
+           (nvFps.stageItem(oadId(BENCH_OAD_BLOCK), sizeof(block), &block)
+            != NVINTF_SUCCESS) ||
+           (nvFps.commitTxn() != NVINTF_SUCCESS))
+        {
+            fprintf(stderr, "block %u: transaction failed\n", i);
+            return (1);
+        }
+    }
+    NvLinux_getStats(&txn);
+
+    printf("%u blocks, flash writes, bytes, erases:\n", blocks);
+    printf("  cached      %6u %8u %4u\n", cached.writes, cached.writeBytes,
+           cached.erases);
+    printf("  flush       %6u %8u %4u\n", flush.writes, flush.writeBytes,
+           flush.erases);
+    printf("  transaction %6u %8u %4u\n", txn.writes, txn.writeBytes,
+           txn.erases);
+    printf("%d errors\n", bad);
+
+    return (bad != 0);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       ID of an OAD item.
+ *
+ * @param       subID - item of the OAD state
+ *
+ * @return      the item ID
+ */
+static NVINTF_itemID_t oadId(uint16_t subID)
+{
+    NVINTF_itemID_t id;
+
+    id.systemID = NVINTF_SYSID_APP;
+    id.itemID = BENCH_OAD_ID;
+    id.subID = subID;
+
+    return (id);
+}
+
+/*!
+ * @brief       Write the OAD state of a new download in one transaction.
+ *
+ * @return      true if committed
+ */
+static bool startDownload(void)
+{
+    uint16_t block = 0;
+    uint8_t imgHdr[BENCH_IMG_HDR_LEN];
+    uint8_t imgId = 1;
+    uint8_t server[BENCH_SERVER_LEN];
+
+    memset(imgHdr, 0xA5, sizeof(imgHdr));
+    memset(server, 0x5A, sizeof(server));
+
+    if(nvFps.beginTxn() != NVINTF_SUCCESS)
+    {
+        return (false);
+    }
+    if((nvFps.stageItem(oadId(BENCH_OAD_BLOCK), sizeof(block), &block)
+        != NVINTF_SUCCESS) ||
+       (nvFps.stageItem(oadId(BENCH_OAD_IMG_HDR), sizeof(imgHdr), imgHdr)
+        != NVINTF_SUCCESS) ||
+       (nvFps.stageItem(oadId(BENCH_OAD_IMG_ID), sizeof(imgId), &imgId)
+        != NVINTF_SUCCESS) ||
+       (nvFps.stageItem(oadId(BENCH_OAD_SERVER), sizeof(server), server)
+        != NVINTF_SUCCESS))
+    {
+        (void)nvFps.abortTxn();
+        return (false);
+    }
+
+    return (nvFps.commitTxn() == NVINTF_SUCCESS);
+}
+
+/*!
+ * @brief       Check the block number read back.
+ *
+ * @param       pFps - the cache or the driver
+ * @param       block - block number expected
+ *
+ * @return      true if it reads back
+ */
+static bool blockReads(const NVINTF_nvFuncts_t *pFps, uint16_t block)
+{
+    uint16_t read = 0;
+
+    return ((pFps->readItem(oadId(BENCH_OAD_BLOCK), 0, sizeof(read), &read)
+             == NVINTF_SUCCESS) && (read == block));
+}
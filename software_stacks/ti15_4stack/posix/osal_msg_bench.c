@@ -0,0 +1,621 @@
+/******************************************************************************
+
+ @file osal_msg_bench.c
+
+ @brief OSAL message and event check and benchmark, for host builds
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs the message and event path of osal_port.c on the simulated kernel of
+sim_rtos.c, with a random mix of operations on a few registered tasks, and
+checks each against a model of the task queues:
+  - OsalPort_msgSend() appends to the queue of the task, sets
+    OsalPort_SYS_EVENT_MSG and posts the task semaphore
+  - OsalPort_msgReceive() takes the messages in the order they were sent,
+    and clears OsalPort_SYS_EVENT_MSG when the queue is empty
+  - OsalPort_msgFind() and OsalPort_msgFindDequeue() find the first message
+    of an event, the queue keeps its order and its tail after a dequeue
+  - OsalPort_msgCount() is the depth of the queue
+  - OsalPort_setEvent() and OsalPort_clearEvent() set and clear flags
+  - the generic OsalPort_MsgQ functions keep their order, and
+    OsalPort_msgEnqueueMax() stops at its limit, max + 1 messages
+Then reports the host time of a send and a receive with queues of 1 to
+1000 messages, which should not depend on the depth.
+
+Build, from software_stacks/ti15_4stack:
+  cc -O2 -DOSAL_PORT_POSIX -Iposix/include -Iposix -Iosal_port
+     posix/osal_msg_bench.c osal_port/osal_port.c
+     osal_port/osal_port_timers.c posix/sim_rtos.c -o osal_msg_bench
+
+Usage: osal_msg_bench [-n ops] [-s seed]
+  -n  message operations, default 1000000
+  -s  seed of the operations, default 1
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_rtos.h"
+#include "osal_port.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Tasks registered by the bench */
+#define BENCH_TASKS 4
+
+/* Deepest queue of the model */
+#define BENCH_MAX_DEPTH 256
+
+/* Events carried by the messages */
+#define BENCH_EVENTS 8
+
+/* Limit of the OsalPort_msgEnqueueMax() checks */
+#define BENCH_ENQUEUE_MAX 16
+
+/* Errors printed, the rest are only counted */
+#define BENCH_MAX_PRINTS 10
+
+/* Model of a queue, oldest message first */
+typedef struct
+{
+    uint8_t *pMsgs[BENCH_MAX_DEPTH];
+    uint16_t depth;
+} benchQueue_t;
+
+/* Message of the bench */
+typedef struct
+{
+    OsalPort_EventHdr hdr;
+    uint32_t seq;
+} benchMsg_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Task IDs, semaphores and event flags of the tasks */
+static uint8_t benchTaskIds[BENCH_TASKS];
+static Semaphore_Struct benchSems[BENCH_TASKS];
+static uint32_t benchEvents[BENCH_TASKS];
+
+/* Model of the task queues and of one generic queue */
+static benchQueue_t benchQueues[BENCH_TASKS];
+static benchQueue_t benchGeneric;
+static OsalPort_MsgQ genericQ;
+
+/* Messages made so far */
+static uint32_t benchSeq;
+
+/* Errors found */
+static uint32_t benchErrors;
+
+/* State of the random generator */
+static uint32_t benchRandomState = 1;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static uint32_t benchRandom(uint32_t range);
+static void benchError(const char *pMsg, uint32_t task);
+static uint8_t *newMsg(void);
+static void modelRemove(benchQueue_t *pQueue, uint16_t pos);
+static int16_t modelFind(const benchQueue_t *pQueue, uint8_t event);
+static void checkTask(uint32_t task);
+static void taskOp(uint32_t kind, uint32_t task);
+static void genericOp(uint32_t kind);
+static void timeDepths(void);
+static double realTime(void);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t ops = 1000000;
+    uint32_t seed = 1;
+    uint32_t i;
+    uint8_t *pMsg;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n':
+                ops = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n ops] [-s seed]\n", argv[0]);
+                return (2);
+        }
+    }
+
+    benchRandomState = (seed != 0) ? seed : 1;
+    SimRtos_init();
+
+    for(i = 0; i < BENCH_TASKS; i++)
+    {
+        Semaphore_Params semParams;
+
+        Semaphore_Params_init(&semParams);
+        semParams.mode = Semaphore_Mode_BINARY;
+        Semaphore_construct(&benchSems[i], 0, &semParams);
+        benchTaskIds[i] = OsalPort_registerTask(NULL, &benchSems[i],
+                                                &benchEvents[i]);
+    }
+
+    /* A task that is not registered */
+    pMsg = newMsg();
+    if(OsalPort_msgSend(BENCH_TASKS, pMsg) != OsalPort_INVALID_TASK)
+    {
+        benchError("send to an unknown task accepted", BENCH_TASKS);
+    }
+    OsalPort_msgDeallocate(pMsg);
+
+    for(i = 0; i < ops; i++)
+    {
+        uint32_t task = benchRandom(BENCH_TASKS + 1);
+        uint32_t kind = benchRandom(100);
+
+        if(task == BENCH_TASKS)
+        {
+            genericOp(kind);
+        }
+        else
+        {
+            taskOp(kind, task);
+            checkTask(task);
+        }
+    }
+
+    printf("%u operations on %u task queues and a generic queue\n", ops,
+           BENCH_TASKS);
+
+    timeDepths();
+
+    printf("%u errors\n", benchErrors);
+
+    return ((benchErrors != 0) ? 1 : 0);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Random number.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t benchRandom(uint32_t range)
+{
+    benchRandomState ^= benchRandomState << 13;
+    benchRandomState ^= benchRandomState >> 17;
+    benchRandomState ^= benchRandomState << 5;
+
+    return ((range != 0) ? (benchRandomState % range) : 0);
+}
+
+/*!
+ * @brief       Count an error and print the first ones.
+ *
+ * @param       pMsg - what is wrong
+ * @param       task - task of the error, BENCH_TASKS for the generic queue
+ */
+static void benchError(const char *pMsg, uint32_t task)
+{
+    if(benchErrors < BENCH_MAX_PRINTS)
+    {
+        printf("queue %u: %s\n", task, pMsg);
+    }
+    benchErrors++;
+}
+
+/*!
+ * @brief       Allocate a message with a random event and the next
+ *              sequence number.
+ *
+ * @return      the message
+ */
+static uint8_t *newMsg(void)
+{
+    benchMsg_t *pMsg = (benchMsg_t *)OsalPort_msgAllocate(sizeof(benchMsg_t));
+
+    if(pMsg == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+    pMsg->hdr.event = (uint8_t)benchRandom(BENCH_EVENTS);
+    pMsg->hdr.status = 0;
+    pMsg->seq = benchSeq++;
+
+    return ((uint8_t *)pMsg);
+}
+
+/*!
+ * @brief       Remove a message from a queue model.
+ *
+ * @param       pQueue - queue model
+ * @param       pos - position of the message
+ */
+static void modelRemove(benchQueue_t *pQueue, uint16_t pos)
+{
+    memmove(&pQueue->pMsgs[pos], &pQueue->pMsgs[pos + 1],
+            (pQueue->depth - pos - 1) * sizeof(pQueue->pMsgs[0]));
+    pQueue->depth--;
+}
+
+/*!
+ * @brief       Find the first message of an event in a queue model.
+ *
+ * @param       pQueue - queue model
+ * @param       event - event of the message
+ *
+ * @return      position of the message, -1 if there is none
+ */
+static int16_t modelFind(const benchQueue_t *pQueue, uint8_t event)
+{
+    uint16_t i;
+
+    for(i = 0; i < pQueue->depth; i++)
+    {
+        if(((OsalPort_EventHdr *)pQueue->pMsgs[i])->event == event)
+        {
+            return ((int16_t)i);
+        }
+    }
+
+    return (-1);
+}
+
+/*!
+ * @brief       Check the depth of a task queue, and that the message event
+ *              is set while it has messages.
+ *
+ * @param       task - task number
+ */
+static void checkTask(uint32_t task)
+{
+    const benchQueue_t *pQueue = &benchQueues[task];
+
+    if(OsalPort_msgCount(benchTaskIds[task]) != pQueue->depth)
+    {
+        benchError("wrong message count", task);
+    }
+    if((pQueue->depth != 0) && !(benchEvents[task] & OsalPort_SYS_EVENT_MSG))
+    {
+        benchError("messages waiting without the message event", task);
+    }
+}
+
+/*!
+ * @brief       Run an operation on a task queue and check it.
+ *
+ * @param       kind - operation, 0 to 99
+ * @param       task - task number
+ */
+static void taskOp(uint32_t kind, uint32_t task)
+{
+    benchQueue_t *pQueue = &benchQueues[task];
+    uint8_t taskId = benchTaskIds[task];
+    uint8_t event = (uint8_t)benchRandom(BENCH_EVENTS);
+    uint8_t *pMsg;
+    int16_t pos;
+
+    if((kind < 40) && (pQueue->depth < BENCH_MAX_DEPTH))
+    {
+        pMsg = newMsg();
+        /* Take the posts of the earlier operations */
+        benchSems[task].count = 0;
+        if(OsalPort_msgSend(taskId, pMsg) != OsalPort_SUCCESS)
+        {
+            benchError("send failed", task);
+            OsalPort_msgDeallocate(pMsg);
+            return;
+        }
+        pQueue->pMsgs[pQueue->depth++] = pMsg;
+        if(Semaphore_getCount(Semaphore_handle(&benchSems[task])) == 0)
+        {
+            benchError("send did not post the task", task);
+        }
+    }
+    else if(kind < 70)
+    {
+        pMsg = OsalPort_msgReceive(taskId);
+        if(pMsg != ((pQueue->depth != 0) ? pQueue->pMsgs[0] : NULL))
+        {
+            benchError("received out of order", task);
+        }
+        if(pQueue->depth != 0)
+        {
+            modelRemove(pQueue, 0);
+        }
+        if((pQueue->depth == 0) && (benchEvents[task] & OsalPort_SYS_EVENT_MSG))
+        {
+            benchError("message event left on an empty queue", task);
+        }
+        if(pMsg != NULL)
+        {
+            if(OsalPort_msgDeallocate(pMsg) != OsalPort_SUCCESS)
+            {
+                benchError("received message not freed", task);
+            }
+        }
+    }
+    else if(kind < 80)
+    {
+        pos = modelFind(pQueue, event);
+        if((uint8_t *)OsalPort_msgFind(taskId, event) !=
+           ((pos >= 0) ? pQueue->pMsgs[pos] : NULL))
+        {
+            benchError("wrong message found", task);
+        }
+    }
+    else if(kind < 90)
+    {
+        pos = modelFind(pQueue, event);
+        pMsg = (uint8_t *)OsalPort_msgFindDequeue(taskId, event);
+        if(pMsg != ((pos >= 0) ? pQueue->pMsgs[pos] : NULL))
+        {
+            benchError("wrong message dequeued", task);
+        }
+        if(pos >= 0)
+        {
+            modelRemove(pQueue, (uint16_t)pos);
+        }
+        if(pMsg != NULL)
+        {
+            OsalPort_msgDeallocate(pMsg);
+        }
+    }
+    else
+    {
+        /* Other event flags come and go without touching the queue */
+        uint32_t flag = 1UL << benchRandom(15);
+
+        if(kind & 1)
+        {
+            OsalPort_setEvent(taskId, flag);
+            if(!(benchEvents[task] & flag))
+            {
+                benchError("event not set", task);
+            }
+        }
+        else
+        {
+            OsalPort_clearEvent(taskId, flag);
+            if(benchEvents[task] & flag)
+            {
+                benchError("event not cleared", task);
+            }
+        }
+    }
+}
+
+/*!
+ * @brief       Run an operation on the generic queue and check it.
+ *
+ * @param       kind - operation, 0 to 99
+ */
+static void genericOp(uint32_t kind)
+{
+    benchQueue_t *pQueue = &benchGeneric;
+    uint8_t *pMsg;
+    void *pPrev;
+    void *pQ;
+    uint16_t pos;
+    uint16_t i;
+
+    if((kind < 30) && (pQueue->depth < BENCH_MAX_DEPTH))
+    {
+        pMsg = newMsg();
+        OsalPort_msgEnqueue(&genericQ, pMsg);
+        pQueue->pMsgs[pQueue->depth++] = pMsg;
+    }
+    else if(kind < 45)
+    {
+        uint8_t accepted;
+
+        pMsg = newMsg();
+        accepted = OsalPort_msgEnqueueMax(&genericQ, pMsg, BENCH_ENQUEUE_MAX);
+        /*
+         It counts the links between the messages, like it always did for
+         the MAC library, so a queue takes max + 1 messages
+         */
+        if(accepted != (pQueue->depth <= BENCH_ENQUEUE_MAX))
+        {
+            benchError("wrong OsalPort_msgEnqueueMax() result", BENCH_TASKS);
+        }
+        if(accepted)
+        {
+            pQueue->pMsgs[pQueue->depth++] = pMsg;
+        }
+        else
+        {
+            OsalPort_msgDeallocate(pMsg);
+        }
+    }
+    else if((kind < 55) && (pQueue->depth < BENCH_MAX_DEPTH))
+    {
+        pMsg = newMsg();
+        OsalPort_msgPush(&genericQ, pMsg);
+        memmove(&pQueue->pMsgs[1], &pQueue->pMsgs[0],
+                pQueue->depth * sizeof(pQueue->pMsgs[0]));
+        pQueue->pMsgs[0] = pMsg;
+        pQueue->depth++;
+    }
+    else if(kind < 85)
+    {
+        pMsg = OsalPort_msgDequeue(&genericQ);
+        if(pMsg != ((pQueue->depth != 0) ? pQueue->pMsgs[0] : NULL))
+        {
+            benchError("dequeued out of order", BENCH_TASKS);
+        }
+        if(pMsg != NULL)
+        {
+            modelRemove(pQueue, 0);
+            OsalPort_msgDeallocate(pMsg);
+        }
+    }
+    else if(pQueue->depth != 0)
+    {
+        pos = (uint16_t)benchRandom(pQueue->depth);
+        pPrev = (pos != 0) ? pQueue->pMsgs[pos - 1] : NULL;
+        pMsg = pQueue->pMsgs[pos];
+        OsalPort_msgExtract(&genericQ, pMsg, pPrev);
+        modelRemove(pQueue, pos);
+        OsalPort_msgDeallocate(pMsg);
+    }
+
+    /* Walk the whole queue now and then */
+    if(kind == 0)
+    {
+        for(pQ = genericQ, i = 0; (pQ != NULL) && (i < pQueue->depth);
+            pQ = OsalPort_MSG_NEXT(pQ), i++)
+        {
+            if(pQ != pQueue->pMsgs[i])
+            {
+                break;
+            }
+        }
+        if((pQ != NULL) || (i != pQueue->depth))
+        {
+            benchError("generic queue out of order", BENCH_TASKS);
+        }
+    }
+}
+
+/*!
+ * @brief       Report the host time of a send and a receive with queues of
+ *              different depths.
+ */
+static void timeDepths(void)
+{
+    static const uint16_t depths[] = {1, 10, 100, 1000};
+    uint8_t **ppMsgs;
+    uint8_t taskId = benchTaskIds[0];
+    uint32_t rounds = 1000000;
+    uint32_t d;
+    uint32_t r;
+
+    /* Empty the queue of the first task */
+    while(benchQueues[0].depth != 0)
+    {
+        OsalPort_msgDeallocate(OsalPort_msgReceive(taskId));
+        benchQueues[0].depth--;
+    }
+
+    ppMsgs = malloc(1000 * sizeof(uint8_t *));
+    if(ppMsgs == NULL)
+    {
+        return;
+    }
+
+    printf("host time of a send and a receive:\n");
+    for(d = 0; d < (sizeof(depths) / sizeof(depths[0])); d++)
+    {
+        double start;
+        double t;
+        uint32_t i;
+
+        for(i = 0; i < depths[d]; i++)
+        {
+            ppMsgs[i] = newMsg();
+            OsalPort_msgSend(taskId, ppMsgs[i]);
+        }
+
+        /* Each round keeps the depth: one message in, the oldest out */
+        start = realTime();
+        for(r = 0; r < rounds; r++)
+        {
+            uint8_t *pMsg = OsalPort_msgReceive(taskId);
+
+            OsalPort_msgSend(taskId, pMsg);
+        }
+        t = realTime() - start;
+
+        if(OsalPort_msgCount(taskId) != depths[d])
+        {
+            benchError("depth not kept", 0);
+        }
+        for(i = 0; i < depths[d]; i++)
+        {
+            OsalPort_msgDeallocate(OsalPort_msgReceive(taskId));
+        }
+
+        printf("  %4u messages queued: %6.1f ns\n", depths[d],
+               t * 1e9 / rounds);
+    }
+
+    free(ppMsgs);
+}
+
+/*!
+ * @brief       Host time.
+ *
+ * @return      seconds
+ */
+static double realTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
@@ -0,0 +1,583 @@
+/******************************************************************************
+
+ @file osal_timers_bench.c
+
+ @brief OSAL timer check and benchmark, for host builds
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+/******************************************************************************
+ Overview
+ *****************************************************************************/
+/*
+Runs hundreds of OSAL timers through osal_port_timers.c on the simulated
+clock of sim_rtos.c, with a random mix of one-shot and reload starts,
+restarts, stops, timeout queries and time moving forward, and checks each
+against a model of the timers:
+  - every event is sent on the millisecond its timer expires, never early,
+    late or twice, and reload timers keep their period
+  - OsalPortTimers_getTimerTimeout() gives the time left
+  - stops succeed for running timers only
+Then fills the table past OsalPortTimers_MAX_TIMERS and checks that the
+extra starts fail and are counted by OsalPortTimers_getStats(), and reports
+the host time of each kind of call with all the timers running.
+
+The events are taken by the bench, which provides OsalPort_setEvent() and
+the critical section of osal_port.c.
+
+Build, from software_stacks/ti15_4stack:
+  cc -O2 -Iposix/include -Iposix -Iosal_port -DOsalPortTimers_MAX_TIMERS=512
+     -DOsalPortTimers_HASH_SIZE=256 posix/osal_timers_bench.c
+     osal_port/osal_port_timers.c posix/sim_rtos.c -o osal_timers_bench
+
+Usage: osal_timers_bench [-t timers] [-n ops] [-s seed]
+  -t  timers in use, up to OsalPortTimers_MAX_TIMERS, default 500
+  -n  timer operations, default 1000000
+  -s  seed of the operations, default 1
+*/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_rtos.h"
+#include "osal_port.h"
+#include "osal_port_timers.h"
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/* Timers of each task, one per event bit */
+#define BENCH_EVENTS 32
+
+/* Clock ticks in a millisecond */
+#define BENCH_TICKS_PER_MS (1000 / SIM_RTOS_TICK_PERIOD)
+
+/* Errors printed, the rest are only counted */
+#define BENCH_MAX_PRINTS 10
+
+/* Model of a timer */
+typedef struct
+{
+    /* Expiry time in ms, 0 if not running */
+    uint64_t expires;
+    /* Reload period in ms, 0 for a one-shot timer */
+    uint32_t period;
+} benchTimer_t;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Timer models, timer i is task i / BENCH_EVENTS, event bit i % BENCH_EVENTS */
+static benchTimer_t *benchTimers;
+static uint32_t benchNumTimers;
+
+/* Events received and errors found */
+static uint64_t benchEvents;
+static uint32_t benchErrors;
+
+/* State of the random generator */
+static uint32_t benchRandomState = 1;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static uint32_t benchRandom(uint32_t range);
+static uint64_t nowMs(void);
+static uint32_t randomTimeout(void);
+static void benchError(const char *pMsg, uint32_t timer);
+static uint8_t timerTask(uint32_t timer);
+static uint32_t timerEvent(uint32_t timer);
+static void runOps(uint32_t ops);
+static void checkFull(void);
+static void timeCalls(void);
+static double realTime(void);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+    uint32_t ops = 1000000;
+    uint32_t seed = 1;
+    OsalPortTimers_Stats_t stats;
+    int opt;
+
+    benchNumTimers = 500;
+    while((opt = getopt(argc, argv, "t:n:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 't':
+                benchNumTimers = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                ops = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-t timers] [-n ops] [-s seed]\n",
+                        argv[0]);
+                return (2);
+        }
+    }
+    if((benchNumTimers == 0) || (benchNumTimers > OsalPortTimers_MAX_TIMERS))
+    {
+        fprintf(stderr, "timers must be 1 to %u\n",
+                (unsigned)OsalPortTimers_MAX_TIMERS);
+        return (2);
+    }
+
+    benchTimers = calloc(OsalPortTimers_MAX_TIMERS + 1, sizeof(benchTimer_t));
+    if(benchTimers == NULL)
+    {
+        fprintf(stderr, "out of memory\n");
+        return (2);
+    }
+
+    benchRandomState = (seed != 0) ? seed : 1;
+    SimRtos_init();
+
+    runOps(ops);
+    OsalPortTimers_getStats(&stats);
+    printf("%u timers, %u operations, %llu events, %u wakeups, "
+           "at most %u running\n", benchNumTimers, ops,
+           (unsigned long long)benchEvents, SimRtos_getWakeups(),
+           stats.maxUsed);
+
+    checkFull();
+    timeCalls();
+
+    printf("%u errors\n", benchErrors);
+    free(benchTimers);
+
+    return ((benchErrors != 0) ? 1 : 0);
+}
+
+/*!
+ Take a timer event.
+
+ Public function defined in osal_port.h
+ */
+uint8_t OsalPort_setEvent(uint8_t destinationTask, uint32_t eventFlag)
+{
+    uint32_t timer = (uint32_t)destinationTask * BENCH_EVENTS;
+    benchTimer_t *pTimer;
+
+    while(eventFlag > 1)
+    {
+        eventFlag >>= 1;
+        timer++;
+    }
+
+    benchEvents++;
+    if(timer >= (OsalPortTimers_MAX_TIMERS + 1))
+    {
+        benchError("event of an unknown timer", timer);
+        return (OsalPort_SUCCESS);
+    }
+
+    pTimer = &benchTimers[timer];
+    if(pTimer->expires != nowMs())
+    {
+        char msg[80];
+
+        snprintf(msg, sizeof(msg), "event at %llu ms, expected %llu ms",
+                 (unsigned long long)nowMs(),
+                 (unsigned long long)pTimer->expires);
+        benchError(msg, timer);
+    }
+
+    pTimer->expires = (pTimer->period != 0) ? (nowMs() + pTimer->period) : 0;
+
+    return (OsalPort_SUCCESS);
+}
+
+/*!
+ Enter a critical section.
+
+ Public function defined in osal_port.h
+ */
+uint32_t OsalPort_enterCS(void)
+{
+    return ((uint32_t)HwiP_disable());
+}
+
+/*!
+ Leave a critical section.
+
+ Public function defined in osal_port.h
+ */
+void OsalPort_leaveCS(uint32_t key)
+{
+    HwiP_restore(key);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief       Random number.
+ *
+ * @param       range - the number is below this
+ *
+ * @return      random number
+ */
+static uint32_t benchRandom(uint32_t range)
+{
+    benchRandomState ^= benchRandomState << 13;
+    benchRandomState ^= benchRandomState >> 17;
+    benchRandomState ^= benchRandomState << 5;
+
+    return ((range != 0) ? (benchRandomState % range) : 0);
+}
+
+/*!
+ * @brief       Simulated time in ms, the timers start at time 0.
+ *
+ * @return      time in ms
+ */
+static uint64_t nowMs(void)
+{
+    return (SimRtos_getTime() / BENCH_TICKS_PER_MS);
+}
+
+/*!
+ * @brief       Random timeout, mostly short like the MAC's, some long.
+ *
+ * @return      timeout in ms
+ */
+static uint32_t randomTimeout(void)
+{
+    uint32_t kind = benchRandom(10);
+
+    if(kind < 5)
+    {
+        return (1 + benchRandom(100));
+    }
+    else if(kind < 8)
+    {
+        return (1 + benchRandom(10000));
+    }
+
+    return (1 + benchRandom(3600000));
+}
+
+/*!
+ * @brief       Count an error and print the first ones.
+ *
+ * @param       pMsg - what is wrong
+ * @param       timer - timer number
+ */
+static void benchError(const char *pMsg, uint32_t timer)
+{
+    if(benchErrors < BENCH_MAX_PRINTS)
+    {
+        printf("timer %u: %s\n", timer, pMsg);
+    }
+    benchErrors++;
+}
+
+/*!
+ * @brief       Task ID of a timer.
+ *
+ * @param       timer - timer number
+ *
+ * @return      task ID
+ */
+static uint8_t timerTask(uint32_t timer)
+{
+    return ((uint8_t)(timer / BENCH_EVENTS));
+}
+
+/*!
+ * @brief       Event of a timer.
+ *
+ * @param       timer - timer number
+ *
+ * @return      event bit
+ */
+static uint32_t timerEvent(uint32_t timer)
+{
+    return (1UL << (timer % BENCH_EVENTS));
+}
+
+/*!
+ * @brief       Run random timer operations and check them against the model.
+ *
+ * @param       ops - number of operations
+ */
+static void runOps(uint32_t ops)
+{
+    uint32_t i;
+    uint32_t t;
+
+    /* Start the time base of the timers at time 0 */
+    OsalPortTimers_startTimer(0, 1, 1);
+    OsalPortTimers_stopTimer(0, 1);
+
+    for(i = 0; i < ops; i++)
+    {
+        uint32_t timer = benchRandom(benchNumTimers);
+        benchTimer_t *pTimer = &benchTimers[timer];
+        uint32_t kind = benchRandom(100);
+        uint32_t timeout;
+        uint8_t status;
+
+        if(kind < 45)
+        {
+            /* One-shot start or restart, a restart keeps the period */
+            timeout = randomTimeout();
+            status = OsalPortTimers_startTimer(timerTask(timer),
+                                               timerEvent(timer), timeout);
+            if(status != OsalPort_SUCCESS)
+            {
+                benchError("start failed", timer);
+            }
+            if(pTimer->expires == 0)
+            {
+                pTimer->period = 0;
+            }
+            pTimer->expires = nowMs() + timeout;
+        }
+        else if(kind < 50)
+        {
+            /* Reload start, periods long enough not to flood the events */
+            timeout = 10 + benchRandom(10000);
+            status = OsalPortTimers_startReloadTimer(timerTask(timer),
+                                                     timerEvent(timer),
+                                                     timeout);
+            if(status != OsalPort_SUCCESS)
+            {
+                benchError("reload start failed", timer);
+            }
+            if(pTimer->expires == 0)
+            {
+                pTimer->period = timeout;
+            }
+            pTimer->expires = nowMs() + timeout;
+        }
+        else if(kind < 60)
+        {
+            status = OsalPortTimers_stopTimer(timerTask(timer),
+                                              timerEvent(timer));
+            if(status != ((pTimer->expires != 0) ? OsalPort_SUCCESS :
+                                                   OsalPort_INVALIDPARAMETER))
+            {
+                benchError("wrong stop status", timer);
+            }
+            pTimer->expires = 0;
+        }
+        else if(kind < 90)
+        {
+            timeout = OsalPortTimers_getTimerTimeout(timerTask(timer),
+                                                     timerEvent(timer));
+            if(timeout != ((pTimer->expires != 0) ?
+                           (uint32_t)(pTimer->expires - nowMs()) : 0))
+            {
+                benchError("wrong time left", timer);
+            }
+        }
+        else
+        {
+            /* Move the time, the events come on the way */
+            SimRtos_advance(1 + benchRandom(200 * BENCH_TICKS_PER_MS));
+            for(t = 0; t < benchNumTimers; t++)
+            {
+                if((benchTimers[t].expires != 0)
+                   && (benchTimers[t].expires <= nowMs()))
+                {
+                    benchError("event not sent", t);
+                    benchTimers[t].expires = 0;
+                }
+            }
+        }
+    }
+
+    /* Stop what is left so the next checks start from an empty table */
+    for(t = 0; t < benchNumTimers; t++)
+    {
+        if(benchTimers[t].expires != 0)
+        {
+            OsalPortTimers_stopTimer(timerTask(t), timerEvent(t));
+            benchTimers[t].expires = 0;
+        }
+    }
+}
+
+/*!
+ * @brief       Start more timers than the table holds, the extra ones must
+ *              fail and be counted.
+ */
+static void checkFull(void)
+{
+    OsalPortTimers_Stats_t before;
+    OsalPortTimers_Stats_t after;
+    uint32_t failed = 0;
+    uint32_t t;
+
+    OsalPortTimers_getStats(&before);
+    for(t = 0; t <= OsalPortTimers_MAX_TIMERS; t++)
+    {
+        if(OsalPortTimers_startTimer(timerTask(t), timerEvent(t), 1000)
+           == OsalPort_NO_TIMER_AVAIL)
+        {
+            failed++;
+        }
+        else
+        {
+            benchTimers[t].period = 0;
+            benchTimers[t].expires = nowMs() + 1000;
+        }
+    }
+    OsalPortTimers_getStats(&after);
+
+    if((failed != 1) || (after.noTimerAvail != (before.noTimerAvail + 1))
+       || (after.used != OsalPortTimers_MAX_TIMERS))
+    {
+        benchError("full table not reported", OsalPortTimers_MAX_TIMERS);
+    }
+    printf("%u timers started in a table of %u: %u failed, %u counted\n",
+           OsalPortTimers_MAX_TIMERS + 1, OsalPortTimers_MAX_TIMERS, failed,
+           after.noTimerAvail - before.noTimerAvail);
+
+    for(t = 0; t <= OsalPortTimers_MAX_TIMERS; t++)
+    {
+        if(benchTimers[t].expires != 0)
+        {
+            OsalPortTimers_stopTimer(timerTask(t), timerEvent(t));
+            benchTimers[t].expires = 0;
+        }
+    }
+}
+
+/*!
+ * @brief       Report the host time of each call with benchNumTimers
+ *              timers running.
+ */
+static void timeCalls(void)
+{
+    static volatile uint32_t sink;
+    uint32_t *pTimeouts;
+    uint32_t rounds = 2000000 / benchNumTimers + 1;
+    uint32_t r;
+    uint32_t t;
+    double start;
+    double startTime = 0;
+    double queryTime = 0;
+    double stopTime = 0;
+
+    pTimeouts = malloc(benchNumTimers * sizeof(uint32_t));
+    if(pTimeouts == NULL)
+    {
+        return;
+    }
+    for(t = 0; t < benchNumTimers; t++)
+    {
+        pTimeouts[t] = randomTimeout() + 1000;
+    }
+
+    for(r = 0; r < rounds; r++)
+    {
+        /* First round starts, then restarts */
+        start = realTime();
+        for(t = 0; t < benchNumTimers; t++)
+        {
+            OsalPortTimers_startTimer(timerTask(t), timerEvent(t),
+                                      pTimeouts[t]);
+        }
+        startTime += realTime() - start;
+
+        start = realTime();
+        for(t = 0; t < benchNumTimers; t++)
+        {
+            sink += OsalPortTimers_getTimerTimeout(timerTask(t),
+                                                   timerEvent(t));
+        }
+        queryTime += realTime() - start;
+
+        /* Stop half of them so the starts are a mix of new and restarts */
+        start = realTime();
+        for(t = (r & 1); t < benchNumTimers; t += 2)
+        {
+            OsalPortTimers_stopTimer(timerTask(t), timerEvent(t));
+        }
+        stopTime += realTime() - start;
+    }
+
+    for(t = 0; t < benchNumTimers; t++)
+    {
+        OsalPortTimers_stopTimer(timerTask(t), timerEvent(t));
+    }
+    free(pTimeouts);
+
+    printf("host time with %u timers running:\n", benchNumTimers);
+    printf("  start: %6.1f ns\n",
+           startTime * 1e9 / ((double)rounds * benchNumTimers));
+    printf("  query: %6.1f ns\n",
+           queryTime * 1e9 / ((double)rounds * benchNumTimers));
+    printf("  stop:  %6.1f ns\n",
+           stopTime * 1e9 / ((double)rounds * ((benchNumTimers + 1) / 2)));
+}
+
+/*!
+ * @brief       Host time.
+ *
+ * @return      seconds
+ */
+static double realTime(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (ts.tv_sec + ts.tv_nsec / 1e9);
+}
@@ -0,0 +1,566 @@
+/******************************************************************************
+
+ @file sim_rtos.c
+
+ @brief Simulated TI-RTOS kernel for running the application on a host
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_rtos.h"
+
+/******************************************************************************
+ Global Variables
+ *****************************************************************************/
+
+const uint32_t Clock_tickPeriod = SIM_RTOS_TICK_PERIOD;
+
+/******************************************************************************
+ Local Variables
+ *****************************************************************************/
+
+/* Simulated time, in ticks */
+static uint64_t simTime = 0;
+
+/* Time stops moving here, 0 for never */
+static uint64_t simStopTime = 0;
+
+/* Number of times the time moved */
+static uint32_t simWakeups = 0;
+
+/* Active clocks, sorted by expiry */
+static Clock_Struct *pActiveClocks = NULL;
+
+/* There is only one thread, any non NULL value does for its handle */
+static int simTask;
+
+/* Power constraint counts */
+static uint8_t simConstraints[PowerCC26XX_IDLE_PD_DISALLOW + 1];
+
+/* State of the random number generator */
+static uint32_t simRandom = 1;
+
+/******************************************************************************
+ Local Function Prototypes
+ *****************************************************************************/
+static void insertClock(Clock_Struct *pClock);
+static void removeClock(Clock_Struct *pClock);
+static void expireClocks(void);
+
+/******************************************************************************
+ Public Functions
+ *****************************************************************************/
+
+/*!
+ Reset the simulated time.
+
+ Public function defined in sim_rtos.h
+ */
+void SimRtos_init(void)
+{
+    simTime = 0;
+    simStopTime = 0;
+    simWakeups = 0;
+    pActiveClocks = NULL;
+    memset(simConstraints, 0, sizeof(simConstraints));
+}
+
+/*!
+ Get the simulated time.
+
+ Public function defined in sim_rtos.h
+ */
+uint64_t SimRtos_getTime(void)
+{
+    return (simTime);
+}
+
+/*!
+ Move to the next clock expiry.
+
+ Public function defined in sim_rtos.h
+ */
+bool SimRtos_runNext(void)
+{
+    if((pActiveClocks == NULL) || SimRtos_stopped())
+    {
+        return (false);
+    }
+
+    if((simStopTime != 0) && (pActiveClocks->expiry > simStopTime))
+    {
+        simTime = simStopTime;
+        return (false);
+    }
+
+    if(pActiveClocks->expiry > simTime)
+    {
+        simTime = pActiveClocks->expiry;
+        simWakeups++;
+    }
+
+    expireClocks();
+
+    return (true);
+}
+
+/*!
+ Move the simulated time forward.
+
+ Public function defined in sim_rtos.h
+ */
+void SimRtos_advance(uint32_t ticks)
+{
+    uint64_t end = simTime + ticks;
+
+    while((pActiveClocks != NULL) && (pActiveClocks->expiry <= end))
+    {
+        if(pActiveClocks->expiry > simTime)
+        {
+            simTime = pActiveClocks->expiry;
+            simWakeups++;
+        }
+        expireClocks();
+    }
+
+    simTime = end;
+}
+
+/*!
+ Set the stop time.
+
+ Public function defined in sim_rtos.h
+ */
+void SimRtos_setStopTime(uint64_t time)
+{
+    simStopTime = time;
+}
+
+/*!
+ Check if the stop time is reached.
+
+ Public function defined in sim_rtos.h
+ */
+bool SimRtos_stopped(void)
+{
+    return (((simStopTime != 0) && (simTime >= simStopTime))
+            || (pActiveClocks == NULL));
+}
+
+/*!
+ Get the number of wakeups.
+
+ Public function defined in sim_rtos.h
+ */
+uint32_t SimRtos_getWakeups(void)
+{
+    return (simWakeups);
+}
+
+/*!
+ Seed the random number generator.
+
+ Public function defined in sim_rtos.h
+ */
+void SimRtos_setSeed(uint32_t seed)
+{
+    simRandom = (seed != 0) ? seed : 1;
+}
+
+/******************************************************************************
+ Clock
+ *****************************************************************************/
+
+void Clock_Params_init(Clock_Params *pParams)
+{
+    memset(pParams, 0, sizeof(Clock_Params));
+}
+
+void Clock_construct(Clock_Struct *pClock, Clock_FuncPtr fxn,
+                     uint32_t timeout, const Clock_Params *pParams)
+{
+    Clock_Params params;
+
+    if(pParams == NULL)
+    {
+        Clock_Params_init(&params);
+        pParams = &params;
+    }
+
+    memset(pClock, 0, sizeof(Clock_Struct));
+    pClock->fxn = fxn;
+    pClock->arg = pParams->arg;
+    pClock->timeout = timeout;
+    pClock->period = pParams->period;
+
+    if(pParams->startFlag)
+    {
+        Clock_start(pClock);
+    }
+}
+
+void Clock_destruct(Clock_Struct *pClock)
+{
+    Clock_stop(pClock);
+}
+
+Clock_Handle Clock_create(Clock_FuncPtr fxn, uint32_t timeout,
+                          const Clock_Params *pParams, Error_Block *pEb)
+{
+    Clock_Struct *pClock = malloc(sizeof(Clock_Struct));
+
+    (void)pEb;
+
+    if(pClock != NULL)
+    {
+        Clock_construct(pClock, fxn, timeout, pParams);
+    }
+
+    return (pClock);
+}
+
+void Clock_delete(Clock_Handle *pHandle)
+{
+    if(*pHandle != NULL)
+    {
+        Clock_stop(*pHandle);
+        free(*pHandle);
+        *pHandle = NULL;
+    }
+}
+
+void Clock_start(Clock_Handle handle)
+{
+    if(handle->active)
+    {
+        removeClock(handle);
+    }
+
+    handle->expiry = simTime + handle->timeout;
+    insertClock(handle);
+}
+
+void Clock_stop(Clock_Handle handle)
+{
+    if(handle->active)
+    {
+        removeClock(handle);
+    }
+}
+
+bool Clock_isActive(Clock_Handle handle)
+{
+    return (handle->active);
+}
+
+void Clock_setTimeout(Clock_Handle handle, uint32_t timeout)
+{
+    handle->timeout = timeout;
+}
+
+/* Remaining time of an active clock, like the device */
+uint32_t Clock_getTimeout(Clock_Handle handle)
+{
+    if(handle->active)
+    {
+        return ((uint32_t)(handle->expiry - simTime));
+    }
+
+    return (handle->timeout);
+}
+
+void Clock_setPeriod(Clock_Handle handle, uint32_t period)
+{
+    handle->period = period;
+}
+
+uint32_t Clock_getPeriod(Clock_Handle handle)
+{
+    return (handle->period);
+}
+
+void Clock_setFunc(Clock_Handle handle, Clock_FuncPtr fxn, UArg arg)
+{
+    handle->fxn = fxn;
+    handle->arg = arg;
+}
+
+uint32_t Clock_getTicks(void)
+{
+    return ((uint32_t)simTime);
+}
+
+/******************************************************************************
+ Semaphore
+ *****************************************************************************/
+
+void Semaphore_Params_init(Semaphore_Params *pParams)
+{
+    pParams->mode = Semaphore_Mode_COUNTING;
+}
+
+void Semaphore_construct(Semaphore_Struct *pSem, Int count,
+                         const Semaphore_Params *pParams)
+{
+    pSem->count = (uint32_t)count;
+    pSem->mode = (pParams != NULL) ? pParams->mode : Semaphore_Mode_COUNTING;
+}
+
+Semaphore_Handle Semaphore_create(Int count, const Semaphore_Params *pParams,
+                                  Error_Block *pEb)
+{
+    Semaphore_Struct *pSem = malloc(sizeof(Semaphore_Struct));
+
+    (void)pEb;
+
+    if(pSem != NULL)
+    {
+        Semaphore_construct(pSem, count, pParams);
+    }
+
+    return (pSem);
+}
+
+void Semaphore_post(Semaphore_Handle handle)
+{
+    if((handle->mode == Semaphore_Mode_COUNTING) || (handle->count == 0))
+    {
+        handle->count++;
+    }
+}
+
+/*
+ The only place the simulated time moves: run the clocks until one of them
+ posts the semaphore, or the timeout is over.
+ */
+bool Semaphore_pend(Semaphore_Handle handle, uint32_t timeout)
+{
+    uint64_t deadline = simTime + timeout;
+
+    while(handle->count == 0)
+    {
+        if((timeout == BIOS_NO_WAIT) || (pActiveClocks == NULL)
+           || ((timeout != BIOS_WAIT_FOREVER)
+               && (pActiveClocks->expiry > deadline)))
+        {
+            if((timeout != BIOS_WAIT_FOREVER) && (deadline > simTime))
+            {
+                SimRtos_advance((uint32_t)(deadline - simTime));
+            }
+            break;
+        }
+
+        if(SimRtos_runNext() == false)
+        {
+            break;
+        }
+    }
+
+    if(handle->count == 0)
+    {
+        return (false);
+    }
+
+    handle->count--;
+    return (true);
+}
+
+Int Semaphore_getCount(Semaphore_Handle handle)
+{
+    return ((Int)handle->count);
+}
+
+/******************************************************************************
+ Task and interrupts
+ *****************************************************************************/
+
+/* Clock functions only run from Semaphore_pend(), nothing to lock out */
+
+Task_Handle Task_self(void)
+{
+    return (&simTask);
+}
+
+UInt Task_disable(void)
+{
+    return (0);
+}
+
+void Task_restore(UInt key)
+{
+    (void)key;
+}
+
+uintptr_t HwiP_disable(void)
+{
+    return (0);
+}
+
+void HwiP_restore(uintptr_t key)
+{
+    (void)key;
+}
+
+/******************************************************************************
+ Power and Random
+ *****************************************************************************/
+
+int_fast16_t Power_setConstraint(uint_fast16_t constraintId)
+{
+    if(constraintId < sizeof(simConstraints))
+    {
+        simConstraints[constraintId]++;
+    }
+    return (Power_SOK);
+}
+
+int_fast16_t Power_releaseConstraint(uint_fast16_t constraintId)
+{
+    if((constraintId < sizeof(simConstraints))
+       && (simConstraints[constraintId] != 0))
+    {
+        simConstraints[constraintId]--;
+    }
+    return (Power_SOK);
+}
+
+uint_fast32_t Power_getConstraintMask(void)
+{
+    uint_fast32_t mask = 0;
+    uint8_t i;
+
+    for(i = 0; i < sizeof(simConstraints); i++)
+    {
+        if(simConstraints[i] != 0)
+        {
+            mask |= (1 << i);
+        }
+    }
+
+    return (mask);
+}
+
+/* xorshift32, repeatable from the seed */
+uint32_t Random_getNumber(void)
+{
+    simRandom ^= simRandom << 13;
+    simRandom ^= simRandom >> 17;
+    simRandom ^= simRandom << 5;
+
+    return (simRandom);
+}
+
+/******************************************************************************
+ Local Functions
+ *****************************************************************************/
+
+/*!
+ * @brief   Add a clock to the active list, after the clocks with the same
+ *          expiry so they run in the order they were started.
+ *
+ * @param   pClock - clock to add
+ */
+static void insertClock(Clock_Struct *pClock)
+{
+    Clock_Struct **ppNext = &pActiveClocks;
+
+    while((*ppNext != NULL) && ((*ppNext)->expiry <= pClock->expiry))
+    {
+        ppNext = &(*ppNext)->pNext;
+    }
+
+    pClock->pNext = *ppNext;
+    *ppNext = pClock;
+    pClock->active = true;
+}
+
+/*!
+ * @brief   Remove a clock from the active list.
+ *
+ * @param   pClock - clock to remove
+ */
+static void removeClock(Clock_Struct *pClock)
+{
+    Clock_Struct **ppNext = &pActiveClocks;
+
+    while(*ppNext != NULL)
+    {
+        if(*ppNext == pClock)
+        {
+            *ppNext = pClock->pNext;
+            break;
+        }
+        ppNext = &(*ppNext)->pNext;
+    }
+
+    pClock->pNext = NULL;
+    pClock->active = false;
+}
+
+/*!
+ * @brief   Call the functions of the clocks that expire at the current
+ *          time, and restart the periodic ones.
+ */
+static void expireClocks(void)
+{
+    while((pActiveClocks != NULL) && (pActiveClocks->expiry <= simTime))
+    {
+        Clock_Struct *pClock = pActiveClocks;
+
+        removeClock(pClock);
+
+        if(pClock->period != 0)
+        {
+            pClock->expiry += pClock->period;
+            insertClock(pClock);
+        }
+
+        if(pClock->fxn != NULL)
+        {
+            pClock->fxn(pClock->arg);
+        }
+    }
+}
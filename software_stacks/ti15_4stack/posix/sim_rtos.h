@@ -0,0 +1,315 @@
+/******************************************************************************
+
+ @file sim_rtos.h
+
+ @brief Simulated TI-RTOS kernel for running the application on a host
+
+ Group: WCS LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef SimRtos_H
+#define SimRtos_H
+
+/******************************************************************************
+ Includes
+ *****************************************************************************/
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ \defgroup SimRtos Simulated TI-RTOS Kernel
+ <BR>
+ The parts of the TI-RTOS kernel and drivers used by the OSAL port, the
+ UtilTimer module and the application (Clock, Semaphore, Task_self(), Hwi,
+ HwiP, Power constraints and Random), built on a simulated clock so the
+ application layer can run as a host process.
+ <BR>
+ The process is single threaded. Time only moves when a semaphore is pended
+ on and it isn't available: the simulated time jumps to the next clock
+ expiry and the clock functions are called from there, like they would be
+ from the clock interrupt. Nothing waits for real time, so a day of
+ simulated reporting intervals runs in well under a second, and two runs
+ with the same inputs give the same results.
+ <BR>
+ The headers in posix/include redirect the TI-RTOS includes here. A host
+ build puts that directory first in the include path, defines
+ OSAL_PORT_POSIX, and links sim_rtos.c and api_mac_posix.c in place of the
+ kernel and api_mac.c. osal_port.c, osal_port_timers.c and util_timer.c are
+ built unchanged. application/sensor/posix/sensor_sim.c runs the sensor
+ application this way.
+ <BR>
+ */
+
+/******************************************************************************
+ Constants and definitions
+ *****************************************************************************/
+
+/*!
+ * \ingroup SimRtos
+ * @{
+ */
+
+/*! Length of a clock tick in microseconds, like the device configuration */
+#ifndef SIM_RTOS_TICK_PERIOD
+#define SIM_RTOS_TICK_PERIOD 10
+#endif
+
+/*! xdc types */
+typedef uintptr_t UArg;
+typedef void Void;
+typedef void xdc_Void;
+typedef int Int;
+typedef unsigned int UInt;
+typedef uint8_t UInt8;
+typedef uint16_t UInt16;
+typedef uint32_t UInt32;
+typedef bool Bool;
+typedef char Char;
+typedef UArg xdc_UArg;
+typedef Int xdc_Int;
+typedef UInt xdc_UInt;
+typedef Bool xdc_Bool;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+/*! Timeouts of Semaphore_pend() */
+#define BIOS_WAIT_FOREVER (~((UInt32)0))
+#define BIOS_NO_WAIT 0
+
+/*! Clock function */
+typedef void (*Clock_FuncPtr)(UArg arg);
+
+/*! Clock instance */
+typedef struct Clock_Struct
+{
+    /*! Next active clock, in expiry order */
+    struct Clock_Struct *pNext;
+    Clock_FuncPtr fxn;
+    UArg arg;
+    /*! Initial timeout, in ticks */
+    uint32_t timeout;
+    /*! Period in ticks, 0 for a one-shot clock */
+    uint32_t period;
+    /*! Simulated time of the next expiry */
+    uint64_t expiry;
+    bool active;
+} Clock_Struct;
+
+typedef Clock_Struct *Clock_Handle;
+
+/*! Clock creation parameters */
+typedef struct
+{
+    uint32_t period;
+    bool startFlag;
+    UArg arg;
+} Clock_Params;
+
+/*! Semaphore modes */
+typedef enum
+{
+    Semaphore_Mode_COUNTING = 0,
+    Semaphore_Mode_BINARY = 1
+} Semaphore_Mode;
+
+/*! Semaphore instance */
+typedef struct
+{
+    uint32_t count;
+    Semaphore_Mode mode;
+} Semaphore_Struct;
+
+typedef Semaphore_Struct *Semaphore_Handle;
+
+/*! Semaphore creation parameters */
+typedef struct
+{
+    Semaphore_Mode mode;
+} Semaphore_Params;
+
+typedef void *Task_Handle;
+
+/*! Queue element, only embedded in other structures */
+typedef struct Queue_Elem
+{
+    struct Queue_Elem *next;
+    struct Queue_Elem *prev;
+} Queue_Elem;
+
+typedef void *Error_Block;
+
+/*! Power constraints */
+#define Power_SOK 0
+#define PowerCC26XX_SB_DISALLOW 0
+#define PowerCC26XX_SD_DISALLOW 1
+#define PowerCC26XX_IDLE_PD_DISALLOW 2
+
+extern const uint32_t Clock_tickPeriod;
+
+/******************************************************************************
+ Function Prototypes
+ *****************************************************************************/
+
+/*!
+ * @brief   Reset the simulated time to 0 and forget all the clocks.
+ */
+extern void SimRtos_init(void);
+
+/*!
+ * @brief   Get the simulated time.
+ *
+ * @return  ticks since SimRtos_init(), does not wrap like Clock_getTicks()
+ */
+extern uint64_t SimRtos_getTime(void);
+
+/*!
+ * @brief   Move the simulated time to the next clock expiry and call the
+ *          functions of all the clocks that expire then.
+ *
+ * @return  false if no clock is active or the stop time is reached
+ */
+extern bool SimRtos_runNext(void);
+
+/*!
+ * @brief   Move the simulated time forward, calling the functions of the
+ *          clocks that expire on the way.
+ *
+ * @param   ticks - how far to move
+ */
+extern void SimRtos_advance(uint32_t ticks);
+
+/*!
+ * @brief   Set a simulated time after which the time stops moving and
+ *          Semaphore_pend() returns false instead of waiting.
+ *
+ * @param   time - stop time in ticks, 0 to run forever
+ */
+extern void SimRtos_setStopTime(uint64_t time);
+
+/*!
+ * @brief   Check if the stop time is reached.
+ *
+ * @return  true if the time reached the stop time, or can't move because
+ *          no clock is active
+ */
+extern bool SimRtos_stopped(void);
+
+/*!
+ * @brief   Get the number of times the simulated time moved, each one is
+ *          a wakeup of the device.
+ *
+ * @return  number of wakeups
+ */
+extern uint32_t SimRtos_getWakeups(void);
+
+/*!
+ * @brief   Seed the generator behind Random_getNumber().
+ *
+ * @param   seed - any value but 0
+ */
+extern void SimRtos_setSeed(uint32_t seed);
+
+/* Clock */
+extern void Clock_Params_init(Clock_Params *pParams);
+extern void Clock_construct(Clock_Struct *pClock, Clock_FuncPtr fxn,
+                            uint32_t timeout, const Clock_Params *pParams);
+extern void Clock_destruct(Clock_Struct *pClock);
+extern Clock_Handle Clock_create(Clock_FuncPtr fxn, uint32_t timeout,
+                                 const Clock_Params *pParams,
+                                 Error_Block *pEb);
+extern void Clock_delete(Clock_Handle *pHandle);
+extern void Clock_start(Clock_Handle handle);
+extern void Clock_stop(Clock_Handle handle);
+extern bool Clock_isActive(Clock_Handle handle);
+extern void Clock_setTimeout(Clock_Handle handle, uint32_t timeout);
+extern uint32_t Clock_getTimeout(Clock_Handle handle);
+extern void Clock_setPeriod(Clock_Handle handle, uint32_t period);
+extern uint32_t Clock_getPeriod(Clock_Handle handle);
+extern void Clock_setFunc(Clock_Handle handle, Clock_FuncPtr fxn, UArg arg);
+extern uint32_t Clock_getTicks(void);
+
+#define Clock_handle(pClock) ((Clock_Handle)(pClock))
+
+/* Semaphore */
+extern void Semaphore_Params_init(Semaphore_Params *pParams);
+extern void Semaphore_construct(Semaphore_Struct *pSem, Int count,
+                                const Semaphore_Params *pParams);
+extern Semaphore_Handle Semaphore_create(Int count,
+                                         const Semaphore_Params *pParams,
+                                         Error_Block *pEb);
+extern void Semaphore_post(Semaphore_Handle handle);
+extern bool Semaphore_pend(Semaphore_Handle handle, uint32_t timeout);
+extern Int Semaphore_getCount(Semaphore_Handle handle);
+
+#define Semaphore_handle(pSem) ((Semaphore_Handle)(pSem))
+
+/* Task and interrupts */
+extern Task_Handle Task_self(void);
+extern UInt Task_disable(void);
+extern void Task_restore(UInt key);
+extern uintptr_t HwiP_disable(void);
+extern void HwiP_restore(uintptr_t key);
+
+#define Hwi_disable()       ((UInt)HwiP_disable())
+#define Hwi_restore(key)    HwiP_restore(key)
+
+/* Power and Random drivers */
+extern int_fast16_t Power_setConstraint(uint_fast16_t constraintId);
+extern int_fast16_t Power_releaseConstraint(uint_fast16_t constraintId);
+extern uint_fast32_t Power_getConstraintMask(void);
+extern uint32_t Random_getNumber(void);
+
+/*! @} end group SimRtos */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SimRtos_H */
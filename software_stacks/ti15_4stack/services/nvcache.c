@@ -0,0 +1,713 @@
+/******************************************************************************
+
+ @file  nvcache.c
+
+ @brief Write-back cache for hot NV items, layered over the NV interface
+
+ Group: CMCU, LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+//*****************************************************************************
+// Design Overview
+//*****************************************************************************
+/*
+Each hot item has an entry with a RAM copy of the item. An entry starts out
+UNKNOWN and is loaded from the driver the first time the item is used. From
+there it is ABSENT when the item doesn't exist, CLEAN when the RAM copy
+matches flash, or DIRTY when the RAM copy was written since the last flush.
+An item too long for the entry stays UNKNOWN, so its calls go to the driver.
+
+Calls that the cache can't answer from RAM, like readContItem() or doNext(),
+flush first and pass through, so the driver sees the same items the user
+does.
+
+Transactions go to the driver. A staged hot item is flushed and drops its
+RAM copy, so it reads the staged data after a commit and its last write
+after an abort or a failed commit. A commit drops the RAM copies that
+aren't DIRTY, so they are loaded with the committed data.
+*/
+
+//*****************************************************************************
+// Includes
+//*****************************************************************************
+
+#include <string.h>
+
+#include "nvcache.h"
+
+//*****************************************************************************
+// Constants and Definitions
+//*****************************************************************************
+
+// Entry states
+enum {NVCACHE_FREE = 0, NVCACHE_UNKNOWN, NVCACHE_ABSENT, NVCACHE_CLEAN,
+      NVCACHE_DIRTY};
+
+// Hot item entry
+typedef struct
+{
+  NVINTF_itemID_t id;               // item ID
+  uint16_t len;                     // length of the RAM copy
+  uint8_t state;                    // entry state
+  uint8_t data[NVCACHE_ITEM_LEN];   // RAM copy of the item
+} NVCACHE_entry_t;
+
+//*****************************************************************************
+// Local variables
+//*****************************************************************************
+
+// Driver functions
+static NVINTF_nvFuncts_t NVCACHE_driver;
+
+// Hot items
+static NVCACHE_entry_t NVCACHE_entries[NVCACHE_MAX_ITEMS];
+
+// Dirty callback
+static NVCACHE_dirtyCb_t NVCACHE_dirtyCb = NULL;
+
+//*****************************************************************************
+// API Function Prototypes
+//*****************************************************************************
+
+static uint8_t  NVCACHE_initNvApi(void *param);
+static uint8_t  NVCACHE_createItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf);
+static uint8_t  NVCACHE_updateItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf);
+static uint8_t  NVCACHE_deleteItemApi(NVINTF_itemID_t id);
+static uint8_t  NVCACHE_readItemApi(NVINTF_itemID_t id, uint16_t ofs, uint16_t len,
+                                    void *pBuf);
+static uint8_t  NVCACHE_readContItemApi(NVINTF_itemID_t id, uint16_t ofs,
+                                        uint16_t rlen, void *rBuf,
+                                        uint16_t clen, uint16_t cofs,
+                                        void *cBuf, uint16_t *pSubId);
+static uint8_t  NVCACHE_writeItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf);
+static uint32_t NVCACHE_getItemLenApi(NVINTF_itemID_t id);
+static uint8_t  NVCACHE_doNextApi(NVINTF_nvProxy_t *prx);
+static uint8_t  NVCACHE_eraseNvApi(void);
+static uint8_t  NVCACHE_stageItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf);
+static uint8_t  NVCACHE_commitTxnApi(void);
+
+//*****************************************************************************
+// Local Function Prototypes
+//*****************************************************************************
+
+static NVCACHE_entry_t *NVCACHE_find(NVINTF_itemID_t id);
+static bool    NVCACHE_load(NVCACHE_entry_t *pEntry);
+static uint8_t NVCACHE_flushEntry(NVCACHE_entry_t *pEntry);
+static void    NVCACHE_forget(void);
+
+//*****************************************************************************
+// Global Functions
+//*****************************************************************************
+
+/**
+ * @fn      NVCACHE_loadApiPtrs
+ *
+ * @brief   Global function to return function pointers for the cache, which
+ *          pass the NV calls to the driver functions given. Functions the
+ *          driver doesn't provide are NULL.
+ *
+ * @param   pfn - pointer to caller's structure of NV function pointers
+ * @param   pDriver - function pointers of the NV driver, copied
+ *
+ * @return  none
+ */
+void NVCACHE_loadApiPtrs(NVINTF_nvFuncts_t *pfn, const NVINTF_nvFuncts_t *pDriver)
+{
+    NVCACHE_driver = *pDriver;
+
+    // Calls that don't touch item contents go to the driver directly
+    *pfn = *pDriver;
+    pfn->initNV       = pDriver->initNV ? &NVCACHE_initNvApi : NULL;
+    pfn->createItem   = pDriver->createItem ? &NVCACHE_createItemApi : NULL;
+    pfn->updateItem   = pDriver->updateItem ? &NVCACHE_updateItemApi : NULL;
+    pfn->deleteItem   = pDriver->deleteItem ? &NVCACHE_deleteItemApi : NULL;
+    pfn->readItem     = pDriver->readItem ? &NVCACHE_readItemApi : NULL;
+    pfn->readContItem = pDriver->readContItem ? &NVCACHE_readContItemApi : NULL;
+    pfn->writeItem    = pDriver->writeItem ? &NVCACHE_writeItemApi : NULL;
+    pfn->getItemLen   = pDriver->getItemLen ? &NVCACHE_getItemLenApi : NULL;
+    pfn->doNext       = pDriver->doNext ? &NVCACHE_doNextApi : NULL;
+    pfn->eraseNV      = pDriver->eraseNV ? &NVCACHE_eraseNvApi : NULL;
+    pfn->stageItem    = pDriver->stageItem ? &NVCACHE_stageItemApi : NULL;
+    pfn->commitTxn    = pDriver->commitTxn ? &NVCACHE_commitTxnApi : NULL;
+}
+
+/**
+ * @fn      NVCACHE_addHotItem
+ *
+ * @brief   Global function to declare an item hot, so its writes are kept in
+ *          RAM until the next flush
+ *
+ * @param   id - NV item type identifier
+ *
+ * @return  true if declared, false if there is no room for another item
+ */
+bool NVCACHE_addHotItem(NVINTF_itemID_t id)
+{
+    uint8_t i;
+
+    if(NVCACHE_find(id) != NULL)
+    {
+        return(true);
+    }
+
+    for(i = 0; i < NVCACHE_MAX_ITEMS; i++)
+    {
+        if(NVCACHE_entries[i].state == NVCACHE_FREE)
+        {
+            NVCACHE_entries[i].id = id;
+            NVCACHE_entries[i].state = NVCACHE_UNKNOWN;
+            return(true);
+        }
+    }
+
+    return(false);
+}
+
+/**
+ * @fn      NVCACHE_setDirtyCb
+ *
+ * @brief   Global function to provide a function called when a hot item is
+ *          written and its RAM copy differs from flash
+ *
+ * @param   funcPtr - callback function, NULL for none
+ *
+ * @return  none
+ */
+void NVCACHE_setDirtyCb(NVCACHE_dirtyCb_t funcPtr)
+{
+    NVCACHE_dirtyCb = funcPtr;
+}
+
+/**
+ * @fn      NVCACHE_flush
+ *
+ * @brief   Global function to write the hot items written since the last
+ *          flush to flash
+ *
+ * @return  NVINTF_SUCCESS or the first failure code of the driver, items
+ *          that failed are written again by the next flush
+ */
+uint8_t NVCACHE_flush(void)
+{
+    uint8_t i;
+    uint8_t err;
+    uint8_t status = NVINTF_SUCCESS;
+
+    for(i = 0; i < NVCACHE_MAX_ITEMS; i++)
+    {
+        err = NVCACHE_flushEntry(&NVCACHE_entries[i]);
+        if(status == NVINTF_SUCCESS)
+        {
+            status = err;
+        }
+    }
+
+    return(status);
+}
+
+//*****************************************************************************
+// API Functions
+//*****************************************************************************
+
+/******************************************************************************
+ * @fn      NVCACHE_initNvApi
+ *
+ * @brief   API function to initialize the NV driver, hot items are loaded
+ *          again afterwards
+ *
+ * @param   param - pointer to caller's structure of NV init parameters
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_initNvApi(void *param)
+{
+    NVCACHE_forget();
+
+    return(NVCACHE_driver.initNV(param));
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_createItemApi
+ *
+ * @brief   API function to create a new NV item. Creates are rare, so hot
+ *          items are created in flash right away.
+ *
+ * @param   id - NV item type identifier
+ * @param   len - length of NV data
+ * @param   pBuf - pointer to caller's data buffer  (NULL is illegal)
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_createItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf)
+{
+    uint8_t err;
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if((pEntry != NULL) && NVCACHE_load(pEntry) && (pEntry->state != NVCACHE_ABSENT))
+    {
+        return(NVINTF_EXIST);
+    }
+
+    err = NVCACHE_driver.createItem(id, len, pBuf);
+
+    if(pEntry != NULL)
+    {
+        if((err == NVINTF_SUCCESS) && (len <= NVCACHE_ITEM_LEN))
+        {
+            memcpy(pEntry->data, pBuf, len);
+            pEntry->len = (uint16_t)len;
+            pEntry->state = NVCACHE_CLEAN;
+        }
+        else
+        {
+            pEntry->state = NVCACHE_UNKNOWN;
+        }
+    }
+
+    return(err);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_updateItemApi
+ *
+ * @brief   API function to update an existing NV item
+ *
+ * @param   id - NV item type identifier
+ * @param   len - length of NV data
+ * @param   pBuf - pointer to caller's data buffer  (NULL is illegal)
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_updateItemApi(NVINTF_itemID_t id, uint32_t len, void *pBuf)
+{
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if(pEntry != NULL)
+    {
+        // The driver has to know the item exists
+        (void)NVCACHE_flushEntry(pEntry);
+        pEntry->state = NVCACHE_UNKNOWN;
+    }
+
+    return(NVCACHE_driver.updateItem(id, len, pBuf));
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_deleteItemApi
+ *
+ * @brief   API function to delete an existing NV item
+ *
+ * @param   id - NV item type identifier
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_deleteItemApi(NVINTF_itemID_t id)
+{
+    uint8_t err;
+    bool dirty = false;
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if(pEntry != NULL)
+    {
+        dirty = (pEntry->state == NVCACHE_DIRTY);
+        pEntry->state = NVCACHE_UNKNOWN;
+    }
+
+    err = NVCACHE_driver.deleteItem(id);
+
+    // Item only written to RAM so far
+    if((err == NVINTF_NOTFOUND) && dirty)
+    {
+        err = NVINTF_SUCCESS;
+    }
+
+    if((pEntry != NULL) && (err == NVINTF_SUCCESS))
+    {
+        pEntry->state = NVCACHE_ABSENT;
+    }
+
+    return(err);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_readItemApi
+ *
+ * @brief   API function to read data from an NV item, from RAM for hot items
+ *
+ * @param   id   - NV item type identifier
+ * @param   ofs  - offset into NV data
+ * @param   len  - length of NV data to return (0 is illegal)
+ * @param   pBuf - pointer to caller's read data buffer  (NULL is illegal)
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_readItemApi(NVINTF_itemID_t id, uint16_t ofs, uint16_t len,
+                                   void *pBuf)
+{
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if((pEntry == NULL) || (pBuf == NULL) || (len == 0) || !NVCACHE_load(pEntry))
+    {
+        return(NVCACHE_driver.readItem(id, ofs, len, pBuf));
+    }
+
+    if(pEntry->state == NVCACHE_ABSENT)
+    {
+        return(NVINTF_NOTFOUND);
+    }
+
+    if((ofs + len) > pEntry->len)
+    {
+        // Bad length or offset
+        return((len > pEntry->len) ? NVINTF_BADLENGTH : NVINTF_BADOFFSET);
+    }
+
+    memcpy(pBuf, pEntry->data + ofs, len);
+
+    return(NVINTF_SUCCESS);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_readContItemApi
+ *
+ * @brief   API function to read data from an NV item found by its contents
+ *
+ * @param   id      - NV item type identifier
+ * @param   ofs     - offset into NV data
+ * @param   rlen    - length of NV data to return (0 is illegal)
+ * @param   rBuf    - pointer to caller's read data buffer (NULL is illegal)
+ * @param   clen    - length of content to compare
+ * @param   cofs    - offset of content to compare
+ * @param   cBuf    - pointer to content to compare
+ * @param   pSubId  - pointer to the sub ID found
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_readContItemApi(NVINTF_itemID_t id, uint16_t ofs,
+                                       uint16_t rlen, void *rBuf,
+                                       uint16_t clen, uint16_t cofs,
+                                       void *cBuf, uint16_t *pSubId)
+{
+    // The driver searches flash, it has to have the latest contents
+    (void)NVCACHE_flush();
+
+    return(NVCACHE_driver.readContItem(id, ofs, rlen, rBuf, clen, cofs, cBuf,
+                                       pSubId));
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_writeItemApi
+ *
+ * @brief   API function to write data to an NV item, creating it if needed.
+ *          Hot items are only written to RAM, and not at all if the contents
+ *          are the same.
+ *
+ * @param   id - NV item type identifier
+ * @param   len - data buffer length to write into NV block
+ * @param   pBuf - pointer to caller's data buffer to write  (NULL is illegal)
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_writeItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
+{
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if((pEntry == NULL) || (pBuf == NULL) || (len == 0))
+    {
+        return(NVCACHE_driver.writeItem(id, len, pBuf));
+    }
+
+    if(len > NVCACHE_ITEM_LEN)
+    {
+        // Too long to keep in RAM
+        pEntry->state = NVCACHE_UNKNOWN;
+        return(NVCACHE_driver.writeItem(id, len, pBuf));
+    }
+
+    (void)NVCACHE_load(pEntry);
+
+    if(((pEntry->state == NVCACHE_CLEAN) || (pEntry->state == NVCACHE_DIRTY)) &&
+       (pEntry->len == len) && (memcmp(pEntry->data, pBuf, len) == 0))
+    {
+        // Same contents, nothing to write
+        return(NVINTF_SUCCESS);
+    }
+
+    memcpy(pEntry->data, pBuf, len);
+    pEntry->len = len;
+    if(pEntry->state != NVCACHE_DIRTY)
+    {
+        pEntry->state = NVCACHE_DIRTY;
+        if(NVCACHE_dirtyCb != NULL)
+        {
+            NVCACHE_dirtyCb();
+        }
+    }
+
+    return(NVINTF_SUCCESS);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_getItemLenApi
+ *
+ * @brief   API function to return the length of an NV data item
+ *
+ * @param   id - NV item type identifier
+ *
+ * @return  Item length, if found; zero otherwise.
+ */
+static uint32_t NVCACHE_getItemLenApi(NVINTF_itemID_t id)
+{
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if((pEntry == NULL) || !NVCACHE_load(pEntry))
+    {
+        return(NVCACHE_driver.getItemLen(id));
+    }
+
+    return((pEntry->state == NVCACHE_ABSENT) ? 0 : pEntry->len);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_doNextApi
+ *
+ * @brief   API function to find, read or delete the next item
+ *
+ * @param   prx - NV item proxy
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_doNextApi(NVINTF_nvProxy_t *prx)
+{
+    uint8_t err;
+
+    // The driver walks flash, it has to have the latest contents
+    (void)NVCACHE_flush();
+
+    err = NVCACHE_driver.doNext(prx);
+
+    if(prx->flag & NVINTF_DODELETE)
+    {
+        NVCACHE_forget();
+    }
+
+    return(err);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_eraseNvApi
+ *
+ * @brief   API function to erase all NV items
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_eraseNvApi(void)
+{
+    NVCACHE_forget();
+
+    return(NVCACHE_driver.eraseNV());
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_stageItemApi
+ *
+ * @brief   API function to add an item to the transaction. A hot item's RAM
+ *          copy is written to flash first and dropped, so the item is loaded
+ *          again from what the transaction leaves.
+ *
+ * @param   id   - NV item type identifier
+ * @param   len  - length of NV data
+ * @param   pBuf - pointer to caller's data buffer, valid until the commit
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_stageItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
+{
+    NVCACHE_entry_t *pEntry = NVCACHE_find(id);
+
+    if(pEntry != NULL)
+    {
+        (void)NVCACHE_flushEntry(pEntry);
+        pEntry->state = NVCACHE_UNKNOWN;
+    }
+
+    return(NVCACHE_driver.stageItem(id, len, pBuf));
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_commitTxnApi
+ *
+ * @brief   API function to commit the transaction. RAM copies read while it
+ *          was open are loaded again.
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_commitTxnApi(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < NVCACHE_MAX_ITEMS; i++)
+    {
+        if((NVCACHE_entries[i].state == NVCACHE_CLEAN) ||
+           (NVCACHE_entries[i].state == NVCACHE_ABSENT))
+        {
+            NVCACHE_entries[i].state = NVCACHE_UNKNOWN;
+        }
+    }
+
+    return(NVCACHE_driver.commitTxn());
+}
+
+//*****************************************************************************
+// Local Functions
+//*****************************************************************************
+
+/******************************************************************************
+ * @fn      NVCACHE_find
+ *
+ * @brief   Find the entry of a hot item
+ *
+ * @param   id - NV item type identifier
+ *
+ * @return  entry, NULL if the item isn't hot
+ */
+static NVCACHE_entry_t *NVCACHE_find(NVINTF_itemID_t id)
+{
+    uint8_t i;
+    NVCACHE_entry_t *pEntry;
+
+    for(i = 0; i < NVCACHE_MAX_ITEMS; i++)
+    {
+        pEntry = &NVCACHE_entries[i];
+        if((pEntry->state != NVCACHE_FREE) &&
+           (pEntry->id.systemID == id.systemID) &&
+           (pEntry->id.itemID == id.itemID) && (pEntry->id.subID == id.subID))
+        {
+            return(pEntry);
+        }
+    }
+
+    return(NULL);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_load
+ *
+ * @brief   Load the RAM copy of a hot item from the driver, if not done yet
+ *
+ * @param   pEntry - hot item entry
+ *
+ * @return  true if the entry can answer for the item, false if the driver
+ *          has to
+ */
+static bool NVCACHE_load(NVCACHE_entry_t *pEntry)
+{
+    uint32_t len;
+
+    if(pEntry->state != NVCACHE_UNKNOWN)
+    {
+        return(true);
+    }
+
+    if(NVCACHE_driver.getItemLen == NULL)
+    {
+        return(false);
+    }
+
+    len = NVCACHE_driver.getItemLen(pEntry->id);
+    if(len == 0)
+    {
+        pEntry->state = NVCACHE_ABSENT;
+    }
+    else if((len <= NVCACHE_ITEM_LEN) &&
+            (NVCACHE_driver.readItem(pEntry->id, 0, (uint16_t)len,
+                                     pEntry->data) == NVINTF_SUCCESS))
+    {
+        pEntry->len = (uint16_t)len;
+        pEntry->state = NVCACHE_CLEAN;
+    }
+
+    return(pEntry->state != NVCACHE_UNKNOWN);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_flushEntry
+ *
+ * @brief   Write the RAM copy of a hot item to flash, if it was written
+ *
+ * @param   pEntry - hot item entry
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVCACHE_flushEntry(NVCACHE_entry_t *pEntry)
+{
+    uint8_t err = NVINTF_SUCCESS;
+
+    if(pEntry->state == NVCACHE_DIRTY)
+    {
+        err = NVCACHE_driver.writeItem(pEntry->id, pEntry->len, pEntry->data);
+        if(err == NVINTF_SUCCESS)
+        {
+            pEntry->state = NVCACHE_CLEAN;
+        }
+    }
+
+    return(err);
+}
+
+/******************************************************************************
+ * @fn      NVCACHE_forget
+ *
+ * @brief   Drop the RAM copies, hot items are loaded again when used
+ *
+ * @return  none
+ */
+static void NVCACHE_forget(void)
+{
+    uint8_t i;
+
+    for(i = 0; i < NVCACHE_MAX_ITEMS; i++)
+    {
+        if(NVCACHE_entries[i].state != NVCACHE_FREE)
+        {
+            NVCACHE_entries[i].state = NVCACHE_UNKNOWN;
+        }
+    }
+}
@@ -0,0 +1,173 @@
+/******************************************************************************
+
+ @file  nvcache.h
+
+ @brief Write-back cache for hot NV items, layered over the NV interface
+
+ Group: CMCU, LPC
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2016-2021, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+#ifndef NVCACHE_H
+#define NVCACHE_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "nvintf.h"
+
+//*****************************************************************************
+// Usage Overview
+//*****************************************************************************
+/*
+Some NV items are written over and over, often with the same contents. Every
+write of an NV driver like NVOCMP appends a new copy of the item to flash,
+which wears the flash and brings the next page compaction closer.
+
+This module sits between the user and an NV driver. It is loaded like a
+driver, with a copy of the driver's function pointers. Items declared hot
+with NVCACHE_addHotItem() are kept in RAM: writes only update the RAM copy,
+writes of the same contents are dropped, and reads are served from RAM. The
+RAM copies are written to flash by NVCACHE_flush(), which the user calls from
+a timer, before a reset, or whenever the items must be safe. The dirty
+callback tells the user when there is something to flush. Other items go
+straight to the driver.
+
+A hot item written since the last flush is lost on a reset, so only items
+that can safely go back to an older value should be declared hot. Frame
+counters for example must not be.
+
+NVINTF_nvFuncts_t driverFps;
+NVINTF_nvFuncts_t nvFps;
+
+NVOCMP_loadApiPtrs(&driverFps);
+driverFps.initNV(NULL);
+NVCACHE_loadApiPtrs(&nvFps, &driverFps);
+NVCACHE_addHotItem(configId);
+// Use nvFps like the driver, flush now and then
+NVCACHE_flush();
+
+The cache is not protected against concurrent use, all its calls must be made
+from the same task.
+
+Configuration:
+NVCACHE_MAX_ITEMS - number of hot items. Default is 4.
+NVCACHE_ITEM_LEN - largest hot item, in bytes. Longer writes go to the driver.
+Default is 32.
+*/
+
+//*****************************************************************************
+// Constants and definitions
+//*****************************************************************************
+
+#ifndef NVCACHE_MAX_ITEMS
+#define NVCACHE_MAX_ITEMS   4
+#endif
+
+#ifndef NVCACHE_ITEM_LEN
+#define NVCACHE_ITEM_LEN    32
+#endif
+
+//*****************************************************************************
+// Typedefs
+//*****************************************************************************
+
+// Called when a hot item is written and its RAM copy has to be flushed
+typedef void (*NVCACHE_dirtyCb_t)(void);
+
+//*****************************************************************************
+// Functions
+//*****************************************************************************
+
+/**
+ * @fn      NVCACHE_loadApiPtrs
+ *
+ * @brief   Global function to return function pointers for the cache, which
+ *          pass the NV calls to the driver functions given. Functions the
+ *          driver doesn't provide are NULL.
+ *
+ * @param   pfn - pointer to caller's structure of NV function pointers
+ * @param   pDriver - function pointers of the NV driver, copied
+ *
+ * @return  none
+ */
+extern void NVCACHE_loadApiPtrs(NVINTF_nvFuncts_t *pfn,
+                                const NVINTF_nvFuncts_t *pDriver);
+
+/**
+ * @fn      NVCACHE_addHotItem
+ *
+ * @brief   Global function to declare an item hot, so its writes are kept in
+ *          RAM until the next flush
+ *
+ * @param   id - NV item type identifier
+ *
+ * @return  true if declared, false if there is no room for another item
+ */
+extern bool NVCACHE_addHotItem(NVINTF_itemID_t id);
+
+/**
+ * @fn      NVCACHE_setDirtyCb
+ *
+ * @brief   Global function to provide a function called when a hot item is
+ *          written and its RAM copy differs from flash
+ *
+ * @param   funcPtr - callback function, NULL for none
+ *
+ * @return  none
+ */
+extern void NVCACHE_setDirtyCb(NVCACHE_dirtyCb_t funcPtr);
+
+/**
+ * @fn      NVCACHE_flush
+ *
+ * @brief   Global function to write the hot items written since the last
+ *          flush to flash
+ *
+ * @return  NVINTF_SUCCESS or the first failure code of the driver, items
+ *          that failed are written again by the next flush
+ */
+extern uint8_t NVCACHE_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NVCACHE_H */
@@ -84,6 +84,26 @@ nvFps.initNV(NULL);
 nvFps.compactNv(NULL);
 status = nvFps.readItem(id, 0, len, buf);
 
+Items that must change together are written in a transaction, when the driver
+provides one. Either all the staged items are written or, after a reset in the
+middle of the commit, none of them. The staged buffers are used by the commit,
+they must stay valid until then. There is one transaction at a time:
+beginTxn() fails while one is open, and commitTxn() or abortTxn() closes it,
+whatever their result:
+
+if((nvFps.beginTxn != NULL) && (nvFps.beginTxn() == NVINTF_SUCCESS))
+{
+    if((nvFps.stageItem(id1, len1, buf1) == NVINTF_SUCCESS) &&
+       (nvFps.stageItem(id2, len2, buf2) == NVINTF_SUCCESS))
+    {
+        status = nvFps.commitTxn();
+    }
+    else
+    {
+        nvFps.abortTxn();
+    }
+}
+
 */
 
 //*****************************************************************************
@@ -218,6 +238,20 @@ typedef uint8_t (*NVINTF_eraseNV)(void);
 //! Function pointer definition for the NVINTF_getFreeNV() function
 typedef uint32_t (*NVINTF_getFreeNV)(void);
 
+//! Function pointer definition for the NVINTF_beginTxn() function
+typedef uint8_t (*NVINTF_beginTxn)(void);
+
+//! Function pointer definition for the NVINTF_stageItem() function
+typedef uint8_t (*NVINTF_stageItem)(NVINTF_itemID_t id,
+                                    uint16_t length,
+                                    void *buffer );
+
+//! Function pointer definition for the NVINTF_commitTxn() function
+typedef uint8_t (*NVINTF_commitTxn)(void);
+
+//! Function pointer definition for the NVINTF_abortTxn() function
+typedef uint8_t (*NVINTF_abortTxn)(void);
+
 //! Structure of NV API function pointers
 typedef struct nvintf_nvfuncts_t
 {
@@ -251,6 +285,14 @@ typedef struct nvintf_nvfuncts_t
     NVINTF_eraseNV eraseNV;
     //! Get Free NV function
     NVINTF_getFreeNV getFreeNV;
+    //! Begin transaction function
+    NVINTF_beginTxn beginTxn;
+    //! Stage transaction item function
+    NVINTF_stageItem stageItem;
+    //! Commit transaction function
+    NVINTF_commitTxn commitTxn;
+    //! Abort transaction function
+    NVINTF_abortTxn abortTxn;
 } NVINTF_nvFuncts_t;
 
 //*****************************************************************************
@@ -122,7 +122,25 @@ the most recently written item. This makes 'finding' items by 'trying' item IDs
 in order extremely inefficient. The doNext() API call allows the user to find,
 read, or delete items in one page traversal. However, this call requires the
 user to lock access to NV until the operation is complete so it should be used
-carefully and sparingly.
+carefully and sparingly. When NVOCMP_RAMIDX is on, operations on a single
+item find its newest copy through a RAM index instead of a traversal.
+
+Note: A compaction copies every active item of a page before the write that
+needed the room can go ahead. With two pages, NVOCMP_compactStep() does the
+copy a few items at a time while the active page still takes writes, and
+switches pages once the copy has caught up. Items deleted or replaced after
+being copied are also marked inactive on the compaction page. If a write runs
+out of room before that, the remaining items are copied right away. With other
+page counts NVOCMP_compactStep() does a whole compaction.
+
+Note: Items written by a transaction are appended to the active page with
+the valid bit still set, so reads and compactions ignore them, and a commit
+marker item is written after the last one. From the marker on the items are
+committed: each is marked valid and its old copy inactive, then the marker
+is marked inactive. A reset before the marker leaves items that a compaction
+drops, a reset after it is finished by initNV(). A write that was cut by a
+reset leaves a torn item at the top of the active page, initNV() finds the
+last good item below it and compacts the page from there.
 
 Note: The compile flag NVDEBUG can be passed to enable ASSERT and ALERT
 macros which provide assert and logging functionality. When this flag is used,
@@ -138,8 +156,29 @@ Configuration:
 NVOCMP_STATS - Places a protected item with driver stats
 NVOCMP_CRCONREAD (on:1 off:0) - item crc is checked on read. Disabling this may
 increase driver speed but safety is reduced.
+NVOCMP_CRCMAPPED (on:1 off:0) - item crc is computed straight from memory
+mapped flash, instead of copying it out in blocks with NVS_read() first.
+Only used when the NVS region is addressable. Default is on.
 NVOCMP_NVS_INDEX - The index of the NVS_Config structure which describes the
 flash sector that NVOCMP should use. Default is 0.
+NVOCMP_RAMIDX (on:1 off:0) - keep a RAM index of where the newest copy of each
+item is, so item operations don't traverse the pages. The index is built by
+initNV(), is kept up to date by item writes and deletes, and is rebuilt after
+compaction. Default is on.
+NVOCMP_RAMIDX_SIZE - number of index entries, a power of 2. Up to 3/4 of them
+are used, items past that are found by traversing the pages. Default is 64.
+NVOCMP_BGCOMPACT (on:1 off:0) - provide NVOCMP_compactStep() so compaction can
+be done ahead of time, from an idle hook or a low priority task. It trades
+flash wear for write latency: a compaction started early copies items that
+would have been replaced before the page filled, so pages are erased more
+often. Default is off.
+NVOCMP_BGWATERMARK - free bytes of the active page below which
+NVOCMP_compactStep() starts a compaction. The higher it is, the more often a
+write finds the copy done, and the more pages are erased. Default is 1/16 of
+a page, where 100000 writes of the nv_bench fill workload erase 513 pages
+instead of 482 (740 with a quarter of a page).
+NVOCMP_TXNITEMS - most items staged in one transaction, 0 leaves the
+transaction API out. Default is 4.
 
 Dependencies:
 Requires NVS for NV access.
@@ -191,6 +230,30 @@ Requires API's in a crc.h to implement CRC functionality.
 #define NVOCMP_NWSAMEITEM   0           // Not Write Same Item
 #endif
 
+#ifndef NVOCMP_RAMIDX
+#define NVOCMP_RAMIDX       1           // RAM Index of Item Headers
+#endif
+
+#ifndef NVOCMP_RAMIDX_SIZE
+#define NVOCMP_RAMIDX_SIZE  64          // Number of Index Entries
+#endif
+
+#if (NVOCMP_RAMIDX_SIZE & (NVOCMP_RAMIDX_SIZE - 1))
+#error "NVOCMP_RAMIDX_SIZE should be a power of 2"
+#endif
+
+#ifndef NVOCMP_BGCOMPACT
+#define NVOCMP_BGCOMPACT    0           // Background Compaction Steps
+#endif
+
+#ifndef NVOCMP_BGWATERMARK
+#define NVOCMP_BGWATERMARK  (FLASH_PAGE_SIZE / 16) // Free Bytes to Start Compaction
+#endif
+
+#ifndef NVOCMP_TXNITEMS
+#define NVOCMP_TXNITEMS     4           // Items in a Transaction
+#endif
+
 #ifndef NVOCMP_MIGRATE_ENABLED
 #define NVOCMP_MIGRATE_DISABLED         // Migration from old NVOCTP disabled by default
 #endif
@@ -198,6 +261,12 @@ Requires API's in a crc.h to implement CRC functionality.
 #define NVOCMP_NVONEP       1           // One Page NV
 #define NVOCMP_NVTWOP       2           // Two Page NV
 
+#if (NVOCMP_BGCOMPACT && (NVOCMP_NVPAGES == NVOCMP_NVTWOP))
+#define NVOCMP_BGCOPY       1           // Items Copied a Few per Step
+#else
+#define NVOCMP_BGCOPY       0
+#endif
+
 #define NVOCMP_NVSIZE       NVOCMP_size
 #define NVOCMP_ADDPAGE(p,n) (((p) + (n)) % NVOCMP_NVSIZE)
 #define NVOCMP_INCPAGE(p)   NVOCMP_ADDPAGE(p,1)
@@ -239,10 +308,20 @@ Requires API's in a crc.h to implement CRC functionality.
 static const NVINTF_itemID_t diagId = NVOCMP_NVID_DIAG;
 #endif  // NVOCMP_STATS
 
+#if NVOCMP_TXNITEMS
+// NV item ID of the transaction commit marker, its data is the item count
+static const NVINTF_itemID_t txnId = NVOCMP_NVID_TXN;
+#endif
+
 // CRC options
 // When not NULL, reads will result in a CRC check before returning
 #define NVOCMP_CRCONREAD    1
 
+// When not 0, CRCs are computed from memory mapped flash if possible
+#ifndef NVOCMP_CRCMAPPED
+#define NVOCMP_CRCMAPPED    1
+#endif
+
 // findItem search types
 // Find any item, item of spec'd sysid, item of spec'd sys and item id
 // or find the exact item specified
@@ -251,6 +330,24 @@ enum {NVOCMP_FINDANY = 0x00, NVOCMP_FINDSYSID, NVOCMP_FINDITMID, NVOCMP_FINDSTRI
 
 #define NVOCMP_FINDLMASK    0x0F
 #define NVOCMP_FINDHMASK    0xF0
+
+#if NVOCMP_RAMIDX
+// RAM index states, items are only looked up when PART or FULL
+// NONE: not built yet, STALE: items moved, rebuild before use
+// PART: some items are not indexed, FULL: all active items are indexed
+enum {NVOCMP_IDXNONE = 0, NVOCMP_IDXSTALE, NVOCMP_IDXPART, NVOCMP_IDXFULL};
+
+// Most entries in use, keeps an empty entry at the end of every probe
+#define NVOCMP_IDXMAXUSED   ((NVOCMP_RAMIDX_SIZE * 3) / 4)
+#endif
+
+#if NVOCMP_BGCOPY
+// Background compaction states
+enum {NVOCMP_BGIDLE = 0, NVOCMP_BGBUSY};
+
+// Number of items a compaction step copies when it has to finish
+#define NVOCMP_BGALLITEMS   0xFFFF
+#endif
 //*****************************************************************************
 // Macros
 //*****************************************************************************
@@ -521,6 +618,42 @@ typedef enum NVOCMP_writeMode {
   NVOCMP_UPDATE,
 } NVOCMP_writeMode_t;
 
+#if NVOCMP_RAMIDX
+// RAM index entry, hofs is 0 when the item was deleted
+typedef struct
+{
+  uint32_t cmpid;   // compressed ID, NVOCMP_ERASEDWORD for an empty entry
+  uint16_t hofs;    // header offset of the newest copy
+  uint8_t hpage;    // header page of the newest copy
+} NVOCMP_idxEntry_t;
+#endif
+
+#if NVOCMP_BGCOPY
+// Background compaction progress. The source page items between loOff and
+// hiOff are copied from the top down. Items below loOff and from srcOff up
+// to hiOff are on the destination page.
+typedef struct
+{
+  uint8_t state;    // NVOCMP_BGIDLE or NVOCMP_BGBUSY
+  uint8_t srcPg;    // page the items are copied from
+  uint8_t dstPg;    // page the items are copied to
+  uint16_t srcOff;  // end of the next item to copy
+  uint16_t loOff;   // low end of this pass
+  uint16_t hiOff;   // high end of this pass
+  uint16_t dstOff;  // end of the copied items
+} NVOCMP_bgInfo_t;
+#endif
+
+#if NVOCMP_TXNITEMS
+// Item staged for a transaction, the buffer is written by the commit
+typedef struct
+{
+  NVINTF_itemID_t id;   // item ID
+  uint16_t len;         // data length
+  uint8_t *pBuf;        // caller's data buffer
+} NVOCMP_txnItem_t;
+#endif
+
 typedef struct
 {
   uint8_t state;    // page state
@@ -610,6 +743,32 @@ static uint16_t NVOCMP_badCRCCount = 0;
 NVOCMP_initAction_t gAction;
 uint8_t NVOCMP_size;
 
+#if NVOCMP_RAMIDX
+// RAM index of the item headers, open addressing with linear probing
+static NVOCMP_idxEntry_t NVOCMP_idxTable[NVOCMP_RAMIDX_SIZE];
+static uint16_t NVOCMP_idxUsed;
+static uint8_t NVOCMP_idxState = NVOCMP_IDXNONE;
+#endif
+
+#if NVOCMP_BGCOMPACT
+// Free bytes after the last compaction, steps don't start a compaction
+// when the last one couldn't get above the watermark
+static uint32_t NVOCMP_bgFree = NVOCMP_ERASEDWORD;
+#endif
+
+#if NVOCMP_BGCOPY
+static NVOCMP_bgInfo_t NVOCMP_bgInfo;
+#endif
+
+#if NVOCMP_TXNITEMS
+// Staged items, the transaction is open when the count isn't TXNCLOSED
+#define NVOCMP_TXNCLOSED    0xFF
+static NVOCMP_txnItem_t NVOCMP_txnItems[NVOCMP_TXNITEMS];
+static uint8_t NVOCMP_txnCount = NVOCMP_TXNCLOSED;
+// Items are written with the valid bit set while true
+static bool NVOCMP_txnPending = false;
+#endif
+
 //*****************************************************************************
 // NV API Function Prototypes
 //*****************************************************************************
@@ -632,6 +791,12 @@ static void       NVOCMP_unlockNvApi(int32_t);
 static bool       NVOCMP_expectCompApi(uint16_t len);
 static uint8_t    NVOCMP_eraseNvApi(void);
 static uint32_t   NVOCMP_getFreeNvApi(void);
+#if NVOCMP_TXNITEMS
+static uint8_t    NVOCMP_beginTxnApi(void);
+static uint8_t    NVOCMP_stageItemApi(NVINTF_itemID_t id, uint16_t len, void *buf);
+static uint8_t    NVOCMP_commitTxnApi(void);
+static uint8_t    NVOCMP_abortTxnApi(void);
+#endif
 
 //*****************************************************************************
 // NV Local Function Prototypes
@@ -672,6 +837,32 @@ static uint8_t    NVOCMP_doRAMCRC(uint8_t *input, uint16_t len, uint8_t crc);
 static uint8_t    NVOCMP_verifyCRC(uint16_t iOfs, uint16_t len, uint8_t crc, uint8_t pg, bool flag);
 static uint8_t    NVOCMP_readByte(uint8_t pg, uint16_t ofs);
 static void       NVOCMP_writeByte(uint8_t pg, uint16_t ofs, uint8_t bwv);
+static bool       NVOCMP_trimTop(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg);
+
+#if NVOCMP_RAMIDX
+static void       NVOCMP_idxBuild(NVOCMP_nvHandle_t *pNvHandle, uint32_t dupCid);
+static bool       NVOCMP_idxFind(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
+                                 int8_t *pStatus);
+static void       NVOCMP_idxUpdate(uint32_t cmpid, uint8_t pg, uint16_t hofs, bool replace);
+static void       NVOCMP_idxRemove(uint8_t pg, uint16_t hofs);
+static void       NVOCMP_idxInvalidate(void);
+#endif
+
+#if NVOCMP_BGCOMPACT
+static bool       NVOCMP_bgStep(NVOCMP_nvHandle_t *pNvHandle, uint16_t maxItems);
+#endif
+
+#if NVOCMP_TXNITEMS
+static uint8_t    NVOCMP_txnWrite(NVOCMP_nvHandle_t *pNvHandle);
+static void       NVOCMP_txnFinish(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
+                                   uint16_t mOfs);
+static void       NVOCMP_txnRecover(NVOCMP_nvHandle_t *pNvHandle);
+#endif
+
+#if NVOCMP_BGCOPY
+static void       NVOCMP_bgAbort(NVOCMP_nvHandle_t *pNvHandle);
+static void       NVOCMP_bgDrop(NVOCMP_nvHandle_t *pNvHandle, uint16_t iOfs);
+#endif
 
 #if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
 static uint8_t    NVOCMP_findDstPage(NVOCMP_nvHandle_t *pNvHandle);
@@ -681,8 +872,10 @@ static void       NVOCMP_getCompactHdr(uint8_t dstPg, uint16_t location, NVOCMP_
 #endif
 
 #if (NVOCMP_NVPAGES > NVOCMP_NVONEP)
-#if !defined(NVOCMP_MIGRATE_DISABLED)
+#if (!defined(NVOCMP_MIGRATE_DISABLED) || NVOCMP_BGCOPY)
 static void       NVOCMP_copyItem(uint8_t srcPg, uint8_t xPg, uint16_t sOfs, uint16_t dOfs, uint16_t len);
+#endif
+#if !defined(NVOCMP_MIGRATE_DISABLED)
 static void       NVOCMP_migratePage(NVOCMP_nvHandle_t *pNvHandle, uint8_t page);
 #endif
 #endif
@@ -719,6 +912,17 @@ void NVOCMP_loadApiPtrs(NVINTF_nvFuncts_t *pfn)
     pfn->expectComp   = &NVOCMP_expectCompApi;
     pfn->eraseNV      = &NVOCMP_eraseNvApi;
     pfn->getFreeNV    = &NVOCMP_getFreeNvApi;
+#if NVOCMP_TXNITEMS
+    pfn->beginTxn     = &NVOCMP_beginTxnApi;
+    pfn->stageItem    = &NVOCMP_stageItemApi;
+    pfn->commitTxn    = &NVOCMP_commitTxnApi;
+    pfn->abortTxn     = &NVOCMP_abortTxnApi;
+#else
+    pfn->beginTxn     = NULL;
+    pfn->stageItem    = NULL;
+    pfn->commitTxn    = NULL;
+    pfn->abortTxn     = NULL;
+#endif
 }
 
 /**
@@ -751,6 +955,10 @@ void NVOCMP_loadApiPtrsMin(NVINTF_nvFuncts_t *pfn)
     pfn->expectComp   = &NVOCMP_expectCompApi;
     pfn->eraseNV      = &NVOCMP_eraseNvApi;
     pfn->getFreeNV    = &NVOCMP_getFreeNvApi;
+    pfn->beginTxn     = NULL;
+    pfn->stageItem    = NULL;
+    pfn->commitTxn    = NULL;
+    pfn->abortTxn     = NULL;
 }
 
 /**
@@ -782,6 +990,17 @@ void NVOCMP_loadApiPtrsExt(NVINTF_nvFuncts_t *pfn)
     pfn->expectComp   = &NVOCMP_expectCompApi;
     pfn->eraseNV      = &NVOCMP_eraseNvApi;
     pfn->getFreeNV    = &NVOCMP_getFreeNvApi;
+#if NVOCMP_TXNITEMS
+    pfn->beginTxn     = &NVOCMP_beginTxnApi;
+    pfn->stageItem    = &NVOCMP_stageItemApi;
+    pfn->commitTxn    = &NVOCMP_commitTxnApi;
+    pfn->abortTxn     = &NVOCMP_abortTxnApi;
+#else
+    pfn->beginTxn     = NULL;
+    pfn->stageItem    = NULL;
+    pfn->commitTxn    = NULL;
+    pfn->abortTxn     = NULL;
+#endif
 }
 
 /**
@@ -860,6 +1079,46 @@ static bool NVOCMP_checkVoltage(void)
 }
 #endif
 
+#if NVOCMP_BGCOMPACT
+/**
+ * @fn      NVOCMP_compactStep
+ *
+ * @brief   Global function to do some of the next compaction ahead of time.
+ *          Meant to be called when the application has nothing else to do.
+ *          Once the free space of the active page falls below
+ *          NVOCMP_BGWATERMARK, each call copies up to maxItems active items
+ *          to the compaction page, so an item write doesn't have to wait
+ *          for a whole page compaction.
+ *
+ * @param   maxItems - maximum number of items to copy in this step
+ *
+ * @return  true if there is more to do, false if not
+ */
+extern bool NVOCMP_compactStep(uint16_t maxItems)
+{
+    bool more = false;
+    uint8_t err = NVINTF_SUCCESS;
+
+    // Check voltage if possible
+    NVOCMP_FLASHACCESS(err)
+    if(err || (NVOCMP_failF != NVINTF_SUCCESS) || (maxItems == 0))
+    {
+      return(false);
+    }
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    more = NVOCMP_bgStep(&NVOCMP_nvHandle, maxItems);
+
+#ifdef NV_LINUX
+    NV_LINUX_save();
+#endif
+
+    NVOCMP_UNLOCK(more);
+}
+#endif
+
 #ifdef NVDEBUG
 void NVOCMP_corruptData(uint8_t pg, uint16_t off, uint16_t len, uint8_t buf)
 {
@@ -934,6 +1193,7 @@ static uint8_t NVOCMP_initNvApi(void *param)
         NV_LINUX_init();
         
         NVOCMP_nvsHandle = NVS_HANDLE;
+        NVOCMP_nvsAttrs.regionBase = NV_LINUX_regionBase();
         NVOCMP_nvsAttrs.sectorSize = FLASH_PAGE_SIZE;
         NVOCMP_nvsAttrs.regionSize = FLASH_PAGE_SIZE * NVOCMP_NVPAGES;
 #endif
@@ -966,6 +1226,21 @@ static uint8_t NVOCMP_initNvApi(void *param)
 
         NVOCMP_initNv(&NVOCMP_nvHandle);
 
+#if NVOCMP_RAMIDX
+        // Index the items once, item operations don't traverse the pages.
+        // A resume that had to find the older copy of the last item already
+        // built it, unless a compaction since moved the items.
+        if(NVOCMP_idxState < NVOCMP_IDXPART)
+        {
+            NVOCMP_idxBuild(&NVOCMP_nvHandle, NVOCMP_ERASEDWORD);
+        }
+#endif
+
+#if NVOCMP_TXNITEMS
+        // Finish a transaction committed before the reset
+        NVOCMP_txnRecover(&NVOCMP_nvHandle);
+#endif
+
 #if defined (NVOCMP_STATS)
         {
             uint8_t err;
@@ -1021,6 +1296,14 @@ static uint8_t NVOCMP_eraseNvApi(void)
     NVOCMP_failW |= NVOCMP_erase(&NVOCMP_nvHandle, pg);
   }
 
+#if NVOCMP_BGCOPY
+  // Copied items are gone too
+  NVOCMP_bgInfo.state = NVOCMP_BGIDLE;
+#endif
+#if NVOCMP_BGCOMPACT
+  NVOCMP_bgFree = NVOCMP_ERASEDWORD;
+#endif
+
   err = NVOCMP_failW;
 
   // initial state, set head page, act page and tail page
@@ -1546,6 +1829,176 @@ static uint8_t NVOCMP_writeItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
     NVOCMP_UNLOCK(err);
 }
 
+#if NVOCMP_TXNITEMS
+/******************************************************************************
+ * @fn      NVOCMP_beginTxnApi
+ *
+ * @brief   API function to begin a transaction. There is one at a time,
+ *          commitTxn() or abortTxn() ends it.
+ *
+ * @return  NVINTF_SUCCESS, NVINTF_FAILURE if a transaction is open, or
+ *          specific failure code
+ */
+static uint8_t NVOCMP_beginTxnApi(void)
+{
+    if(NVOCMP_failF == NVINTF_NOTREADY)
+    {
+        // NV driver has not been initialized
+        return(NVINTF_NOTREADY);
+    }
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    if(NVOCMP_txnCount != NVOCMP_TXNCLOSED)
+    {
+        // The items staged so far belong to another caller
+        NVOCMP_UNLOCK(NVINTF_FAILURE);
+    }
+
+    NVOCMP_txnCount = 0;
+
+    NVOCMP_UNLOCK(NVINTF_SUCCESS);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_stageItemApi
+ *
+ * @brief   API function to add an item to the transaction. Nothing is written
+ *          until the commit, which reads the caller's buffer. Staging an item
+ *          again replaces its earlier data.
+ *
+ * @param   id   - NV item type identifier
+ * @param   len  - length of NV data
+ * @param   pBuf - pointer to caller's data buffer, valid until the commit
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_stageItemApi(NVINTF_itemID_t id, uint16_t len, void *pBuf)
+{
+    uint8_t i;
+    uint8_t err;
+    NVOCMP_itemHdr_t iHdr;
+
+    // Parameter Sanity Check
+    if (pBuf == NULL || len == 0)
+    {
+        return(NVINTF_BADPARAM);
+    }
+
+    err = NVOCMP_checkItem(&id, len, &iHdr, NVOCMP_FINDSTRICT);
+    if(err)
+    {
+      return(err);
+    }
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    if(NVOCMP_txnCount == NVOCMP_TXNCLOSED)
+    {
+        // No transaction to add to
+        NVOCMP_UNLOCK(NVINTF_BADPARAM);
+    }
+
+    for(i = 0; i < NVOCMP_txnCount; i++)
+    {
+        if(NVOCMP_CMPRID(NVOCMP_txnItems[i].id.systemID, NVOCMP_txnItems[i].id.itemID,
+                         NVOCMP_txnItems[i].id.subID) == iHdr.cmpid)
+        {
+            break;
+        }
+    }
+
+    if(i == NVOCMP_TXNITEMS)
+    {
+        // No room for another item
+        NVOCMP_UNLOCK(NVINTF_FAILURE);
+    }
+    if(i == NVOCMP_txnCount)
+    {
+        NVOCMP_txnCount++;
+    }
+
+    NVOCMP_txnItems[i].id = id;
+    NVOCMP_txnItems[i].len = len;
+    NVOCMP_txnItems[i].pBuf = (uint8_t *)pBuf;
+
+    NVOCMP_UNLOCK(NVINTF_SUCCESS);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_commitTxnApi
+ *
+ * @brief   API function to write the staged items and end the transaction.
+ *          The items are written together on the active page, and are
+ *          replaced all at once. The transaction ends on a failure too.
+ *
+ * @return  NVINTF_SUCCESS or specific failure code, none of the items are
+ *          replaced on a failure
+ */
+static uint8_t NVOCMP_commitTxnApi(void)
+{
+    uint8_t err = NVINTF_SUCCESS;
+
+    // Check voltage if possible
+    NVOCMP_FLASHACCESS(err)
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    if(NVOCMP_txnCount == NVOCMP_TXNCLOSED)
+    {
+        // No transaction to commit
+        NVOCMP_UNLOCK(NVINTF_BADPARAM);
+    }
+
+    if((err == NVINTF_SUCCESS) && (NVOCMP_txnCount > 0))
+    {
+        err = NVOCMP_txnWrite(&NVOCMP_nvHandle);
+    }
+    NVOCMP_txnCount = NVOCMP_TXNCLOSED;
+
+#ifdef NV_LINUX
+    if(err == NVINTF_SUCCESS)
+    {
+        NV_LINUX_save();
+    }
+#endif
+
+    NVOCMP_UNLOCK(err);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_abortTxnApi
+ *
+ * @brief   API function to end the transaction without writing the staged
+ *          items
+ *
+ * @return  NVINTF_SUCCESS, or NVINTF_BADPARAM if no transaction is open
+ */
+static uint8_t NVOCMP_abortTxnApi(void)
+{
+    if(NVOCMP_failF == NVINTF_NOTREADY)
+    {
+        // NV driver has not been initialized
+        return(NVINTF_NOTREADY);
+    }
+
+    // Prevent RTOS thread contention
+    NVOCMP_LOCK();
+
+    if(NVOCMP_txnCount == NVOCMP_TXNCLOSED)
+    {
+        // No transaction to abort
+        NVOCMP_UNLOCK(NVINTF_BADPARAM);
+    }
+    NVOCMP_txnCount = NVOCMP_TXNCLOSED;
+
+    NVOCMP_UNLOCK(NVINTF_SUCCESS);
+}
+#endif
+
 //*****************************************************************************
 // Extended API Functions
 //*****************************************************************************
@@ -2122,6 +2575,12 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
     {
       return;
     }
+    if(((pPageInfo->state == NVOCMP_PGACT) || (pPageInfo->state == NVOCMP_PGFULL)) &&
+       NVOCMP_trimTop(pNvHandle, pg) && (pPageInfo->state == NVOCMP_PGACT))
+    {
+      // A write was cut by the reset, nothing more goes on this page
+      NVOCMP_changePageState(pNvHandle, pg, NVOCMP_PGFULL);
+    }
     if(pPageInfo->state == NVOCMP_PGNACT)
     {
       noPgNact++;
@@ -2227,7 +2686,7 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
       else if(noPgNact)
       {
         pgXdst = pgNact;
-        NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+        NVOCMP_changePageState(pNvHandle, pgXdst, NVOCMP_PGXDST);
         action = NVOCMP_NORMAL_RESUME;
       }
       else
@@ -2277,13 +2736,24 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
         if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
         {
           NVOCMP_readHeader(pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN , &iHdr, false);
-          if(iHdr.stats & NVOCMP_FOLLOWBIT)
+          if((iHdr.stats & NVOCMP_FOLLOWBIT) && (iHdr.stats & NVOCMP_VALIDIDBIT))
           {
-            status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
-                            &iHdr, NVOCMP_FINDSTRICT, NULL);
-            if((status == NVINTF_SUCCESS) && (iHdr.hofs > 0))
+            // Item of a transaction that wasn't committed, replaces nothing
+          }
+          else if(iHdr.stats & NVOCMP_FOLLOWBIT)
+          {
+#if NVOCMP_RAMIDX
+            // The traversal that builds the index retires the older copy
+            NVOCMP_idxBuild(pNvHandle, iHdr.cmpid);
+            if(NVOCMP_idxState == NVOCMP_IDXSTALE)
+#endif
             {
-              NVOCMP_setItemInactive(pNvHandle, iHdr.hpage, iHdr.hofs);
+              status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
+                              &iHdr, NVOCMP_FINDSTRICT, NULL);
+              if((status == NVINTF_SUCCESS) && (iHdr.hofs > 0))
+              {
+                NVOCMP_setItemInactive(pNvHandle, iHdr.hpage, iHdr.hofs);
+              }
             }
           }
           else
@@ -2486,17 +2956,41 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
   switch(action)
   {
   case NVOCMP_NORMAL_RESUME :
+#if NVOCMP_BGCOPY
+      // Reset during a background compaction, the copied items are not needed
+      if(NVOCMP_readByte(pNvHandle->tailPage, NVOCMP_COMPMODEOFS) != NVOCMP_PGNORMAL)
+      {
+        NVOCMP_failW |= NVOCMP_erase(pNvHandle, pNvHandle->tailPage);
+        NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+      }
+#endif
       // resume state, set head page, act page and tail page
-      if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
+      if(NVOCMP_trimTop(pNvHandle, pNvHandle->actPage))
+      {
+        // A write was cut by the reset
+        compact = true;
+      }
+      else if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
       {
         NVOCMP_readHeader(pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN , &iHdr, false);
-        if(iHdr.stats & NVOCMP_FOLLOWBIT)
+        if((iHdr.stats & NVOCMP_FOLLOWBIT) && (iHdr.stats & NVOCMP_VALIDIDBIT))
         {
-          status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
-                          &iHdr, NVOCMP_FINDSTRICT, NULL);
-          if((status == NVINTF_SUCCESS) && (iHdr.hofs > 0))
+          // Item of a transaction that wasn't committed, replaces nothing
+        }
+        else if(iHdr.stats & NVOCMP_FOLLOWBIT)
+        {
+#if NVOCMP_RAMIDX
+          // The traversal that builds the index retires the older copy
+          NVOCMP_idxBuild(pNvHandle, iHdr.cmpid);
+          if(NVOCMP_idxState == NVOCMP_IDXSTALE)
+#endif
           {
-            NVOCMP_setItemInactive(pNvHandle, iHdr.hpage, iHdr.hofs);
+            status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
+                            &iHdr, NVOCMP_FINDSTRICT, NULL);
+            if((status == NVINTF_SUCCESS) && (iHdr.hofs > 0))
+            {
+              NVOCMP_setItemInactive(pNvHandle, iHdr.hpage, iHdr.hofs);
+            }
           }
         }
         else
@@ -2598,16 +3092,32 @@ static void NVOCMP_initNv(NVOCMP_nvHandle_t *pNvHandle)
   {
   case NVOCMP_NORMAL_RESUME :
       // resume state, set head page, act page and tail page
-      if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
+      if(NVOCMP_trimTop(pNvHandle, pNvHandle->actPage))
+      {
+        // A write was cut by the reset
+        compact = true;
+      }
+      else if(pNvHandle->actOffset > NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)
       {
         NVOCMP_readHeader(pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN , &iHdr, false);
-        if(iHdr.stats & NVOCMP_FOLLOWBIT)
+        if((iHdr.stats & NVOCMP_FOLLOWBIT) && (iHdr.stats & NVOCMP_VALIDIDBIT))
+        {
+          // Item of a transaction that wasn't committed, replaces nothing
+        }
+        else if(iHdr.stats & NVOCMP_FOLLOWBIT)
         {
-          status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
-                          &iHdr, NVOCMP_FINDSTRICT, NULL);
-          if((status == NVINTF_SUCCESS) && (iHdr.hofs > 0))
+#if NVOCMP_RAMIDX
+          // The traversal that builds the index retires the older copy
+          NVOCMP_idxBuild(pNvHandle, iHdr.cmpid);
+          if(NVOCMP_idxState == NVOCMP_IDXSTALE)
+#endif
           {
-            NVOCMP_setItemInactive(pNvHandle, iHdr.hpage, iHdr.hofs);
+            status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset - NVOCMP_ITEMHDRLEN - iHdr.len,
+                            &iHdr, NVOCMP_FINDSTRICT, NULL);
+            if((status == NVINTF_SUCCESS) && (iHdr.hofs > 0))
+            {
+              NVOCMP_setItemInactive(pNvHandle, iHdr.hpage, iHdr.hofs);
+            }
           }
         }
         else
@@ -2932,6 +3442,11 @@ static uint8_t NVOCMP_erase(NVOCMP_nvHandle_t *pNvHandle, uint8_t dstPg)
     uint8_t err = NVINTF_SUCCESS;
     int_fast16_t nvsRes = 0;
 
+#if NVOCMP_RAMIDX
+    // Items of this page are gone
+    NVOCMP_idxInvalidate();
+#endif
+
     // Check voltage if possible
     NVOCMP_FLASHACCESS(err)
 
@@ -3058,6 +3573,17 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
             cHdr[4] |= ((newCRC >> 6) & 0x3);
             // Note NVOCMP_VALIDIDBIT set implicitly zero
             cHdr[5] = ((newCRC & 0x3F) << 2) | NVOCMP_ACTIVEIDBIT;
+#endif
+#if NVOCMP_TXNITEMS
+            if(NVOCMP_txnPending)
+            {
+                // Transaction item, valid once the transaction is committed
+#if NVOCMP_HDRLE
+                cHdr[5] |= (NVOCMP_VALIDIDBIT << 6);
+#else
+                cHdr[5] |= NVOCMP_VALIDIDBIT;
+#endif
+            }
 #endif
             cHdr[6] = NVOCMP_SIGNATURE;
             memcpy(NVOCMP_itemBuffer + dLen, (const void *)cHdr,
@@ -3089,10 +3615,21 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
             // Note NVOCMP_VALIDIDBIT set implicitly zero
             cHdr[5] = ((newCRC & 0x3F) << 2) | NVOCMP_ACTIVEIDBIT;
 #endif
-            cHdr[6] = NVOCMP_SIGNATURE;
-            // Write data
-            NVOCMP_failW = NVOCMP_write(dstPg, dstOff, pBuf, dLen);
-            // Write header
+#if NVOCMP_TXNITEMS
+            if(NVOCMP_txnPending)
+            {
+                // Transaction item, valid once the transaction is committed
+#if NVOCMP_HDRLE
+                cHdr[5] |= (NVOCMP_VALIDIDBIT << 6);
+#else
+                cHdr[5] |= NVOCMP_VALIDIDBIT;
+#endif
+            }
+#endif
+            cHdr[6] = NVOCMP_SIGNATURE;
+            // Write data
+            NVOCMP_failW = NVOCMP_write(dstPg, dstOff, pBuf, dLen);
+            // Write header
             NVOCMP_failW |= NVOCMP_write(dstPg, hOfs, cHdr, NVOCMP_ITEMHDRLEN);
             // Advance to next location
             NVOCMP_ASSERT(dstOff < (dstOff + iLen), "Page offset overflow!")
@@ -3113,6 +3650,18 @@ static void NVOCMP_writeItem(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHd
         {
             NVOCMP_setItemInactive(pNvHandle, dstPg, hOfs);
         }
+#if NVOCMP_RAMIDX
+#if NVOCMP_TXNITEMS
+        else if(!NVOCMP_txnPending)
+#else
+        else
+#endif
+        {
+            // This is the newest copy of the item now
+            NVOCMP_idxUpdate(NVOCMP_CMPRID(pHdr->sysid, pHdr->itemid, pHdr->subid),
+                             dstPg, hOfs, true);
+        }
+#endif
     }
     else
     {
@@ -3276,6 +3825,79 @@ static void NVOCMP_setItemInactive(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
     // Mark the item as inactive
     NVOCMP_writeByte(pg, iOfs + NVOCMP_HDRVLDOFS, tmp);
 
+#if NVOCMP_RAMIDX
+    NVOCMP_idxRemove(pg, iOfs);
+#endif
+
+#if NVOCMP_BGCOPY
+    // The copy made by a background compaction is not active anymore either
+    if((NVOCMP_bgInfo.state == NVOCMP_BGBUSY) && (pg == NVOCMP_bgInfo.srcPg) &&
+       ((iOfs < NVOCMP_bgInfo.loOff) ||
+        ((iOfs >= NVOCMP_bgInfo.srcOff) && (iOfs < NVOCMP_bgInfo.hiOff))))
+    {
+      NVOCMP_bgDrop(pNvHandle, iOfs);
+    }
+#endif
+
+    if(pNvHandle->pageInfo[pg].allActive)
+    {
+      tmp = NVOCMP_readByte(pg, NVOCMP_PGHDRVER);
+      tmp &= ~NVOCMP_ALLACTIVE;
+      NVOCMP_writeByte(pg, NVOCMP_PGHDRVER, tmp);
+      pNvHandle->pageInfo[pg].allActive = NVOCMP_SOMEINACTIVE;
+    }
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_trimTop
+ *
+ * @brief   Check the top item of a page. A write cut by a reset leaves a
+ *          torn item there, which hides the items below it. The page is
+ *          then cut back to the highest whole item, the caller compacts it
+ *          or marks it full to keep the torn bytes from being written over.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   pg - page to check
+ *
+ * @return  true if the page was cut back
+ */
+static bool NVOCMP_trimTop(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg)
+{
+    uint8_t tmp;
+    uint16_t top = pNvHandle->pageInfo[pg].offset;
+    uint16_t ofs;
+    NVOCMP_itemHdr_t iHdr;
+
+    // The top item is whole unless a write was cut, then look further down
+    for(ofs = top; ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN); ofs--)
+    {
+        NVOCMP_readHeader(pg, ofs - NVOCMP_ITEMHDRLEN, &iHdr, false);
+        if((iHdr.stats & NVOCMP_FOLLOWBIT) &&
+           (iHdr.len <= (ofs - NVOCMP_ITEMHDRLEN - NVOCMP_PGDATAOFS)) &&
+           (NVOCMP_verifyCRC(ofs - NVOCMP_ITEMHDRLEN - iHdr.len, iHdr.len,
+                             iHdr.crc8, pg, false) == NVINTF_SUCCESS))
+        {
+            break;
+        }
+    }
+    if(ofs < (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN))
+    {
+        ofs = NVOCMP_PGDATAOFS;
+    }
+    if(ofs == top)
+    {
+        return(false);
+    }
+
+    NVOCMP_ALERT(false, "Torn item on top of the page, compaction needed.")
+
+    pNvHandle->pageInfo[pg].offset = ofs;
+    if(pg == pNvHandle->actPage)
+    {
+        pNvHandle->actOffset = ofs;
+    }
+
+    // The torn bytes are not an active item
     if(pNvHandle->pageInfo[pg].allActive)
     {
       tmp = NVOCMP_readByte(pg, NVOCMP_PGHDRVER);
@@ -3283,7 +3905,202 @@ static void NVOCMP_setItemInactive(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
       NVOCMP_writeByte(pg, NVOCMP_PGHDRVER, tmp);
       pNvHandle->pageInfo[pg].allActive = NVOCMP_SOMEINACTIVE;
     }
+
+    return(true);
+}
+
+#if NVOCMP_TXNITEMS
+/******************************************************************************
+ * @fn      NVOCMP_txnWrite
+ *
+ * @brief   Write the staged items and the commit marker after them, then
+ *          replace the old copies of the items
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  NVINTF_SUCCESS or specific failure code
+ */
+static uint8_t NVOCMP_txnWrite(NVOCMP_nvHandle_t *pNvHandle)
+{
+    uint8_t i;
+    uint8_t err = NVINTF_SUCCESS;
+    uint8_t count = NVOCMP_txnCount;
+    uint16_t mOfs;
+    uint16_t iLen = NVOCMP_ITEMHDRLEN + sizeof(count);
+    NVINTF_itemID_t id = txnId;
+    NVOCMP_itemHdr_t iHdr;
+
+    // The items and the marker go on the same page
+    for(i = 0; i < count; i++)
+    {
+        iLen += NVOCMP_ITEMHDRLEN + NVOCMP_txnItems[i].len;
+    }
+    if(iLen > (FLASH_PAGE_SIZE - NVOCMP_PGDATAOFS))
+    {
+        return(NVINTF_BADLENGTH);
+    }
+
+    if(NVOCMP_getDstPage(pNvHandle, iLen) == NVOCMP_NULLPAGE)
+    {
+        // Won't fit on the active page, compact and check again
+        if(NVOCMP_compactPage(pNvHandle, iLen) < iLen)
+        {
+            // Failure means there's no place to put these items
+            NVOCMP_ALERT(false, "Out of NV.")
+            return((NVOCMP_failW != NVINTF_SUCCESS) ?
+                   NVOCMP_failW : NVINTF_BADLENGTH);
+        }
+    }
+
+    // Until the marker is written the items are not valid
+    NVOCMP_txnPending = true;
+    for(i = 0; (i < count) && (err == NVINTF_SUCCESS); i++)
+    {
+        (void)NVOCMP_checkItem(&NVOCMP_txnItems[i].id, NVOCMP_txnItems[i].len,
+                               &iHdr, NVOCMP_FINDSTRICT);
+        NVOCMP_writeItem(pNvHandle, &iHdr, pNvHandle->actPage,
+                         pNvHandle->actOffset, NVOCMP_txnItems[i].pBuf);
+        err = NVOCMP_failW;
+    }
+    NVOCMP_txnPending = false;
+
+    if(err == NVINTF_SUCCESS)
+    {
+        // Single write that commits the transaction
+        (void)NVOCMP_checkItem(&id, sizeof(count), &iHdr, NVOCMP_FINDSTRICT);
+        mOfs = pNvHandle->actOffset + sizeof(count);
+        NVOCMP_writeItem(pNvHandle, &iHdr, pNvHandle->actPage,
+                         pNvHandle->actOffset, &count);
+        err = NVOCMP_failW;
+    }
+
+    if(err == NVINTF_SUCCESS)
+    {
+        NVOCMP_txnFinish(pNvHandle, pNvHandle->actPage, mOfs);
+        err = NVOCMP_failW;
+    }
+
+    return(err);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_txnFinish
+ *
+ * @brief   Replace the old copies of the items of a committed transaction.
+ *          Each step can be done again, so a reset on the way only means
+ *          finishing again from initNV().
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   pg - page of the commit marker
+ * @param   mOfs - offset of the commit marker header
+ *
+ * @return  none
+ */
+static void NVOCMP_txnFinish(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg,
+                             uint16_t mOfs)
+{
+    uint8_t tmp;
+    uint8_t count;
+    uint16_t ofs;
+    int8_t status;
+    NVOCMP_itemHdr_t iHdr;
+    NVOCMP_itemHdr_t oHdr;
+
+    // Marker data is the number of items, they are right below it
+    count = NVOCMP_readByte(pg, mOfs - sizeof(count));
+    ofs = mOfs - sizeof(count);
+
+    while((count > 0) && (ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)))
+    {
+        count--;
+
+        // Align to start of item header
+        ofs -= NVOCMP_ITEMHDRLEN;
+
+        // Read and decompress item header
+        NVOCMP_readHeader(pg, ofs, &iHdr, false);
+        if(!(iHdr.stats & NVOCMP_FOLLOWBIT) ||
+           (iHdr.len > (ofs - NVOCMP_PGDATAOFS)))
+        {
+            NVOCMP_ALERT(false, "Transaction item corrupted.")
+            break;
+        }
+
+        // Find the copy this item replaces. It is the newest one, unless
+        // the item was marked valid before a reset.
+        oHdr.sysid = iHdr.sysid;
+        oHdr.itemid = iHdr.itemid;
+        oHdr.subid = iHdr.subid;
+        status = NVOCMP_findItem(pNvHandle, pNvHandle->actPage, pNvHandle->actOffset,
+                                 &oHdr, NVOCMP_FINDSTRICT, NULL);
+        if((status == NVINTF_SUCCESS) && (oHdr.hpage == pg) && (oHdr.hofs == ofs))
+        {
+            status = NVOCMP_findItem(pNvHandle, pg, ofs - iHdr.len, &oHdr,
+                                     NVOCMP_FINDSTRICT, NULL);
+        }
+
+        if(iHdr.stats & NVOCMP_VALIDIDBIT)
+        {
+            // Mark the new copy valid
+            tmp = NVOCMP_readByte(pg, ofs + NVOCMP_HDRVLDOFS);
+#if NVOCMP_HDRLE
+            tmp &= ~(NVOCMP_VALIDIDBIT << 6);
+#else
+            tmp &= ~NVOCMP_VALIDIDBIT;
+#endif
+            NVOCMP_writeByte(pg, ofs + NVOCMP_HDRVLDOFS, tmp);
+        }
+
+        if(status == NVINTF_SUCCESS)
+        {
+            // Mark the old copy inactive
+            NVOCMP_setItemInactive(pNvHandle, oHdr.hpage, oHdr.hofs);
+        }
+
+#if NVOCMP_RAMIDX
+        // This is the newest copy of the item now
+        NVOCMP_idxUpdate(iHdr.cmpid, pg, ofs, true);
+#endif
+
+        // Jump to next item
+        ofs -= iHdr.len;
+    }
+
+    // Transaction done, the marker goes last
+    NVOCMP_setItemInactive(pNvHandle, pg, mOfs);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_txnRecover
+ *
+ * @brief   Finish a transaction that was committed but not finished before
+ *          a reset. Its marker is then the top item of the active page.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  none
+ */
+static void NVOCMP_txnRecover(NVOCMP_nvHandle_t *pNvHandle)
+{
+    uint8_t pg = pNvHandle->actPage;
+    uint16_t ofs = pNvHandle->actOffset;
+    NVOCMP_itemHdr_t iHdr;
+
+    if((pg == NVOCMP_NULLPAGE) || (ofs < (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN)))
+    {
+        return;
+    }
+
+    NVOCMP_readHeader(pg, ofs - NVOCMP_ITEMHDRLEN, &iHdr, false);
+    if((iHdr.stats & NVOCMP_FOLLOWBIT) && (iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+       !(iHdr.stats & NVOCMP_VALIDIDBIT) &&
+       (iHdr.cmpid == NVOCMP_CMPRID(txnId.systemID, txnId.itemID, txnId.subID)))
+    {
+        NVOCMP_ALERT(false, "Finishing a committed transaction.")
+        NVOCMP_txnFinish(pNvHandle, pg, ofs - NVOCMP_ITEMHDRLEN);
+    }
 }
+#endif
 
 /******************************************************************************
  * @fn      NVOCMP_setCompactHdr
@@ -3514,6 +4331,20 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
 #endif
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#if NVOCMP_RAMIDX
+    // Search for the newest copy of an item, use the index
+    if((flag == NVOCMP_FINDSTRICT) && (pg == pNvHandle->actPage) &&
+       (ofs == pNvHandle->actOffset))
+    {
+        int8_t status;
+
+        if(NVOCMP_idxFind(pNvHandle, pHdr, &status))
+        {
+            return(status);
+        }
+    }
+#endif
+
 #ifdef NVOCMP_GPRAM
     NVOCMP_disableCache(&vm);
 #endif
@@ -3665,6 +4496,20 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
     uint16_t items = 0;
     uint32_t cid = NVOCMP_CMPRID(pHdr->sysid,pHdr->itemid,pHdr->subid);
 
+#if NVOCMP_RAMIDX
+    // Search for the newest copy of an item, use the index
+    if((flag == NVOCMP_FINDSTRICT) && (pg == pNvHandle->actPage) &&
+       (ofs == pNvHandle->actOffset))
+    {
+        int8_t status;
+
+        if(NVOCMP_idxFind(pNvHandle, pHdr, &status))
+        {
+            return(status);
+        }
+    }
+#endif
+
 #if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
     uint16_t nvSearched = 0;
     for(p = pg; nvSearched < NVOCMP_NVSIZE; p = NVOCMP_DECPAGE(p), ofs = pNvHandle->pageInfo[p].offset)
@@ -3798,6 +4643,258 @@ static int8_t NVOCMP_findItem(NVOCMP_nvHandle_t *pNvHandle, uint8_t pg, uint16_t
 }
 #endif
 
+#if NVOCMP_RAMIDX
+/******************************************************************************
+ * @fn      NVOCMP_idxSlot
+ *
+ * @brief   Find the index entry of an item, or the empty entry where it
+ *          would be added
+ *
+ * @param   cmpid - compressed ID of the item
+ *
+ * @return  pointer to the index entry
+ */
+static NVOCMP_idxEntry_t *NVOCMP_idxSlot(uint32_t cmpid)
+{
+    // Multiplicative hash, IDs of one system are spread over the table
+    uint16_t i = (uint16_t)((cmpid * 0x9E3779B1) >> 16) & (NVOCMP_RAMIDX_SIZE - 1);
+
+    // The table is never full, there is an empty entry at the end
+    while((NVOCMP_idxTable[i].cmpid != cmpid) &&
+          (NVOCMP_idxTable[i].cmpid != NVOCMP_ERASEDWORD))
+    {
+        i = (i + 1) & (NVOCMP_RAMIDX_SIZE - 1);
+    }
+
+    return(&NVOCMP_idxTable[i]);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxUpdate
+ *
+ * @brief   Record where the newest copy of an item is
+ *
+ * @param   cmpid - compressed ID of the item
+ * @param   pg - header page
+ * @param   hofs - header offset
+ * @param   replace - true to replace the location already recorded, false
+ *                    to keep it (it is newer)
+ *
+ * @return  none
+ */
+static void NVOCMP_idxUpdate(uint32_t cmpid, uint8_t pg, uint16_t hofs, bool replace)
+{
+    NVOCMP_idxEntry_t *pEntry;
+
+    if(NVOCMP_idxState < NVOCMP_IDXPART)
+    {
+        return;
+    }
+
+    pEntry = NVOCMP_idxSlot(cmpid);
+    if(pEntry->cmpid == NVOCMP_ERASEDWORD)
+    {
+        if(NVOCMP_idxUsed >= NVOCMP_IDXMAXUSED)
+        {
+            // No room, this item will be found by traversing the pages
+            NVOCMP_idxState = NVOCMP_IDXPART;
+            return;
+        }
+        NVOCMP_idxUsed++;
+        pEntry->cmpid = cmpid;
+    }
+    else if(!replace && pEntry->hofs)
+    {
+        return;
+    }
+
+    pEntry->hpage = pg;
+    pEntry->hofs = hofs;
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxRemove
+ *
+ * @brief   Record that the item copy at a location was deleted
+ *
+ * @param   pg - header page
+ * @param   hofs - header offset
+ *
+ * @return  none
+ */
+static void NVOCMP_idxRemove(uint8_t pg, uint16_t hofs)
+{
+    uint16_t i;
+
+    if(NVOCMP_idxState < NVOCMP_IDXPART)
+    {
+        return;
+    }
+
+    // The entry stays, so a search for the item doesn't need the pages
+    for(i = 0; i < NVOCMP_RAMIDX_SIZE; i++)
+    {
+        if((NVOCMP_idxTable[i].hofs == hofs) && (NVOCMP_idxTable[i].hpage == pg) &&
+           (NVOCMP_idxTable[i].cmpid != NVOCMP_ERASEDWORD))
+        {
+            NVOCMP_idxTable[i].hofs = 0;
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxInvalidate
+ *
+ * @brief   Mark the index stale after items moved, the next search
+ *          rebuilds it
+ *
+ * @return  none
+ */
+static void NVOCMP_idxInvalidate(void)
+{
+    if(NVOCMP_idxState != NVOCMP_IDXNONE)
+    {
+        NVOCMP_idxState = NVOCMP_IDXSTALE;
+    }
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxBuild
+ *
+ * @brief   Build the index by traversing the pages once, from the newest
+ *          item to the oldest
+ *
+ *          At boot, the same traversal sets the older copy of the last item
+ *          written inactive, when the reset came between writing the item
+ *          and retiring its older copy. Without it, the resume would need
+ *          a traversal of its own.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   dupCid - compressed ID of the last item, its older active copy
+ *                   is set inactive, or NVOCMP_ERASEDWORD
+ *
+ * @return  none
+ */
+static void NVOCMP_idxBuild(NVOCMP_nvHandle_t *pNvHandle, uint32_t dupCid)
+{
+    uint8_t p = pNvHandle->actPage;
+    uint16_t ofs = pNvHandle->actOffset;
+    uint16_t topOfs = pNvHandle->actOffset - NVOCMP_ITEMHDRLEN;
+    NVOCMP_itemHdr_t iHdr;
+
+    memset(NVOCMP_idxTable, 0xFF, sizeof(NVOCMP_idxTable));
+    NVOCMP_idxUsed = 0;
+    NVOCMP_idxState = NVOCMP_IDXFULL;
+
+#if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
+    uint16_t nvSearched = 0;
+    for(p = pNvHandle->actPage; nvSearched < NVOCMP_NVSIZE; p = NVOCMP_DECPAGE(p), ofs = pNvHandle->pageInfo[p].offset)
+    {
+      nvSearched++;
+      if(p == pNvHandle->tailPage)
+      {
+        continue;
+      }
+#endif
+      while(ofs >= (NVOCMP_PGDATAOFS + NVOCMP_ITEMHDRLEN))
+      {
+          // Align to start of item header
+          ofs -= NVOCMP_ITEMHDRLEN;
+
+          // Read and decompress item header
+          NVOCMP_readHeader(p, ofs, &iHdr, false);
+
+          if(!(iHdr.stats & NVOCMP_FOLLOWBIT) || (iHdr.len >= ofs))
+          {
+              // Corrupted, findItem() traverses the pages and compacts
+              NVOCMP_idxState = NVOCMP_IDXSTALE;
+              return;
+          }
+
+          if((iHdr.stats & NVOCMP_ACTIVEIDBIT) &&
+            !(iHdr.stats & NVOCMP_VALIDIDBIT))
+          {
+              if((iHdr.cmpid == dupCid) &&
+                 ((p != pNvHandle->actPage) || (ofs != topOfs)))
+              {
+                  // Older copy of the last item, the reset came before it
+                  // was retired
+                  NVOCMP_setItemInactive(pNvHandle, p, ofs);
+                  dupCid = NVOCMP_ERASEDWORD;
+              }
+              else
+              {
+                  // Newer copies were recorded first
+                  NVOCMP_idxUpdate(iHdr.cmpid, p, ofs, false);
+              }
+          }
+
+          // Jump to next item
+          ofs -= iHdr.len;
+      }
+#if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
+    }
+#endif
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_idxFind
+ *
+ * @brief   Find the newest copy of an item with the index
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   pHdr - pointer to item header, with the IDs to find
+ * @param   pStatus - NVINTF_SUCCESS or NVINTF_NOTFOUND
+ *
+ * @return  true if the index has the answer, false if the pages must be
+ *          traversed
+ */
+static bool NVOCMP_idxFind(NVOCMP_nvHandle_t *pNvHandle, NVOCMP_itemHdr_t *pHdr,
+                           int8_t *pStatus)
+{
+    NVOCMP_idxEntry_t *pEntry;
+    NVOCMP_itemHdr_t iHdr;
+    uint32_t cid = NVOCMP_CMPRID(pHdr->sysid, pHdr->itemid, pHdr->subid);
+
+    if(NVOCMP_idxState == NVOCMP_IDXSTALE)
+    {
+        NVOCMP_idxBuild(pNvHandle, NVOCMP_ERASEDWORD);
+    }
+    if(NVOCMP_idxState < NVOCMP_IDXPART)
+    {
+        return(false);
+    }
+
+    pEntry = NVOCMP_idxSlot(cid);
+    if((pEntry->cmpid == NVOCMP_ERASEDWORD) || (pEntry->hofs == 0))
+    {
+        if((pEntry->cmpid == NVOCMP_ERASEDWORD) && (NVOCMP_idxState != NVOCMP_IDXFULL))
+        {
+            // Not indexed, may still be in NV
+            return(false);
+        }
+        pHdr->hofs = 0;
+        *pStatus = NVINTF_NOTFOUND;
+        return(true);
+    }
+
+    // Confirm the header is still the one that was indexed
+    NVOCMP_readHeader(pEntry->hpage, pEntry->hofs, &iHdr, false);
+    if((iHdr.cmpid == cid) && (iHdr.stats & NVOCMP_FOLLOWBIT) &&
+       (iHdr.stats & NVOCMP_ACTIVEIDBIT) && !(iHdr.stats & NVOCMP_VALIDIDBIT))
+    {
+        memcpy(pHdr, &iHdr, sizeof(NVOCMP_itemHdr_t));
+        *pStatus = NVINTF_SUCCESS;
+        return(true);
+    }
+
+    NVOCMP_ALERT(false, "Index out of date, rebuilding it.")
+    NVOCMP_idxState = NVOCMP_IDXSTALE;
+    return(false);
+}
+#endif
+
 #if (NVOCMP_NVPAGES > NVOCMP_NVTWOP)
 /******************************************************************************
  * @fn      NVOCMP_cleanPage
@@ -3907,6 +5004,11 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     return(0);
   }
 
+#if NVOCMP_RAMIDX
+  // Items are about to move
+  NVOCMP_idxInvalidate();
+#endif
+
   srcPg = pNvHandle->headPage;
   dstPg = pNvHandle->tailPage;
   compactPages = NVOCMP_NVSIZE - 1;
@@ -4064,6 +5166,9 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
   pNvHandle->actPage = pg;
   pNvHandle->actOffset = pNvHandle->pageInfo[pNvHandle->actPage].offset;
   NVOCMP_changePageState(pNvHandle, pNvHandle->tailPage, NVOCMP_PGXDST);
+#if NVOCMP_BGCOMPACT
+  NVOCMP_bgFree = NVOCMP_getFreeNvApi();
+#endif
   return(FLASH_PAGE_SIZE - pNvHandle->compactInfo.xDstOffset);
 }
 #else
@@ -4101,6 +5206,25 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
     return(0);
   }
 
+#if NVOCMP_BGCOPY
+  if(NVOCMP_bgInfo.state == NVOCMP_BGBUSY)
+  {
+    // Copy the rest of the items, unless something went wrong on the way
+    while(NVOCMP_bgStep(pNvHandle, NVOCMP_BGALLITEMS));
+    needBytes = nBytes ? nBytes : 16;
+    if((NVOCMP_bgInfo.state == NVOCMP_BGIDLE) && (NVOCMP_failW == NVINTF_SUCCESS) &&
+       (FLASH_PAGE_SIZE - pNvHandle->actOffset >= needBytes))
+    {
+      return(FLASH_PAGE_SIZE - pNvHandle->actOffset);
+    }
+  }
+#endif
+
+#if NVOCMP_RAMIDX
+  // Items are about to move
+  NVOCMP_idxInvalidate();
+#endif
+
 #if(NVOCMP_NVPAGES == NVOCMP_NVONEP)
   srcPg = 0;
   dstPg = 0;
@@ -4174,11 +5298,235 @@ static int16_t NVOCMP_compactPage(NVOCMP_nvHandle_t *pNvHandle, uint16_t nBytes)
   pNvHandle->actOffset = pNvHandle->pageInfo[dstPg].offset;
 #if(NVOCMP_NVPAGES > NVOCMP_NVONEP)
   NVOCMP_changePageState(pNvHandle, srcPg ,NVOCMP_PGXDST);
+#endif
+#if NVOCMP_BGCOMPACT
+  NVOCMP_bgFree = FLASH_PAGE_SIZE - pNvHandle->actOffset;
 #endif
   return(FLASH_PAGE_SIZE - pNvHandle->actOffset);
 }
 #endif
 
+#if NVOCMP_BGCOPY
+/******************************************************************************
+ * @fn      NVOCMP_bgStep
+ *
+ * @brief   Copy some active items to the other page. The copy is started
+ *          when the free space of the active page falls below the watermark,
+ *          and is done in passes: each pass copies the items written before
+ *          it started, from the newest down. Writes still go to the active
+ *          page in the meantime, so once a pass is done the items written
+ *          during it get the next one. Pages are switched when a pass ends
+ *          with nothing new written.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   maxItems - maximum number of items to copy
+ *
+ * @return  true if there is more to do, false if not
+ */
+static bool NVOCMP_bgStep(NVOCMP_nvHandle_t *pNvHandle, uint16_t maxItems)
+{
+  NVOCMP_bgInfo_t *pBg = &NVOCMP_bgInfo;
+  NVOCMP_itemHdr_t iHdr;
+  uint16_t hOfs;
+  uint16_t iLen;
+
+  // Reset Flash erase/write fail indicator
+  NVOCMP_failW = NVINTF_SUCCESS;
+
+  if(pBg->state == NVOCMP_BGIDLE)
+  {
+    // Enough room, nothing to gain or last compaction was no better
+    if((FLASH_PAGE_SIZE - pNvHandle->actOffset >= NVOCMP_BGWATERMARK) ||
+       (NVOCMP_bgFree < NVOCMP_BGWATERMARK) ||
+       (pNvHandle->pageInfo[pNvHandle->headPage].allActive) ||
+       (pNvHandle->pageInfo[pNvHandle->tailPage].state != NVOCMP_PGXDST))
+    {
+      return(false);
+    }
+
+    NVOCMP_ALERT(false, "Background compaction started.")
+    pBg->srcPg = pNvHandle->headPage;
+    pBg->dstPg = pNvHandle->tailPage;
+    pBg->loOff = NVOCMP_PGDATAOFS;
+    pBg->hiOff = pNvHandle->actOffset;
+    pBg->srcOff = pBg->hiOff;
+    pBg->dstOff = NVOCMP_PGDATAOFS;
+
+    // Lets initNv() know the page has copies to drop after a reset
+    NVOCMP_writeByte(pBg->dstPg, NVOCMP_COMPMODEOFS, NVOCMP_PGCDST);
+    pNvHandle->pageInfo[pBg->dstPg].mode = NVOCMP_PGCDST;
+    pBg->state = NVOCMP_BGBUSY;
+  }
+
+  while(maxItems && (pBg->srcOff > pBg->loOff))
+  {
+    hOfs = pBg->srcOff - NVOCMP_ITEMHDRLEN;
+    NVOCMP_readHeader(pBg->srcPg, hOfs, &iHdr, false);
+
+    // A regular compaction knows how to get past a damaged item
+    if((pBg->srcOff < pBg->loOff + NVOCMP_ITEMHDRLEN) ||
+       (hOfs < (iHdr.len + pBg->loOff)) || (iHdr.sig != NVOCMP_SIGNATURE))
+    {
+      NVOCMP_ALERT(false, "Item header corrupted, background compaction stopped.")
+      NVOCMP_bgAbort(pNvHandle);
+      return(false);
+    }
+
+    if(!(iHdr.stats & NVOCMP_VALIDIDBIT) && (iHdr.stats & NVOCMP_ACTIVEIDBIT))
+    {
+      if(NVOCMP_verifyCRC(hOfs - iHdr.len, iHdr.len, iHdr.crc8, pBg->srcPg, false))
+      {
+        NVOCMP_ALERT(false, "Item CRC incorrect, background compaction stopped.")
+        NVOCMP_bgAbort(pNvHandle);
+        return(false);
+      }
+
+      iLen = iHdr.len + NVOCMP_ITEMHDRLEN;
+      NVOCMP_copyItem(pBg->srcPg, pBg->dstPg, hOfs - iHdr.len, pBg->dstOff, iLen);
+      if(NVOCMP_failW != NVINTF_SUCCESS)
+      {
+        NVOCMP_bgAbort(pNvHandle);
+        return(false);
+      }
+      pBg->dstOff += iLen;
+      maxItems--;
+    }
+    pBg->srcOff = hOfs - iHdr.len;
+  }
+
+  if(pBg->srcOff > pBg->loOff)
+  {
+    return(true);
+  }
+
+  if(pNvHandle->actOffset > pBg->hiOff)
+  {
+    // Next pass for the items written during this one
+    pBg->loOff = pBg->hiOff;
+    pBg->hiOff = pNvHandle->actOffset;
+    pBg->srcOff = pBg->hiOff;
+    return(true);
+  }
+
+  // Every active item is on the other page, switch pages. Both pages are
+  // complete until the source page is marked, initNv() can resume from either.
+  pNvHandle->pageInfo[pBg->dstPg].offset = pBg->dstOff;
+  if(FLASH_PAGE_SIZE - pBg->dstOff >= 16)
+  {
+    NVOCMP_changePageState(pNvHandle, pBg->dstPg, NVOCMP_PGACT);
+  }
+  else
+  {
+    NVOCMP_changePageState(pNvHandle, pBg->dstPg, NVOCMP_PGFULL);
+  }
+  NVOCMP_changePageState(pNvHandle, pBg->srcPg, NVOCMP_PGXSRC);
+  NVOCMP_failW |= NVOCMP_erase(pNvHandle, pBg->srcPg);
+
+  // mark XDST page as done
+  NVOCMP_writeByte(pBg->dstPg, NVOCMP_COMPMODEOFS, NVOCMP_PGCDONE);
+  pNvHandle->pageInfo[pBg->dstPg].mode = NVOCMP_PGCDONE;
+
+  // move tail page and head page
+  pNvHandle->tailPage = pBg->srcPg;
+  pNvHandle->headPage = pBg->dstPg;
+  pNvHandle->actPage = pBg->dstPg;
+  pNvHandle->actOffset = pBg->dstOff;
+  NVOCMP_changePageState(pNvHandle, pBg->srcPg, NVOCMP_PGXDST);
+
+  pBg->state = NVOCMP_BGIDLE;
+  NVOCMP_bgFree = FLASH_PAGE_SIZE - pNvHandle->actOffset;
+  NVOCMP_ALERT(false, "Background compaction done.")
+
+  return(false);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_bgAbort
+ *
+ * @brief   Stop a background compaction and drop its copies. No other
+ *          background compaction starts until a regular one is done.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ *
+ * @return  none
+ */
+static void NVOCMP_bgAbort(NVOCMP_nvHandle_t *pNvHandle)
+{
+  NVOCMP_bgInfo.state = NVOCMP_BGIDLE;
+  NVOCMP_bgFree = 0;
+
+  NVOCMP_failW = NVOCMP_erase(pNvHandle, NVOCMP_bgInfo.dstPg);
+  NVOCMP_changePageState(pNvHandle, NVOCMP_bgInfo.dstPg, NVOCMP_PGXDST);
+}
+
+/******************************************************************************
+ * @fn      NVOCMP_bgDrop
+ *
+ * @brief   Mark the copy of a source page item inactive on the destination
+ *          page of the background compaction
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   iOfs - offset of the item header on the source page
+ *
+ * @return  none
+ */
+static void NVOCMP_bgDrop(NVOCMP_nvHandle_t *pNvHandle, uint16_t iOfs)
+{
+  NVOCMP_itemHdr_t iHdr;
+  NVOCMP_itemHdr_t cHdr;
+  uint16_t ofs = NVOCMP_bgInfo.dstOff;
+
+  NVOCMP_readHeader(NVOCMP_bgInfo.srcPg, iOfs, &iHdr, false);
+
+  // Copies were checked, so lengths can be trusted
+  while(ofs > NVOCMP_PGDATAOFS)
+  {
+    ofs -= NVOCMP_ITEMHDRLEN;
+    NVOCMP_readHeader(NVOCMP_bgInfo.dstPg, ofs, &cHdr, false);
+    if((cHdr.cmpid == iHdr.cmpid) && (cHdr.stats & NVOCMP_ACTIVEIDBIT))
+    {
+      NVOCMP_setItemInactive(pNvHandle, NVOCMP_bgInfo.dstPg, ofs);
+      break;
+    }
+    ofs -= cHdr.len;
+  }
+}
+#elif NVOCMP_BGCOMPACT
+/******************************************************************************
+ * @fn      NVOCMP_bgStep
+ *
+ * @brief   Compact ahead of time when the free space falls below the
+ *          watermark. Items only move a few at a time with two pages, with
+ *          other page counts this is a regular compaction.
+ *
+ * @param   pNvHandle - pointer to NV handle
+ * @param   maxItems - not used
+ *
+ * @return  false, there is nothing more to do
+ */
+static bool NVOCMP_bgStep(NVOCMP_nvHandle_t *pNvHandle, uint16_t maxItems)
+{
+  (void)maxItems;
+
+  // Reset Flash erase/write fail indicator
+  NVOCMP_failW = NVINTF_SUCCESS;
+
+  // Enough room, or last compaction was no better
+  if((NVOCMP_getFreeNvApi() < NVOCMP_BGWATERMARK) &&
+     (NVOCMP_bgFree >= NVOCMP_BGWATERMARK))
+  {
+    (void)NVOCMP_compactPage(pNvHandle, 0);
+    if(NVOCMP_failW != NVINTF_SUCCESS)
+    {
+      // Don't keep trying
+      NVOCMP_bgFree = 0;
+    }
+  }
+
+  return(false);
+}
+#endif
+
 /******************************************************************************
 * @fn      NVOCMP_findSignature
 *
@@ -4647,7 +5995,7 @@ static NVOCMP_compactStatus_t NVOCMP_compact(NVOCMP_nvHandle_t *pNvHandle)
 }
 #endif
 
-#if ((NVOCMP_NVPAGES > NVOCMP_NVONEP) && !defined(NVOCMP_MIGRATE_DISABLED))
+#if ((NVOCMP_NVPAGES > NVOCMP_NVONEP) && (!defined(NVOCMP_MIGRATE_DISABLED) || NVOCMP_BGCOPY))
 /******************************************************************************
  * @fn      NVOCMP_copyItem
  *
@@ -4745,18 +6093,26 @@ static uint8_t NVOCMP_doNVCRC(uint8_t pg, uint16_t ofs, uint16_t len, uint8_t cr
     uint8_t tmp[NVOCMP_XFERBLKMAX];
     crc_t newCRC = (crc_t)crc;
 
+    if(flag)
+    {
+        // Data is in RAM already
+        return(crc_update(newCRC, pTBuffer + ofs, len));
+    }
+
+#if NVOCMP_CRCMAPPED
+    if(NVOCMP_nvsAttrs.regionBase != NVS_REGION_NOT_ADDRESSABLE)
+    {
+        // Flash can be read in place, no need to copy it out
+        return(crc_update(newCRC, (uint8_t *)NVOCMP_nvsAttrs.regionBase +
+                          NVOCMP_FLASHOFFSET(pg, ofs), len));
+    }
+#endif
+
     // Read flash and compute CRC in blocks
     while(len > 0)
     {
         rdLen  = (len < NVOCMP_XFERBLKMAX ? len : NVOCMP_XFERBLKMAX);
-        if(flag)
-        {
-          memcpy((uint8_t *)tmp, (uint8_t *)(pTBuffer+ofs), rdLen);
-        }
-        else
-        {
-          NVOCMP_read(pg, ofs, tmp, rdLen);
-        }
+        NVOCMP_read(pg, ofs, tmp, rdLen);
         newCRC = crc_update(newCRC,tmp,rdLen);
         len   -= rdLen;
         ofs   += rdLen;
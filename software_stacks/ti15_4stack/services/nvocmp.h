@@ -63,6 +63,7 @@ extern "C"
 
 // NV driver item ID definitions
 #define NVOCMP_NVID_DIAG {NVINTF_SYSID_NVDRVR, 1, 0}
+#define NVOCMP_NVID_TXN  {NVINTF_SYSID_NVDRVR, 2, 0}
 
 //*****************************************************************************
 // Typedefs
@@ -154,6 +155,22 @@ extern void NVOCMP_setCheckVoltage(void *funcPtr);
  */
 extern void NVOCMP_setLowVoltageCb(lowVoltCbFptr funcPtr);
 
+/**
+ * @fn      NVOCMP_compactStep
+ *
+ * @brief   Global function to do some of the next compaction ahead of time,
+ *          from an idle hook or a low priority task. Once the free space of
+ *          the active page falls below NVOCMP_BGWATERMARK, each call copies
+ *          up to maxItems active items to the compaction page, so an item
+ *          write doesn't have to wait for a whole page compaction.
+ *          Requires NVOCMP_BGCOMPACT, which is off by default.
+ *
+ * @param   maxItems - maximum number of items to copy in this step
+ *
+ * @return  true if there is more to do, false if not
+ */
+extern bool NVOCMP_compactStep(uint16_t maxItems);
+
 // Exception function can be defined to handle NV corruption issues
 // If none provided, NV module attempts to proceed ignoring problem
 #if !defined (NVOCMP_EXCEPTION)
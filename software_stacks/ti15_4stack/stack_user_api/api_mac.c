@@ -330,6 +330,30 @@ void ApiMac_processIncoming(void)
     }
 }
 
+/*!
+ Process one message from the MAC stack without waiting.
+
+ Public function defined in api_mac.h
+ */
+bool ApiMac_processPending(void)
+{
+    macCbackEvent_t *pMsg;
+
+    /* Retrieve the response message, if any */
+    pMsg = (macCbackEvent_t*) OsalPort_msgReceive( appTaskId );
+    if(pMsg == NULL)
+    {
+        return (false);
+    }
+
+    /* Process the message from the MAC stack */
+    processIncomingICallMsg(pMsg);
+
+    OsalPort_msgDeallocate((uint8_t*)pMsg);
+
+    return (true);
+}
+
 /*!
  This function sends application data to the MAC for
  transmission in a MAC data frame.
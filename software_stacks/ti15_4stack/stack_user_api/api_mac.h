@@ -97,6 +97,7 @@
  - ApiMac_init()
  - ApiMac_registerCallbacks()
  - ApiMac_processIncoming()
+ - ApiMac_processPending()
 
  Data Interfaces
  ===============================
@@ -2534,6 +2535,18 @@ extern void ApiMac_registerCallbacks(ApiMac_callbacks_t *pCallbacks);
  */
 extern void ApiMac_processIncoming(void);
 
+/*!
+ * @brief       Process one message from the MAC stack, if there is one,
+ *              without waiting.
+ *
+ * Lets an application with pending events of its own keep up with the
+ * MAC. The semaphore is not taken, the application's next call to
+ * ApiMac_processIncoming() returns without a message instead.
+ *
+ * @return      true if a message was processed, false if there was none
+ */
+extern bool ApiMac_processPending(void);
+
 /*!
  * @brief       This function sends application data to the MAC for
  *              transmission in a MAC data frame.